@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include <CommandQueue.h>
+
+/*
+ * One pass of loop(): run the command that's due, then find the next. The
+ * radar has three to five commands queued at a time, so a few sizes around
+ * that show how finding the next one grows with the queue.
+ *
+ * The commands count calls in their context and do nothing else, and the
+ * clock moves on a millisecond a pass, so they take turns as on the device.
+ */
+
+namespace {
+
+__attribute__((noinline)) void count(void* context) {
+  ++*static_cast<uint32_t*>(context);
+}
+
+} // namespace
+
+static void BM_CommandQueueDispatch(benchmark::State& state) {
+  auto n = (uint16_t)state.range(0);
+  // a context each, as entries are told apart by function and context
+  auto* calls = new uint32_t[n] {};
+  CommandQueue queue;
+  for (uint16_t i = 0; i < n; ++i) {
+    queue.add_entry(count, &calls[i], 25 + 25 * i);
+  }
+
+  for (auto _ : state) {
+    NullArduino::advance(1000);
+    benchmark::DoNotOptimize(queue.execute_current_entry());
+  }
+
+  state.counters["scans_per_call"] = benchmark::Counter(
+      (double)queue.scans() / (double)state.iterations());
+  queue.clear_queue();
+  delete[] calls;
+}
+BENCHMARK(BM_CommandQueueDispatch)->Arg(1)->Arg(3)->Arg(5)->Arg(8)->Arg(16);
+
+// adding and removing a state's commands, as each state change does
+static void BM_CommandQueueAddRemove(benchmark::State& state) {
+  uint32_t calls[3] {};
+  CommandQueue queue;
+  uint32_t resident = 0;
+  queue.add_entry(count, &resident, 100);
+
+  for (auto _ : state) {
+    for (auto& c : calls) {
+      queue.add_entry(count, &c, 250);
+    }
+    for (auto& c : calls) {
+      queue.remove_entry(count, &c);
+    }
+    benchmark::DoNotOptimize(queue.next_call_time());
+  }
+  queue.clear_queue();
+}
+BENCHMARK(BM_CommandQueueAddRemove);
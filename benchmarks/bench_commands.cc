@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+#include <CommandQueue.h>
+
+/*
+ * Command dispatch, plain function pointer with the context passed in against
+ * the old virtual function objects sharing one static context, which are
+ * reproduced below. Four commands are called in turn, as the queue does, so
+ * the call target keeps changing.
+ *
+ * The commands just count calls in their context, so what's timed is the
+ * call itself.
+ */
+
+namespace {
+
+struct Context {
+  uint32_t calls[4] {};
+};
+
+namespace legacy {
+
+class FunctionObject {
+ public:
+  virtual void operator()() = 0;
+  virtual ~FunctionObject() = default;
+};
+
+class RadarAction : public FunctionObject {
+ public:
+  inline static Context* context_;
+};
+
+template<uint8_t I>
+class Do : public RadarAction {
+ public:
+  static RadarAction* instance(Context* c) {
+    static RadarAction* instance_ = new Do<I>;
+    context_ = c;
+    return instance_;
+  }
+  __attribute__((noinline)) void operator()() final {
+    ++context_->calls[I];
+  }
+};
+
+} // namespace legacy
+
+template<uint8_t I>
+__attribute__((noinline)) void command(void* context) {
+  ++static_cast<Context*>(context)->calls[I];
+}
+
+} // namespace
+
+static void BM_VirtualCommand(benchmark::State& state) {
+  Context context;
+  legacy::FunctionObject* commands[4] {
+      legacy::Do<0>::instance(&context), legacy::Do<1>::instance(&context),
+      legacy::Do<2>::instance(&context), legacy::Do<3>::instance(&context)};
+
+  uint8_t i = 0;
+  for (auto _ : state) {
+    legacy::FunctionObject* current = commands[i++ & 3];
+    benchmark::DoNotOptimize(current);
+    (*current)();
+  }
+  benchmark::DoNotOptimize(context);
+
+  // pointer in each entry, plus one heap object (vtable pointer) and one
+  // instance pointer per command, and the shared context pointer
+  state.counters["ram_bytes"] = (double)(4 * (sizeof(void*) + sizeof(void*)
+                                             + sizeof(void*))
+                                         + sizeof(void*));
+}
+BENCHMARK(BM_VirtualCommand);
+
+static void BM_FunctionCommand(benchmark::State& state) {
+  Context context;
+  struct {
+    Command function;
+    void* context;
+  } commands[4] {{command<0>, &context}, {command<1>, &context},
+                 {command<2>, &context}, {command<3>, &context}};
+
+  uint8_t i = 0;
+  for (auto _ : state) {
+    auto& current = commands[i++ & 3];
+    benchmark::DoNotOptimize(current);
+    current.function(current.context);
+  }
+  benchmark::DoNotOptimize(context);
+
+  // function and context pointer in each entry
+  state.counters["ram_bytes"] = (double)(4 * (sizeof(Command) + sizeof(void*)));
+}
+BENCHMARK(BM_FunctionCommand);
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <IntFormat.h>
+#include <LCDBuffer.h>
+
+#include <cstring>
+
+/*
+ * A distance printed after "Distance: ", the way DoPing used to through
+ * LiquidCrystal's Print, against IntFormat. Both write into an LCDBuffer so
+ * only the formatting differs.
+ *
+ * Print::printNumber() is reproduced below. It divides twice per digit, which
+ * on the host is a single instruction, but on the AVR a call into the 32 bit
+ * division routine. So the host understates the difference; div_per_print
+ * counts the divisions each way makes.
+ */
+
+namespace legacy {
+
+// Print::print(unsigned long, int) and Print::printNumber() from the Arduino
+// AVR core, writing to the screen rather than the LCD
+template<typename Screen>
+size_t printNumber(Screen& screen, unsigned long n, uint8_t base,
+                   uint32_t& divisions) {
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+
+  *str = '\0';
+  if (base < 2) base = 10;
+
+  do {
+    char c = n % base;
+    n /= base;
+    divisions += 2;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+
+  screen.print(str);
+  return std::strlen(str);
+}
+
+} // namespace legacy
+
+static const uint32_t distances[] {0, 7, 61, 299, 845, 1234, 4000, 6516};
+static const uint8_t n_distances {sizeof(distances) / sizeof(*distances)};
+
+static void BM_PrintDistance(benchmark::State& state) {
+  LCDBuffer screen;
+  uint32_t divisions = 0;
+  uint8_t i = 0;
+
+  for (auto _ : state) {
+    uint32_t distance = distances[i++ % n_distances];
+    benchmark::DoNotOptimize(distance);
+    screen.setCursor(10, 1);
+    legacy::printNumber(screen, distance, 10, divisions);
+    screen.print("  ");
+  }
+  benchmark::DoNotOptimize(screen);
+
+  state.counters["div_per_print"] = benchmark::Counter(
+      (double)divisions, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_PrintDistance);
+
+static void BM_IntFormatDistance(benchmark::State& state) {
+  LCDBuffer screen;
+  uint8_t i = 0;
+
+  for (auto _ : state) {
+    uint32_t distance = distances[i++ % n_distances];
+    benchmark::DoNotOptimize(distance);
+    screen.setCursor(10, 1);
+    screen.print(distance, 6);
+  }
+  benchmark::DoNotOptimize(screen);
+
+  state.counters["div_per_print"] = 0;
+}
+BENCHMARK(BM_IntFormatDistance);
+
+// just the formatting, into a plain buffer
+static void BM_FormatUint(benchmark::State& state) {
+  char out[6];
+  uint8_t i = 0;
+
+  for (auto _ : state) {
+    uint32_t distance = distances[i++ % n_distances];
+    benchmark::DoNotOptimize(distance);
+    IntFormat::format_uint(out, sizeof(out), distance);
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_FormatUint);
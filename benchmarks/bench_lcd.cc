@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include <LCDBuffer.h>
+#include <LiquidCrystal.h>
+
+/*
+ * The distance line the ping command writes, from formatting it into the
+ * screen buffer to the bytes going out to the LCD's pins. flush() sends what
+ * changed to LiquidCrystal's queue, then the queue is drained, as lcd_poll()
+ * would over the next few milliseconds.
+ */
+
+namespace {
+
+class LCDFixture : public benchmark::Fixture {
+ protected:
+  LCDBuffer screen_;
+  LiquidCrystal lcd_ {14, 15, 16, 17, 18, 19, 13, 12, 8, 7};
+
+ public:
+  void SetUp(const benchmark::State&) override {
+    lcd_.begin(16, 2);
+    lcd_.flush();
+    screen_.reset();
+  }
+};
+
+} // namespace
+
+BENCHMARK_F(LCDFixture, BM_LCDFormat)(benchmark::State& state) {
+  uint32_t distance = 0;
+  for (auto _ : state) {
+    screen_.setCursor(0, 1);
+    screen_.print("Distance: ");
+    screen_.print(distance, LCDBuffer::cols - 10);
+    distance = (distance + 37) % 4000;
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_F(LCDFixture, BM_LCDFormatAndSend)(benchmark::State& state) {
+  uint32_t distance = 0;
+  uint32_t cells = 0;
+  for (auto _ : state) {
+    screen_.setCursor(0, 1);
+    screen_.print("Distance: ");
+    screen_.print(distance, LCDBuffer::cols - 10);
+    distance = (distance + 37) % 4000;
+    cells += screen_.flush(lcd_);
+    lcd_.flush();
+  }
+  state.counters["cells_per_line"] = benchmark::Counter(
+      (double)cells / (double)state.iterations());
+}
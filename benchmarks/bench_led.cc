@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include <MyLED.h>
+
+/*
+ * tick() is the LED's timer ISR, run every 1024µs, so it's what the LED costs
+ * the rest of the firmware. Pulsing while fading to a new colour is the most
+ * it does in a tick, steady with nothing to fade the least.
+ */
+
+static void BM_LEDTickPulse(benchmark::State& state) {
+  MyLED led {3, 6, 5};
+  led.set_effect(LEDEffect::PULSE, 3000);
+  // a fade every 256 ticks, so most of them have one going
+  uint8_t i = 0;
+  bool red = false;
+
+  for (auto _ : state) {
+    if (++i == 0) {
+      red = !red;
+      led.set_colour(red ? LEDColour::RED : LEDColour::GREEN, 200);
+    }
+    led.tick();
+  }
+}
+BENCHMARK(BM_LEDTickPulse);
+
+static void BM_LEDTickSteady(benchmark::State& state) {
+  MyLED led {3, 6, 5};
+  led.set_colour(LEDColour::GREEN);
+  led.set_effect(LEDEffect::STEADY);
+
+  for (auto _ : state) {
+    led.tick();
+  }
+}
+BENCHMARK(BM_LEDTickSteady);
+
+// what sensing_react() does after every ping
+static void BM_LEDSetColour(benchmark::State& state) {
+  MyLED led {3, 6, 5};
+  const LEDColour colours[] {LEDColour::RED, LEDColour::ORANGE,
+                             LEDColour::YELLOW, LEDColour::GREEN};
+  uint8_t i = 0;
+
+  for (auto _ : state) {
+    led.set_colour(colours[i++ & 3], 200);
+  }
+}
+BENCHMARK(BM_LEDSetColour);
@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+#include <LinkedList.h>
+
+/*
+ * The command queue's list. Inserts go at the head, so they cost the same
+ * however long the list is, but a remove walks it to find its match. Removing
+ * in the order inserted finds each one at the tail, the worst case.
+ */
+
+static void BM_LinkedListInsertRemove(benchmark::State& state) {
+  auto n = (uint32_t)state.range(0);
+  LinkedList<uint32_t> list;
+
+  for (auto _ : state) {
+    for (uint32_t i = 0; i < n; ++i) {
+      list.insert(i);
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+      list.remove(i);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_LinkedListInsertRemove)
+    ->RangeMultiplier(2)->Range(1, 32)->Complexity(benchmark::oNSquared);
+
+static void BM_LinkedListIterate(benchmark::State& state) {
+  LinkedList<uint32_t> list;
+  for (uint32_t i = 0; i < (uint32_t)state.range(0); ++i) {
+    list.insert(i);
+  }
+
+  for (auto _ : state) {
+    uint32_t sum = 0;
+    for (auto it = list.begin(); it != list.end(); ++it) {
+      sum += **it;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_LinkedListIterate)
+    ->RangeMultiplier(2)->Range(1, 32)->Complexity(benchmark::oN);
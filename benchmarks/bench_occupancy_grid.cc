@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <OccupancyGrid.h>
+
+#include <sstream>
+#include <string>
+
+// The radar pings every 550ms, so this many samples is an hour of data
+static const uint32_t samples_per_hour {3600 * 1000 / 550};
+
+/*
+ * Sweep Stream
+ *
+ * Make a text sweep stream the same shape as the unit produces: servo angle
+ * moving back and forth 22° per ping, ranges between 0.3m and 4m with the
+ * odd missing echo.
+ */
+static std::string sweep_stream(uint32_t samples) {
+  std::ostringstream out;
+  out << "time_ms,angle,range_mm\n";
+
+  int angle = 0, direction = 22;
+  uint32_t seed = 1;
+
+  for (uint32_t i = 0; i < samples; ++i) {
+    seed = seed * 1103515245 + 12345;  // cheap LCG, just needs to be varied
+    uint32_t range = 300 + (seed >> 8) % 3700;
+    if ((seed & 0xF) == 0) {
+      range = UINT32_MAX;
+    }
+
+    out << i * 550 << "," << angle << "," << range << "\n";
+
+    if (angle + direction > 180 || angle + direction < 0) {
+      direction = -direction;
+    }
+    angle += direction;
+  }
+  return out.str();
+}
+
+static void BM_OccupancyGridAddRay(benchmark::State& state) {
+  OccupancyGrid::Params params;
+  params.cell_mm = (uint16_t)state.range(0);
+  OccupancyGrid grid {params};
+
+  float angle = 0;
+  uint32_t range = 300;
+
+  for (auto _ : state) {
+    grid.add_ray(angle, range);
+
+    angle = (angle >= 180) ? 0 : angle + 1.5f;
+    range = (range >= 4000) ? 300 : range + 37;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OccupancyGridAddRay)->Arg(50)->Arg(20)->Arg(10)->Arg(5);
+
+/*
+ * Parse and rasterise whole hours of recorded data. hours_per_second is how
+ * many hours of data from one unit are handled each second.
+ */
+static void BM_OccupancyGridIngest(benchmark::State& state) {
+  std::string stream = sweep_stream(samples_per_hour * state.range(0));
+  OccupancyGrid grid;
+
+  for (auto _ : state) {
+    std::istringstream in {stream};
+    grid.clear();
+    benchmark::DoNotOptimize(ingest(in, grid));
+  }
+
+  state.SetItemsProcessed(state.iterations() * samples_per_hour
+                              * state.range(0));
+  state.counters["hours_per_second"] = benchmark::Counter(
+      (double)state.iterations() * state.range(0),
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_OccupancyGridIngest)->Arg(1)->Arg(24)->Unit(benchmark::kMillisecond);
+
+static void BM_OccupancyGridWritePGM(benchmark::State& state) {
+  OccupancyGrid grid;
+  std::istringstream in {sweep_stream(samples_per_hour)};
+  ingest(in, grid);
+
+  for (auto _ : state) {
+    std::ostringstream out;
+    grid.write_pgm(out);
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_OccupancyGridWritePGM)->Unit(benchmark::kMillisecond);
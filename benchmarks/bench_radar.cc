@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <radar.h>
+
+/*
+ * What Radar does between the hardware: turning the echo times the ISR left
+ * into a distance in ping(), and stepping the servo in move(). The times are
+ * set before each ping as the ISR would, over the sensor's range.
+ */
+
+static void BM_RadarPing(benchmark::State& state) {
+  Radar<Servo> radar;
+  radar.init(4, 2, 9);
+  uint32_t echo_us = 100;
+
+  for (auto _ : state) {
+    EchoISR::pulse_start_ = 1000;
+    EchoISR::pulse_end_ = 1000 + echo_us;
+    benchmark::DoNotOptimize(radar.ping());
+    echo_us = (echo_us < 23000) ? echo_us + 37 : 100;
+  }
+}
+BENCHMARK(BM_RadarPing);
+
+// nothing came back, the common case in an empty room
+static void BM_RadarPingNoEcho(benchmark::State& state) {
+  Radar<Servo> radar;
+  radar.init(4, 2, 9);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(radar.ping());
+  }
+}
+BENCHMARK(BM_RadarPingNoEcho);
+
+static void BM_RadarMove(benchmark::State& state) {
+  Radar<Servo> radar;
+  radar.init(4, 2, 9);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(radar.move());
+  }
+}
+BENCHMARK(BM_RadarMove);
@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+#include <RadarState.h>
+#include <test/MockCommandQueue.h>
+#include <test/MockLiquidCrystal.h>
+#include <test/MockMyLED.h>
+#include <test/MockRadar.h>
+
+/*
+ * Most updates don't change state: the PIR check finds nothing in standby, or
+ * something is still too close in warning. These benchmarks time just that
+ * dispatch, table driven against the old design of one virtual singleton per
+ * state, which is reproduced below.
+ */
+
+namespace legacy {
+
+class State {
+ public:
+  virtual void update(uint32_t input) = 0;
+};
+
+class Standby : public State {
+ public:
+  static State* instance() {
+    static Standby* instance_ = new Standby;
+    return instance_;
+  }
+  void update(uint32_t input) final {
+    if (input) {
+      benchmark::DoNotOptimize(input);
+    }
+  }
+};
+
+class Warning : public State {
+ public:
+  static State* instance() {
+    static Warning* instance_ = new Warning;
+    return instance_;
+  }
+  void update(uint32_t distance) final {
+    if (distance >= CFG::distance_warning) {
+      benchmark::DoNotOptimize(distance);
+    }
+  }
+};
+
+} // namespace legacy
+
+/*
+ * The context holds mock peripherals in a host build, which need somewhere to
+ * point. None of them are touched by a dispatch that doesn't change state.
+ */
+class ContextFixture : public benchmark::Fixture {
+ protected:
+  testing::NiceMock<MockMyLED> led_;
+  testing::NiceMock<MockCommandQueue> queue_;
+  testing::NiceMock<MockRadar> radar_;
+  testing::NiceMock<MockLiquidCrystal> lcd_;
+  RadarContext* context_ {nullptr};
+
+ public:
+  void SetUp(const benchmark::State&) override {
+    MyLEDMockInterface::mock_led_ = &led_;
+    CommandQueueMockInterface::mock_queue_ = &queue_;
+    RadarMockInterface::mock_radar_ = &radar_;
+    LiquidCrystalMockInterface::mock_lcd_ = &lcd_;
+    context_ = new RadarContext;
+  }
+  void TearDown(const benchmark::State&) override {
+    delete context_;
+  }
+};
+
+static void set_state_counters(benchmark::State& state, size_t ram) {
+  state.counters["state_ram_bytes"] = (double)ram;
+}
+
+BENCHMARK_F(ContextFixture, BM_TableDispatchStandby)(benchmark::State& state) {
+  for (auto _ : state) {
+    RadarState::update(context_, RadarStateId::STANDBY, 0);
+  }
+  set_state_counters(state, sizeof(RadarStateId));
+}
+
+BENCHMARK_F(ContextFixture, BM_TableDispatchWarning)(benchmark::State& state) {
+  uint32_t distance = CFG::distance_warning - 1;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(distance);
+    RadarState::update(context_, RadarStateId::WARNING, distance);
+  }
+  set_state_counters(state, sizeof(RadarStateId));
+}
+
+// context pointer to the current state, plus each singleton and its pointer
+static const size_t legacy_ram {sizeof(legacy::State*)
+                                + 3 * (sizeof(legacy::Standby)
+                                       + sizeof(legacy::State*))};
+
+static void BM_VirtualDispatchStandby(benchmark::State& state) {
+  legacy::State* current = legacy::Standby::instance();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(current);
+    current->update(0);
+  }
+  set_state_counters(state, legacy_ram);
+}
+BENCHMARK(BM_VirtualDispatchStandby);
+
+static void BM_VirtualDispatchWarning(benchmark::State& state) {
+  legacy::State* current = legacy::Warning::instance();
+  uint32_t distance = CFG::distance_warning - 1;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(current);
+    benchmark::DoNotOptimize(distance);
+    current->update(distance);
+  }
+  set_state_counters(state, legacy_ram);
+}
+BENCHMARK(BM_VirtualDispatchWarning);
+
+// every state and event, as looked up after each react
+static void BM_TransitionLookup(benchmark::State& state) {
+  uint8_t i = 0;
+  for (auto _ : state) {
+    auto s = (RadarStateId)(i % 3);
+    auto e = (StateEvent)(i % 5);
+    benchmark::DoNotOptimize(RadarState::next_state(s, e));
+    ++i;
+  }
+}
+BENCHMARK(BM_TransitionLookup);
@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <RadarState.h>
+
+/*
+ * The whole of a visit, through the real RadarContext with everything it
+ * drives doing nothing: the PIR sees someone, they come too close and back
+ * off, then nothing is in range for standby_timeout. That's four state
+ * changes, each stopping and starting states, changing the queued commands,
+ * the LED and the screen buffer.
+ */
+
+static void BM_StateCycle(benchmark::State& state) {
+  RadarContext context;
+  context.init();
+
+  for (auto _ : state) {
+    context.update(1);                             // STANDBY -> SENSING
+    context.update(CFG::distance_warning - 1);     // -> WARNING
+    context.update(CFG::distance_green);           // -> SENSING
+    NullArduino::advance(CFG::standby_timeout * 1000);
+    context.update(UINT32_MAX);                    // -> STANDBY
+  }
+  if (context.get_state() != RadarStateId::STANDBY) {
+    state.SkipWithError("didn't get back to standby");
+  }
+  state.SetItemsProcessed(state.iterations() * 4);
+}
+BENCHMARK(BM_StateCycle);
+
+// a ping in SENSING that changes nothing but the LED colour
+static void BM_StateSensingPing(benchmark::State& state) {
+  RadarContext context;
+  context.init();
+  context.update(1);
+  uint32_t distance = CFG::distance_red;
+
+  for (auto _ : state) {
+    context.update(distance);
+    distance = (distance < CFG::distance_yellow) ? distance + 7
+                                                 : CFG::distance_red;
+  }
+}
+BENCHMARK(BM_StateSensingPing);
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include <TargetTracker.h>
+
+/*
+ * Sweep
+ *
+ * Fake a radar sweeping back and forth 22° per ping across a room with a few
+ * objects in it, with a gap of nothing in range between each one.
+ */
+static void sweep(TargetTracker& tracker, int64_t samples) {
+  uint8_t angle = 0;
+  int8_t direction = 22;
+  uint32_t time = 0;
+
+  for (int64_t i = 0; i < samples; ++i) {
+    uint32_t range;
+    if (angle < 40) {
+      range = 600;
+    } else if (angle < 70) {
+      range = UINT32_MAX;
+    } else if (angle < 120) {
+      range = 1500 + (i & 0x3F); // a bit of noise
+    } else {
+      range = 3000;
+    }
+
+    tracker.add_sample(angle, range, time);
+
+    if (angle + direction > 180 || angle + direction < 0) {
+      direction = -direction;
+    }
+    angle += direction;
+    time += 550;
+  }
+}
+
+/*
+ * Cost per sample should be flat no matter how many samples have been fed in,
+ * so items_per_second should be the same at every size and total time should
+ * fit O(N).
+ */
+static void BM_TargetTrackerAddSample(benchmark::State& state) {
+  for (auto _ : state) {
+    TargetTracker tracker;
+    sweep(tracker, state.range(0));
+    benchmark::DoNotOptimize(tracker);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_TargetTrackerAddSample)
+    ->RangeMultiplier(8)->Range(8, 1 << 18)->Complexity(benchmark::oN);
+
+static void BM_TargetTrackerNearest(benchmark::State& state) {
+  TargetTracker tracker;
+  Target targets[TargetTracker::max_targets];
+  sweep(tracker, 64);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tracker.nearest(targets, state.range(0)));
+  }
+}
+BENCHMARK(BM_TargetTrackerNearest)->DenseRange(1, TargetTracker::max_targets);
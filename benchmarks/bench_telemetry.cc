@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+#include <TelemetrySender.h>
+#include <TelemetryDecoder.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/*
+ * Telemetry, from the firmware framing a ping to the host decoding it. The
+ * pings are a sweep as the radar makes them, a degree a ping back and forth,
+ * 30ms apart, over something 400mm or so away with now and then no echo.
+ */
+
+namespace {
+
+struct Sweep {
+  uint32_t time {0};
+  uint8_t angle {90};
+  int8_t step {1};
+  uint32_t noise {1};
+
+  void next() {
+    time += 30;
+    if (angle == 0 || angle == 180) {
+      step = (int8_t)-step;
+    }
+    angle = (uint8_t)(angle + step);
+    noise = noise * 1103515245 + 12345;
+  }
+
+  uint32_t range() const {
+    return ((noise >> 16) % 17 == 0) ? UINT32_MAX : 400 + (noise >> 16) % 40;
+  }
+};
+
+size_t drain(std::vector<uint8_t>& out) {
+  size_t n = 0;
+  uint8_t byte;
+  while (TelemetrySender::read(byte)) {
+    out.push_back(byte);
+    ++n;
+  }
+  return n;
+}
+
+} // namespace
+
+// framing a ping into the buffer, and taking it out again
+static void BM_TelemetryEncode(benchmark::State& state) {
+  TelemetrySender::start();
+  Sweep sweep;
+  std::vector<uint8_t> sent;
+  sent.reserve(64);
+  size_t bytes = 0;
+
+  for (auto _ : state) {
+    sweep.next();
+    TelemetrySender::range(sweep.angle, sweep.range(), sweep.time);
+    sent.clear();
+    bytes += drain(sent);
+    benchmark::DoNotOptimize(sent.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["bytes_per_ping"] = (double)bytes / state.iterations();
+}
+BENCHMARK(BM_TelemetryEncode);
+
+// decoding a recorded stream on the host
+static void BM_TelemetryDecode(benchmark::State& state) {
+  TelemetrySender::start();
+  Sweep sweep;
+  std::vector<uint8_t> stream;
+  for (int i = 0; i < 4096; ++i) {
+    sweep.next();
+    TelemetrySender::range(sweep.angle, sweep.range(), sweep.time);
+    drain(stream);
+  }
+
+  size_t rows = 0;
+  for (auto _ : state) {
+    TelemetryDecoder decoder;
+    rows += decoder.feed(stream.data(), stream.size());
+  }
+  state.SetItemsProcessed((int64_t)rows);
+  state.SetBytesProcessed(state.iterations() * (int64_t)stream.size());
+}
+BENCHMARK(BM_TelemetryDecode);
+
+/*
+ * Each ping written into one end of a pty and decoded from the other, as
+ * telemetry_decode reads a serial port. A pty has no line speed of its own,
+ * so the writes are held back to what the baud rate (10 bits a byte) would
+ * take. The pings a second it manages is the most the link carries.
+ */
+static void BM_TelemetryPty(benchmark::State& state) {
+  auto baud = (unsigned long)state.range(0);
+
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  int slave = -1;
+  if (master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0) {
+    slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  }
+  if (slave < 0) {
+    state.SkipWithError("no pty");
+    return;
+  }
+  for (int fd : {master, slave}) {
+    termios tio {};
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, baud == 9600 ? B9600 : B115200);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+
+  TelemetrySender::start();
+  TelemetryDecoder decoder;
+  Sweep sweep;
+  std::vector<uint8_t> sent;
+  uint8_t received[256];
+  uint64_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  for (auto _ : state) {
+    sweep.next();
+    TelemetrySender::range(sweep.angle, sweep.range(), sweep.time);
+    sent.clear();
+    drain(sent);
+    if (write(slave, sent.data(), sent.size()) != (ssize_t)sent.size()) {
+      state.SkipWithError("write failed");
+      break;
+    }
+    bytes += sent.size();
+    std::this_thread::sleep_until(
+        start + std::chrono::microseconds(bytes * 10 * 1000000 / baud));
+
+    bool decoded = false;
+    while (!decoded) {
+      pollfd ready {master, POLLIN, 0};
+      ssize_t n = 0;
+      if (poll(&ready, 1, 1000) != 1
+          || (n = read(master, received, sizeof(received))) <= 0) {
+        break;
+      }
+      decoded = decoder.feed(received, (size_t)n) != 0;
+    }
+    if (!decoded) {
+      state.SkipWithError("nothing decoded");
+      break;
+    }
+  }
+  close(slave);
+  close(master);
+
+  state.SetItemsProcessed((int64_t)decoder.rows().size());
+  state.SetBytesProcessed((int64_t)bytes);
+  state.counters["bad"] = (double)decoder.stats().bad;
+}
+BENCHMARK(BM_TelemetryPty)->Arg(9600)->Arg(115200)->UseRealTime();
@@ -0,0 +1,92 @@
+#ifndef A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_ARDUINO_H_
+#define A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_ARDUINO_H_
+
+/*
+ * Stand in for the core's Arduino.h in the HOST_BENCH build. Everything that
+ * would touch the hardware goes to NullArduino and does nothing, whether it's
+ * called through ArduinoInterface or straight from the core (LiquidCrystal).
+ *
+ * Print.h and avr/pgmspace.h are the simulator's, from tools/sim/shim.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <avr/pgmspace.h>
+#include <Print.h>
+#include <NullArduino.h>
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p)  ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#define PIN_A0   (14)
+#define PIN_A1   (15)
+#define PIN_A2   (16)
+#define PIN_A3   (17)
+#define PIN_A4   (18)
+#define PIN_A5   (19)
+#define PIN_A6   (20)
+#define PIN_A7   (21)
+
+static const uint8_t A0 = PIN_A0;
+static const uint8_t A1 = PIN_A1;
+static const uint8_t A2 = PIN_A2;
+static const uint8_t A3 = PIN_A3;
+static const uint8_t A4 = PIN_A4;
+static const uint8_t A5 = PIN_A5;
+static const uint8_t A6 = PIN_A6;
+static const uint8_t A7 = PIN_A7;
+
+#define noInterrupts()
+#define interrupts()
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  NullArduino::pinMode(pin, mode);
+}
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+  NullArduino::digitalWrite(pin, val);
+}
+inline int digitalRead(uint8_t pin) {
+  return NullArduino::digitalRead(pin);
+}
+inline void analogWrite(uint8_t pin, int val) {
+  NullArduino::analogueWrite(pin, (uint8_t)val);
+}
+inline unsigned long millis() {
+  return NullArduino::millis();
+}
+inline unsigned long micros() {
+  return NullArduino::micros();
+}
+inline void delay(unsigned long) {}
+inline void delayMicroseconds(unsigned int us) {
+  NullArduino::delayMicroseconds(us);
+}
+
+/*
+ * HardwareSerial
+ *
+ * What's written goes nowhere, and nothing ever arrives.
+ */
+class HardwareSerial : public Print {
+ public:
+  void begin(unsigned long) {}
+  int availableForWrite() { return 63; }
+  int available() { return 0; }
+  int read() { return -1; }
+  size_t write(uint8_t) override { return 1; }
+  using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+#endif //A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_ARDUINO_H_
@@ -0,0 +1,60 @@
+#ifndef A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_NULLARDUINO_H_
+#define A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_NULLARDUINO_H_
+
+#include <cstdint>
+
+/*
+ * NullArduino
+ *
+ * An ArduinoInterface backend that does nothing, for the HOST_BENCH build
+ * (see ArduinoInterface.h). Every call is inline and empty, or as near as
+ * makes no difference, so a benchmark only times our own code around it.
+ *
+ * Inputs read low, and the EEPROM is blank. The clock only moves when
+ * something asks for micros(), by step_us a time, so code waiting on it
+ * (LiquidCrystal's queue) gets there without spinning, or when a benchmark
+ * calls advance().
+ */
+class NullArduino {
+  inline static uint32_t clock_us_ {0};
+  inline static volatile uint8_t ports_[3] {};
+
+ public:
+  static constexpr uint32_t step_us {40};
+
+  static void pinMode(uint8_t, uint8_t) {}
+  static void digitalWrite(uint8_t, uint8_t) {}
+  static uint8_t digitalRead(uint8_t) { return 0; }
+  static void delayMicroseconds(unsigned int) {}
+  static unsigned long pulseIn(uint8_t, uint8_t, uint32_t = 1000000) {
+    return 0;
+  }
+  static void analogueWrite(uint8_t, uint8_t) {}
+  static uint32_t millis() { return clock_us_ / 1000; }
+  static uint32_t micros() { return clock_us_ += step_us; }
+  static void attachInterrupt(uint8_t, void (*)(), uint8_t) {}
+  static void tone(uint8_t, uint16_t, uint32_t = 0) {}
+  static void noTone(uint8_t) {}
+  static void one_shot(uint16_t, void (*)()) {}
+  static void timer_tick(void (*)()) {}
+  static uint16_t timer_ticks() { return 0; }
+
+  // a byte a port, as the Uno has, so PinGroup still does its sums
+  static volatile uint8_t* port_output_register(uint8_t pin) {
+    return &ports_[pin / 8 % 3];
+  }
+  static uint8_t pin_bit_mask(uint8_t pin) {
+    return (uint8_t)(1 << (pin % 8));
+  }
+  static void write_port(volatile uint8_t* port, uint8_t mask, uint8_t bits) {
+    *port = (*port & ~mask) | bits;
+  }
+  // erased, and stays that way
+  static uint8_t eeprom_read(uint16_t) { return 0xff; }
+  static void eeprom_update(uint16_t, uint8_t) {}
+
+  // move the clock on, for code that waits on millis()
+  static void advance(uint32_t us) { clock_us_ += us; }
+};
+
+#endif //A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_NULLARDUINO_H_
@@ -0,0 +1,29 @@
+#ifndef A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_SERVO_H_
+#define A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_SERVO_H_
+
+#include <cstdint>
+
+/*
+ * Servo
+ *
+ * Stands in for the Servo library in the HOST_BENCH build. It remembers the
+ * angle and nothing else.
+ */
+class Servo {
+ public:
+  uint8_t attach(int pin) { return attach(pin, 544, 2400); }
+  uint8_t attach(int pin, int, int) {
+    pin_ = pin;
+    return 0;
+  }
+  void detach() { pin_ = -1; }
+  bool attached() const { return pin_ >= 0; }
+  void write(int value) { angle_ = value; }
+  int read() const { return angle_; }
+
+ private:
+  int pin_ {-1};
+  int angle_ {90};
+};
+
+#endif //A_TOOLCHAIN_TEST_BENCHMARKS_SHIM_SERVO_H_
@@ -8,8 +8,10 @@
 #ifdef UNIT_TEST
 #include <gmock/gmock.h>
 #include <test/MockArduino.h>
+#include <cstring>
 // make things virtual for test
 #define TEST_VIRTUAL virtual
+#define INSTANCE_LOCAL
 
 // Constants copies from Arduino.h
 #define HIGH 0x1
@@ -20,6 +22,8 @@
 #define NOT_AN_INTERRUPT -1
 #define digitalPinToInterrupt(p)  ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
 #define PROGMEM
+#define memcpy_P memcpy
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
 
 #define PIN_A0   (14)
 #define PIN_A1   (15)
@@ -90,13 +94,61 @@ struct MockArduino {
   inline static void noTone(uint8_t pin) {
     mock->noTone(pin);
   }
+  inline static void one_shot(uint16_t us, void (*isr)()) {
+    mock->one_shot(us, isr);
+  }
+  inline static void timer_tick(void (*isr)()) {
+    mock->timer_tick(isr);
+  }
+  static uint16_t timer_ticks() {
+    return mock->timer_ticks();
+  }
+  static volatile uint8_t* port_output_register(uint8_t pin) {
+    return mock->port_output_register(pin);
+  }
+  static uint8_t pin_bit_mask(uint8_t pin) {
+    return mock->pin_bit_mask(pin);
+  }
+  // not mocked, tests point port_output_register() at bytes of their own and
+  // check what ends up in them
+  static void write_port(volatile uint8_t* port, uint8_t mask, uint8_t bits) {
+    *port = (*port & ~mask) | bits;
+  }
+  // not mocked either, tests fill it and look at what was written
+  inline static uint8_t eeprom[1024];
+  static uint8_t eeprom_read(uint16_t address) {
+    return eeprom[address];
+  }
+  static void eeprom_update(uint16_t address, uint8_t value) {
+    eeprom[address] = value;
+  }
 };
 
-#else
+#elif defined(HOST_SIM)
+// the simulator's stand in for the core, from tools/sim/shim
 #include <Arduino.h>
-#include <new.h>
 
 #define TEST_VIRTUAL
+// Globals the firmware keeps for its ISRs. The simulator runs one firmware
+// per thread, so each needs its own copy.
+#define INSTANCE_LOCAL thread_local
+
+#elif defined(HOST_BENCH)
+// NullArduino and the shims in benchmarks/shim, which do nothing, so the
+// benchmarks only time our code
+#include <Arduino.h>
+
+#define TEST_VIRTUAL
+#define INSTANCE_LOCAL
+
+#else
+// before new.h, whose Memory.h needs INSTANCE_LOCAL
+#define TEST_VIRTUAL
+#define INSTANCE_LOCAL
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <new.h>
 
 /*
  * ConcreteArduino
@@ -140,9 +192,106 @@ class ConcreteArduino {
     ::noTone(pin);
   }
 
+  /*
+   * One Shot
+   *
+   * Call isr once, from a timer interrupt, us microseconds from now. This uses
+   * Timer1 compare channel B. The Servo library owns Timer1 but only uses
+   * channel A, and runs it with a /8 prescaler, so a tick is 0.5µs at 16MHz.
+   *
+   * Servo resets TCNT1 at the end of each 20ms frame. If that happens before
+   * the match, isr is called late (by up to a frame) rather than not at all.
+   *
+   * The vector itself is in ArduinoInterface.cc.
+   */
+  inline static void one_shot(uint16_t us, void (*isr)()) {
+    one_shot_isr_ = isr;
+    uint8_t sreg = SREG;
+    cli();
+    OCR1B = TCNT1 + us * (uint16_t)(F_CPU / 8000000UL);
+    TIFR1 = _BV(OCF1B);     // clear any old match so we don't fire straight away
+    TIMSK1 |= _BV(OCIE1B);
+    SREG = sreg;
+  }
+  inline static void (* volatile one_shot_isr_)() {nullptr};
+
+  /*
+   * Timer Tick
+   *
+   * Call isr from a timer interrupt every ArduinoInterface::tick_us, until
+   * timer_tick() is given nullptr. This uses Timer0 compare channel B. Timer0
+   * is the core's millis() timer, so it always runs, overflowing every 1024µs
+   * at 16MHz. Channel B matches once an overflow whatever OCR0B is set to, so
+   * analogWrite() on pin 5, which sets OCR0B, still works alongside it.
+   *
+   * The vector itself is in ArduinoInterface.cc.
+   */
+  inline static void timer_tick(void (*isr)()) {
+    uint8_t sreg = SREG;
+    cli();
+    timer_tick_isr_ = isr;
+    if (isr != nullptr) {
+      TIFR0 = _BV(OCF0B);
+      TIMSK0 |= _BV(OCIE0B);
+    } else {
+      TIMSK0 &= ~_BV(OCIE0B);
+    }
+    SREG = sreg;
+  }
+  inline static void (* volatile timer_tick_isr_)() {nullptr};
+
+  /*
+   * Timer Ticks
+   *
+   * TCNT1, Timer1's count. As for one_shot() that's the Servo library's
+   * timer, ticking every 0.5µs and reset to 0 at the end of each 20ms frame,
+   * so it only counts up to about ArduinoInterface::frame_ticks. Reading it
+   * costs a couple of cycles rather than the 60 or so micros() does.
+   *
+   * TCNT1 is 16 bits wide and read a byte at a time through a shared temp
+   * register, so interrupts are off for the read.
+   */
+  inline static uint16_t timer_ticks() {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t ticks = TCNT1;
+    SREG = sreg;
+    return ticks;
+  }
+
+  inline static volatile uint8_t* port_output_register(uint8_t pin) {
+    return portOutputRegister(digitalPinToPort(pin));
+  }
+  inline static uint8_t pin_bit_mask(uint8_t pin) {
+    return digitalPinToBitMask(pin);
+  }
+
+  /*
+   * Write Port
+   *
+   * Set the bits of port in mask to bits. Interrupts are off for the read,
+   * modify, write, so an ISR writing other pins on the same port (Servo does)
+   * can't be undone by it.
+   */
+  inline static void write_port(volatile uint8_t* port, uint8_t mask,
+                                uint8_t bits) {
+    uint8_t sreg = SREG;
+    cli();
+    *port = (*port & ~mask) | bits;
+    SREG = sreg;
+  }
+
+  inline static uint8_t eeprom_read(uint16_t address) {
+    return eeprom_read_byte((const uint8_t*)(uintptr_t)address);
+  }
+  // only writes if the byte is different, as each cell wears out after
+  // 100,000 writes or so
+  inline static void eeprom_update(uint16_t address, uint8_t value) {
+    eeprom_update_byte((uint8_t*)(uintptr_t)address, value);
+  }
 };
 
-#endif // UNIT_TEST
+#endif // UNIT_TEST, HOST_SIM, HOST_BENCH
 
 /*
  * ArduinoInterface template class.
@@ -153,16 +302,33 @@ class ConcreteArduino {
  *
  * A preprocessor macro is using to switch between concrete and mock interfaces
  * depending on if UNIT_TEST is set. So, this detail is invisible to all code
- * that depends on it.
+ * that depends on it. HOST_SIM picks the simulator in tools/sim instead, to
+ * run the firmware itself on a virtual clock, and HOST_BENCH picks the no-op
+ * backend the benchmarks use.
  */
 class ArduinoInterface {
  public:
 #ifdef UNIT_TEST // this avoids having to template every class using this interface
  using AI = MockArduino;
+#elif defined(HOST_SIM)
+  using AI = SimArduino;
+#elif defined(HOST_BENCH)
+  using AI = NullArduino;
 #else
   using AI = ConcreteArduino;
 #endif // UNIT_TEST
 
+  // time between timer_tick() interrupts
+  static constexpr uint16_t tick_us {1024};
+
+  // timer_ticks() counts this many a µs, and starts again from 0 after
+  // frame_ticks
+  static constexpr uint8_t ticks_per_us {2};
+  static constexpr uint16_t frame_ticks {40000};
+
+  // bytes of EEPROM, at addresses 0 on
+  static constexpr uint16_t eeprom_size {1024};
+
   inline static void pinMode(uint8_t pin, uint8_t mode) {
     AI::pinMode(pin, mode);
   }
@@ -196,6 +362,31 @@ class ArduinoInterface {
   inline static void noTone(uint8_t pin) {
     AI::noTone(pin);
   }
+  inline static void one_shot(uint16_t us, void (*isr)()) {
+    AI::one_shot(us, isr);
+  }
+  inline static void timer_tick(void (*isr)()) {
+    AI::timer_tick(isr);
+  }
+  inline static uint16_t timer_ticks() {
+    return AI::timer_ticks();
+  }
+  inline static volatile uint8_t* port_output_register(uint8_t pin) {
+    return AI::port_output_register(pin);
+  }
+  inline static uint8_t pin_bit_mask(uint8_t pin) {
+    return AI::pin_bit_mask(pin);
+  }
+  inline static void write_port(volatile uint8_t* port, uint8_t mask,
+                                uint8_t bits) {
+    AI::write_port(port, mask, bits);
+  }
+  inline static uint8_t eeprom_read(uint16_t address) {
+    return AI::eeprom_read(address);
+  }
+  inline static void eeprom_update(uint16_t address, uint8_t value) {
+    AI::eeprom_update(address, value);
+  }
 };
 
 #endif //A_TOOLCHAIN_TEST_INCLUDE_ARDUINOINTERFACE_H_
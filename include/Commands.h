@@ -7,84 +7,51 @@
 
 
 #include "RadarState.h"
-#include <FunctionObject.h>
+#include <CommandQueue.h>
 
-// All our action objects can share this context pointer
-class RadarAction : public FunctionObject {
- protected:
-  friend class CommandsTest;
-
-  explicit RadarAction();
-  inline static RadarContext* context_;
-
- public:
-  ~RadarAction() override = default;
-};
+/*
+ * Commands
+ *
+ * The jobs the radar runs from its command queue. Each one is a plain function
+ * taking the RadarContext it was queued with, so there's no object to allocate
+ * and no virtual call to dispatch. RadarContext passes itself in when it adds
+ * one to the queue.
+ */
+namespace Commands {
 
 // move radar
-class DoMove : public RadarAction {
- private:
-  inline static RadarAction* instance_ {nullptr};
-  explicit DoMove() = default;
-  ~DoMove() final = default;
+void move(void* context);
 
- public:
-  static RadarAction* instance(RadarContext* c);
-  static void delete_instance();
-  void operator()() final;
-};
+// ping the radar and post the distance back to the context
+void ping(void* context);
 
-// ping the radar and stick it back into the context
-class DoPing : public RadarAction {
- private:
-  inline static RadarAction* instance_ {nullptr};
-  explicit DoPing() = default;
-  ~DoPing() final = default;
+// check the PIR sensor and post to the context if it saw something
+void pir_check(void* context);
 
- public:
-  static RadarAction* instance(RadarContext* c);
-  static void delete_instance();
-  void operator()() final;
+// send changes on screen to the LCD
+void lcd_flush(void* context);
 
-};
+// draw the nearest target on the LCD. Slow and not urgent, so runs rarely.
+void lcd_graph(void* context);
 
-// pulse LED
-class DoLEDPulse : public RadarAction {
- private:
-  inline static RadarAction* instance_ {nullptr};
-  explicit DoLEDPulse() = default;
-  ~DoLEDPulse() final = default;
+#ifdef PROFILE
+// send the profiler's histograms over Serial and start a new window
+void profile_dump(void* context);
+#endif // PROFILE
 
- public:
-  static RadarAction* instance(RadarContext* c);
-  static void delete_instance();
-  void operator()() final;
-};
+#ifdef MEMORY_STATS
+// measure the free stack, keeping the least there's been
+void memory_check(void* context);
 
+// send the heap and stack figures over Serial
+void memory_report(void* context);
+#endif // MEMORY_STATS
 
-class DoPIRCheck : RadarAction {
- private:
-  inline static RadarAction* instance_ {nullptr};
-  explicit DoPIRCheck() = default;
-  ~DoPIRCheck() final = default;
+#ifdef CONSOLE
+// pass what's arrived on Serial to the console, as long as it has room
+void console(void* context);
+#endif // CONSOLE
 
- public:
-  static RadarAction* instance(RadarContext* c);
-  static void delete_instance();
-  void operator()() final;
-
-};
-/*
-class DoMemStats : RadarAction {
- private:
-  inline static RadarAction* instance_ {nullptr};
-  explicit DoMemStats() = default;
-  ~DoMemStats() final = default;
+} // namespace Commands
 
- public:
-  static RadarAction* instance(RadarContext* c);
-  static void delete_instance();
-  void operator()() final;
-};
-*/
 #endif //A_TOOLCHAIN_TEST_INCLUDE_COMMANDS_H_
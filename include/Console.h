@@ -0,0 +1,105 @@
+#ifndef A_TOOLCHAIN_TEST_INCLUDE_CONSOLE_H_
+#define A_TOOLCHAIN_TEST_INCLUDE_CONSOLE_H_
+
+#include <ArduinoInterface.h>
+#include <EventQueue.h>
+#include <Settings.h>
+#include <TelemetrySender.h>
+
+/*
+ * Console
+ *
+ * Read and change Settings over Serial while the radar runs, a line at a
+ * time:
+ *
+ *    get NAME          NAME=VALUE
+ *    set NAME VALUE    NAME=VALUE, or error: MIN to MAX it can be now
+ *    list              NAME=VALUE for each of them, then ok
+ *    save              write them to EEPROM
+ *    load              read them back from it
+ *    defaults          back to the defaults, save to keep them
+ *    exit              give Serial back to telemetry
+ *    help              the commands
+ *
+ * Commands::console feeds it what has arrived a byte at a time, every
+ * CFG::console_ms, and a line is run as soon as it ends (\r, \n or both).
+ * Replies wait in a ring buffer for the main loop to send with read(), as
+ * telemetry does, so a slow line never holds up the radar. Nothing is
+ * allocated: the line and the replies are fixed buffers, and list goes out
+ * a setting at a time as there's room.
+ *
+ * Telemetry is binary, so it can't share Serial with text. The first line
+ * typed stops it, and exit starts it again. exit's reply ends with a 0,
+ * which to a telemetry reader ends the text as if it were a bad frame, so
+ * it carries on from the KEY after it.
+ *
+ * Commands::console is only queued with CONSOLE defined, which it is in
+ * builds with TELEMETRY. Otherwise Serial has a trace or text reports on it.
+ */
+class Console {
+ public:
+  static constexpr uint8_t line_size {32};
+  static constexpr uint8_t buffer_size {64};
+  // help's, the longest reply
+  static constexpr uint8_t max_reply {48};
+
+ private:
+  static constexpr uint8_t not_listing {0xff};
+
+  inline static INSTANCE_LOCAL char line_[line_size + 1] {};
+  inline static INSTANCE_LOCAL uint8_t length_ {0};
+  inline static INSTANCE_LOCAL bool overlong_ {false};
+  inline static INSTANCE_LOCAL bool active_ {false};
+  inline static INSTANCE_LOCAL uint8_t listing_ {not_listing};
+  inline static INSTANCE_LOCAL EventQueue<uint8_t, buffer_size> buffer_;
+
+  static void run_();
+  static void put_(const char* text);
+  static void put_P_(const char* text);     // text in flash
+  static void put_number_(uint32_t n);
+  static void put_value_(Settings::Id id);
+
+ public:
+  Console() = delete;
+
+  // forget the line and any replies, and leave Serial to telemetry
+  static void reset();
+
+  /*
+   * Ready
+   *
+   * Whether there's room for the reply to a line, and list has finished.
+   * Commands::console leaves what's arrived in Serial's buffer until there
+   * is.
+   */
+  static bool ready();
+
+  /*
+   * Feed
+   *
+   * The next byte that arrived. Only when ready().
+   */
+  static void feed(uint8_t c);
+
+  // carry on with list, if there's room
+  static void poll();
+
+  /*
+   * Read
+   *
+   * uint8_t& byte - set to the next byte of reply to send, if there is one
+   *
+   * Returns:
+   * bool - false if there's nothing to send
+   */
+  static bool read(uint8_t& byte);
+
+  // whether the console has Serial, from the first line until exit
+  static bool active();
+};
+
+#ifdef TELEMETRY
+#define CONSOLE
+#endif // TELEMETRY
+
+#endif //A_TOOLCHAIN_TEST_INCLUDE_CONSOLE_H_
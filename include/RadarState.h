@@ -19,6 +19,16 @@
 #include <MyLED.h>
 #endif // UNIT_TEST
 #include <ArduinoInterface.h>
+#include <TargetTracker.h>
+#include <EventQueue.h>
+#include <LCDBuffer.h>
+#include <LCDGlyphs.h>
+#include <TraceRecorder.h>
+#include <Profiler.h>
+#include <Memory.h>
+#include <TelemetrySender.h>
+#include <Settings.h>
+#include <Console.h>
 
 namespace CFG {
 
@@ -40,20 +50,77 @@ const uint8_t red_pin PROGMEM {3}, green_pin PROGMEM {6}, blue_pin PROGMEM {5};
 
 const uint8_t buzzer_pin PROGMEM {10};
 
-// distance thresholds for radar
+// LED pulse periods in ms, slow in standby and quick as a warning, and how
+// long the LED takes to fade to a new colour
+const uint16_t standby_pulse_ms PROGMEM {3000}, warning_pulse_ms PROGMEM {400},
+    led_fade_ms PROGMEM {200};
+
+// distance thresholds for radar. Closer than each is that colour, and
+// anything closer than yellow counts as in range. These, the timeout and the
+// command periods are the defaults, Settings has what's in use.
 const uint32_t  distance_warning PROGMEM {60}, distance_red PROGMEM {300},
-    distance_yellow PROGMEM {600}, distance_green PROGMEM {900};
+    distance_orange PROGMEM {450}, distance_yellow PROGMEM {600},
+    distance_green PROGMEM {900};
 
 const uint32_t standby_timeout PROGMEM {10000};
 
+// how often the radar moves a degree while sensing, pings, and checks the PIR
+// sensor in standby
+const uint16_t move_ms PROGMEM {25}, ping_ms PROGMEM {550},
+    pir_check_ms PROGMEM {250};
+
+// how often to send changes to the LCD. Nothing needs to be quicker than this,
+// so it gets out of the way of the radar commands.
+const uint16_t lcd_flush_ms PROGMEM {100};
+
+// how often to redraw the nearest target on the top row while sensing, and the
+// range in mm that fills its bar
+const uint16_t lcd_graph_ms PROGMEM {250};
+const uint32_t graph_full_scale PROGMEM {1000};
+
+// how often a PROFILE build sends the profiler's histograms over Serial
+const uint16_t profile_dump_ms PROGMEM {10000};
+
+// how often a MEMORY_STATS build measures the free stack, and sends the heap
+// and stack figures over Serial
+const uint16_t memory_check_ms PROGMEM {1000},
+    memory_report_ms PROGMEM {10000};
+
+// how often the console reads what's come in over Serial. At 9600 baud 48
+// bytes can arrive in that time, which the core's 64 byte buffer holds.
+const uint16_t console_ms PROGMEM {50};
+
 } // namespace CFG
 
 
 class RadarContext;
 class RadarState;
-class StandbyState;
-class SensingState;
-class WarningState;
+
+/*
+ * RadarStateId
+ *
+ * The states the radar can be in. These index the state table in
+ * RadarState.cc, so keep the two in the same order.
+ *
+ * STANDBY - blinking the LED green and checking the PIR sensor
+ * SENSING - sweeping the radar and setting the LED colour by distance
+ * WARNING - something is too close. Runs inside SENSING, so the radar keeps
+ *           sweeping, but the LED pulses red and the buzzer sounds.
+ */
+enum class RadarStateId : uint8_t { STANDBY, SENSING, WARNING, NONE };
+
+/*
+ * StateEvent
+ *
+ * What the current state makes of an input. The transition table maps a state
+ * and an event to the next state.
+ *
+ * MOTION - the PIR sensor saw something
+ * TOO_CLOSE - something is inside the warning distance
+ * CLEAR - nothing is inside the warning distance any more
+ * TIMEOUT - nothing has been in range for standby_timeout
+ */
+enum class StateEvent : uint8_t { NONE, MOTION, TOO_CLOSE, CLEAR, TIMEOUT };
 
 /*
  * RadarContext
@@ -77,59 +144,84 @@ class RadarContext {
                       CFG::d3, CFG::d4, CFG::d5, CFG::d6, CFG::d7};
 #endif // UNIT_TEST
 
-  RadarState* state_ {nullptr};
+  RadarStateId state_ {RadarStateId::STANDBY};
   uint32_t timer_ {0}; // track how long since measurement in range
 
+  TargetTracker tracker_;
+  uint8_t angle_ {90};        // servo angle after the last radar_move()
+  uint8_t ping_angle_ {90};   // servo angle when the last ping was sent
+
+  // inputs posted by commands, handled after each command has run
+  EventQueue<uint32_t, 4> events_;
+
+  // what the LCD should show. lcd_ only gets what changes, on lcd_flush()
+  LCDBuffer screen_;
+
+  // nearest target bar graph and bearing, and the glyphs it has uploaded
+  TargetDisplay display_ {CFG::graph_full_scale};
+
+  /*
+   * Dispatch Events
+   *
+   * Pass every posted input to update(), oldest first.
+   */
+  void dispatch_events_();
+
+  /*
+   * Apply Settings
+   *
+   * Reschedule the queued commands whose period has changed in Settings.
+   * The rest of the settings are read as they're used.
+   */
+  void apply_settings_();
+
   /*
    * Change State
    *
-   * RadarState* s - the new state to transition to
+   * This only records the new state. The entry and exit actions are run by
+   * RadarState.
+   *
+   * RadarStateId s - the new state to transition to
    */
-  TEST_VIRTUAL void change_state(RadarState* s); //
+  TEST_VIRTUAL void change_state(RadarStateId s);
 
   /*
    * Command Add Entry
    *
-   * Add an entry to the command queue
+   * Add an entry to the command queue. The command will be called with this
+   * context.
    *
-   * FunctionObject* func - the function object to add
-   * uint16_t frequency - how often to call the object in milliseconds
+   * Command func - the command to add, from Commands.h
+   * uint16_t frequency - how often to call the command in milliseconds
    */
-  TEST_VIRTUAL void command_add_entry(FunctionObject *func, uint16_t frequency);
+  TEST_VIRTUAL void command_add_entry(Command func, uint16_t frequency);
 
   /*
    * Command Remove Entry
    *
-   * FunctionObject* func - function object to remove
+   * Command func - command to remove
    */
-  TEST_VIRTUAL void command_remove_entry(FunctionObject *func);
+  TEST_VIRTUAL void command_remove_entry(Command func);
 
   /*
    * LED Set Colour
    *
-   * LEDColour colour - red, yellow or green (from MyLED.h)
-   */
-  TEST_VIRTUAL void led_set_colour(LEDColour colour);
-
-  /*
-   * LED Set Pulse
+   * Fades to colour over CFG::led_fade_ms.
    *
-   * int8_t increment - how much to vary the brightness each time led_pulse()
-   *                    is called. Max brightness is 255.
+   * LEDColour colour - one of the named colours (from MyLED.h)
    */
-  TEST_VIRTUAL void led_set_pulse(int8_t  increment);
+  TEST_VIRTUAL void led_set_colour(LEDColour colour);
 
   /*
-   * Get Timer
+   * LED Set Effect
    *
-   * RadarContext tracks how long it has been since something is in range. This
-   * method returns that time in milliseconds
+   * The LED runs the effect by itself from a timer interrupt, so nothing needs
+   * to be added to the command queue for it.
    *
-   * Returns:
-   *
-   * uint32_t - time value in milliseconds
+   * LEDEffect effect - steady, pulse or blink (from MyLED.h)
+   * uint16_t period - ms from one peak of brightness to the next
    */
-  TEST_VIRTUAL uint32_t get_timer() const;
+  TEST_VIRTUAL void led_set_effect(LEDEffect effect, uint16_t period);
 
   /*
    * Set Timer
@@ -144,10 +236,10 @@ class RadarContext {
   /*
    * Constructor
    *
-   * RadarState* state - Initial state. If nothing is passed it defaults to
-   *                     standby.
+   * RadarStateId state - Initial state. If nothing is passed it defaults to
+   *                      standby.
    */
-  explicit RadarContext(RadarState* state = nullptr);
+  explicit RadarContext(RadarStateId state = RadarStateId::STANDBY);
   TEST_VIRTUAL ~RadarContext();
 
   /*
@@ -177,21 +269,33 @@ class RadarContext {
    * a value based on those numbers when they are available.
    *
    * As a consequence, ONLY CALL THIS METHOD EVERY 500MS OR MORE!
+   *
+   * Every value returned is also fed to the target tracker, paired with the
+   * angle the radar was at when that ping was sent.
    */
   TEST_VIRTUAL uint32_t radar_ping();
 
   /*
-   * LED Pulse
+   * Nearest Targets
+   *
+   * Copy up to n of the targets seen in recent sweeps into out, nearest first.
    *
-   * modifify the LED brightness by the value configured in set_pulse()
+   * Target out[] - array to copy targets into
+   * uint8_t n - size of out
+   *
+   * Returns:
+   * uint8_t - number of targets copied
    */
-  TEST_VIRTUAL void led_pulse();
+  TEST_VIRTUAL uint8_t nearest_targets(Target out[], uint8_t n) const;
 
   /*
    * LCD Set Cursor
    *
    * Set the LCD cursor to position on screen.
    *
+   * This and the other lcd_ methods below only change a copy of the screen in
+   * RAM. Nothing is sent to the LCD until lcd_flush().
+   *
    * setCursor is camelCase to match the Arduino LiquidCrystal library this
    * method wraps.
    *
@@ -212,6 +316,13 @@ class RadarContext {
   // int n - an integer
   TEST_VIRTUAL void lcd_print(int n);
 
+  /*
+   * uint32_t n - an integer, right aligned in width characters. If it doesn't
+   *              fit, width '*'s are printed instead.
+   * uint8_t width - characters to fill
+   */
+  TEST_VIRTUAL void lcd_print(uint32_t n, uint8_t width);
+
   /*
    * LCD Clear
    *
@@ -220,246 +331,191 @@ class RadarContext {
   TEST_VIRTUAL void lcd_clear();
 
   /*
-   * Execute Current Entry
-   *
-   * Executes the current command queue entry. The queue is smart and will
-   * figure out what it needs to do next.
+   * LCD Flush
    *
-   * Returns:
-   * uint32_t - time in milliseconds at which next command expects to be
-   *            executed.
+   * Send whatever has changed on screen to the LCD. This only queues it in
+   * the LCD driver, lcd_poll() sends it.
    */
-  TEST_VIRTUAL uint32_t execute_current_entry();
+  TEST_VIRTUAL void lcd_flush();
 
   /*
-   * Start
+   * LCD Graph
    *
-   * This method is state dependant. It is passed through to the current state
+   * Draw the nearest target's range and bearing on the top row. Any custom
+   * characters needed that aren't on the LCD already are uploaded now.
    */
-  TEST_VIRTUAL void start();
+  TEST_VIRTUAL void lcd_graph();
 
   /*
-   * Update
+   * LCD Poll
    *
-   * This method is state dependant. It is passed through to the current state
-   *
-   * uint32_t value - The value to be passed to the state
-   */
-  TEST_VIRTUAL void update(uint32_t);
-};
-
-/*
- * RadarState Abstract Base Class
- *
- * This class is friends with RadarContext, meaning it can access protected or
- * private methods. RadarState child classes use the methods in this class to
- * access or update the state stored in RadarContext.
- */
-class RadarState {
- protected:
-  /*
-   * All these methods are just wrappers for the same methods in RadarContext.
+   * Send the LCD whatever queued bytes it is ready for. Never waits, so call
+   * this whenever there is nothing else to do.
    */
-  static void change_state(RadarContext* c, RadarState* s);
-  static void command_add_entry(RadarContext *c,
-                                FunctionObject *func,
-                                uint16_t frequency);
-  static void command_remove_entry(RadarContext *c, FunctionObject *func);
-  static void led_set_colour(RadarContext* c, LEDColour colour);
-  static void led_set_pulse(RadarContext* c, int8_t  increment);
-  static uint32_t get_timer(RadarContext* c);
-  static void set_timer(RadarContext *c);
-
-  RadarState() = default;
-
- public:
-  virtual ~RadarState() = default;
+  TEST_VIRTUAL void lcd_poll();
 
   /*
-   * These methods are pure virtual. The concrete states implement them
-   */
-  virtual void start(RadarContext *c) = 0;
-  virtual void update(RadarContext *c, uint32_t input) = 0;
-};
-
-/*
- * StandbyState
- *
- * In this state, the system is blinking the LED green and checking the PIR
- * sensor. If anything is detected, it will transition to SensingState.
- *
- * This class is a singleton.
- */
-class StandbyState : public RadarState {
-
- private:
-  StandbyState() = default;
-  inline static RadarState* instance_ {nullptr}; // instance pointer
-  ~StandbyState() final = default;
-
- public:
-  /*
-   * Instance
+   * Execute Current Entry
+   *
+   * Executes the current command queue entry. The queue is smart and will
+   * figure out what it needs to do next.
    *
-   * Return pointer to singleton instance.
+   * Any inputs the command posted are handled after it has run, so state
+   * changes never add or remove commands while the queue is running one.
+   * Commands rescheduled by a change to Settings are dealt with then too.
+   *
+   * Returns:
+   * uint32_t - time in milliseconds at which next command expects to be
+   *            executed.
    */
-  static RadarState* instance();
+  TEST_VIRTUAL uint32_t execute_current_entry();
 
   /*
-   * Delete Instance
+   * Post Event
+   *
+   * Queue an input for the current state. Commands use this rather than
+   * update(), which may change state.
    *
-   * Delete the singleton and reset instance to nullptr.
+   * uint32_t input - The value to be passed to the state
    *
-   * This was put here for testing, and is is probably a bad idea to do in
-   * release.
+   * Returns:
+   * bool - false if the event queue was full and the input was dropped
    */
-  static void delete_instance();
+  TEST_VIRTUAL bool post_event(uint32_t input);
 
   /*
    * Start
    *
-   * This method will add the following commands:
-   *
-   * DoPIRCheck
-   * DoLEDPulse
-   *
-   * It will set the LED colour to Green.
-   *
-   * RadarContext* c - pointer to the Radar Context.
+   * Run the entry actions of the current state.
    */
-  void start(RadarContext *c) final;
+  TEST_VIRTUAL void start();
 
   /*
    * Update
    *
-   * This method will clear previously registered commands and transition to
-   * sensing state on any non 0 input.
+   * Pass an input to the current state, and change state if the transition
+   * table says so.
    *
-   * RadarContext* c - pointer to the Radar Context.
-   * uint32_t input - input value
+   * uint32_t value - The value to be passed to the state
    */
-  void update(RadarContext *c, uint32_t input) final;
-};
+  TEST_VIRTUAL void update(uint32_t);
 
-class SensingState : public RadarState {
- private:
   /*
-   * I
+   * Get State
+   *
+   * Returns:
+   * RadarStateId - the current state
    */
-  inline static RadarState* instance_ {nullptr};
-  SensingState() = default;
-  ~SensingState() final = default;
+  TEST_VIRTUAL RadarStateId get_state() const;
 
   /*
-   * Change Standby
-   *
-   * This method will remove the following commands:
+   * Get Timer
    *
-   * DoMove
-   * DoPing
+   * RadarContext tracks how long it has been since something is in range. This
+   * method returns that time in milliseconds. It's public so host tools can
+   * see when the radar last decided something was in range.
    *
-   * it will then transition to standby
+   * Returns:
    *
-   * RadarContext* c - pointer to the Radar Context.
+   * uint32_t - time value in milliseconds
    */
-  static void change_standby(RadarContext* c);
+  TEST_VIRTUAL uint32_t get_timer() const;
+};
 
-  /*
-   * Change Warning
-   *
-   * This method will transition to WarningState
-   *
-   * RadarContext* c - pointer to the Radar Context.
-   */
-  static void change_warning(RadarContext* c);
+/*
+ * RadarState
+ *
+ * The radar's state machine. There are no state objects: each state is an
+ * entry in a table held in flash, built at compile time, which lists what to
+ * do when the state is entered or left:
+ *
+ * - the commands to run while in the state, and the setting for how often
+ * - the LED colour and pulse to set
+ * - whether to clear the LCD and what to print on it
+ * - whether to sound the buzzer
+ *
+ * Commands are added on entry and removed on exit, and the buzzer is started
+ * on entry and stopped on exit, so these never need to be written out by hand.
+ *
+ * A state can have a parent (WARNING runs inside SENSING). Moving between a
+ * parent and its child only enters or leaves the child, so the parent's
+ * commands keep running.
+ *
+ * Inputs are handled in two steps. First the current state turns the input
+ * into a StateEvent, doing anything that doesn't change state on the way
+ * (like setting the LED colour by distance). This is a switch on the state.
+ * Then the transition table is looked up to find the next state, if any.
+ *
+ * This class is friends with RadarContext, so all of this is static and works
+ * on the context passed in.
+ */
+class RadarState {
+ private:
+  static StateEvent standby_react(RadarContext* c, uint32_t input);
+  static StateEvent sensing_react(RadarContext* c, uint32_t distance);
+  static StateEvent warning_react(RadarContext* c, uint32_t distance);
 
  public:
-  /*
-   * Instance
-   *
-   * Return pointer to singleton instance
-   */
-  static RadarState* instance();
-
-  /*
-   * Delete Instance
-   *
-   * Delete the singleton and reset instance to nullptr.
-   *
-   * This was put here for testing, and is is probably a bad idea to do in
-   * release.
-   */
-  static void delete_instance();
+  RadarState() = delete;
 
   /*
    * Start
    *
-   * This method will register the following commands:
+   * Run the entry actions of state s.
    *
-   * DoMove
-   * DoPing
+   * RadarContext* c - pointer to the Radar Context
+   * RadarStateId s - state being entered
    */
-  void start(RadarContext *c) final;
+  static void start(RadarContext* c, RadarStateId s);
 
   /*
-   * Update
+   * Stop
    *
-   * This method takes a distance and will update the LED colour or transition
-   * to a new state depending upon the value
+   * Run the exit actions of state s.
    *
-   * RadarContext* c - pointer to the Radar Context.
-   * uint32_t input - distance as returned from radar.ping()
+   * RadarContext* c - pointer to the Radar Context
+   * RadarStateId s - state being left
    */
-  void update(RadarContext *c, uint32_t input) final;
-};
-
-class WarningState : public RadarState {
- private:
-  inline static RadarState* instance_ {nullptr};
-  WarningState() = default;
-  ~WarningState() final = default;
+  static void stop(RadarContext* c, RadarStateId s);
 
- public:
   /*
-   * Instance
+   * React
+   *
+   * Turn an input into an event for state s. May change the LED colour or
+   * reset the context timer, but never changes state.
    *
-   * Return pointer to singleton instance
+   * Returns:
+   * StateEvent - what the input means to state s
    */
-  static RadarState* instance();
+  static StateEvent react(RadarContext* c, RadarStateId s, uint32_t input);
 
   /*
-   * Delete Instance
+   * Next State
    *
-   * Delete the singleton and reset instance to nullptr.
+   * Look up the transition table.
    *
-   * This was put here for testing, and is is probably a bad idea to do in
-   * release.
+   * Returns:
+   * RadarStateId - state to move to, or s if event doesn't cause a transition
    */
-  static void delete_instance();
+  static RadarStateId next_state(RadarStateId s, StateEvent event);
 
   /*
-   * Start
+   * Parent
    *
-   * This method will register the following commands:
-   *
-   * DoLEDPulse
-   *
-   * It will set the LED colour to red
-   * It will sound the buzzer
-   *
-   * RadarContext* c - pointer to the Radar Context.
+   * Returns:
+   * RadarStateId - parent state of s, or NONE
    */
-  void start(RadarContext *c) final;
+  static RadarStateId parent(RadarStateId s);
 
   /*
    * Update
    *
-   * This method takes a distance. If the distance is beyond the warning range,
-   * it will transition back to sensing state.
+   * Pass input to state s and make any transition that results.
    *
-   * RadarContext* c - pointer to the Radar Context.
-   * uint32_t input - distance as returned from radar.ping()
+   * RadarContext* c - pointer to the Radar Context
+   * RadarStateId s - current state
+   * uint32_t input - 1 from the PIR sensor, or a distance from radar.ping()
    */
-  void update(RadarContext *c, uint32_t input) final;
+  static void update(RadarContext* c, RadarStateId s, uint32_t input);
 };
 #endif //A_TOOLCHAIN_TEST_SRC_RADARSTATE_H_
@@ -0,0 +1,117 @@
+#ifndef A_TOOLCHAIN_TEST_INCLUDE_SETTINGS_H_
+#define A_TOOLCHAIN_TEST_INCLUDE_SETTINGS_H_
+
+#include <ArduinoInterface.h>
+
+/*
+ * Settings
+ *
+ * The radar's thresholds and command periods that can be changed without
+ * reflashing. Each has a row in a table in flash (see Settings.cc), with its
+ * name, the default from CFG, and the least and most it can be set to. The
+ * values themselves are shadowed in SRAM, so get() is only an array read.
+ *
+ * load() reads them from EEPROM and save() writes them back, from address 0:
+ *
+ *    'R' 'S' version count   each value, 4 bytes little endian   checksum
+ *
+ * The checksum is Fletcher-16 over everything before it. If anything doesn't
+ * match, a new board or a table that's changed since, nothing is loaded and
+ * the defaults stay. save() only writes the bytes that have changed, so the
+ * EEPROM's 100,000 writes last.
+ *
+ * The distances have to stay in order, warning < red < orange < yellow <
+ * green, or RadarContext's colours and warning would be the wrong way round.
+ * So the range a distance can be set to is its row's, narrowed to between
+ * the distances either side of it as they are now. See range().
+ *
+ * set() and the rest mark what they change, for RadarContext to pick up
+ * with take_changed() and reschedule the commands whose period it is.
+ */
+class Settings {
+ public:
+  enum class Id : uint8_t {
+    DISTANCE_WARNING, DISTANCE_RED, DISTANCE_ORANGE, DISTANCE_YELLOW,
+    DISTANCE_GREEN, STANDBY_TIMEOUT, MOVE_MS, PING_MS, PIR_CHECK_MS,
+    LCD_FLUSH_MS, LCD_GRAPH_MS, COUNT
+  };
+
+  static constexpr uint8_t count {(uint8_t)Id::COUNT};
+  static constexpr uint8_t name_size {17};    // with the '\0'
+  static constexpr uint8_t version {1};
+  static constexpr uint8_t header_size {4};
+  static constexpr uint8_t stored_size {header_size + count * 4 + 2};
+
+  /*
+   * Entry
+   *
+   * A row of the table. Periods are in ms and go in the command queue's
+   * uint16_t, so their max is no more than UINT16_MAX.
+   */
+  struct Entry {
+    char name[name_size];
+    uint32_t value;     // the default
+    uint32_t min;
+    uint32_t max;
+  };
+
+  // every value, as they're kept in SRAM
+  struct Values {
+    uint32_t values[count];
+  };
+
+  struct Range {
+    uint32_t min;
+    uint32_t max;
+  };
+
+ private:
+  static_assert(count <= 16, "changed_ has a bit per setting");
+
+  // starts as the defaults, see Settings.cc
+  static INSTANCE_LOCAL Values values_;
+  inline static INSTANCE_LOCAL uint16_t changed_ {0};
+
+  static void put_(Id id, uint32_t value);
+
+ public:
+  Settings() = delete;
+
+  inline static uint32_t get(Id id) {
+    return values_.values[(uint8_t)id];
+  }
+
+  /*
+   * Set
+   *
+   * Returns:
+   * bool - false if value is outside range(id), and wasn't set
+   */
+  static bool set(Id id, uint32_t value);
+
+  // what the setting can be set to now, see above for the distances
+  static Range range(Id id);
+
+  // the setting's row of the table, copied out of flash
+  static Entry entry(Id id);
+
+  // the setting with this name, or Id::COUNT
+  static Id find(const char* name);
+
+  // every setting back to its default
+  static void defaults();
+
+  /*
+   * Load
+   *
+   * Returns:
+   * bool - false if the EEPROM didn't hold settings this table can read
+   */
+  static bool load();
+  static void save();
+
+  // a bit (1 << Id) for each setting changed since the last call
+  static uint16_t take_changed();
+};
+
+#endif //A_TOOLCHAIN_TEST_INCLUDE_SETTINGS_H_
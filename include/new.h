@@ -5,13 +5,8 @@
 #ifndef A_TOOLCHAIN_TEST_INCLUDE_NEW_H_
 #define A_TOOLCHAIN_TEST_INCLUDE_NEW_H_
 
-//#include <stdlib.h>
-#include <ArduinoInterface.h>
-
-//inline extern volatile uint32_t current_alloc {0}, max_alloc {0};
-
-void *operator new(size_t size, unsigned int);
-void operator delete(void * ptr, unsigned int);
-
+// The counted operator new in new.cc is declared in Memory.h, so libraries
+// can use it without picking up the core's new.h by mistake
+#include <Memory.h>
 
 #endif //A_TOOLCHAIN_TEST_INCLUDE_NEW_H_
@@ -33,6 +33,11 @@ class MockArduinoClass{
   MOCK_METHOD(void, attachInterrupt, (uint8_t, void (*)(), uint8_t));
   MOCK_METHOD(void, tone, (uint8_t, uint16_t, uint32_t duration));
   MOCK_METHOD(void, noTone, (uint8_t));
+  MOCK_METHOD(void, one_shot, (uint16_t, void (*)()));
+  MOCK_METHOD(void, timer_tick, (void (*)()));
+  MOCK_METHOD(uint16_t, timer_ticks, ());
+  MOCK_METHOD(volatile uint8_t*, port_output_register, (uint8_t));
+  MOCK_METHOD(uint8_t, pin_bit_mask, (uint8_t));
 };
 
 
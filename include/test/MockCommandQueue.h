@@ -6,34 +6,46 @@
 #define A_TOOLCHAIN_TEST_INCLUDE_TEST_MOCKCOMMANDQUEUE_H_
 
 #include <gmock/gmock.h>
-#include <FunctionObject.h>
+#include <CommandQueue.h>
 
 class MockCommandQueue {
  public:
   MockCommandQueue();
   ~MockCommandQueue();
-  MOCK_METHOD(void, add_entry, (FunctionObject*, uint16_t));
-  MOCK_METHOD(void, remove_entry, (FunctionObject*));
+  MOCK_METHOD(void, add_entry, (Command, void*, uint16_t));
+  MOCK_METHOD(void, remove_entry, (Command, void*));
   MOCK_METHOD(uint32_t, execute_current_entry, ());
+  MOCK_METHOD(void, run_current_entry, ());
+  MOCK_METHOD(uint32_t, next_call_time, ());
   MOCK_METHOD(void, clear_queue, ());
+  MOCK_METHOD(bool, reschedule, (Command, void*, uint16_t));
 };
 
 class CommandQueueMockInterface  {
  public:
   inline static MockCommandQueue* mock_queue_;
 
-  void add_entry(FunctionObject* function, uint16_t frequency) {
-    mock_queue_->add_entry(function, frequency);
+  void add_entry(Command function, void* context, uint16_t frequency) {
+    mock_queue_->add_entry(function, context, frequency);
   }
-  void remove_entry(FunctionObject* function) {
-    mock_queue_->remove_entry(function);
+  void remove_entry(Command function, void* context) {
+    mock_queue_->remove_entry(function, context);
   }
   uint32_t execute_current_entry() {
     return mock_queue_->execute_current_entry();
   }
+  void run_current_entry() {
+    mock_queue_->run_current_entry();
+  }
+  uint32_t next_call_time() {
+    return mock_queue_->next_call_time();
+  }
   void clear_queue() {
     mock_queue_->clear_queue();
   }
+  bool reschedule(Command function, void* context, uint16_t frequency) {
+    return mock_queue_->reschedule(function, context, frequency);
+  }
 };
 
 #endif //A_TOOLCHAIN_TEST_INCLUDE_TEST_MOCKCOMMANDQUEUE_H_
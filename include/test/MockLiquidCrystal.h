@@ -17,7 +17,10 @@ class MockLiquidCrystal {
   MOCK_METHOD(void, print, (const char []));
   MOCK_METHOD(void, print, (int));
   MOCK_METHOD(void, clear, ());
+  MOCK_METHOD(size_t, write, (uint8_t));
   MOCK_METHOD(void, begin, (uint8_t, uint8_t));
+  MOCK_METHOD(void, poll, ());
+  MOCK_METHOD(void, createChar, (uint8_t, uint8_t*));
 };
 
 class LiquidCrystalMockInterface {
@@ -41,9 +44,18 @@ class LiquidCrystalMockInterface {
   void clear() {
     mock_lcd_->clear();
   }
+  size_t write(uint8_t value) {
+    return mock_lcd_->write(value);
+  }
   void begin(uint8_t col, uint8_t row) {
     mock_lcd_->begin(col, row);
   }
+  void poll() {
+    mock_lcd_->poll();
+  }
+  void createChar(uint8_t location, uint8_t charmap[]) {
+    mock_lcd_->createChar(location, charmap);
+  }
 };
 
 #endif //A_TOOLCHAIN_TEST_INCLUDE_TEST_MOCKLIQUIDCRYSTAL_H_
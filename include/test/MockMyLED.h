@@ -7,16 +7,19 @@
 
 #include <gmock/gmock.h>
 
-enum class LEDColour { RED, YELLOW, GREEN };
+enum class LEDColour : uint8_t {
+  RED, ORANGE, YELLOW, LIME, GREEN, BLUE, WHITE
+};
+enum class LEDEffect : uint8_t { STEADY, PULSE, BLINK };
 
 class MockMyLED {
  public:
   MockMyLED();
   ~MockMyLED();
   MOCK_METHOD(void, MyLED, (uint8_t, uint8_t, uint8_t));
-  MOCK_METHOD(void, set_colour, (LEDColour));
-  MOCK_METHOD(void, set_pulse, (int8_t));
-  MOCK_METHOD(void, pulse, ());
+  MOCK_METHOD(void, set_colour, (LEDColour, uint16_t));
+  MOCK_METHOD(void, set_effect, (LEDEffect, uint16_t));
+  MOCK_METHOD(void, start, ());
 };
 
 class MyLEDMockInterface {
@@ -27,14 +30,14 @@ class MyLEDMockInterface {
     //mock_led_->MyLED(red_pin, green_pin, blue_pin);
   }
 
-  void set_colour(LEDColour colour) {
-    mock_led_->set_colour(colour);
+  void set_colour(LEDColour colour, uint16_t fade = 0) {
+    mock_led_->set_colour(colour, fade);
   }
-  void set_pulse(int8_t increment) {
-    mock_led_->set_pulse(increment);
+  void set_effect(LEDEffect effect, uint16_t period = 0) {
+    mock_led_->set_effect(effect, period);
   }
-  void pulse() {
-    mock_led_->pulse();
+  void start() {
+    mock_led_->start();
   }
 };
 
@@ -11,7 +11,7 @@ class MockRadar {
  public:
   MockRadar();
   ~MockRadar();
-  MOCK_METHOD(void, move, ());
+  MOCK_METHOD(uint8_t, move, ());
   MOCK_METHOD(uint32_t, ping, ());
   MOCK_METHOD(void, init, (uint8_t, uint8_t, uint8_t));
 };
@@ -20,8 +20,8 @@ class RadarMockInterface {
  public:
   inline static MockRadar* mock_radar_;
 
-  void move() {
-    mock_radar_->move();
+  uint8_t move() {
+    return mock_radar_->move();
   }
   uint32_t ping() {
     return mock_radar_->ping();
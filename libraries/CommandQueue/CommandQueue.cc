@@ -5,54 +5,87 @@
 
 #include <ArduinoInterface.h>
 #include <CommandQueue.h>
+#include <Profiler.h>
 
 /*
  * Add Entry - add an entry to the command queue
  *
- * This method takes a function pointer and a frequency in ms. This class will
- * then call the function at the specified frequency. When a command is added,
- * it is scheduled to be executed next.
+ * This method takes a function pointer, a context to call it with and a
+ * frequency in ms. This class will then call the function at the specified
+ * frequency. When a command is added, it is scheduled to be executed next.
  *
  * If multiple commands are added, then the order of execution is undefined. If
  * you want to add and execute commands in sequence, interleave each add with a
  * call to execute_current_entry().
+ *
+ * If there isn't the memory for it the command isn't added, and
+ * Memory::stats() counts the failure.
  */
-void CommandQueue::add_entry(FunctionObject* function, uint16_t frequency) {
+void CommandQueue::add_entry(Command function, void* context,
+                             uint16_t frequency) {
 
   using AI = ArduinoInterface;
 
   CommandQueueEntry command;
   command.function_ = function;
+  command.context_ = context;
   command.frequency_ = frequency;
 
   command.last_call_ = AI::millis();
 
-  queue_.insert(command);
+  bool was_empty = queue_.begin() == queue_.end();
+  if (!queue_.insert(command)) {
+    return;
+  }
+
+  // new entries go at the head of the list. If we already know which command
+  // is next we only need to compare against that one, otherwise leave it for
+  // the next scan.
+  CommandQueueEntry* entry = *queue_.begin();
+  if (was_empty) {
+    current_command = entry;
+  } else if (current_command != nullptr && *entry < *current_command) {
+    current_command = entry;
+  }
 }
 
 //
-void CommandQueue::remove_entry(FunctionObject* function) {
+void CommandQueue::remove_entry(Command function, void* context) {
 
   // make a queue entry
   CommandQueueEntry entry;
 
-  // give it the function
+  // give it the function and context
   entry.function_ = function;
+  entry.context_ = context;
+
+  // if we're about to delete the current command, we'll need a new one
+  if (current_command != nullptr && *current_command == entry) {
+    current_command = nullptr;
+  }
 
   // now we can compare it to existing entries for deletion
   queue_.remove(entry);
+}
 
-  // if we just deleted the current command, set it to nullptr
-  current_command = nullptr;
+bool CommandQueue::reschedule(Command function, void* context,
+                              uint16_t frequency) {
+  CommandQueueEntry key;
+  key.function_ = function;
+  key.context_ = context;
+
+  for (auto entry : queue_) {
+    if (*entry == key) {
+      entry->frequency_ = frequency;
+      // it may be next now, or not be any more
+      current_command = nullptr;
+      return true;
+    }
+  }
+  return false;
 }
 
-/*
- * Execute Current Entry - executes the current command, return time to next
- *
- * This method will execute the current command and then update current command
- * to get entry ready for next call.
- */
-uint32_t CommandQueue::execute_current_entry() {
+void CommandQueue::run_current_entry() {
 
   using AI = ArduinoInterface;
 
@@ -61,27 +94,25 @@ uint32_t CommandQueue::execute_current_entry() {
     update_current_command_();
   }
 
-  // if we have a command, do it and update
+  // if we have a command, do it and note when we did
   if (current_command != nullptr) {
-
-    // do the command
-    (*current_command->function_)();
-   // ++command_calls_;
-
-
-    uint32_t current_time = AI::millis();
-
-    // check we didn't change states in previous command. Dereferencing nullptr
-    // is undefined, so don't do it!
-    if (current_command !=nullptr) {
-      // save the current time so we know when we called it
-      current_command->last_call_ = current_time;
+    {
+      PROFILE_COMMAND(current_command->function_);
+      current_command->function_(current_command->context_);
     }
+    current_command->last_call_ = AI::millis();
 
+    // it may not be next any more
+    current_command = nullptr;
+  }
+}
 
-    // get the next command ready for next time we are called
+uint32_t CommandQueue::next_call_time() {
+  if (current_command == nullptr) {
     update_current_command_();
+  }
 
+  if (current_command != nullptr) {
     // last_call_ + frequency_ is the time the command should be called next
     return current_command->last_call_ + (uint32_t)current_command->frequency_;
   } else {
@@ -89,6 +120,17 @@ uint32_t CommandQueue::execute_current_entry() {
   }
 }
 
+/*
+ * Execute Current Entry - executes the current command, return time to next
+ *
+ * This method will execute the current command and then update current command
+ * to get entry ready for next call.
+ */
+uint32_t CommandQueue::execute_current_entry() {
+  run_current_entry();
+  return next_call_time();
+}
+
 /*
  * Update Current Command
  *
@@ -97,6 +139,8 @@ uint32_t CommandQueue::execute_current_entry() {
  */
 void CommandQueue::update_current_command_() {
 
+  ++scans_;
+
   for (auto entry : queue_) {
     if (current_command != nullptr) {
       if (*entry < *current_command) {
@@ -114,17 +158,18 @@ void CommandQueue::clear_queue() {
   for (auto iterator = queue_.begin(); iterator != queue_.end();) {
       auto entry = *iterator;
       ++iterator;
-    remove_entry(entry->function_);
+    remove_entry(entry->function_, entry->context_);
   }
+  current_command = nullptr;
 }
 
 /*
  * == Operator
  *
- * When comparing equal or not equal, just compare the function
+ * When comparing equal or not equal, just compare the function and context
  */
 bool CommandQueueEntry::operator==(const CommandQueueEntry& rhs) const {
-  return this->function_ == rhs.function_;
+  return this->function_ == rhs.function_ && this->context_ == rhs.context_;
 }
 
 /*
@@ -7,27 +7,35 @@
 
 #include <ArduinoInterface.h>
 #include <LinkedList.h>
-#include <FunctionObject.h>
-//#include <Commands.h>
+
+/*
+ * Command
+ *
+ * A command is a plain function. The context it works on is given when it is
+ * added to the queue and passed back in each time it is called, so the same
+ * function can be queued for more than one context.
+ */
+typedef void (*Command)(void* context);
 
 /*
  * CommandQueueEntry - an entry for the Command Queue
  *
- * A command queue entry consists of three parts - a function pointer to be
- * executed, the last time it was called, and how frequently it should be
- * called. This class is a friend to CommandQueue, so CommandQueue has access
- * to its internal state.
+ * A command queue entry consists of four parts - a function pointer to be
+ * executed, the context to pass it, the last time it was called, and how
+ * frequently it should be called. This class is a friend to CommandQueue, so
+ * CommandQueue has access to its internal state.
  *
  * This class also defined comparison operators. A CommandQueueEntry is equal to
- * another CommmandQueueEntry if they have the same function pointer, and is
- * greater than or lesser than another CommandQueueEntry by comparing the last
- * call time plus the frequency.
+ * another CommmandQueueEntry if they have the same function pointer and
+ * context, and is greater than or lesser than another CommandQueueEntry by
+ * comparing the last call time plus the frequency.
  */
 class CommandQueueEntry {
   friend class CommandQueue;
 
  private:
-  FunctionObject* function_ {nullptr};
+  Command   function_ {nullptr};
+  void*     context_ {nullptr};
   uint32_t  last_call_ {UINT32_MAX};       // time last called as returned by millis()
   uint16_t  frequency_ {UINT16_MAX};        // how many ms desired between calls
 
@@ -35,10 +43,12 @@ class CommandQueueEntry {
   CommandQueueEntry() = default;
 
   CommandQueueEntry(
-      FunctionObject* function,
+      Command function,
+      void* context,
       uint32_t last_call,
       uint8_t frequency
-      ) : function_ {function}, last_call_{last_call}, frequency_{frequency} {};
+      ) : function_ {function}, context_ {context}, last_call_{last_call},
+          frequency_{frequency} {};
 
   // comparison operators
   bool operator==(const CommandQueueEntry& rhs) const;
@@ -53,24 +63,60 @@ class CommandQueueEntry {
  * CommandQueue - a queue of commands to execute
  *
  * This class extends LinkedList and provides methods
+ *
+ * Commands must not add or remove entries while they are being run. Anything
+ * that needs to change the queue should happen between run_current_entry()
+ * and next_call_time(), where the queue keeps track of the next command as
+ * entries come and go and only has to scan the list once.
  */
 class CommandQueue {
  private:
   LinkedList<CommandQueueEntry> queue_;
-  CommandQueueEntry* current_command {nullptr};
+  CommandQueueEntry* current_command {nullptr}; // nullptr if we need a scan
 
-  //uint32_t command_calls_ {0};
+  uint32_t scans_ {0}; // times the whole list has been walked
 
   void update_current_command_();
 
  public:
 
-  void add_entry(FunctionObject* function, uint16_t frequency);
-  void remove_entry(FunctionObject* function);
+  void add_entry(Command function, void* context, uint16_t frequency);
+  void remove_entry(Command function, void* context);
   void clear_queue();
-  uint32_t execute_current_entry();
 
+  /*
+   * Reschedule
+   *
+   * Change how often a queued command is called. It's next due frequency ms
+   * after it last ran, so a shorter period can make it due straight away.
+   * Like add_entry() and remove_entry(), not from inside a command.
+   *
+   * Returns:
+   * bool - false if the command isn't queued with that context
+   */
+  bool reschedule(Command function, void* context, uint16_t frequency);
+
+  /*
+   * Run Current Entry
+   *
+   * Run the command that is due next and note the time it ran. The next
+   * command isn't worked out until next_call_time(), so entries can be added
+   * and removed in between without any extra work.
+   */
+  void run_current_entry();
+
+  /*
+   * Next Call Time
+   *
+   * Returns:
+   * uint32_t - time in ms the next command is due, or 0 if the queue is empty
+   */
+  uint32_t next_call_time();
+
+  // run_current_entry() then next_call_time()
+  uint32_t execute_current_entry();
 
+  inline uint32_t scans() const { return scans_; };
 };
 
 
@@ -0,0 +1,73 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_EVENTQUEUE_EVENTQUEUE_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_EVENTQUEUE_EVENTQUEUE_H_
+
+#ifdef UNIT_TEST
+#include <cstdint>
+#else
+#include <ArduinoInterface.h>
+#endif // UNIT_TEST
+
+/*
+ * EventQueue - a fixed size first in, first out queue of events
+ *
+ * Commands post events here rather than acting on them straight away, and
+ * they get handled once the command has finished. That way nothing changes
+ * the command queue while it is in the middle of running a command.
+ *
+ * N must be a power of 2 so the indexes wrap with a mask. The indexes are
+ * free running and only masked when used, so head_ - tail_ is always the
+ * number of events waiting, even after they wrap.
+ *
+ * If the queue is full the new event is dropped and post() returns false.
+ */
+template<typename T, uint8_t N>
+class EventQueue {
+  static_assert(N != 0 && (N & (N - 1)) == 0, "N must be a power of 2");
+
+ private:
+  static constexpr uint8_t mask_ {N - 1};
+
+  T       events_[N];
+  uint8_t head_ {0};   // next slot to post into
+  uint8_t tail_ {0};   // next slot to pop from
+
+ public:
+  /*
+   * Post
+   *
+   * T event - event to add to the back of the queue
+   *
+   * Returns:
+   * bool - false if the queue was full and the event was dropped
+   */
+  inline bool post(const T& event) {
+    if (full()) {
+      return false;
+    }
+    events_[head_++ & mask_] = event;
+    return true;
+  };
+
+  /*
+   * Pop
+   *
+   * T& event - set to the event at the front of the queue, if there is one
+   *
+   * Returns:
+   * bool - false if there was nothing to pop
+   */
+  inline bool pop(T& event) {
+    if (empty()) {
+      return false;
+    }
+    event = events_[tail_++ & mask_];
+    return true;
+  };
+
+  inline uint8_t size() const { return head_ - tail_; };
+  inline bool empty() const { return head_ == tail_; };
+  inline bool full() const { return size() == N; };
+  inline void clear() { tail_ = head_; };
+};
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_EVENTQUEUE_EVENTQUEUE_H_
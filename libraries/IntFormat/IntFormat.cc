@@ -0,0 +1,97 @@
+#include <IntFormat.h>
+#include <ArduinoInterface.h>
+
+namespace IntFormat {
+
+namespace {
+
+const uint8_t max_digits {10};
+
+const uint32_t powers[max_digits] PROGMEM {
+    1000000000, 100000000, 10000000, 1000000, 100000,
+    10000, 1000, 100, 10, 1};
+
+inline uint32_t power(uint8_t i) {
+  uint32_t p;
+  memcpy_P(&p, &powers[i], sizeof(p));
+  return p;
+}
+
+/*
+ * Format
+ *
+ * Everything comes through here. The number is magnitude, with a '-' in front
+ * if negative, and a point before the last decimals digits.
+ */
+uint8_t format(char out[], uint8_t width, uint32_t magnitude, bool negative,
+               uint8_t decimals) {
+  if (decimals >= max_digits) {
+    decimals = max_digits - 1;
+  }
+
+  // first power of ten that goes into magnitude. Always write the units, and
+  // a 0 before the point.
+  uint8_t first = max_digits - 1 - decimals;
+  for (uint8_t i = 0; i < first; ++i) {
+    if (magnitude >= power(i)) {
+      first = i;
+      break;
+    }
+  }
+
+  uint8_t length = (max_digits - first) + negative + (decimals != 0);
+  if (width == 0) {
+    width = length;
+  }
+  if (length > width) {
+    for (uint8_t i = 0; i < width; ++i) {
+      out[i] = '*';
+    }
+    return width;
+  }
+
+  uint8_t pos = 0;
+  while (pos < width - length) {
+    out[pos++] = ' ';
+  }
+  if (negative) {
+    out[pos++] = '-';
+  }
+
+  for (uint8_t i = first; i < max_digits; ++i) {
+    if (max_digits - i == decimals) {
+      out[pos++] = '.';
+    }
+    uint32_t p = power(i);
+    char digit = '0';
+    while (magnitude >= p) {
+      magnitude -= p;
+      ++digit;
+    }
+    out[pos++] = digit;
+  }
+
+  return width;
+}
+
+// work in unsigned so the most negative value doesn't overflow
+inline uint32_t magnitude(int32_t value) {
+  return (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+}
+
+} // namespace
+
+uint8_t format_uint(char out[], uint8_t width, uint32_t value) {
+  return format(out, width, value, false, 0);
+}
+
+uint8_t format_int(char out[], uint8_t width, int32_t value) {
+  return format(out, width, magnitude(value), value < 0, 0);
+}
+
+uint8_t format_fixed(char out[], uint8_t width, int32_t value,
+                     uint8_t decimals) {
+  return format(out, width, magnitude(value), value < 0, decimals);
+}
+
+} // namespace IntFormat
@@ -0,0 +1,58 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_INTFORMAT_INTFORMAT_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_INTFORMAT_INTFORMAT_H_
+
+#ifdef UNIT_TEST
+#include <cstdint>
+#else
+#include <ArduinoInterface.h>
+#endif // UNIT_TEST
+
+/*
+ * IntFormat - integers to decimal text, right aligned in a fixed width
+ *
+ * The AVR has no divide instruction, so % 10 and / 10 are each a call into a
+ * 32 bit division routine of several hundred cycles, twice per digit. Here
+ * each digit is found by subtracting a power of ten, from a table in flash,
+ * until it won't go, which is at most 9 subtractions.
+ *
+ * Text is written straight into out, with no '\0' added and nothing
+ * allocated, so out can be part of a framebuffer.
+ *
+ * If the text won't fit in width, out is filled with '*' instead, so a
+ * number that is too big can't be mistaken for a smaller one.
+ */
+namespace IntFormat {
+
+// longest text: sign, 10 digits and a decimal point
+const uint8_t max_width {12};
+
+/*
+ * Format Unsigned
+ *
+ * char out[] - where to write the text, at least width characters long
+ * uint8_t width - characters to fill, padding on the left with spaces. 0 to
+ *                 write just as many as are needed, up to max_width.
+ * uint32_t value - number to write
+ *
+ * Returns:
+ * uint8_t - number of characters written
+ */
+uint8_t format_uint(char out[], uint8_t width, uint32_t value);
+
+// int32_t value - number to write, with a '-' if negative
+uint8_t format_int(char out[], uint8_t width, int32_t value);
+
+/*
+ * Format Fixed
+ *
+ * Fixed point, so 1234 with 2 decimals is "12.34" and 5 is "0.05".
+ *
+ * int32_t value - number to write, in units of 10^-decimals
+ * uint8_t decimals - digits after the decimal point, up to 9
+ */
+uint8_t format_fixed(char out[], uint8_t width, int32_t value,
+                     uint8_t decimals);
+
+} // namespace IntFormat
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_INTFORMAT_INTFORMAT_H_
@@ -0,0 +1,75 @@
+#include <LCDBuffer.h>
+#include <IntFormat.h>
+
+LCDBuffer::LCDBuffer() {
+  reset();
+}
+
+void LCDBuffer::put_(char c) {
+  if (cursor_ >= row_end_) {
+    return; // off the end of the row
+  }
+  if (cells_[cursor_] != c) {
+    cells_[cursor_] = c;
+    dirty_ |= (uint32_t)1 << cursor_;
+  }
+  ++cursor_;
+}
+
+void LCDBuffer::setCursor(uint8_t col, uint8_t row) {
+  if (row >= rows) {
+    row = rows - 1;
+  }
+  row_end_ = (row + 1) * cols;
+  cursor_ = (col < cols) ? row * cols + col : row_end_;
+}
+
+void LCDBuffer::print(const char str[]) {
+  while (*str != '\0') {
+    put_(*str++);
+  }
+}
+
+void LCDBuffer::print(int n) {
+  char text[IntFormat::max_width];
+  uint8_t length = IntFormat::format_int(text, 0, n);
+
+  for (uint8_t i = 0; i < length; ++i) {
+    put_(text[i]);
+  }
+}
+
+void LCDBuffer::print(uint32_t n, uint8_t width) {
+  char text[cols];
+  if (width > cols) {
+    width = cols;
+  }
+  IntFormat::format_uint(text, width, n);
+
+  for (uint8_t i = 0; i < width; ++i) {
+    put_(text[i]);
+  }
+}
+
+void LCDBuffer::write(char c) {
+  put_(c);
+}
+
+void LCDBuffer::clear() {
+  for (uint8_t row = 0; row < rows; ++row) {
+    setCursor(0, row);
+    for (uint8_t col = 0; col < cols; ++col) {
+      put_(' ');
+    }
+  }
+  setCursor(0, 0);
+}
+
+void LCDBuffer::reset() {
+  for (uint8_t i = 0; i < cells; ++i) {
+    cells_[i] = ' ';
+    shown_[i] = ' ';
+  }
+  dirty_ = 0;
+  setCursor(0, 0);
+}
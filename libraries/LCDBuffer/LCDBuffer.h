@@ -0,0 +1,152 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_LCDBUFFER_LCDBUFFER_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_LCDBUFFER_LCDBUFFER_H_
+
+#ifdef UNIT_TEST
+#include <cstdint>
+#else
+#include <ArduinoInterface.h>
+#endif // UNIT_TEST
+
+/*
+ * LCDBuffer - a copy of a 16x2 character LCD in RAM
+ *
+ * setCursor(), print() and clear() work like the LiquidCrystal methods of the
+ * same name, but only change the copy. Each character written over with
+ * something different is marked dirty. flush() then compares each dirty
+ * character with a second copy of what the LCD is showing, and sends just the
+ * ones that really are different, so clearing the screen and writing the same
+ * text back sends nothing.
+ *
+ * LiquidCrystal doesn't block: each byte goes in its LCDQueue, and poll()
+ * sends what the controller is ready for, reading the busy flag where there
+ * is one. Its queue is only 32 bytes though, a screen's worth, and once full
+ * write() waits for room. flush() only queues what's changed, so a redraw
+ * of the same text queues nothing, and clearing the screen only queues
+ * spaces over the characters that weren't spaces already, rather than the
+ * slow clear instruction.
+ *
+ * Text past the end of a row is dropped rather than wrapped.
+ */
+class LCDBuffer {
+ public:
+  static constexpr uint8_t cols {16};
+  static constexpr uint8_t rows {2};
+  static constexpr uint8_t cells {cols * rows};
+
+ private:
+  char      cells_[cells];  // what the screen should show, row by row
+  char      shown_[cells];  // what the LCD is showing
+  uint32_t  dirty_ {0};     // bit n set if cells_[n] may not be on the LCD
+  uint8_t   cursor_ {0};    // where print() writes next
+  uint8_t   row_end_ {cols};  // first cell after the cursor's row
+
+  static_assert(cells <= 32, "dirty_ needs a bit per cell");
+
+  void put_(char c);
+
+ public:
+  LCDBuffer();
+
+  /*
+   * Set Cursor
+   *
+   * uint8_t col - column
+   * uint8_t row - row
+   */
+  void setCursor(uint8_t col, uint8_t row);
+
+  /*
+   * Print
+   *
+   * Write at the cursor and move the cursor along.
+   *
+   * const char str[] - a string
+   */
+  void print(const char str[]);
+
+  // int n - an integer, printed in decimal
+  void print(int n);
+
+  /*
+   * Print
+   *
+   * uint32_t n - an integer, printed in decimal right aligned in width
+   *              characters, or as width '*'s if it doesn't fit
+   * uint8_t width - characters to fill, padded with spaces on the left
+   */
+  void print(uint32_t n, uint8_t width);
+
+  // char c - one character, which may be a custom one (0 to 15)
+  void write(char c);
+
+  /*
+   * Clear
+   *
+   * Fill with spaces and move the cursor to 0,0
+   */
+  void clear();
+
+  /*
+   * Reset
+   *
+   * The LCD has just been cleared (by begin() or clear()). Make the copy
+   * match, with nothing to send.
+   */
+  void reset();
+
+  // what the screen should show at col, row
+  inline char at(uint8_t col, uint8_t row) const {
+    return cells_[row * cols + col];
+  };
+
+  // true if there may be anything to send
+  inline bool dirty() const { return dirty_ != 0; };
+
+  /*
+   * Flush
+   *
+   * Send the dirty characters to lcd. Runs of dirty characters on the same
+   * row are written one after the other, so only need one setCursor() between
+   * them as the LCD moves its own cursor along as it is written to.
+   *
+   * LCD& lcd - anything with setCursor(col, row) and write(uint8_t), like
+   *            LiquidCrystal
+   *
+   * Returns:
+   * uint8_t - number of send()s made, one per setCursor() or write()
+   */
+  template<typename LCD>
+  uint8_t flush(LCD& lcd);
+};
+
+template<typename LCD>
+uint8_t LCDBuffer::flush(LCD& lcd) {
+  uint8_t sends = 0;
+  uint8_t lcd_cursor = UINT8_MAX; // where the LCD will write next, if known
+  uint32_t bit = 1;
+
+  for (uint8_t i = 0; i < cells && dirty_ != 0; ++i, bit <<= 1) {
+    if ((dirty_ & bit) == 0) {
+      continue;
+    }
+    dirty_ &= ~bit;
+    if (cells_[i] == shown_[i]) {
+      continue; // changed, then changed back
+    }
+
+    if (i != lcd_cursor) {
+      lcd.setCursor(i % cols, i / cols);
+      ++sends;
+    }
+    lcd.write((uint8_t)cells_[i]);
+    shown_[i] = cells_[i];
+    ++sends;
+
+    // the LCD's address doesn't carry on to the start of the next row
+    lcd_cursor = ((i + 1) % cols == 0) ? UINT8_MAX : i + 1;
+  }
+
+  return sends;
+}
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_LCDBUFFER_LCDBUFFER_H_
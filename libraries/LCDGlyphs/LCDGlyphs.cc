@@ -0,0 +1,97 @@
+#include <LCDGlyphs.h>
+#include <ArduinoInterface.h>
+
+namespace Glyphs {
+
+namespace {
+
+const uint8_t patterns[count][8] PROGMEM {
+    // BAR_1 to BAR_4
+    {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000},
+    {0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000},
+    {0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100},
+    {0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110},
+    // NEEDLE_0 to NEEDLE_8, 0° to 180°
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00111},
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00011, 0b00110},
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00001, 0b00010, 0b00100},
+    {0b00000, 0b00001, 0b00001, 0b00011, 0b00010, 0b00010, 0b00110, 0b00100},
+    {0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100},
+    {0b00000, 0b10000, 0b10000, 0b11000, 0b01000, 0b01000, 0b01100, 0b00100},
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b10000, 0b01000, 0b00100},
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11000, 0b01100},
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11100},
+};
+
+} // namespace
+
+void pattern(uint8_t id, uint8_t rows[8]) {
+  memcpy_P(rows, patterns[id], 8);
+}
+
+} // namespace Glyphs
+
+GlyphCache::GlyphCache() {
+  reset();
+}
+
+void GlyphCache::reset() {
+  for (uint8_t i = 0; i < slots; ++i) {
+    loaded_[i] = none;
+    age_[i] = UINT8_MAX;
+  }
+  used_ = 0;
+}
+
+void GlyphCache::begin_frame() {
+  for (uint8_t i = 0; i < slots; ++i) {
+    if (age_[i] != UINT8_MAX) {
+      ++age_[i];
+    }
+  }
+  used_ = 0;
+}
+
+uint8_t GlyphCache::find_(uint8_t id) const {
+  for (uint8_t i = 0; i < slots; ++i) {
+    if (loaded_[i] == id) {
+      return i;
+    }
+  }
+  return none;
+}
+
+// an empty slot if there is one, otherwise the one unused for longest, but
+// never one used this frame
+uint8_t GlyphCache::victim_() const {
+  uint8_t victim = none;
+
+  for (uint8_t i = 0; i < slots; ++i) {
+    if (loaded_[i] == none) {
+      return i;
+    }
+    if (used_ & (1 << i)) {
+      continue;
+    }
+    if (victim == none || age_[i] > age_[victim]) {
+      victim = i;
+    }
+  }
+  return victim;
+}
+
+uint8_t TargetDisplay::bar_steps(uint32_t range) const {
+  const uint8_t max = bar_cells * 5;
+  if (range >= full_scale_) {
+    return max;
+  }
+  return (uint8_t)(range * max / full_scale_);
+}
+
+uint8_t TargetDisplay::needle(uint8_t bearing) {
+  if (bearing > 180) {
+    bearing = 180;
+  }
+  // nearest 22.5°
+  return Glyphs::NEEDLE_0 + (uint8_t)(((uint16_t)bearing * 2 + 22) / 45);
+}
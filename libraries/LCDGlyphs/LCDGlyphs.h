@@ -0,0 +1,195 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_LCDGLYPHS_LCDGLYPHS_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_LCDGLYPHS_LCDGLYPHS_H_
+
+#include <LCDBuffer.h>
+#include <TargetTracker.h>
+
+/*
+ * Glyphs
+ *
+ * Custom characters the radar draws with. Each is 8 rows of 5 pixels, the top
+ * row first and the leftmost pixel in bit 4, as createChar() wants them.
+ *
+ * BAR_1 to BAR_4 - the left 1 to 4 columns lit, for the end of a bar graph
+ * NEEDLE_0 to NEEDLE_8 - a line from the bottom middle pointing at 0°, 22.5°
+ *                        and so on up to 180°, with 0° to the right as the
+ *                        servo has it
+ */
+namespace Glyphs {
+
+const uint8_t BAR_1 {0};
+const uint8_t NEEDLE_0 {4};
+const uint8_t count {13};
+
+/*
+ * Pattern
+ *
+ * uint8_t id - glyph to draw, below count
+ * uint8_t rows[8] - set to its pattern
+ */
+void pattern(uint8_t id, uint8_t rows[8]);
+
+} // namespace Glyphs
+
+/*
+ * GlyphCache - which glyph is in each of the LCD's 8 CGRAM slots
+ *
+ * Uploading a glyph with createChar() is nine send()s, so a glyph is only
+ * uploaded if it isn't in a slot already. When every slot is full, the slot
+ * that has gone longest without being asked for is reused, but never one
+ * asked for in the current frame, as it may be on screen.
+ *
+ * Characters 8 to 15 show CGRAM slots 0 to 7 the same as characters 0 to 7
+ * do, so glyph() hands those out instead, and a glyph can go in a string
+ * without looking like the '\0' on the end.
+ */
+class GlyphCache {
+ public:
+  static constexpr uint8_t slots {8};
+  static constexpr uint8_t none {UINT8_MAX};
+
+ private:
+  uint8_t   loaded_[slots];   // glyph in each slot, or none
+  uint8_t   age_[slots];      // frames since each slot was asked for, to 255
+  uint8_t   used_ {0};        // bit n set if slot n was asked for this frame
+  uint16_t  uploads_ {0};
+
+  uint8_t find_(uint8_t id) const;
+  uint8_t victim_() const;
+
+ public:
+  GlyphCache();
+
+  /*
+   * Reset
+   *
+   * The LCD has just been started, so nothing is in CGRAM.
+   */
+  void reset();
+
+  /*
+   * Begin Frame
+   *
+   * Call before drawing each frame. Slots asked for before this may be
+   * reused.
+   */
+  void begin_frame();
+
+  /*
+   * Glyph
+   *
+   * Get a character showing glyph id, uploading it first if need be.
+   *
+   * LCD& lcd - anything with createChar(uint8_t, uint8_t[]), like LiquidCrystal
+   * uint8_t id - glyph from Glyphs
+   *
+   * Returns:
+   * char - character code to print, or ' ' if every slot is taken this frame
+   */
+  template<typename LCD>
+  char glyph(LCD& lcd, uint8_t id);
+
+  // createChar() calls since construction
+  inline uint16_t uploads() const { return uploads_; };
+};
+
+template<typename LCD>
+char GlyphCache::glyph(LCD& lcd, uint8_t id) {
+  uint8_t slot = find_(id);
+
+  if (slot == none) {
+    slot = victim_();
+    if (slot == none) {
+      return ' ';
+    }
+    uint8_t rows[8];
+    Glyphs::pattern(id, rows);
+    lcd.createChar(slot, rows);
+    loaded_[slot] = id;
+    ++uploads_;
+  }
+
+  age_[slot] = 0;
+  used_ |= 1 << slot;
+  return (char)(slots + slot);
+}
+
+/*
+ * TargetDisplay - the nearest target on one row of the LCD
+ *
+ *    ███████▌    45↗
+ *
+ * The bar is range, full_scale mm across bar_cells cells at 5 steps per cell,
+ * and the end of the row is the bearing in degrees and a needle pointing that
+ * way. Whole cells of bar are the LCD's own solid block, so at most two
+ * glyphs are needed: the end of the bar and the needle.
+ *
+ * With no target the bar is empty and the bearing is "---".
+ */
+class TargetDisplay {
+ public:
+  static constexpr uint8_t bar_cells {11};
+  static constexpr char block {(char)0xFF};  // solid block in the LCD's ROM
+
+ private:
+  GlyphCache  glyphs_;
+  uint32_t    full_scale_;
+
+ public:
+  // uint32_t full_scale - range in mm that fills the bar
+  explicit TargetDisplay(uint32_t full_scale = 1000)
+      : full_scale_{full_scale} {};
+
+  /*
+   * Draw
+   *
+   * Draw target into row of screen. Glyphs it needs that aren't on the LCD
+   * already are uploaded to lcd straight away; the rest goes when screen is
+   * flushed.
+   *
+   * const Target* target - target to show, or nullptr for none
+   */
+  template<typename LCD>
+  void draw(LCDBuffer& screen, LCD& lcd, const Target* target, uint8_t row);
+
+  inline void reset() { glyphs_.reset(); };
+  inline const GlyphCache& glyphs() const { return glyphs_; };
+
+  // steps of bar for range, 0 to bar_cells * 5
+  uint8_t bar_steps(uint32_t range) const;
+
+  // needle for a bearing in degrees, NEEDLE_0 to NEEDLE_0 + 8
+  static uint8_t needle(uint8_t bearing);
+};
+
+template<typename LCD>
+void TargetDisplay::draw(LCDBuffer& screen, LCD& lcd, const Target* target,
+                         uint8_t row) {
+  glyphs_.begin_frame();
+  screen.setCursor(0, row);
+
+  uint8_t steps = (target != nullptr) ? bar_steps(target->range) : 0;
+  uint8_t cell = 0;
+  for (; cell < steps / 5; ++cell) {
+    screen.write(block);
+  }
+  if (steps % 5 != 0) {
+    screen.write(glyphs_.glyph(lcd, Glyphs::BAR_1 + steps % 5 - 1));
+    ++cell;
+  }
+  for (; cell <= bar_cells; ++cell) {
+    screen.write(' ');
+  }
+
+  if (target == nullptr) {
+    screen.print("--- ");
+    return;
+  }
+
+  // bearing_max is never more than 180, so this can't overflow
+  uint8_t bearing = (uint8_t)((target->bearing_min + target->bearing_max) / 2);
+  screen.print((uint32_t)bearing, 3);
+  screen.write(glyphs_.glyph(lcd, needle(bearing)));
+}
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_LCDGLYPHS_LCDGLYPHS_H_
@@ -0,0 +1,118 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_LCDQUEUE_LCDQUEUE_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_LCDQUEUE_LCDQUEUE_H_
+
+#include <EventQueue.h>
+
+/*
+ * LCDQueue - bytes waiting to go to an HD44780, and when it can take the next
+ *
+ * The controller can't take another byte until it has finished the last one.
+ * Rather than waiting that out after every byte, LiquidCrystal queues them
+ * here and sends one whenever pop() says the controller is ready, so the wait
+ * is spent running commands instead.
+ *
+ * If the controller's busy flag can be read, the next byte goes as soon as it
+ * clears, and the execution time is only a timeout in case it never does.
+ *
+ * Execution times are for the slowest oscillator the datasheet allows
+ * (190kHz). Most instructions take 37us at the usual 270kHz, so 53us at
+ * 190kHz, and clear and home take 1.52ms, so 2.16ms. exec_us is the 100us
+ * LiquidCrystal has always allowed.
+ *
+ * N must be a power of 2, as for EventQueue.
+ */
+template<uint8_t N>
+class LCDQueue {
+ public:
+  static constexpr uint16_t exec_us {100};
+  static constexpr uint16_t clear_us {2200};
+
+  /*
+   * Exec Time
+   *
+   * uint8_t value - byte sent
+   * uint8_t mode - RS line, 0 for an instruction, 1 for data
+   *
+   * Returns:
+   * uint16_t - microseconds until the controller can take another byte
+   */
+  static inline uint16_t exec_time(uint8_t value, uint8_t mode) {
+    // clear display is 0x01, return home 0x02 or 0x03
+    return (mode == 0 && value != 0 && value < 0x04) ? clear_us : exec_us;
+  };
+
+ private:
+  struct Entry {
+    uint8_t value;
+    uint8_t mode;
+  };
+
+  EventQueue<Entry, N> entries_;
+  uint32_t  last_sent_ {0};   // micros() when the last byte was latched
+  uint16_t  wait_ {0};        // how long that byte takes
+
+ public:
+  /*
+   * Push
+   *
+   * Returns:
+   * bool - false if the queue was full and the byte wasn't added
+   */
+  inline bool push(uint8_t value, uint8_t mode) {
+    return entries_.post(Entry{value, mode});
+  };
+
+  /*
+   * Ready
+   *
+   * uint32_t now - micros()
+   *
+   * Returns:
+   * bool - true if the controller has finished the last byte
+   */
+  inline bool ready(uint32_t now) const {
+    return now - last_sent_ >= wait_;
+  };
+
+  /*
+   * Pop
+   *
+   * Take the next byte, if there is one and the controller is ready for it.
+   * Call sent() once it has been written.
+   *
+   * uint32_t now - micros()
+   * uint8_t& value, mode - set to the byte to send
+   * bool busy - the busy flag, if it was read. Leave it out to go by time.
+   *
+   * Returns:
+   * bool - false if there is nothing to send yet
+   */
+  inline bool pop(uint32_t now, uint8_t& value, uint8_t& mode,
+                  bool busy = true) {
+    Entry entry;
+    if ((busy && !ready(now)) || !entries_.pop(entry)) {
+      return false;
+    }
+    value = entry.value;
+    mode = entry.mode;
+    wait_ = exec_time(value, mode);
+    return true;
+  };
+
+  /*
+   * Sent
+   *
+   * The byte from the last pop() has been latched. The controller is busy
+   * from now, not from when it was popped, as the write itself takes time.
+   *
+   * uint32_t now - micros() after the enable pulse
+   */
+  inline void sent(uint32_t now) { last_sent_ = now; };
+
+  inline uint8_t size() const { return entries_.size(); };
+  inline bool empty() const { return entries_.empty(); };
+  inline bool full() const { return entries_.full(); };
+  inline void clear() { entries_.clear(); };
+};
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_LCDQUEUE_LCDQUEUE_H_
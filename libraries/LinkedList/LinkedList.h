@@ -5,13 +5,7 @@
 #ifndef A_TOOLCHAIN_TEST_LIBRARIES_LINKEDLIST_LINKEDLIST_H_
 #define A_TOOLCHAIN_TEST_LIBRARIES_LINKEDLIST_LINKEDLIST_H_
 
-#ifdef UNIT_TEST
-#include <cstdint>
-#else
-#include <ArduinoInterface.h>
-//#include <new.h>
-#include <stdlib.h>
-#endif // UNIT_TEST
+#include <Memory.h>
 
 template <typename T> class ListNode;
 template <typename T> class LinkedList;
@@ -37,6 +31,9 @@ class ListNode {
  * an entry at the head of the list. Delete will delete the first found match in
  * the list. Iterate returns a subsequent list entry with every call, and NULL
  * to indicate the end of the list.
+ *
+ * Nodes come from the counted heap, see Memory. If there's no memory for one,
+ * insert() leaves the list as it was.
  */
 template<typename T>
 class LinkedList {
@@ -98,7 +95,7 @@ class LinkedList {
 
  public:
   ~LinkedList();
-  void insert(T data);
+  bool insert(T data);
   void remove(T data);
 
 
@@ -122,8 +119,7 @@ LinkedList<T>::~LinkedList() {
   while (current_ptr!=nullptr) {
     old_ptr = current_ptr; // save that pointer
     current_ptr = current_ptr->next_; // advance to next pointer
-    delete old_ptr; // and now delete that object
-    //free(old_ptr);
+    heap_delete(old_ptr); // and now delete that object
   }
 }
 
@@ -133,19 +129,29 @@ LinkedList<T>::~LinkedList() {
  * This will stick an item at the START of the list. This is makes this nice
  * and fast. So, items should be added in REVERSE order as the things you add
  * later will be return before, if that is important to you.
+ *
+ * Returns:
+ * bool - false if there wasn't the memory for it, and the list is as it was
  */
 template<typename T>
-void LinkedList<T>::insert(T data) {
+bool LinkedList<T>::insert(T data) {
 
   // if list is not empty (more common case)
   if (head_ != nullptr) {
-    auto node = new ListNode<T>(data, head_);
+    auto node = new (Memory::heap) ListNode<T>(data, head_);
+    if (node == nullptr) {
+      return false;
+    }
     head_ = node;
 
   } else {
-    auto node = new ListNode<T>(data, nullptr);
+    auto node = new (Memory::heap) ListNode<T>(data, nullptr);
+    if (node == nullptr) {
+      return false;
+    }
     head_ = node;
   }
+  return true;
 }
 
 
@@ -168,12 +174,12 @@ void LinkedList<T>::remove(T data) {
     if (current_ptr->data_ == data) {
       if (old_ptr == nullptr) { // this is true if we're still at head
         head_ = current_ptr->next_; // make head the next one
-        delete current_ptr;
+        heap_delete(current_ptr);
         break; // break out of loop here
 
       } else { // snip current entry out of the list
         old_ptr->next_ = current_ptr->next_;
-        delete current_ptr;
+        heap_delete(current_ptr);
         break;
       }
     } else { // carry on looking
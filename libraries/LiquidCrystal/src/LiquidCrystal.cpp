@@ -67,6 +67,8 @@ void LiquidCrystal::init(uint8_t fourbitmode, uint8_t rs, uint8_t rw, uint8_t en
   _data_pins[6] = d6;
   _data_pins[7] = d7; 
 
+  _busy_flag = 0;
+
   if (fourbitmode)
     _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
   else 
@@ -94,12 +96,18 @@ void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
     pinMode(_rw_pin, OUTPUT);
   }
   pinMode(_enable_pin, OUTPUT);
+
+  _queue.clear();
+  _sync = 1;
   
   // Do these once, instead of every time a character is drawn for speed reasons.
   for (int i=0; i<((_displayfunction & LCD_8BITMODE) ? 8 : 4); ++i)
   {
     pinMode(_data_pins[i], OUTPUT);
    } 
+#ifdef LCD_FAST_IO
+  _fast = _data.init(_data_pins, (_displayfunction & LCD_8BITMODE) ? 8 : 4);
+#endif
 
   // SEE PAGE 45/46 FOR INITIALIZATION SPECIFICATION!
   // according to datasheet, we need at least 40ms after power rises above 2.7V
@@ -131,6 +139,7 @@ void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
 
     // finally, set to 4-bit interface
     write4bits(0x02); 
+    delayMicroseconds(100);
   } else {
     // this is according to the hitachi HD44780 datasheet
     // page 45 figure 23
@@ -162,6 +171,7 @@ void LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
   // set the entry mode
   command(LCD_ENTRYMODESET | _displaymode);
 
+  _sync = 0;
 }
 
 void LiquidCrystal::setRowOffsets(int row0, int row1, int row2, int row3)
@@ -176,13 +186,13 @@ void LiquidCrystal::setRowOffsets(int row0, int row1, int row2, int row3)
 void LiquidCrystal::clear()
 {
   command(LCD_CLEARDISPLAY);  // clear display, set cursor position to zero
-  delayMicroseconds(2000);  // this command takes a long time!
+  // this command takes a long time! The queue holds back the next byte.
 }
 
 void LiquidCrystal::home()
 {
   command(LCD_RETURNHOME);  // set cursor position to zero
-  delayMicroseconds(2000);  // this command takes a long time!
+  // this command takes a long time! The queue holds back the next byte.
 }
 
 void LiquidCrystal::setCursor(uint8_t col, uint8_t row)
@@ -283,8 +293,48 @@ inline size_t LiquidCrystal::write(uint8_t value) {
 
 /************ low level data pushing commands **********/
 
-// write either command or data, with automatic 4/8-bit selection
+// queue command or data, to go out when the controller is ready for it
 void LiquidCrystal::send(uint8_t value, uint8_t mode) {
+  // if the queue is full, wait for room
+  while (!_queue.push(value, mode)) {
+    poll();
+  }
+  if (_sync) {
+    flush();
+  }
+}
+
+// send the queued bytes the controller is ready for, without waiting. With
+// the busy flag that may be several, so stop after a few and let the caller
+// get on.
+void LiquidCrystal::poll() {
+  uint8_t value, mode;
+  for (uint8_t i = 0; i < 4 && !_queue.empty(); ++i) {
+    uint32_t now = micros();
+    // the busy flag can't be read until begin() is done, and there is no
+    // point once the timeout has passed
+    bool busy = !_busy_flag || _sync || _queue.ready(now) || readBusyFlag();
+    if (!_queue.pop(now, value, mode, busy)) {
+      return;
+    }
+    sendNow(value, mode);
+    _queue.sent(micros());
+  }
+}
+
+void LiquidCrystal::useBusyFlag(bool on) {
+  _busy_flag = on && _rw_pin != 255;
+}
+
+// wait until every queued byte has been sent
+void LiquidCrystal::flush() {
+  while (!_queue.empty()) {
+    poll();
+  }
+}
+
+// write either command or data, with automatic 4/8-bit selection
+void LiquidCrystal::sendNow(uint8_t value, uint8_t mode) {
   digitalWrite(_rs_pin, mode);
 
   // if there is a RW pin indicated, set it low to Write
@@ -300,16 +350,52 @@ void LiquidCrystal::send(uint8_t value, uint8_t mode) {
   }
 }
 
+// read the busy flag (D7) from the instruction register
+bool LiquidCrystal::readBusyFlag() {
+  uint8_t bits = (_displayfunction & LCD_8BITMODE) ? 8 : 4;
+  for (uint8_t i = 0; i < bits; i++) {
+    pinMode(_data_pins[i], INPUT);
+  }
+  digitalWrite(_rs_pin, LOW);
+  digitalWrite(_rw_pin, HIGH);
+
+  digitalWrite(_enable_pin, HIGH);
+  delayMicroseconds(1);    // data is valid 360ns after enable rises
+  bool busy = digitalRead(_data_pins[bits - 1]) == HIGH;
+  digitalWrite(_enable_pin, LOW);
+
+  // in 4 bit mode the low nibble has to be clocked out too
+  if (bits == 4) {
+    delayMicroseconds(1);
+    digitalWrite(_enable_pin, HIGH);
+    delayMicroseconds(1);
+    digitalWrite(_enable_pin, LOW);
+  }
+
+  digitalWrite(_rw_pin, LOW);
+  for (uint8_t i = 0; i < bits; i++) {
+    pinMode(_data_pins[i], OUTPUT);
+  }
+  return busy;
+}
+
 void LiquidCrystal::pulseEnable(void) {
   digitalWrite(_enable_pin, LOW);
   delayMicroseconds(1);    
   digitalWrite(_enable_pin, HIGH);
   delayMicroseconds(1);    // enable pulse must be >450ns
   digitalWrite(_enable_pin, LOW);
-  delayMicroseconds(100);   // commands need > 37us to settle
+  // commands need > 37us to settle, the queue times that rather than waiting
 }
 
 void LiquidCrystal::write4bits(uint8_t value) {
+#ifdef LCD_FAST_IO
+  if (_fast) {
+    _data.write(value);
+    pulseEnable();
+    return;
+  }
+#endif
   for (int i = 0; i < 4; i++) {
     digitalWrite(_data_pins[i], (value >> i) & 0x01);
   }
@@ -318,6 +404,13 @@ void LiquidCrystal::write4bits(uint8_t value) {
 }
 
 void LiquidCrystal::write8bits(uint8_t value) {
+#ifdef LCD_FAST_IO
+  if (_fast) {
+    _data.write(value);
+    pulseEnable();
+    return;
+  }
+#endif
   for (int i = 0; i < 8; i++) {
     digitalWrite(_data_pins[i], (value >> i) & 0x01);
   }
@@ -3,6 +3,14 @@
 
 #include <inttypes.h>
 #include "Print.h"
+#include <LCDQueue.h>
+
+// Write the data pins straight to the port registers rather than one
+// digitalWrite() each. Define LCD_PORTABLE_IO to go back to digitalWrite().
+#if defined(__AVR__) && !defined(LCD_PORTABLE_IO)
+#define LCD_FAST_IO
+#include <PinGroup.h>
+#endif
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -82,10 +90,23 @@ public:
   void setCursor(uint8_t, uint8_t); 
   virtual size_t write(uint8_t);
   void command(uint8_t);
+
+  // Bytes are queued rather than sent straight away. poll() sends whatever
+  // the controller is ready for without waiting, flush() waits until
+  // everything has gone.
+  void poll();
+  void flush();
+  uint8_t pending() const { return _queue.size(); }
+
+  // With an RW pin, read the busy flag rather than always allowing the worst
+  // case execution time, which is then only a timeout.
+  void useBusyFlag(bool on);
   
   using Print::write;
 private:
   void send(uint8_t, uint8_t);
+  void sendNow(uint8_t, uint8_t);
+  bool readBusyFlag();
   void write4bits(uint8_t);
   void write8bits(uint8_t);
   void pulseEnable();
@@ -103,6 +124,15 @@ private:
 
   uint8_t _numlines;
   uint8_t _row_offsets[4];
+
+  LCDQueue<32> _queue;
+  uint8_t _sync; // begin() sends everything straight away
+  uint8_t _busy_flag;
+
+#ifdef LCD_FAST_IO
+  PinGroup _data; // the data pins in use, set up in begin()
+  uint8_t _fast;  // 0 if they're on too many ports for _data
+#endif
 };
 
 #endif
@@ -0,0 +1,142 @@
+#include "Memory.h"
+
+#ifdef __AVR__
+// from avr-libc, the start of the heap and how far malloc has taken it
+extern uint8_t __heap_start;
+extern void* __brkval;
+#else
+namespace {
+
+// room left for paint()'s own frame, and what it calls, on the host
+const size_t host_margin {512};
+
+} // namespace
+#endif // __AVR__
+
+void Memory::clear() {
+  stats_ = {};
+  stack_low_ = nullptr;
+  stack_high_ = nullptr;
+  free_stack_ = 0;
+  min_free_stack_ = SIZE_MAX;
+#ifdef UNIT_TEST
+  fail_next_ = 0;
+#endif // UNIT_TEST
+}
+
+void Memory::allocated(size_t size) {
+  ++stats_.count;
+  stats_.bytes += size;
+  if (stats_.count > stats_.peak_count) {
+    stats_.peak_count = stats_.count;
+  }
+  if (stats_.bytes > stats_.peak_bytes) {
+    stats_.peak_bytes = stats_.bytes;
+  }
+}
+
+void Memory::released(size_t size) {
+  // allocated before the last clear()
+  if (stats_.count == 0 || stats_.bytes < size) {
+    return;
+  }
+  --stats_.count;
+  stats_.bytes -= size;
+}
+
+void Memory::failed() {
+  if (stats_.failed != UINT16_MAX) {
+    ++stats_.failed;
+  }
+}
+
+Memory::Stats Memory::stats() {
+  return stats_;
+}
+
+#ifdef UNIT_TEST
+void Memory::fail_next(uint16_t n) {
+  fail_next_ = n;
+}
+
+bool Memory::take_failure() {
+  if (fail_next_ == 0) {
+    return false;
+  }
+  --fail_next_;
+  return true;
+}
+#endif // UNIT_TEST
+
+uint8_t* Memory::stack_bottom_() {
+#ifdef __AVR__
+  uint8_t* heap_top = (__brkval != nullptr) ? (uint8_t*)__brkval
+                                            : &__heap_start;
+  return (heap_top > stack_low_) ? heap_top : stack_low_;
+#else
+  return stack_low_;
+#endif // __AVR__
+}
+
+// not inlined, so the frame it paints below is its own
+__attribute__((noinline)) void Memory::paint() {
+#ifdef __AVR__
+  stack_low_ = (__brkval != nullptr) ? (uint8_t*)__brkval : &__heap_start;
+  stack_high_ = (uint8_t*)SP;
+#else
+  stack_high_ = (uint8_t*)__builtin_frame_address(0) - host_margin;
+  stack_low_ = stack_high_ - host_stack;
+#endif // __AVR__
+
+  // volatile, as nothing reads it back that the compiler can see
+  for (volatile uint8_t* p = stack_low_; p < stack_high_; ++p) {
+    *p = paint_byte;
+  }
+  free_stack_ = stack_high_ - stack_low_;
+  min_free_stack_ = free_stack_;
+}
+
+size_t Memory::measure() {
+  if (stack_low_ == nullptr) {
+    return 0;
+  }
+
+  const volatile uint8_t* p = stack_bottom_();
+  while (p < stack_high_ && *p == paint_byte) {
+    ++p;
+  }
+  free_stack_ = (size_t)(p - stack_bottom_());
+  if (free_stack_ < min_free_stack_) {
+    min_free_stack_ = free_stack_;
+  }
+  return free_stack_;
+}
+
+size_t Memory::free_stack() {
+  return free_stack_;
+}
+
+size_t Memory::min_free_stack() {
+  return (stack_low_ == nullptr) ? 0 : min_free_stack_;
+}
+
+#ifndef UNIT_TEST
+void Memory::report(Print& out) {
+  measure();
+
+  out.print("memory n=");
+  out.print(stats_.count);
+  out.print(" bytes=");
+  out.print((unsigned long)stats_.bytes);
+  out.print(" peak_n=");
+  out.print(stats_.peak_count);
+  out.print(" peak=");
+  out.print((unsigned long)stats_.peak_bytes);
+  out.print(" failed=");
+  out.print(stats_.failed);
+  out.print(" stack=");
+  out.print((unsigned long)free_stack_);
+  out.print(" min=");
+  out.println((unsigned long)min_free_stack());
+}
+#endif // UNIT_TEST
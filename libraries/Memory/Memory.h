@@ -0,0 +1,146 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_MEMORY_MEMORY_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_MEMORY_MEMORY_H_
+
+#include <ArduinoInterface.h>
+#include <stddef.h>
+#ifndef UNIT_TEST
+#include <Print.h>
+#endif // UNIT_TEST
+
+/*
+ * Memory - how much of the heap and the stack the firmware uses
+ *
+ * Heap: the firmware allocates with new (Memory::heap) and frees with
+ * heap_delete(), see new.cc, which counts the live allocations and bytes,
+ * the most there have been, and allocations malloc couldn't give. Only what's
+ * allocated that way is counted, so on the simulator whatever the harness
+ * allocates on the same thread doesn't get mixed in.
+ *
+ * Stack: paint() fills the free space between the heap and the stack with
+ * paint_byte, once, at start up. The stack writes over it as it grows down
+ * and nothing puts it back, so the paint measure() finds left is the least
+ * free stack there's been. The heap growing up into it counts too, so
+ * measure() needs running now and again rather than only at the end.
+ *
+ * On the AVR the free space runs from the top of the heap to the stack
+ * pointer. On the host it's a window of host_stack bytes below where paint()
+ * was called, and the frames are x86's, so the numbers are only good for
+ * seeing a change.
+ *
+ * The heap counters are a few bytes, so are always there. Painting and
+ * measuring the stack are for builds with MEMORY_STATS defined.
+ */
+class Memory {
+ public:
+  // picks the counted operator new, see new.cc
+  struct Heap {};
+  static constexpr Heap heap {};
+
+  static constexpr uint8_t paint_byte {0xc5};
+  static constexpr size_t host_stack {16384};
+
+  struct Stats {
+    uint16_t count;        // live allocations
+    size_t bytes;          // live bytes, as asked for
+    uint16_t peak_count;
+    size_t peak_bytes;
+    uint16_t failed;       // malloc gave nullptr
+  };
+
+ private:
+  inline static INSTANCE_LOCAL Stats stats_ {};
+  inline static INSTANCE_LOCAL uint8_t* stack_low_ {nullptr};
+  inline static INSTANCE_LOCAL uint8_t* stack_high_ {nullptr};
+  inline static INSTANCE_LOCAL size_t free_stack_ {0};
+  inline static INSTANCE_LOCAL size_t min_free_stack_ {SIZE_MAX};
+#ifdef UNIT_TEST
+  inline static uint16_t fail_next_ {0};
+#endif // UNIT_TEST
+
+  // where the free space starts now, the heap may have grown into it
+  static uint8_t* stack_bottom_();
+
+ public:
+  Memory() = delete;
+
+  /*
+   * Clear
+   *
+   * Forget the counts and the paint. Anything still allocated from before
+   * isn't counted again when it's freed.
+   */
+  static void clear();
+
+  // from new.cc, as allocations come and go
+  static void allocated(size_t size);
+  static void released(size_t size);
+  static void failed();
+
+  static Stats stats();
+
+#ifdef UNIT_TEST
+  /*
+   * Fail Next
+   *
+   * The next n allocations give nullptr, as if malloc had, for testing what
+   * the firmware does when the heap is full. clear() cancels it.
+   */
+  static void fail_next(uint16_t n);
+
+  // from new.cc, true if this allocation is one of them
+  static bool take_failure();
+#endif // UNIT_TEST
+
+  /*
+   * Paint
+   *
+   * Fill the free stack with paint_byte. Call it as near the top of the
+   * stack as there is, setup() say.
+   */
+  static void paint();
+
+  /*
+   * Measure
+   *
+   * Count the paint left between the heap and the stack, and keep the least.
+   * Run with interrupts on, the scan is a byte at a time.
+   *
+   * Returns:
+   * size_t - free stack in bytes, or 0 if it hasn't been painted
+   */
+  static size_t measure();
+
+  // what measure() last found, and the least it's found
+  static size_t free_stack();
+  static size_t min_free_stack();
+
+#ifndef UNIT_TEST
+  /*
+   * Report
+   *
+   * Measure, and write the heap and stack figures to out as a line of text:
+   *
+   *    memory n=3 bytes=84 peak_n=4 peak=112 failed=0 stack=1203 min=1187
+   */
+  static void report(Print& out);
+#endif // UNIT_TEST
+};
+
+// a counted allocation, nullptr if there isn't the memory
+void* operator new(size_t size, Memory::Heap) noexcept;
+void operator delete(void* ptr, Memory::Heap) noexcept;
+
+/*
+ * Heap Delete
+ *
+ * delete, for what new (Memory::heap) allocated.
+ */
+template<typename T>
+void heap_delete(T* ptr) {
+  if (ptr != nullptr) {
+    ptr->~T();
+    operator delete(ptr, Memory::heap);
+  }
+}
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_MEMORY_MEMORY_H_
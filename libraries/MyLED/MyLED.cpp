@@ -3,6 +3,110 @@
 //
 
 #include <MyLED.h>
+#include <Profiler.h>
+
+namespace {
+
+/*
+ * Breath Table
+ *
+ * 256 steps of the pulse waveform, worked out by the compiler. The maths
+ * library isn't constexpr, so cos() and pow() are done with series here.
+ */
+constexpr double pi {3.14159265358979};
+constexpr double ln2 {0.69314718055995};
+constexpr double gamma_exponent {2.2};
+
+// x from -pi to pi
+constexpr double cos_series(double x) {
+  double term = 1, sum = 1;
+  for (int n = 1; n < 16; ++n) {
+    term *= -x * x / ((2 * n - 1) * (2 * n));
+    sum += term;
+  }
+  return sum;
+}
+
+// x above 0. Scaled into [0.5, 1) by powers of two first, where the
+// series for 2 atanh((x - 1) / (x + 1)) is quick
+constexpr double log_series(double x) {
+  int k = 0;
+  while (x < 0.5) {
+    x *= 2;
+    --k;
+  }
+  double z = (x - 1) / (x + 1), term = z, sum = 0;
+  for (int n = 1; n < 40; n += 2) {
+    sum += term / n;
+    term *= z * z;
+  }
+  return 2 * sum + k * ln2;
+}
+
+// x at or below 0. Halved until small, then squared back up
+constexpr double exp_series(double x) {
+  int halvings = 0;
+  while (x < -0.5) {
+    x /= 2;
+    ++halvings;
+  }
+  double term = 1, sum = 1;
+  for (int n = 1; n < 16; ++n) {
+    term *= x / n;
+    sum += term;
+  }
+  for (; halvings > 0; --halvings) {
+    sum *= sum;
+  }
+  return sum;
+}
+
+struct BreathTable {
+  uint8_t duty[256];
+
+  // raised cosine, 0 at the ends and 1 half way, to the power gamma
+  constexpr BreathTable() : duty{} {
+    for (int i = 0; i < 256; ++i) {
+      double x = 2 * pi * i / 256;
+      double level = (1 - cos_series((i < 128) ? x : x - 2 * pi)) / 2;
+      double corrected =
+          (level > 0) ? exp_series(gamma_exponent * log_series(level)) : 0;
+      duty[i] = (uint8_t)(corrected * UINT8_MAX + 0.5);
+    }
+  }
+};
+
+constexpr BreathTable breath_table PROGMEM {};
+
+static_assert(breath_table.duty[0] == 0, "breath starts dark");
+static_assert(breath_table.duty[128] == UINT8_MAX, "breath peaks half way");
+
+// blend of a and b, mix 0 being all a and 255 all b
+inline uint8_t blend(uint8_t a, uint8_t b, uint8_t mix) {
+  return MyLED::scale(a, UINT8_MAX - mix) + MyLED::scale(b, mix);
+}
+
+/*
+ * Palette
+ *
+ * RGB of each LEDColour, in the same order. Duties rather than how bright
+ * they look, so orange is mostly red.
+ */
+constexpr RGB palette[] PROGMEM {
+    {UINT8_MAX, 0, 0},          // RED
+    {UINT8_MAX, 48, 0},         // ORANGE
+    {UINT8_MAX, UINT8_MAX, 0},  // YELLOW
+    {96, UINT8_MAX, 0},         // LIME
+    {0, UINT8_MAX, 0},          // GREEN
+    {0, 0, UINT8_MAX},          // BLUE
+    {UINT8_MAX, UINT8_MAX, UINT8_MAX},  // WHITE
+};
+
+static_assert(sizeof(palette) / sizeof(palette[0])
+                  == (uint8_t)LEDColour::WHITE + 1,
+              "palette needs one entry per LEDColour");
+
+} // namespace
 
 MyLED::MyLED(uint8_t red_pin, uint8_t green_pin, uint8_t blue_pin) :
         red_pin_{red_pin}, green_pin_{green_pin}, blue_pin_{blue_pin} {
@@ -15,76 +119,112 @@ MyLED::MyLED(uint8_t red_pin, uint8_t green_pin, uint8_t blue_pin) :
   AI::pinMode(blue_pin_, OUTPUT);
 };
 
-void MyLED::set_colour(LEDColour led_colour) {
+RGB MyLED::colour(LEDColour led_colour) {
+  RGB rgb;
+  memcpy_P(&rgb, &palette[(uint8_t)led_colour], sizeof(rgb));
+  return rgb;
+}
 
-  using AI = ArduinoInterface;
+void MyLED::set_colour(LEDColour led_colour, uint16_t fade) {
+  set_colour(colour(led_colour), fade);
+}
+
+void MyLED::set_colour(RGB colour, uint16_t fade) {
+  RGB target {scale(colour.red, balance_.red),
+              scale(colour.green, balance_.green),
+              scale(colour.blue, balance_.blue)};
 
   // only do this if colour is changing
-  if (led_colour_ != led_colour) {
-    led_colour_ = led_colour; // save colour
-    brightness_ = UINT8_MAX; // set brightness to max
-
-    // Red
-    if (led_colour == LEDColour::RED) {
-      AI::digitalWrite(red_pin_, HIGH);
-      AI::digitalWrite(green_pin_, LOW);
-
-      // Yellow
-    } else if (led_colour == LEDColour::YELLOW) {
-      AI::digitalWrite(red_pin_, HIGH);
-      AI::digitalWrite(green_pin_, HIGH);
-
-      // Green
-    } else if (led_colour == LEDColour::GREEN) {
-      AI::digitalWrite(red_pin_, LOW);
-      AI::digitalWrite(green_pin_, HIGH);
-    }
+  if (target == to_) {
+    return;
   }
-}
 
-void MyLED::pulse() {
+  noInterrupts();
+  from_ = now_; // from wherever a fade in progress has got to
+  to_ = target;
+  if (fade == 0) {
+    now_ = to_;
+  }
 
-  using AI = ArduinoInterface;
+  fade_step_ = step_for(2 * (uint32_t)fade); // peak is half a period
+  fade_ = (fade != 0) ? 0 : peak;
+  phase_ = peak; // start the effect from full brightness
+  write_();
+  interrupts();
+}
 
-  // if we are at min or max brightness...
-  if (brightness_ == 0 || brightness_ == 255) {
-    increment_ *= -1; // reverse the sign of the increment
-  }
+void MyLED::set_effect(LEDEffect effect, uint16_t period) {
+  noInterrupts();
+  effect_ = effect;
+  step_ = step_for(period);
+  phase_ = peak;
+  write_();
+  interrupts();
+}
 
-  // TODO: Change this to use CPU status flags to check overflow
-  // make sure we don't over/underflow
-  // ref: Understanding Integer Overflow in C/C++; Stallings
-  // Avoid mixing signed and unsigned §10.5.3 Stroustrup, so cast to uint8_t
-  // if we are decrementing brightness
-  if (increment_ < 0) {
-    auto pos_inc = (uint8_t)abs(increment_); // increment in positive form
+void MyLED::start() {
+  active_ = this;
+  ArduinoInterface::timer_tick(isr_);
+}
 
-    // if brightness is greater than or equal to increment, subtract increment.
-    // Otherwise subtract brightness (i.e. make it 0)
-    brightness_ -= (brightness_ >= pos_inc) ? pos_inc : brightness_;
+void MyLED::isr_() {
+  PROFILE_ISR_SCOPE("led_tick");
+  active_->tick();
+}
 
+uint8_t MyLED::breath(uint32_t phase) {
+  return pgm_read_byte(&breath_table.duty[phase >> 24]);
+}
 
-  } else { // increasing brightness
+uint32_t MyLED::step_for(uint32_t ms) {
+  if (ms == 0) {
+    return 0;
+  }
+  // a period is 2^32 of phase, near enough
+  uint32_t per_ms = UINT32_MAX / ms;
+  const uint16_t tick_us = ArduinoInterface::tick_us;
+  return per_ms / 1000 * tick_us + per_ms % 1000 * tick_us / 1000;
+}
 
-    // difference between maximum and current brightness
-    uint8_t difference = UINT8_MAX - brightness_;
+void MyLED::tick() {
+  phase_ += step_;
 
-    // If different is bigger than the increment, add the increment.
-    // Otherwise add the difference.
-    brightness_ += (difference >= increment_) ? increment_ : difference;
+  if (fade_ != peak) {
+    fade_ = (peak - fade_ > fade_step_) ? fade_ + fade_step_ : peak;
 
+    uint8_t mix = breath(fade_);
+    now_ = {blend(from_.red, to_.red, mix),
+            blend(from_.green, to_.green, mix),
+            blend(from_.blue, to_.blue, mix)};
   }
 
-  // This is the most likely path
-  if (led_colour_ == LEDColour::GREEN) {
-    AI::analogueWrite(green_pin_, brightness_);
+  write_();
+}
+
+void MyLED::write_() {
 
-    // second most likely
-  } else if (led_colour_ == LEDColour::RED) {
-    AI::analogueWrite(red_pin_, brightness_);
+  using AI = ArduinoInterface;
 
-  } else { // Yellow, currently unused but here for completeness
-    AI::analogueWrite(red_pin_, brightness_);
-    AI::analogueWrite(green_pin_, brightness_);
+  RGB duty = now_;
+  if (effect_ == LEDEffect::PULSE) {
+    uint8_t level = breath(phase_);
+    duty = {scale(now_.red, level), scale(now_.green, level),
+            scale(now_.blue, level)};
+  } else if (effect_ == LEDEffect::BLINK) {
+    // on for the half of the period around the peak
+    if (!((phase_ + peak / 2) & peak)) {
+      duty = {0, 0, 0};
+    }
+  }
+
+  if (duty.red != out_.red) {
+    AI::analogueWrite(red_pin_, duty.red);
+  }
+  if (duty.green != out_.green) {
+    AI::analogueWrite(green_pin_, duty.green);
+  }
+  if (duty.blue != out_.blue) {
+    AI::analogueWrite(blue_pin_, duty.blue);
   }
+  out_ = duty;
 }
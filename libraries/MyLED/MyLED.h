@@ -7,30 +7,92 @@
 
 #include <ArduinoInterface.h>
 
-enum class LEDColour { RED, YELLOW, GREEN };
+/*
+ * RGB
+ *
+ * PWM duty of each channel, 0 to 255.
+ */
+struct RGB {
+  uint8_t red;
+  uint8_t green;
+  uint8_t blue;
+};
+
+constexpr bool operator==(const RGB& a, const RGB& b) {
+  return a.red == b.red && a.green == b.green && a.blue == b.blue;
+}
+constexpr bool operator!=(const RGB& a, const RGB& b) {
+  return !(a == b);
+}
+
+/*
+ * LEDColour
+ *
+ * Named colours, from closest to furthest for the radar, then the rest. The
+ * RGB for each is in the palette in MyLED.cpp.
+ */
+enum class LEDColour : uint8_t {
+  RED, ORANGE, YELLOW, LIME, GREEN, BLUE, WHITE
+};
+
+/*
+ * LEDEffect
+ *
+ * STEADY - the colour at full brightness
+ * PULSE - breathing in and out once a period
+ * BLINK - on for half of each period and off for the other half
+ */
+enum class LEDEffect : uint8_t { STEADY, PULSE, BLINK };
 
 /*
  * MyLED - Simple RGB LED class.
  *
  * Initialise with the red, green, and blue pins used.
  *
- * Provides three methods - set_colour(), set_pulse(), and pulse().
+ * set_colour() changes colour, crossfading over a number of ms, and
+ * set_effect() picks an effect and its period. Neither needs calling again
+ * for the LED to keep changing: once start() has been called, tick() is run
+ * from a timer interrupt and does the rest.
  *
- * set_colour sets the current LED colour using an LEDColour enum class.
- * set_pulse set the LED pulse duration in ms.
- * pulse pulses
+ * Effects and fades are phase accumulators, 32 bit fractions of a period
+ * that tick() moves on by a fixed step. The top 8 bits of them look up a
+ * breath waveform in flash: a raised cosine, gamma corrected so it looks even
+ * rather than lingering at full brightness. The rising half of it is the
+ * crossfade curve too.
+ *
+ * A colour is scaled by the balance for each channel once, when it's set,
+ * and the result is kept. Ticks outside a fade only scale that by the
+ * effect's brightness and write the duties that changed, so every colour
+ * costs the same to pulse.
+ *
+ * Only one LED can be started, as the interrupt has nowhere to keep more.
  */
-//template<class T>
 class MyLED {
+ public:
+  static constexpr uint32_t peak {0x80000000};  // phase of full brightness
+
  private:
   uint8_t red_pin_{0};
   uint8_t green_pin_{0};
   uint8_t blue_pin_{0};
 
-  uint8_t brightness_{255};  // Used by pulse() to know current brightness
-  int8_t increment_{5};    // Pulse increment
+  RGB balance_{UINT8_MAX, UINT8_MAX, UINT8_MAX};
 
-  LEDColour led_colour_{LEDColour::GREEN};
+  // used by tick(). Setters change them with interrupts off.
+  LEDEffect effect_{LEDEffect::STEADY};
+  uint32_t phase_{peak};      // how far through the effect's period
+  uint32_t step_{0};          // phase per tick
+  uint32_t fade_{peak};       // how far through the fade, done at peak
+  uint32_t fade_step_{0};
+  RGB from_{0, 0, 0};                   // colour fading from, balanced
+  RGB to_{0, UINT8_MAX, 0};             // and to
+  RGB now_{0, UINT8_MAX, 0};            // where the fade has got to
+  RGB out_{0, 0, 0};                    // last written to the pins
+
+  inline static INSTANCE_LOCAL MyLED* active_ {nullptr};
+
+  static void isr_();
+  void write_();
 
  public:
 
@@ -39,13 +101,64 @@ class MyLED {
   // Arguments are red, green, and blue pins for LED
   MyLED(uint8_t red_pin, uint8_t green_pin, uint8_t blue_pin);
 
-  // set colour
-  void set_colour(LEDColour led_colour);
+  // Set colour, fading from the current one over fade ms
+  void set_colour(RGB colour, uint16_t fade = 0);
+  void set_colour(LEDColour led_colour, uint16_t fade = 0);
+
+  // Scale each channel of colours set from now on, to even out an LED whose
+  // colours aren't equally bright
+  inline void set_balance(RGB balance) { balance_ = balance; };
+
+  // Set effect. Period is ms from one peak of brightness to the next
+  void set_effect(LEDEffect effect, uint16_t period = 0);
+
+  // Run tick() from the timer interrupt
+  void start();
+
+  // Move effect and fade on by one timer tick, and update the pins
+  void tick();
+
+  // RGB of a named colour
+  static RGB colour(LEDColour led_colour);
+
+  // brightness of the waveform at phase, 0 to 255
+  static uint8_t breath(uint32_t phase);
+
+  // phase per tick for a period of ms
+  static uint32_t step_for(uint32_t ms);
+
+  // 0 to 255 of x, rounded so 255 of 255 is 255
+  static constexpr uint8_t scale(uint8_t x, uint8_t level) {
+    return (uint8_t)(((uint16_t)x * level + UINT8_MAX) >> 8);
+  }
 
-  // Set LED pulse. Increment is how much brightness should vary per pulse call;
-  inline void set_pulse(int8_t increment) { increment_ = increment; };
+  /*
+   * HSV
+   *
+   * uint8_t hue - round the colour wheel from red at 0, through green at 86
+   *               and blue at 172
+   * uint8_t saturation - 0 for white, 255 for the pure colour
+   * uint8_t value - brightness
+   *
+   * Returns:
+   * RGB - the same colour
+   */
+  static constexpr RGB hsv(uint8_t hue, uint8_t saturation, uint8_t value) {
+    uint8_t region = hue / 43;
+    uint8_t rem = (uint8_t)((hue - region * 43) * 6);
+    uint8_t p = scale(value, UINT8_MAX - saturation);
+    uint8_t q = scale(value, UINT8_MAX - scale(saturation, rem));
+    uint8_t t = scale(value, UINT8_MAX - scale(saturation, UINT8_MAX - rem));
 
-  void pulse();
+    switch (region) {
+      case 0: return {value, t, p};
+      case 1: return {q, value, p};
+      case 2: return {p, value, t};
+      case 3: return {p, q, value};
+      case 4: return {t, p, value};
+      default: return {value, p, q};
+    }
+  }
 };
 
 #endif //A_TOOLCHAIN_TEST_LIBRARIES_MYLED_MYLED_H_
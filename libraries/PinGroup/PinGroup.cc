@@ -0,0 +1,50 @@
+#include <PinGroup.h>
+
+bool PinGroup::init(const uint8_t pins[], uint8_t n) {
+  using AI = ArduinoInterface;
+
+  n_pins_ = 0;
+  n_ports_ = 0;
+  if (n > max_pins) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < n; ++i) {
+    volatile uint8_t* port = AI::port_output_register(pins[i]);
+
+    uint8_t p = 0;
+    while (p < n_ports_ && ports_[p] != port) {
+      ++p;
+    }
+    if (p == n_ports_) {
+      if (n_ports_ == max_ports) {
+        n_ports_ = 0;
+        return false;
+      }
+      ports_[p] = port;
+      mask_[p] = 0;
+      ++n_ports_;
+    }
+
+    port_of_[i] = p;
+    bit_[i] = AI::pin_bit_mask(pins[i]);
+    mask_[p] |= bit_[i];
+  }
+
+  n_pins_ = n;
+  return true;
+}
+
+void PinGroup::write(uint8_t value) const {
+  uint8_t bits[max_ports] {};
+
+  for (uint8_t i = 0; i < n_pins_; ++i, value >>= 1) {
+    if (value & 1) {
+      bits[port_of_[i]] |= bit_[i];
+    }
+  }
+
+  for (uint8_t p = 0; p < n_ports_; ++p) {
+    ArduinoInterface::write_port(ports_[p], mask_[p], bits[p]);
+  }
+}
@@ -0,0 +1,55 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_PINGROUP_PINGROUP_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_PINGROUP_PINGROUP_H_
+
+#include <ArduinoInterface.h>
+
+/*
+ * PinGroup - write up to 8 output pins at once, straight to the port registers
+ *
+ * digitalWrite() looks up the pin's port and bit from tables in flash and
+ * turns off PWM every time it is called. PinGroup looks them up once, in
+ * init(), and write() then sets every pin with one masked write per port the
+ * pins are on. Pins that share a port change together.
+ *
+ * Pins can be spread over up to max_ports ports, which is every port an Uno
+ * has. init() returns false if there are more.
+ *
+ * The pins must already be outputs.
+ */
+class PinGroup {
+ public:
+  static constexpr uint8_t max_pins {8};
+  static constexpr uint8_t max_ports {4};
+
+ private:
+  volatile uint8_t* ports_[max_ports] {};
+  uint8_t mask_[max_ports] {};      // every pin in the group on each port
+  uint8_t port_of_[max_pins] {};    // index into ports_ for each pin
+  uint8_t bit_[max_pins] {};        // each pin's bit on its port
+  uint8_t n_pins_ {0};
+  uint8_t n_ports_ {0};
+
+ public:
+  /*
+   * Init
+   *
+   * const uint8_t pins[] - Arduino pin numbers. Bit i of a value written goes
+   *                        to pins[i].
+   * uint8_t n - number of pins, up to max_pins
+   *
+   * Returns:
+   * bool - false if the pins are on too many ports, and nothing is written
+   */
+  bool init(const uint8_t pins[], uint8_t n);
+
+  /*
+   * Write
+   *
+   * uint8_t value - bit i goes to pin i. Bits past the last pin are ignored.
+   */
+  void write(uint8_t value) const;
+
+  inline uint8_t ports() const { return n_ports_; };
+};
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_PINGROUP_PINGROUP_H_
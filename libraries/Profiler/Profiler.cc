@@ -0,0 +1,162 @@
+#include <Profiler.h>
+
+void Profiler::clear() {
+  noInterrupts();
+  for (auto& slot : slots_) {
+    slot = {};
+  }
+  unplaced_ = 0;
+  since_ = ArduinoInterface::millis();
+  interrupts();
+}
+
+void Profiler::reset() {
+  noInterrupts();
+  for (auto& slot : slots_) {
+    slot = {slot.id, slot.name};
+  }
+  unplaced_ = 0;
+  since_ = ArduinoInterface::millis();
+  interrupts();
+}
+
+void Profiler::name(Id id, const char* name) {
+  noInterrupts();
+  Slot* slot = slot_(id, name);
+  if (slot != nullptr) {
+    slot->name = name;
+  }
+  interrupts();
+}
+
+uint16_t Profiler::elapsed(uint16_t start, uint16_t end) {
+  if (end >= start) {
+    return end - start;
+  }
+  // Servo set TCNT1 back to 0 in between
+  return (ArduinoInterface::frame_ticks - start) + end;
+}
+
+uint8_t Profiler::bucket(uint16_t ticks) {
+  uint8_t n = 0;
+  while (ticks > 1) {
+    ticks >>= 1;
+    ++n;
+  }
+  return n;
+}
+
+void Profiler::add(Id id, const char* name, uint16_t ticks) {
+  noInterrupts();
+  add_(id, name, ticks);
+  interrupts();
+}
+
+void Profiler::add_isr(Id id, const char* name, uint16_t ticks) {
+  add_(id, name, ticks);
+}
+
+const Profiler::Slot* Profiler::find(Id id) {
+  for (auto& slot : slots_) {
+    if (slot.id == id) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+uint16_t Profiler::unplaced() {
+  return unplaced_;
+}
+
+Profiler::Slot* Profiler::slot_(Id id, const char* name) {
+  // slots are taken in order, so the first empty one ends the search
+  for (auto& slot : slots_) {
+    if (slot.id == id) {
+      return &slot;
+    }
+    if (slot.id == nullptr) {
+      slot.id = id;
+      slot.name = name;
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void Profiler::add_(Id id, const char* name, uint16_t ticks) {
+  Slot* slot = slot_(id, name);
+  if (slot == nullptr) {
+    if (unplaced_ != UINT16_MAX) {
+      ++unplaced_;
+    }
+    return;
+  }
+
+  ++slot->calls;
+  slot->total += ticks;
+  if (ticks > slot->max) {
+    slot->max = ticks;
+  }
+
+  uint16_t& count = slot->counts[bucket(ticks)];
+  if (count == UINT16_MAX) {
+    for (auto& c : slot->counts) {
+      c >>= 1;
+    }
+  }
+  ++count;
+}
+
+#ifndef UNIT_TEST
+void Profiler::dump(Print& out) {
+  using AI = ArduinoInterface;
+
+  // the next window starts here, and each slot's as it's copied, so what's
+  // probed while the slow Serial output goes out is kept for the next dump
+  noInterrupts();
+  uint32_t now = AI::millis();
+  uint32_t window = now - since_;
+  uint16_t unplaced = unplaced_;
+  unplaced_ = 0;
+  since_ = now;
+  interrupts();
+
+  out.print("profile ");
+  out.print(window);
+  out.print(" ms ");
+  out.print((unsigned long)unplaced);
+  out.println(" unplaced");
+
+  for (uint8_t i = 0; i < slots; ++i) {
+    noInterrupts();
+    Slot slot = slots_[i];
+    slots_[i] = {slot.id, slot.name};
+    interrupts();
+    if (slot.id == nullptr) {
+      break;
+    }
+    if (slot.calls == 0) {
+      continue;
+    }
+
+    out.print(slot.name != nullptr ? slot.name : "?");
+    out.print(" n=");
+    out.print(slot.calls);
+    out.print(" total=");
+    out.print(slot.total / AI::ticks_per_us);
+    out.print(" max=");
+    out.print((unsigned long)(slot.max / AI::ticks_per_us));
+    for (uint8_t n = 0; n < buckets; ++n) {
+      if (slot.counts[n] != 0) {
+        // bucket n is under 2^(n+1) ticks
+        out.print(" <");
+        out.print(1UL << n);
+        out.print(':');
+        out.print((unsigned long)slot.counts[n]);
+      }
+    }
+    out.println();
+  }
+}
+#endif // UNIT_TEST
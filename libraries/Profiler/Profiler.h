@@ -0,0 +1,182 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_PROFILER_PROFILER_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_PROFILER_PROFILER_H_
+
+#include <ArduinoInterface.h>
+#ifndef UNIT_TEST
+#include <Print.h>
+#endif // UNIT_TEST
+
+/*
+ * Profiler - how long the hot paths take, as histograms
+ *
+ * Each probe times a stretch of code with ArduinoInterface::timer_ticks(),
+ * 0.5µs a tick, and adds it to the histogram kept for the probe's id. Bucket
+ * n counts the times of 2^n to 2^(n+1) - 1 ticks (bucket 0 takes 0 as well),
+ * so 16 buckets cover everything up to a Timer1 frame. Anything longer than
+ * a frame comes out short by whole frames.
+ *
+ * Commands are keyed by their function, and named with name() so the dump
+ * can say which is which. The other probes are keyed and named by a string.
+ * There's room for slots probes. Any more are counted in unplaced() and
+ * otherwise ignored.
+ *
+ * When a bucket fills up, every bucket of that probe is halved, so the shape
+ * stays right and calls keeps the real count.
+ *
+ * add() is for the main loop and turns interrupts off while it writes.
+ * add_isr() is for ISRs, which run with them off already.
+ *
+ * The slots take about 550 bytes of SRAM, so the probes are only compiled in
+ * with PROFILE defined, and cost nothing otherwise.
+ */
+class Profiler {
+ public:
+  using Id = const void*;
+
+  static constexpr uint8_t slots {12};
+  static constexpr uint8_t buckets {16};
+
+  struct Slot {
+    Id id;
+    const char* name;
+    uint32_t calls;
+    uint32_t total;     // ticks, wraps after 35 minutes
+    uint16_t max;       // ticks
+    uint16_t counts[buckets];
+  };
+
+ private:
+  inline static INSTANCE_LOCAL Slot slots_[slots] {};
+  inline static INSTANCE_LOCAL uint16_t unplaced_ {0};
+  inline static INSTANCE_LOCAL uint32_t since_ {0};
+
+  static Slot* slot_(Id id, const char* name);
+  static void add_(Id id, const char* name, uint16_t ticks);
+
+ public:
+  Profiler() = delete;
+
+  /*
+   * Clear
+   *
+   * Forget every probe, names and all.
+   */
+  static void clear();
+
+  /*
+   * Reset
+   *
+   * Empty every histogram but keep the probes and their names, to start a
+   * new window.
+   */
+  static void reset();
+
+  /*
+   * Name
+   *
+   * Give a probe a name for the dump, taking a slot for it if it hasn't one.
+   *
+   * const char* name - must outlive the profiler, a literal is best
+   */
+  static void name(Id id, const char* name);
+
+  /*
+   * Elapsed
+   *
+   * Ticks from start to end, allowing for Timer1 starting its frame again in
+   * between.
+   */
+  static uint16_t elapsed(uint16_t start, uint16_t end);
+
+  // which bucket a time of ticks goes in
+  static uint8_t bucket(uint16_t ticks);
+
+  /*
+   * Add
+   *
+   * Count a time against a probe, from the main loop.
+   *
+   * Id id - the probe
+   * const char* name - its name if it's new, or nullptr
+   * uint16_t ticks - how long it took
+   */
+  static void add(Id id, const char* name, uint16_t ticks);
+
+  /*
+   * Add ISR
+   *
+   * Count a time from an ISR, with interrupts already off.
+   */
+  static void add_isr(Id id, const char* name, uint16_t ticks);
+
+  // the probe's slot, or nullptr if it hasn't got one
+  static const Slot* find(Id id);
+
+  // times that didn't get counted because every slot was taken
+  static uint16_t unplaced();
+
+#ifndef UNIT_TEST
+  /*
+   * Dump
+   *
+   * Write each probe that has run as a line of text to out, its name, calls,
+   * total and longest time in µs, and the buckets with anything in, each as
+   * the time in µs it's under and its count:
+   *
+   *    profile 10000 ms 0 unplaced
+   *    move n=400 total=2150 max=9 <4:12 <8:388
+   *
+   * Each slot is emptied for the next window as it's copied, so anything
+   * probed while the dump is written out, from an ISR say, is in the next
+   * one. Interrupts are only off while each slot is copied and emptied, not
+   * while it's written out.
+   */
+  static void dump(Print& out);
+#endif // UNIT_TEST
+
+  /*
+   * Scope
+   *
+   * Times from when it's made to when it goes out of scope, for the main
+   * loop.
+   */
+  class Scope {
+    Id id_;
+    const char* name_;
+    uint16_t start_;
+
+   public:
+    Scope(Id id, const char* name)
+        : id_{id}, name_{name}, start_{ArduinoInterface::timer_ticks()} {}
+    ~Scope() {
+      add(id_, name_, elapsed(start_, ArduinoInterface::timer_ticks()));
+    }
+  };
+
+  // Scope, for ISRs
+  class IsrScope {
+    Id id_;
+    const char* name_;
+    uint16_t start_;
+
+   public:
+    IsrScope(Id id, const char* name)
+        : id_{id}, name_{name}, start_{ArduinoInterface::timer_ticks()} {}
+    ~IsrScope() {
+      add_isr(id_, name_, elapsed(start_, ArduinoInterface::timer_ticks()));
+    }
+  };
+};
+
+#ifdef PROFILE
+#define PROFILE_SCOPE(name) Profiler::Scope profile_scope_ {name, name}
+#define PROFILE_ISR_SCOPE(name) Profiler::IsrScope profile_scope_ {name, name}
+#define PROFILE_COMMAND(function) \
+  Profiler::Scope profile_scope_ {(Profiler::Id)(function), nullptr}
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_ISR_SCOPE(name)
+#define PROFILE_COMMAND(function)
+#endif // PROFILE
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_PROFILER_PROFILER_H_
@@ -5,9 +5,9 @@
 
 namespace EchoISR {
 
-volatile uint32_t pulse_start_  {0};
-volatile uint32_t pulse_end_    {0};
-uint8_t echo_pin_               {0};  // echo pin for sensor
+INSTANCE_LOCAL volatile uint32_t pulse_start_  {0};
+INSTANCE_LOCAL volatile uint32_t pulse_end_    {0};
+INSTANCE_LOCAL uint8_t echo_pin_               {0};  // echo pin for sensor
 
 void echo_isr() {
   using AI = ArduinoInterface;
@@ -15,9 +15,21 @@ void echo_isr() {
   // if the pin is set high
   if (AI::digitalRead(echo_pin_) == HIGH) {
   pulse_start_ = AI::micros(); // get the start time
+  TRACE_ISR(Trace::Kind::ECHO, HIGH, pulse_start_);
   } else {
   pulse_end_ = AI::micros(); // else get the end time
+  TRACE_ISR(Trace::Kind::ECHO, LOW, pulse_end_);
   }
 }
 
-} // namespace EchoISR
\ No newline at end of file
+} // namespace EchoISR
+
+namespace TriggerISR {
+
+INSTANCE_LOCAL uint8_t trigger_pin_ {0}; // trigger pin for sensor
+
+void trigger_isr() {
+  ArduinoInterface::digitalWrite(trigger_pin_, LOW);
+}
+
+} // namespace TriggerISR
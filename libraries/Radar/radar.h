@@ -11,15 +11,17 @@
 #endif // UNIT_TEST
 
 #include <ArduinoInterface.h>
+#include <Memory.h>
+#include <TraceRecorder.h>
 
 #define SPEED_OF_SOUND 0.343 // speed of sound in mm/µs
 
 // These globals are needed for the ping echo ISR
 namespace EchoISR {
-extern volatile uint32_t pulse_start_ ;
-extern volatile uint32_t pulse_end_;
+extern INSTANCE_LOCAL volatile uint32_t pulse_start_ ;
+extern INSTANCE_LOCAL volatile uint32_t pulse_end_;
 extern volatile bool i_flag;
-extern uint8_t echo_pin_;  // echo pin for sensor
+extern INSTANCE_LOCAL uint8_t echo_pin_;  // echo pin for sensor
 
 /*
  * Echo ISR
@@ -32,6 +34,23 @@ void echo_isr();
 
 } // namespace EchoISR
 
+// The trigger pulse is ended from a timer interrupt, so needs a global too
+namespace TriggerISR {
+extern INSTANCE_LOCAL uint8_t trigger_pin_;  // trigger pin for sensor
+
+// how long the trigger is held high. The HC-SR04 needs at least 10µs.
+const uint16_t trigger_us {10};
+
+/*
+ * Trigger ISR
+ *
+ * Called by the one shot timer armed in Radar::ping() to end the trigger
+ * pulse.
+ */
+void trigger_isr();
+
+} // namespace TriggerISR
+
 /*
  * Radar - encapsulates servo motor and distance sensor.
  * This class does two things - move the servo motor and provide distance
@@ -54,7 +73,6 @@ class Radar
                                       // to be going left or right
   uint8_t servo_angle_ {90};          // Angle of servo in range 0 <= angle <= 180
   ServoInterface* servo_;             // servo object - either concrete or mock
-  uint8_t trigger_pin_ {0};           // trigger pin for sensor
 
   inline void attach_echo_isr_();
 
@@ -65,7 +83,7 @@ class Radar
    */
   Radar() {
     //using AI = ArduinoInterface;
-    auto servo = new ServoInterface;
+    auto servo = new (Memory::heap) ServoInterface;
     servo_ = servo;
   };
 
@@ -97,6 +115,10 @@ class Radar
  *
  * Each call will return the range measurement (if any) from the prior call.
  * The alternative would be just block for 500ms while we wait for a pulse.
+ *
+ * The trigger pulse doesn't block either. The trigger is set high and a one
+ * shot timer is armed to set it low again trigger_us later, so this returns
+ * straight away.
  */
 template<class ServoInterface>
 uint32_t Radar<ServoInterface>::ping() {
@@ -123,14 +145,10 @@ uint32_t Radar<ServoInterface>::ping() {
   }
   interrupts(); // and turn them back on
 
-  // make sure trigger is off...
-  AI::digitalWrite(trigger_pin_, LOW);
-  AI::delayMicroseconds(2); // wait 2µs
-
-  // Send trigger pulse
-  AI::digitalWrite(trigger_pin_, HIGH);
-  AI::delayMicroseconds(10); // wait 10µs
-  AI::digitalWrite(trigger_pin_, LOW);
+  // Send trigger pulse. The trigger was left low by the last trigger_isr(), or
+  // by init().
+  AI::digitalWrite(TriggerISR::trigger_pin_, HIGH);
+  AI::one_shot(TriggerISR::trigger_us, TriggerISR::trigger_isr);
 
   return distance;
 }
@@ -162,6 +180,7 @@ uint8_t Radar<ServoInterface>::move()  {
 
   servo_angle_ += direction_;
   servo_->write(servo_angle_);
+  TRACE(Trace::Kind::SERVO, servo_angle_);
 
   return servo_angle_;
 }
@@ -182,17 +201,23 @@ void Radar<ServoInterface>::init(uint8_t trigger_pin,
 
   using AI = ArduinoInterface;
 
-  trigger_pin_ = trigger_pin; // save trigger and echo for ultrasonic sensor
+  // save trigger and echo for ultrasonic sensor
+  TriggerISR::trigger_pin_ = trigger_pin;
   EchoISR::echo_pin_ = echo_pin;
+  // nothing left over from an earlier run, if the globals outlived it
+  EchoISR::pulse_start_ = 0;
+  EchoISR::pulse_end_ = 0;
 
-  AI::pinMode(trigger_pin_, OUTPUT); // set the pin modes for sensor
+  AI::pinMode(TriggerISR::trigger_pin_, OUTPUT); // set the pin modes for sensor
   AI::pinMode(EchoISR::echo_pin_, INPUT);
+  AI::digitalWrite(TriggerISR::trigger_pin_, LOW); // make sure trigger is off
 
   attach_echo_isr_();
 
   servo_->attach(servo_pin); // attach servo
 
   servo_->write(servo_angle_); // set servo initial position
+  TRACE(Trace::Kind::SERVO, servo_angle_);
 };
 
 #endif
\ No newline at end of file
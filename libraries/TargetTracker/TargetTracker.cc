@@ -0,0 +1,149 @@
+#include <TargetTracker.h>
+
+/*
+ * Add Sample - feed one radar reading into the tracker
+ *
+ * If the sample continues the current cluster, the cluster's target is grown
+ * in place. Otherwise a new cluster is opened in whichever slot find_slot_()
+ * picks. Either way, the work done is bounded by max_targets.
+ */
+void TargetTracker::add_sample(uint8_t angle, uint32_t range, uint32_t now) {
+
+  expire_(now);
+
+  // nothing in range ends whatever cluster we were growing
+  if (range > max_range_) {
+    open_slot_ = UINT8_MAX;
+    return;
+  }
+
+  // Avoid mixing signed and unsigned §10.5.3 Stroustrup
+  int16_t angle_diff = (int16_t)angle - (int16_t)last_angle_;
+  uint32_t range_diff = (range > open_range_) ? range - open_range_
+                                              : open_range_ - range;
+
+  if (open_slot_ != UINT8_MAX
+      && angle_diff <= angle_gap_ && angle_diff >= -angle_gap_
+      && range_diff <= range_gate_) {
+
+    // same object, so grow it
+    Target& target = targets_[open_slot_];
+    target.bearing_min = (angle < target.bearing_min) ? angle
+                                                      : target.bearing_min;
+    target.bearing_max = (angle > target.bearing_max) ? angle
+                                                      : target.bearing_max;
+    target.range = (range < target.range) ? range : target.range;
+    target.last_seen = now;
+
+  } else {
+    // new cluster. If it's something we've seen before, it replaces what we
+    // knew about it, as this sweep is more recent.
+    open_slot_ = find_slot_(angle, range);
+
+    Target& target = targets_[open_slot_];
+    target.bearing_min = angle;
+    target.bearing_max = angle;
+    target.range = range;
+    target.last_seen = now;
+  }
+
+  last_angle_ = angle;
+  open_range_ = range;
+}
+
+/*
+ * Find Slot
+ *
+ * Returns the slot of a known target that a sample at angle and range lines
+ * up with. If there isn't one, returns an empty slot, and if there are no
+ * empty slots returns the slot of the target seen least recently.
+ */
+uint8_t TargetTracker::find_slot_(uint8_t angle, uint32_t range) const {
+
+  uint8_t empty = UINT8_MAX;
+  uint8_t stalest = 0;
+
+  for (uint8_t i = 0; i < max_targets; ++i) {
+    const Target& target = targets_[i];
+
+    if (empty_(i)) {
+      empty = (empty == UINT8_MAX) ? i : empty;
+      continue;
+    }
+
+    uint32_t range_diff = (range > target.range) ? range - target.range
+                                                 : target.range - range;
+
+    // does the angle fall inside the target's span, give or take a gap?
+    if (angle + angle_gap_ >= target.bearing_min
+        && angle <= target.bearing_max + angle_gap_
+        && range_diff <= range_gate_) {
+      return i;
+    }
+
+    if (target.last_seen < targets_[stalest].last_seen) {
+      stalest = i;
+    }
+  }
+
+  return (empty != UINT8_MAX) ? empty : stalest;
+}
+
+/*
+ * Expire
+ *
+ * Empty every slot that hasn't been seen for expiry_ms. Unsigned subtraction
+ * keeps this correct when millis() rolls over.
+ */
+void TargetTracker::expire_(uint32_t now) {
+  for (uint8_t i = 0; i < max_targets; ++i) {
+    if (!empty_(i) && now - targets_[i].last_seen >= expiry_ms_) {
+      targets_[i] = Target();
+
+      if (open_slot_ == i) {
+        open_slot_ = UINT8_MAX;
+      }
+    }
+  }
+}
+
+/*
+ * Nearest
+ *
+ * Selection sort over the slots. There are only max_targets of them, so this
+ * is cheap and needs no scratch space beyond a bitmask of slots already taken.
+ */
+uint8_t TargetTracker::nearest(Target out[], uint8_t n) const {
+
+  uint8_t taken = 0;  // bit i is set once slot i has been copied to out
+  uint8_t count = 0;
+
+  while (count < n) {
+    uint8_t best = UINT8_MAX;
+
+    for (uint8_t i = 0; i < max_targets; ++i) {
+      if (empty_(i) || (taken & (1u << i))) {
+        continue;
+      }
+      if (best == UINT8_MAX || targets_[i].range < targets_[best].range) {
+        best = i;
+      }
+    }
+
+    if (best == UINT8_MAX) {
+      break; // no more targets
+    }
+
+    taken |= (1u << best);
+    out[count++] = targets_[best];
+  }
+
+  return count;
+}
+
+void TargetTracker::clear() {
+  for (auto& target : targets_) {
+    target = Target();
+  }
+  open_slot_ = UINT8_MAX;
+}
@@ -0,0 +1,106 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_TARGETTRACKER_TARGETTRACKER_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_TARGETTRACKER_TARGETTRACKER_H_
+
+#ifdef UNIT_TEST
+#include <cstdint>
+#else
+#include <ArduinoInterface.h>
+#endif // UNIT_TEST
+
+/*
+ * Target - one object seen by the radar
+ *
+ * bearing_min and bearing_max give the span of servo angles the object was
+ * seen across, range is the nearest distance measured within that span and
+ * last_seen is the millis() time of the most recent echo from it.
+ */
+struct Target {
+  uint8_t   bearing_min {0};
+  uint8_t   bearing_max {0};
+  uint32_t  range {UINT32_MAX};
+  uint32_t  last_seen {0};
+};
+
+/*
+ * TargetTracker - cluster (angle, range) samples into targets
+ *
+ * Samples are fed in the order the radar takes them. Consecutive samples that
+ * are close in both angle and range are treated as echoes from the same
+ * object and grow one cluster. Anything else closes the cluster and starts a
+ * new one.
+ *
+ * Every cluster lives in one of a fixed number of target slots, so memory is
+ * bounded and the cost of a sample does not depend on how many samples have
+ * been seen before it. A new cluster that lines up with a target we already
+ * know about reuses that target's slot, otherwise it takes an empty slot or
+ * evicts the stalest target. Targets not seen for expiry_ms are dropped.
+ */
+class TargetTracker {
+ public:
+  static constexpr uint8_t max_targets {6};
+  static_assert(max_targets <= 8,
+                "nearest() keeps a bit per slot in a uint8_t");
+
+ private:
+  Target    targets_[max_targets];
+  uint8_t   open_slot_ {UINT8_MAX};   // slot of the cluster being grown
+  uint8_t   last_angle_ {0};          // angle of the last sample added
+  uint32_t  open_range_ {0};          // range of the last sample added
+
+  uint8_t   angle_gap_;   // max degrees between samples of one cluster
+  uint32_t  range_gate_;  // max mm between samples of one cluster
+  uint32_t  max_range_;   // samples further than this are ignored
+  uint32_t  expiry_ms_;   // targets unseen for this long are dropped
+
+  uint8_t   find_slot_(uint8_t angle, uint32_t range) const;
+  void      expire_(uint32_t now);
+
+  inline bool empty_(uint8_t slot) const {
+    return targets_[slot].range == UINT32_MAX;
+  };
+
+ public:
+  /*
+   * Constructor
+   *
+   * uint8_t angle_gap - maximum angle in degrees between two samples of the
+   *                     same object. The radar pings every ~22° or so, so this
+   *                     must be larger than that.
+   * uint32_t range_gate - maximum difference in mm between two samples of the
+   *                       same object
+   * uint32_t max_range - samples beyond this range in mm are ignored
+   * uint32_t expiry_ms - how long a target is kept without being seen again
+   */
+  explicit TargetTracker(uint8_t angle_gap = 30, uint32_t range_gate = 150,
+                         uint32_t max_range = 4000, uint32_t expiry_ms = 10000)
+      : angle_gap_{angle_gap}, range_gate_{range_gate}, max_range_{max_range},
+        expiry_ms_{expiry_ms} {};
+
+  /*
+   * Add Sample
+   *
+   * uint8_t angle - servo angle the sample was taken at
+   * uint32_t range - distance in mm. UINT32_MAX means nothing was in range.
+   * uint32_t now - time of the sample as returned by millis()
+   */
+  void add_sample(uint8_t angle, uint32_t range, uint32_t now);
+
+  /*
+   * Nearest
+   *
+   * Copy up to n targets into out, nearest first.
+   *
+   * Returns:
+   * uint8_t - the number of targets copied
+   */
+  uint8_t nearest(Target out[], uint8_t n) const;
+
+  /*
+   * Clear
+   *
+   * Forget every target.
+   */
+  void clear();
+};
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_TARGETTRACKER_TARGETTRACKER_H_
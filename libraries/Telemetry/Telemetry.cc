@@ -0,0 +1,87 @@
+#include "Telemetry.h"
+
+namespace Telemetry {
+
+uint16_t crc16(const uint8_t* data, size_t size) {
+  uint16_t crc = 0xffff;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021)
+                           : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t cobs_encode(const uint8_t* data, size_t size, uint8_t* out) {
+  // each block is a code, the distance to the next 0, and what's in between
+  size_t code_at = 0;
+  size_t written = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < size; ++i) {
+    if (data[i] != 0) {
+      out[written++] = data[i];
+      ++code;
+    }
+    // a full block only needs closing if there's more to come
+    if (data[i] == 0 || (code == 0xff && i + 1 < size)) {
+      out[code_at] = code;
+      code_at = written++;
+      code = 1;
+    }
+  }
+  out[code_at] = code;
+  return written;
+}
+
+size_t cobs_decode(const uint8_t* data, size_t size, uint8_t* out) {
+  size_t read = 0;
+  size_t written = 0;
+
+  while (read < size) {
+    uint8_t code = data[read++];
+    if (code == 0 || read + code - 1 > size) {
+      return 0;
+    }
+    for (uint8_t i = 1; i < code; ++i) {
+      if (data[read] == 0) {
+        return 0;
+      }
+      out[written++] = data[read++];
+    }
+    // a 0 went here, unless it was a full block or the end
+    if (code != 0xff && read != size) {
+      out[written++] = 0;
+    }
+  }
+  return written;
+}
+
+uint8_t put_varint(uint32_t value, uint8_t* out) {
+  uint8_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+bool get_varint(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (data == end) {
+      return false;
+    }
+    uint8_t byte = *data++;
+    value |= (uint32_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace Telemetry
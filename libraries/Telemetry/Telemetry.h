@@ -0,0 +1,106 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_TELEMETRY_TELEMETRY_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_TELEMETRY_TELEMETRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Telemetry format
+ *
+ * A stream of frames, each a payload and its CRC, COBS encoded so there's no
+ * 0 in it, then a 0 to end it:
+ *
+ *    frame:    COBS(payload, crc high, crc low) 0x00
+ *    payload:  sequence, kind, fields
+ *
+ * The CRC is CRC-16/CCITT-FALSE over the payload. The sequence goes up by
+ * one each frame, so a reader can tell one went missing.
+ *
+ * Numbers are varints, 7 bits at a time, low bits first, with the top bit
+ * set on all but the last byte. A signed delta is zigzag encoded first, so a
+ * small step either way is a byte. Times are millis(), in ms, and ranges are
+ * in mm with 0 for no echo.
+ *
+ * A ping's record comes to 8 bytes on the wire, a state change to 7, and a
+ * key to 11 or so.
+ *
+ * Only the main loop and the host use these, not ISRs.
+ */
+namespace Telemetry {
+
+constexpr uint8_t version {1};
+constexpr uint8_t max_payload {16};
+constexpr uint8_t crc_size {2};
+// COBS adds a byte per 254, and there's the 0 on the end
+constexpr uint8_t max_frame {max_payload + crc_size + 2};
+// a key every this many frames, for a reader that's lost its place
+constexpr uint8_t key_every {32};
+
+/*
+ * Kind
+ *
+ * KEY - where everything is, so a reader can start from here: the kind of
+ *       frame it's in place of (a byte), time, angle (a byte), range and
+ *       state (a byte). The stream starts with one, there's one after
+ *       anything is dropped, and one every key_every frames.
+ * RANGE - a ping, as deltas from the frame before: time, angle (zigzag) and
+ *         range (zigzag)
+ * STATE - the radar changed state: time delta, and the state (a byte)
+ * LOST - frames (a varint) were dropped here, the buffer was full. A KEY
+ *        comes next.
+ */
+enum class Kind : uint8_t { KEY, RANGE, STATE, LOST };
+
+// CRC-16/CCITT-FALSE, 0x1021 from 0xffff
+uint16_t crc16(const uint8_t* data, size_t size);
+
+/*
+ * COBS Encode
+ *
+ * Write data to out with its 0 bytes taken out, see
+ * https://en.wikipedia.org/wiki/Consistent_Overhead_Byte_Stuffing. Doesn't
+ * add the 0 on the end.
+ *
+ * uint8_t* out - room for size + size / 254 + 1 bytes
+ *
+ * Returns:
+ * size_t - bytes written to out
+ */
+size_t cobs_encode(const uint8_t* data, size_t size, uint8_t* out);
+
+/*
+ * COBS Decode
+ *
+ * Undo cobs_encode(), for a frame without its 0 on the end.
+ *
+ * uint8_t* out - room for size bytes
+ *
+ * Returns:
+ * size_t - bytes written to out, or 0 if it wasn't valid
+ */
+size_t cobs_decode(const uint8_t* data, size_t size, uint8_t* out);
+
+// write value as a varint, returning how many bytes it took (5 at most)
+uint8_t put_varint(uint32_t value, uint8_t* out);
+
+/*
+ * Get Varint
+ *
+ * Read a varint from data, moving data past it.
+ *
+ * Returns:
+ * bool - false if it ran past end first, or was longer than 5 bytes
+ */
+bool get_varint(const uint8_t*& data, const uint8_t* end, uint32_t& value);
+
+// 0, -1, 1, -2, ... to 0, 1, 2, 3, ... and back
+inline uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+inline int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+} // namespace Telemetry
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_TELEMETRY_TELEMETRY_H_
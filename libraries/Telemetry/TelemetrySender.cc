@@ -0,0 +1,143 @@
+#include "TelemetrySender.h"
+
+using Telemetry::Kind;
+
+void TelemetrySender::start() {
+  buffer_.clear();
+  sending_ = true;
+  need_key_ = true;
+  sequence_ = 0;
+  since_key_ = 0;
+  time_ = 0;
+  angle_ = 0;
+  range_ = 0;
+  state_ = 0;
+  lost_ = 0;
+  dropped_ = 0;
+}
+
+void TelemetrySender::stop() {
+  sending_ = false;
+}
+
+bool TelemetrySender::sending() {
+  return sending_;
+}
+
+void TelemetrySender::range(uint8_t angle, uint32_t range, uint32_t time) {
+  if (!sending_) {
+    return;
+  }
+  if (range == UINT32_MAX) {
+    range = 0;
+  }
+
+  uint8_t payload[Telemetry::max_payload + Telemetry::crc_size];
+  uint8_t n = begin_(payload, Kind::RANGE);
+  n += Telemetry::put_varint(time - time_, payload + n);
+  n += Telemetry::put_varint(Telemetry::zigzag((int32_t)angle - angle_),
+                             payload + n);
+  n += Telemetry::put_varint(Telemetry::zigzag((int32_t)(range - range_)),
+                             payload + n);
+  time_ = time;
+  angle_ = angle;
+  range_ = range;
+
+  if (need_key_ || since_key_ >= Telemetry::key_every) {
+    key_(Kind::RANGE);
+  } else if (room_(1)) {
+    frame_(payload, n);
+  } else {
+    drop_();
+  }
+}
+
+void TelemetrySender::state(uint8_t state, uint32_t time) {
+  if (!sending_) {
+    return;
+  }
+
+  uint8_t payload[Telemetry::max_payload + Telemetry::crc_size];
+  uint8_t n = begin_(payload, Kind::STATE);
+  n += Telemetry::put_varint(time - time_, payload + n);
+  payload[n++] = state;
+  time_ = time;
+  state_ = state;
+
+  if (need_key_ || since_key_ >= Telemetry::key_every) {
+    key_(Kind::STATE);
+  } else if (room_(1)) {
+    frame_(payload, n);
+  } else {
+    drop_();
+  }
+}
+
+bool TelemetrySender::read(uint8_t& byte) {
+  return buffer_.pop(byte);
+}
+
+uint16_t TelemetrySender::dropped() {
+  return dropped_;
+}
+
+bool TelemetrySender::room_(uint8_t frames) {
+  return buffer_size - buffer_.size() >= frames * Telemetry::max_frame;
+}
+
+uint8_t TelemetrySender::begin_(uint8_t* payload, Kind kind) {
+  payload[0] = sequence_;
+  payload[1] = (uint8_t)kind;
+  return 2;
+}
+
+void TelemetrySender::frame_(uint8_t* payload, uint8_t size) {
+  uint16_t crc = Telemetry::crc16(payload, size);
+  payload[size++] = (uint8_t)(crc >> 8);
+  payload[size++] = (uint8_t)crc;
+
+  uint8_t encoded[Telemetry::max_frame];
+  size_t n = Telemetry::cobs_encode(payload, size, encoded);
+  for (size_t i = 0; i < n; ++i) {
+    buffer_.post(encoded[i]);
+  }
+  buffer_.post(0);
+
+  ++sequence_;
+  ++since_key_;
+}
+
+void TelemetrySender::key_(Kind kind) {
+  if (!room_((lost_ != 0) ? 2 : 1)) {
+    drop_();
+    return;
+  }
+
+  uint8_t payload[Telemetry::max_payload + Telemetry::crc_size];
+  uint8_t n;
+  if (lost_ != 0) {
+    n = begin_(payload, Kind::LOST);
+    n += Telemetry::put_varint(lost_, payload + n);
+    frame_(payload, n);
+    lost_ = 0;
+  }
+
+  n = begin_(payload, Kind::KEY);
+  payload[n++] = (uint8_t)kind;
+  n += Telemetry::put_varint(time_, payload + n);
+  payload[n++] = angle_;
+  n += Telemetry::put_varint(range_, payload + n);
+  payload[n++] = state_;
+  frame_(payload, n);
+
+  need_key_ = false;
+  since_key_ = 0;
+}
+
+void TelemetrySender::drop_() {
+  if (lost_ != UINT16_MAX) {
+    ++lost_;
+  }
+  ++dropped_;
+  need_key_ = true;
+}
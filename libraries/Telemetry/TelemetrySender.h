@@ -0,0 +1,113 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_TELEMETRY_TELEMETRYSENDER_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_TELEMETRY_TELEMETRYSENDER_H_
+
+#include <ArduinoInterface.h>
+#include <EventQueue.h>
+#include "Telemetry.h"
+
+/*
+ * TelemetrySender - send the radar's ranges and states out over Serial
+ *
+ * The firmware calls the TELEMETRY_...() hooks as it pings and changes
+ * state, and each is framed (see Telemetry.h) straight into a small ring
+ * buffer. The main loop sends the buffer out whenever it's waiting, only as
+ * many bytes as Serial can take without blocking, with read(), so however
+ * slow the link it never holds up the commands.
+ *
+ * A frame that won't fit in the buffer whole is dropped and counted. The
+ * next one that fits goes out as a LOST frame and a KEY, so a reader knows
+ * and can carry on from there.
+ *
+ * Nothing is sent until start(). It's all static, like TraceRecorder, but
+ * only for the main loop, so never turns interrupts off.
+ *
+ * Serial carries telemetry unless something else has it: a trace with
+ * TRACE_RECORD, or the text reports with PROFILE or MEMORY_STATS. Otherwise
+ * TELEMETRY is defined and the hooks are compiled in.
+ */
+class TelemetrySender {
+ public:
+  static constexpr uint8_t buffer_size {64};
+
+ private:
+  inline static INSTANCE_LOCAL EventQueue<uint8_t, buffer_size> buffer_;
+  inline static INSTANCE_LOCAL bool sending_ {false};
+  inline static INSTANCE_LOCAL bool need_key_ {true};
+  inline static INSTANCE_LOCAL uint8_t sequence_ {0};
+  inline static INSTANCE_LOCAL uint8_t since_key_ {0};
+  inline static INSTANCE_LOCAL uint32_t time_ {0};
+  inline static INSTANCE_LOCAL uint8_t angle_ {0};
+  inline static INSTANCE_LOCAL uint32_t range_ {0};
+  inline static INSTANCE_LOCAL uint8_t state_ {0};
+  inline static INSTANCE_LOCAL uint16_t lost_ {0};
+  inline static INSTANCE_LOCAL uint16_t dropped_ {0};
+
+  // room for this many frames of the longest kind
+  static bool room_(uint8_t frames);
+  // sequence and kind, the start of every payload
+  static uint8_t begin_(uint8_t* payload, Telemetry::Kind kind);
+  static void frame_(uint8_t* payload, uint8_t size);
+  // LOST if anything was, then KEY in place of a frame of kind
+  static void key_(Telemetry::Kind kind);
+  static void drop_();
+
+ public:
+  TelemetrySender() = delete;
+
+  /*
+   * Start
+   *
+   * Empty the buffer and start sending, with a KEY first.
+   */
+  static void start();
+  static void stop();
+  static bool sending();
+
+  /*
+   * Range
+   *
+   * Send a ping.
+   *
+   * uint8_t angle - the servo angle the ping was sent at
+   * uint32_t range - in mm, UINT32_MAX for no echo as Radar::ping() gives
+   * uint32_t time - millis() when it came back
+   */
+  static void range(uint8_t angle, uint32_t range, uint32_t time);
+
+  /*
+   * State
+   *
+   * Send a state change.
+   *
+   * uint8_t state - the RadarStateId it changed to
+   */
+  static void state(uint8_t state, uint32_t time);
+
+  /*
+   * Read
+   *
+   * uint8_t& byte - set to the next byte to send, if there is one
+   *
+   * Returns:
+   * bool - false if the buffer is empty
+   */
+  static bool read(uint8_t& byte);
+
+  // frames dropped since start() because the buffer was full
+  static uint16_t dropped();
+};
+
+#if !defined(TRACE_RECORD) && !defined(PROFILE) && !defined(MEMORY_STATS) \
+    && !defined(UNIT_TEST)
+#define TELEMETRY
+#endif
+
+#ifdef TELEMETRY
+#define TELEMETRY_RANGE(at, mm, ms) TelemetrySender::range(at, mm, ms)
+#define TELEMETRY_STATE(id, ms) TelemetrySender::state(id, ms)
+#else
+#define TELEMETRY_RANGE(at, mm, ms)
+#define TELEMETRY_STATE(id, ms)
+#endif // TELEMETRY
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_TELEMETRY_TELEMETRYSENDER_H_
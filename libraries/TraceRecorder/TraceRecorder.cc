@@ -0,0 +1,96 @@
+#include <TraceRecorder.h>
+
+void TraceRecorder::start() {
+  noInterrupts();
+  buffer_.clear();
+  for (uint8_t c : Trace::magic) {
+    buffer_.post(c);
+  }
+  buffer_.post(Trace::version);
+  last_time_ = 0;
+  lost_ = 0;
+  dropped_ = 0;
+  recording_ = true;
+  interrupts();
+}
+
+void TraceRecorder::stop() {
+  recording_ = false;
+}
+
+bool TraceRecorder::recording() {
+  return recording_;
+}
+
+void TraceRecorder::record(Trace::Kind kind, uint8_t value) {
+  if (!recording_) {
+    return;
+  }
+  uint32_t time = ArduinoInterface::micros();
+  noInterrupts();
+  write_(kind, value, time);
+  interrupts();
+}
+
+void TraceRecorder::record_isr(Trace::Kind kind, uint8_t value,
+                               uint32_t time) {
+  if (recording_) {
+    write_(kind, value, time);
+  }
+}
+
+bool TraceRecorder::read(uint8_t& byte) {
+  noInterrupts();
+  bool got = buffer_.pop(byte);
+  interrupts();
+  return got;
+}
+
+uint16_t TraceRecorder::dropped() {
+  return dropped_;
+}
+
+void TraceRecorder::write_(Trace::Kind kind, uint8_t value, uint32_t time) {
+  using Trace::Kind;
+
+  // room for this and a LOST record in front of it
+  uint8_t needed = (lost_ != 0) ? 2 * Trace::max_record : Trace::max_record;
+  if (buffer_size - buffer_.size() < needed) {
+    if (lost_ != UINT8_MAX) {
+      ++lost_;
+    }
+    ++dropped_;
+    return;
+  }
+
+  // stamped with this record's time, as near as we know to the gap
+  if (lost_ != 0) {
+    encode_((uint8_t)Kind::LOST, time - last_time_, true, lost_);
+    last_time_ = time;
+    lost_ = 0;
+  }
+
+  if (kind == Kind::ECHO || kind == Kind::PIR) {
+    encode_((uint8_t)kind | (value ? Trace::level_bit : 0),
+            time - last_time_, false, 0);
+  } else {
+    encode_((uint8_t)kind, time - last_time_, true, value);
+  }
+  last_time_ = time;
+}
+
+void TraceRecorder::encode_(uint8_t tag, uint32_t delta, bool has_value,
+                            uint8_t value) {
+  // zigzag: 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+  uint32_t zigzag = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+
+  buffer_.post(tag);
+  while (zigzag >= 0x80) {
+    buffer_.post((uint8_t)(zigzag | 0x80));
+    zigzag >>= 7;
+  }
+  buffer_.post((uint8_t)zigzag);
+  if (has_value) {
+    buffer_.post(value);
+  }
+}
@@ -0,0 +1,137 @@
+#ifndef A_TOOLCHAIN_TEST_LIBRARIES_TRACERECORDER_TRACERECORDER_H_
+#define A_TOOLCHAIN_TEST_LIBRARIES_TRACERECORDER_TRACERECORDER_H_
+
+#include <ArduinoInterface.h>
+#include <EventQueue.h>
+
+/*
+ * Trace format
+ *
+ * A trace is a header and then one record after another, with nothing in
+ * between:
+ *
+ *    header:  'R' 'T' 'R' version
+ *    record:  tag, time delta, [value]
+ *
+ * The tag is a Kind, with the level in the top bit for ECHO and PIR. The
+ * time delta is the µs since the record before (or since 0 for the first),
+ * zigzag encoded so a record stamped a little before the last one (an ISR
+ * that ran late) still only takes a byte or two, then written 7 bits at a
+ * time, low bits first, with the top bit set on all but the last byte.
+ * SERVO, STATE and LOST records are followed by one value byte.
+ *
+ * Times come from micros(), so they wrap every 71 minutes on the device.
+ * Deltas are taken mod 2^32, which a reader can add up without caring.
+ *
+ * A servo move comes to 5 bytes and a PIR read to 3.
+ */
+namespace Trace {
+
+constexpr uint8_t magic[3] {'R', 'T', 'R'};
+constexpr uint8_t version {1};
+constexpr uint8_t header_size {4};
+constexpr uint8_t level_bit {0x80};
+constexpr uint8_t max_record {7};   // tag, 5 byte delta, value
+
+/*
+ * Kind
+ *
+ * ECHO - an edge on the echo pin, seen by the ISR. Value is the new level.
+ * PIR - the PIR sensor was read. Value is what it read.
+ * SERVO - the radar moved the servo. Value is the angle.
+ * STATE - the radar changed state. Value is the RadarStateId.
+ * LOST - value records (up to 255) were dropped here, the buffer was full
+ */
+enum class Kind : uint8_t { ECHO, PIR, SERVO, STATE, LOST };
+
+} // namespace Trace
+
+/*
+ * TraceRecorder - record what the radar sees and does
+ *
+ * The firmware calls the TRACE() hooks as things happen, and each record is
+ * encoded straight into a small ring buffer. The main loop sends the buffer
+ * out over Serial whenever it's waiting, a byte at a time with read(). It's
+ * all static, like the ISRs that record into it.
+ *
+ * record() is for the main loop and turns interrupts off while it writes.
+ * record_isr() is for ISRs, which run with them off already, and takes the
+ * time the ISR read rather than costing another micros().
+ *
+ * Nothing is recorded until start(). If the buffer hasn't room for a whole
+ * record it's dropped and counted, and a LOST record goes in before the next
+ * one that fits.
+ *
+ * The hooks are only compiled in with TRACE_RECORD defined.
+ */
+class TraceRecorder {
+ public:
+  static constexpr uint8_t buffer_size {64};
+
+ private:
+  inline static INSTANCE_LOCAL EventQueue<uint8_t, buffer_size> buffer_;
+  inline static INSTANCE_LOCAL bool recording_ {false};
+  inline static INSTANCE_LOCAL uint32_t last_time_ {0};
+  inline static INSTANCE_LOCAL uint8_t lost_ {0};
+  inline static INSTANCE_LOCAL uint16_t dropped_ {0};
+
+  static void write_(Trace::Kind kind, uint8_t value, uint32_t time);
+  static void encode_(uint8_t tag, uint32_t delta, bool has_value,
+                      uint8_t value);
+
+ public:
+  TraceRecorder() = delete;
+
+  /*
+   * Start
+   *
+   * Empty the buffer and start a new trace, header first. Times in it are
+   * micros() as it was, so the first delta is from 0 rather than from now.
+   */
+  static void start();
+  static void stop();
+  static bool recording();
+
+  /*
+   * Record
+   *
+   * Add a record stamped with micros(), from the main loop.
+   *
+   * Trace::Kind kind - what happened
+   * uint8_t value - level, angle or state, see Trace::Kind
+   */
+  static void record(Trace::Kind kind, uint8_t value);
+
+  /*
+   * Record ISR
+   *
+   * Add a record from an ISR, with interrupts already off.
+   *
+   * uint32_t time - micros() when it happened
+   */
+  static void record_isr(Trace::Kind kind, uint8_t value, uint32_t time);
+
+  /*
+   * Read
+   *
+   * uint8_t& byte - set to the next byte of the trace, if there is one
+   *
+   * Returns:
+   * bool - false if the buffer is empty
+   */
+  static bool read(uint8_t& byte);
+
+  // records dropped since start() because the buffer was full
+  static uint16_t dropped();
+};
+
+#ifdef TRACE_RECORD
+#define TRACE(kind, value) TraceRecorder::record(kind, value)
+#define TRACE_ISR(kind, value, time) \
+  TraceRecorder::record_isr(kind, value, time)
+#else
+#define TRACE(kind, value)
+#define TRACE_ISR(kind, value, time)
+#endif // TRACE_RECORD
+
+#endif //A_TOOLCHAIN_TEST_LIBRARIES_TRACERECORDER_TRACERECORDER_H_
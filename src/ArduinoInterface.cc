@@ -0,0 +1,16 @@
+#if !defined(UNIT_TEST) && !defined(HOST_SIM) // only on the real thing
+
+#include <ArduinoInterface.h>
+
+// one shot timer, see ConcreteArduino::one_shot()
+ISR(TIMER1_COMPB_vect) {
+  TIMSK1 &= ~_BV(OCIE1B); // only fire once
+  ConcreteArduino::one_shot_isr_();
+}
+
+// periodic tick, see ConcreteArduino::timer_tick()
+ISR(TIMER0_COMPB_vect) {
+  ConcreteArduino::timer_tick_isr_();
+}
+
+#endif // UNIT_TEST, HOST_SIM
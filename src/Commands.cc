@@ -3,87 +3,70 @@
 //
 
 #include <Commands.h>
-#include <new.h>
 
-RadarAction::RadarAction() = default;
+namespace Commands {
 
-RadarAction *DoMove::instance(RadarContext *c) {
-  if (instance_ == nullptr) {
-    instance_ = new DoMove;
-  }
-  context_ = c;
-  return instance_;
+void move(void* context) {
+  static_cast<RadarContext*>(context)->radar_move();
 }
 
-void DoMove::operator()() {
-  context_->radar_move();
-}
-void DoMove::delete_instance() {
-  delete instance_;
-  instance_ = nullptr;
-}
-
-RadarAction *DoPing::instance(RadarContext *c) {
-  if (instance_ == nullptr) {
-    instance_ = new DoPing;
-  }
-  context_ = c;
-  return instance_;
-}
+void ping(void* context) {
+  auto c = static_cast<RadarContext*>(context);
 
-void DoPing::operator()() {
-  uint32_t distance = context_->radar_ping();
-  context_->lcd_setCursor(0, 1);
-  context_->lcd_print("Distance: ");
+  uint32_t distance = c->radar_ping();
+  c->lcd_setCursor(0, 1);
+  c->lcd_print("Distance: ");
   if (distance != UINT32_MAX) {
-    context_->lcd_print(distance);
-    context_->lcd_print("  ");
+    // the rest of the row, so whatever was there before is written over
+    c->lcd_print(distance, LCDBuffer::cols - 10);
   }  else {
-    context_->lcd_print("***");
+    c->lcd_print("   ***");
   }
 
-  context_->update(distance);
-}
-void DoPing::delete_instance() {
-  delete instance_;
-  instance_ = nullptr;
+  c->post_event(distance);
 }
 
-RadarAction *DoLEDPulse::instance(RadarContext *c) {
-  if (instance_== nullptr) {
-    instance_ = new DoLEDPulse;
+void pir_check(void* context) {
+  using AI = ArduinoInterface;
+  uint8_t sensor = AI::digitalRead(CFG::ir_pin);
+  TRACE(Trace::Kind::PIR, sensor);
+  if (sensor) {
+    static_cast<RadarContext*>(context)->post_event(1);
   }
-  context_ = c;
-  return instance_;
 }
 
-void DoLEDPulse::operator()() {
-  context_->led_pulse();
+void lcd_flush(void* context) {
+  static_cast<RadarContext*>(context)->lcd_flush();
 }
 
-void DoLEDPulse::delete_instance() {
-  delete instance_;
-  instance_ = nullptr;
+void lcd_graph(void* context) {
+  static_cast<RadarContext*>(context)->lcd_graph();
 }
 
-RadarAction *DoPIRCheck::instance(RadarContext *c) {
-  if (instance_== nullptr) {
-    instance_ = new DoPIRCheck;
-  }
-  context_ = c;
-  return instance_;
+#ifdef PROFILE
+void profile_dump(void*) {
+  Profiler::dump(Serial);
 }
+#endif // PROFILE
 
-void DoPIRCheck::operator()() {
-  using AI = ArduinoInterface;
-  uint8_t sensor = AI::digitalRead(CFG::ir_pin);
-  if (sensor) {
-    context_->update(1);
-  }
+#ifdef MEMORY_STATS
+void memory_check(void*) {
+  Memory::measure();
 }
 
-void DoPIRCheck::delete_instance() {
-  RadarAction* tmp = instance_;
-  delete tmp;
-  instance_ = nullptr;
+void memory_report(void*) {
+  Memory::report(Serial);
 }
+#endif // MEMORY_STATS
+
+#ifdef CONSOLE
+void console(void*) {
+  Console::poll();
+  // what's left waits in Serial's buffer for next time
+  while (Console::ready() && Serial.available() > 0) {
+    Console::feed((uint8_t)Serial.read());
+  }
+}
+#endif // CONSOLE
+
+} // namespace Commands
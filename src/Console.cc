@@ -0,0 +1,259 @@
+#include <Console.h>
+#include <IntFormat.h>
+
+namespace {
+
+using Id = Settings::Id;
+
+// replies live in flash, as a 2KB AVR hasn't the SRAM to spare for them
+const char ok[] PROGMEM {"ok\r\n"};
+const char help[] PROGMEM {"get set list save load defaults exit help\r\n"};
+const char unknown_command[] PROGMEM {"error: unknown command\r\n"};
+const char unknown_setting[] PROGMEM {"error: unknown setting\r\n"};
+const char not_number[] PROGMEM {"error: not a number\r\n"};
+const char nothing_saved[] PROGMEM {"error: nothing saved\r\n"};
+const char too_long[] PROGMEM {"error: line too long\r\n"};
+const char usage[] PROGMEM {"error: wrong number of words\r\n"};
+const char error[] PROGMEM {"error: "};
+const char to[] PROGMEM {" to "};
+const char end_line[] PROGMEM {"\r\n"};
+
+static_assert(sizeof(help) - 1 <= Console::max_reply,
+              "help is the longest reply");
+
+/*
+ * Command table
+ *
+ * Each command's name and how many words its line has, the name included.
+ */
+enum class Verb : uint8_t { GET, SET, LIST, SAVE, LOAD, DEFAULTS, EXIT, HELP,
+                            NONE };
+
+struct VerbDef {
+  char name[9];
+  uint8_t words;
+};
+
+constexpr VerbDef verbs[] PROGMEM {
+    {"get", 2}, {"set", 3}, {"list", 1}, {"save", 1}, {"load", 1},
+    {"defaults", 1}, {"exit", 1}, {"help", 1},
+};
+
+static_assert(sizeof(verbs) / sizeof(verbs[0]) == (uint8_t)Verb::NONE,
+              "verbs needs one entry per Verb");
+
+Verb find_verb(const char* word, uint8_t& words) {
+  for (uint8_t i = 0; i < (uint8_t)Verb::NONE; ++i) {
+    VerbDef def;
+    memcpy_P(&def, &verbs[i], sizeof(def));
+    if (strcmp(word, def.name) == 0) {
+      words = def.words;
+      return (Verb)i;
+    }
+  }
+  return Verb::NONE;
+}
+
+// decimal digits only, up to UINT32_MAX
+bool parse_uint(const char* word, uint32_t& value) {
+  value = 0;
+  if (*word == '\0') {
+    return false;
+  }
+  for (; *word != '\0'; ++word) {
+    if (*word < '0' || *word > '9') {
+      return false;
+    }
+    uint8_t digit = *word - '0';
+    if (value > (UINT32_MAX - digit) / 10) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+  return true;
+}
+
+} // namespace
+
+void Console::reset() {
+  length_ = 0;
+  overlong_ = false;
+  active_ = false;
+  listing_ = not_listing;
+  buffer_.clear();
+}
+
+bool Console::ready() {
+  return listing_ == not_listing
+         && buffer_size - buffer_.size() >= max_reply;
+}
+
+void Console::feed(uint8_t c) {
+  if (c == '\r' || c == '\n') {
+    if (length_ != 0 || overlong_) {
+      run_();
+    }
+    length_ = 0;
+    overlong_ = false;
+  } else if (c == '\b' || c == 0x7f) {
+    if (length_ != 0) {
+      --length_;
+    }
+  } else if (c >= ' ' && c <= '~') {
+    if (length_ < line_size) {
+      line_[length_++] = (char)c;
+    } else {
+      overlong_ = true;
+    }
+  }
+}
+
+void Console::poll() {
+  while (listing_ != not_listing
+         && buffer_size - buffer_.size() >= max_reply) {
+    if (listing_ < Settings::count) {
+      put_value_((Id)listing_++);
+    } else {
+      put_P_(ok);
+      listing_ = not_listing;
+    }
+  }
+}
+
+bool Console::read(uint8_t& byte) {
+  return buffer_.pop(byte);
+}
+
+bool Console::active() {
+  return active_;
+}
+
+void Console::put_(const char* text) {
+  while (*text != '\0') {
+    buffer_.post((uint8_t)*text++);
+  }
+}
+
+void Console::put_P_(const char* text) {
+  for (char c; (c = (char)pgm_read_byte(text)) != '\0'; ++text) {
+    buffer_.post((uint8_t)c);
+  }
+}
+
+void Console::put_number_(uint32_t n) {
+  char digits[IntFormat::max_width + 1];
+  digits[IntFormat::format_uint(digits, 0, n)] = '\0';
+  put_(digits);
+}
+
+void Console::put_value_(Id id) {
+  put_(Settings::entry(id).name);
+  buffer_.post('=');
+  put_number_(Settings::get(id));
+  put_P_(end_line);
+}
+
+void Console::run_() {
+  if (!active_) {
+    active_ = true;
+#ifdef TELEMETRY
+    TelemetrySender::stop();
+#endif // TELEMETRY
+  }
+  if (overlong_) {
+    put_P_(too_long);
+    return;
+  }
+
+  // split into words where the spaces are
+  char* words[3] {};
+  uint8_t count = 0;
+  line_[length_] = '\0';
+  for (char* p = line_; *p != '\0';) {
+    while (*p == ' ') {
+      *p++ = '\0';
+    }
+    if (*p == '\0') {
+      break;
+    }
+    if (count == 3) {
+      ++count;      // one too many, whatever the command
+      break;
+    }
+    words[count++] = p;
+    while (*p != ' ' && *p != '\0') {
+      ++p;
+    }
+  }
+  if (count == 0) {
+    return;
+  }
+
+  uint8_t expected = 0;
+  Verb verb = find_verb(words[0], expected);
+  if (verb == Verb::NONE) {
+    put_P_(unknown_command);
+    return;
+  }
+  if (count != expected) {
+    put_P_(usage);
+    return;
+  }
+
+  Id id = Id::COUNT;
+  if (verb == Verb::GET || verb == Verb::SET) {
+    id = Settings::find(words[1]);
+    if (id == Id::COUNT) {
+      put_P_(unknown_setting);
+      return;
+    }
+  }
+
+  switch (verb) {
+    case Verb::GET:
+      put_value_(id);
+      break;
+    case Verb::SET: {
+      uint32_t value;
+      if (!parse_uint(words[2], value)) {
+        put_P_(not_number);
+      } else if (!Settings::set(id, value)) {
+        Settings::Range range = Settings::range(id);
+        put_P_(error);
+        put_number_(range.min);
+        put_P_(to);
+        put_number_(range.max);
+        put_P_(end_line);
+      } else {
+        put_value_(id);
+      }
+      break;
+    }
+    case Verb::LIST:
+      listing_ = 0;
+      poll();
+      break;
+    case Verb::SAVE:
+      Settings::save();
+      put_P_(ok);
+      break;
+    case Verb::LOAD:
+      put_P_(Settings::load() ? ok : nothing_saved);
+      break;
+    case Verb::DEFAULTS:
+      Settings::defaults();
+      put_P_(ok);
+      break;
+    case Verb::EXIT:
+      put_P_(ok);
+      buffer_.post(0);
+      active_ = false;
+#ifdef TELEMETRY
+      TelemetrySender::start();
+#endif // TELEMETRY
+      break;
+    default:
+      put_P_(help);
+      break;
+  }
+}
@@ -6,70 +6,169 @@
 #include <ArduinoInterface.h>
 #include <Commands.h>
 
+namespace {
+
+/*
+ * State table
+ *
+ * One StateDef per RadarStateId, in the same order, describing the entry and
+ * exit actions of that state. Entry runs top to bottom:
+ *
+ * - clear the LCD and print the banner, if there is one
+ * - set the LED colour and effect
+ * - add the commands
+ * - start the buzzer
+ *
+ * Exit removes the commands and stops the buzzer. A child state hands the LED
+ * effect back to its parent, as the parent isn't entered again.
+ *
+ * All of this is worked out at compile time and lives in flash.
+ */
+struct StateCommand {
+  Command       function;   // nullptr if slot unused
+  Settings::Id  period;     // the setting with how often to run it
+};
+
+struct StateDef {
+  RadarStateId  parent;
+  bool          clear_lcd;
+  const char*   banner;       // printed at 0,0 after clearing, or nullptr
+  bool          set_colour;
+  LEDColour     colour;
+  LEDEffect     effect;
+  uint16_t      period;       // of the LED effect, in ms
+  uint16_t      tone;         // buzzer frequency, 0 for silence
+  StateCommand  commands[3];
+};
+
+constexpr StateCommand no_command {nullptr, Settings::Id::COUNT};
+
+constexpr StateDef state_table[] PROGMEM {
+    // STANDBY
+    {RadarStateId::NONE, true, "Standby", true, LEDColour::GREEN,
+     LEDEffect::PULSE, CFG::standby_pulse_ms, 0,
+     {{Commands::pir_check, Settings::Id::PIR_CHECK_MS}, no_command,
+      no_command}},
+    // SENSING
+    {RadarStateId::NONE, true, nullptr, false, LEDColour::GREEN,
+     LEDEffect::STEADY, 0, 0,
+     {{Commands::move, Settings::Id::MOVE_MS},
+      {Commands::ping, Settings::Id::PING_MS},
+      {Commands::lcd_graph, Settings::Id::LCD_GRAPH_MS}}},
+    // WARNING
+    {RadarStateId::SENSING, false, nullptr, true, LEDColour::RED,
+     LEDEffect::PULSE, CFG::warning_pulse_ms, 500,
+     {no_command, no_command, no_command}},
+};
+
+static_assert(sizeof(state_table) / sizeof(state_table[0])
+                  == (uint8_t)RadarStateId::NONE,
+              "state_table needs one entry per RadarStateId");
+
+/*
+ * Transition table
+ *
+ * Any state and event not listed here doesn't change state.
+ */
+struct Transition {
+  RadarStateId  from;
+  StateEvent    event;
+  RadarStateId  to;
+};
+
+constexpr Transition transition_table[] PROGMEM {
+    {RadarStateId::STANDBY, StateEvent::MOTION,    RadarStateId::SENSING},
+    {RadarStateId::SENSING, StateEvent::TOO_CLOSE, RadarStateId::WARNING},
+    {RadarStateId::SENSING, StateEvent::TIMEOUT,   RadarStateId::STANDBY},
+    {RadarStateId::WARNING, StateEvent::CLEAR,     RadarStateId::SENSING},
+};
+
+// the table lives in flash, so copy the entry we need out of it
+StateDef state_def(RadarStateId s) {
+  StateDef def;
+  memcpy_P(&def, &state_table[(uint8_t)s], sizeof(def));
+  return def;
+}
+
+} // namespace
+
 /* * * * * * * * *
  * RadarContext  *
  * * * * * * * * *
  */
 
-// Set initial state to standby
-RadarContext::RadarContext(RadarState* state) : led_{CFG::red_pin, CFG::green_pin,
+RadarContext::RadarContext(RadarStateId state) : led_{CFG::red_pin, CFG::green_pin,
                                     CFG::blue_pin},
                                lcd_{CFG::rs, CFG::en, CFG::d0, CFG::d1,
                                     CFG::d2, CFG::d3, CFG::d4, CFG::d5,
                                     CFG::d6, CFG::d7},
-                               state_{state} {
-  if (state_ == nullptr) {
-    state_ = StandbyState::instance();
-  }
-};
+                               state_{state} {};
 
 RadarContext::~RadarContext() = default;
 
-void RadarContext::change_state(RadarState *state) {
+void RadarContext::change_state(RadarStateId state) {
   state_ = state;
+  TRACE(Trace::Kind::STATE, (uint8_t)state);
+  TELEMETRY_STATE((uint8_t)state, ArduinoInterface::millis());
 }
 
 void RadarContext::start() {
-  state_->start(this);
+  RadarState::start(this, state_);
 }
 
 void RadarContext::update(uint32_t distance) {
-
-  state_->update(this, distance);
+  RadarState::update(this, state_, distance);
+}
+RadarStateId RadarContext::get_state() const {
+  return state_;
 }
 void RadarContext::radar_move() {
-  radar_.move();
+  PROFILE_SCOPE("radar_move");
+  angle_ = radar_.move();
 
 }
 uint32_t RadarContext::radar_ping() {
-  return radar_.ping();
+  PROFILE_SCOPE("radar_ping");
+  uint32_t distance = radar_.ping();
+  uint32_t now = ArduinoInterface::millis();
+
+  // this distance is the echo of the previous ping, so it belongs to the angle
+  // we were at back then rather than where we are now
+  tracker_.add_sample(ping_angle_, distance, now);
+  TELEMETRY_RANGE(ping_angle_, distance, now);
+  ping_angle_ = angle_;
 
+  return distance;
 }
-void RadarContext::command_add_entry(FunctionObject *func, uint16_t frequency) {
-  queue_.add_entry(func, frequency);
+uint8_t RadarContext::nearest_targets(Target out[], uint8_t n) const {
+  return tracker_.nearest(out, n);
+}
+void RadarContext::command_add_entry(Command func, uint16_t frequency) {
+  queue_.add_entry(func, this, frequency);
 }
 
-void RadarContext::command_remove_entry(FunctionObject *func) {
-  queue_.remove_entry(func);
+void RadarContext::command_remove_entry(Command func) {
+  queue_.remove_entry(func, this);
 }
 void RadarContext::led_set_colour(LEDColour colour) {
-  led_.set_colour(colour);
-}
-void RadarContext::led_set_pulse(int8_t increment) {
-  led_.set_pulse(increment);
+  PROFILE_SCOPE("led_colour");
+  led_.set_colour(colour, CFG::led_fade_ms);
 }
-void RadarContext::led_pulse() {
-  led_.pulse();
+void RadarContext::led_set_effect(LEDEffect effect, uint16_t period) {
+  led_.set_effect(effect, period);
 }
 void RadarContext::lcd_setCursor(uint8_t col, uint8_t row) {
-  lcd_.setCursor(col, row);
+  screen_.setCursor(col, row);
 }
 void RadarContext::lcd_print(const char *str) {
-  lcd_.print(str);
+  screen_.print(str);
 }
 
 void RadarContext::lcd_print(int n) {
-  lcd_.print(n);
+  screen_.print(n);
+}
+void RadarContext::lcd_print(uint32_t n, uint8_t width) {
+  screen_.print(n, width);
 }
 uint32_t RadarContext::get_timer() const {
   return timer_;
@@ -78,19 +177,102 @@ void RadarContext::set_timer() {
   timer_ = ArduinoInterface::millis();
 }
 uint32_t RadarContext::execute_current_entry() {
-  return queue_.execute_current_entry();
+  queue_.run_current_entry();
+  dispatch_events_();
+  apply_settings_();
+  return queue_.next_call_time();
+}
+bool RadarContext::post_event(uint32_t input) {
+  return events_.post(input);
+}
+void RadarContext::dispatch_events_() {
+  uint32_t input;
+  while (events_.pop(input)) {
+    update(input);
+  }
+}
+void RadarContext::apply_settings_() {
+  uint16_t changed = Settings::take_changed();
+  if (changed == 0) {
+    return;
+  }
+
+  auto reschedule = [this, changed](Command function, Settings::Id period) {
+    if (changed & (1 << (uint8_t)period)) {
+      queue_.reschedule(function, this, (uint16_t)Settings::get(period));
+    }
+  };
+  reschedule(Commands::lcd_flush, Settings::Id::LCD_FLUSH_MS);
+  // only the current state's are queued, the others will start with the new
+  // period when they're entered
+  for (auto& entry : state_table) {
+    StateDef def;
+    memcpy_P(&def, &entry, sizeof(def));
+    for (auto& command : def.commands) {
+      if (command.function != nullptr) {
+        reschedule(command.function, command.period);
+      }
+    }
+  }
 }
 void RadarContext::init() {
   ArduinoInterface::pinMode(CFG::ir_pin, INPUT);
   radar_.init(CFG::trigger_pin, CFG::echo_pin, CFG::servo_pin);
   lcd_.begin(16,2);
+  led_.start();
+  screen_.reset();
+  display_.reset();
   queue_.clear_queue();
-  auto state = StandbyState::instance();
-  change_state(state);
+  events_.clear();
+  tracker_.clear();
+  // scheduled from the settings as they are now, so none need applying
+  Settings::take_changed();
+  command_add_entry(Commands::lcd_flush,
+                    (uint16_t)Settings::get(Settings::Id::LCD_FLUSH_MS));
+#ifdef CONSOLE
+  command_add_entry(Commands::console, CFG::console_ms);
+#endif // CONSOLE
+#ifdef PROFILE
+  Profiler::name((Profiler::Id)Commands::move, "move");
+  Profiler::name((Profiler::Id)Commands::ping, "ping");
+  Profiler::name((Profiler::Id)Commands::pir_check, "pir_check");
+  Profiler::name((Profiler::Id)Commands::lcd_flush, "lcd_flush");
+  Profiler::name((Profiler::Id)Commands::lcd_graph, "lcd_graph");
+#ifndef TRACE_RECORD
+  // a trace has Serial to itself
+  Profiler::name((Profiler::Id)Commands::profile_dump, "profile_dump");
+  command_add_entry(Commands::profile_dump, CFG::profile_dump_ms);
+#endif // TRACE_RECORD
+#endif // PROFILE
+#ifdef MEMORY_STATS
+  command_add_entry(Commands::memory_check, CFG::memory_check_ms);
+#ifdef PROFILE
+  Profiler::name((Profiler::Id)Commands::memory_check, "memory_check");
+#endif // PROFILE
+#ifndef TRACE_RECORD
+  command_add_entry(Commands::memory_report, CFG::memory_report_ms);
+#ifdef PROFILE
+  Profiler::name((Profiler::Id)Commands::memory_report, "memory_report");
+#endif // PROFILE
+#endif // TRACE_RECORD
+#endif // MEMORY_STATS
+  change_state(RadarStateId::STANDBY);
   start();
 }
 void RadarContext::lcd_clear() {
-  lcd_.clear();
+  screen_.clear();
+}
+void RadarContext::lcd_flush() {
+  screen_.flush(lcd_);
+}
+void RadarContext::lcd_graph() {
+  Target nearest;
+  bool found = nearest_targets(&nearest, 1) != 0;
+  display_.draw(screen_, lcd_, found ? &nearest : nullptr, 0);
+}
+void RadarContext::lcd_poll() {
+  PROFILE_SCOPE("lcd_poll");
+  lcd_.poll();
 }
 
 /* * * * * * * *
@@ -99,174 +281,158 @@ void RadarContext::lcd_clear() {
  * * * * * * * *
  */
 
-void RadarState::change_state(RadarContext *c, RadarState *state) {
-  c->change_state(state);
-}
-void RadarState::command_add_entry(RadarContext *c,
-                                   FunctionObject *func,
-                                   uint16_t frequency) {
-  c->command_add_entry(func, frequency);
-}
-void RadarState::command_remove_entry(RadarContext *c, FunctionObject *func) {
-  c->command_remove_entry(func);
-}
-void RadarState::led_set_colour(RadarContext *c, LEDColour colour) {
-  c->led_set_colour(colour);
-}
-void RadarState::led_set_pulse(RadarContext *c, int8_t increment) {
-  c->led_set_pulse(increment);
-}
-void RadarState::set_timer(RadarContext *c) {
-  c->set_timer();
-}
-uint32_t RadarState::get_timer(RadarContext *c) {
-  return c->get_timer();
-}
-
-/* * * * * * * * *
- * StandbyState  *
- * * * * * * * * *
- */
+void RadarState::start(RadarContext *c, RadarStateId s) {
+  StateDef def = state_def(s);
 
-// instance method. Returns single instance.
-RadarState *StandbyState::instance() {
-  if (instance_ == nullptr) {
-    instance_ = new StandbyState;
+  if (def.clear_lcd) {
+    c->lcd_clear();
+  }
+  if (def.banner != nullptr) {
+    c->lcd_setCursor(0, 0);
+    c->lcd_print(def.banner);
+  }
+  if (def.set_colour) {
+    c->led_set_colour(def.colour);
+  }
+  c->led_set_effect(def.effect, def.period);
+  for (auto& command : def.commands) {
+    if (command.function != nullptr) {
+      c->command_add_entry(command.function,
+                           (uint16_t)Settings::get(command.period));
+    }
+  }
+  if (def.tone != 0) {
+    ArduinoInterface::tone(CFG::buzzer_pin, def.tone);
   }
-  return instance_;
-}
-
-
-void StandbyState::start(RadarContext *c) {
-  led_set_colour(c, LEDColour::GREEN);
-  led_set_pulse(c, 5);
-  c->lcd_clear();
-  c->lcd_setCursor(0,0);
-  c->lcd_print("Standby");
-
-  auto command = DoPIRCheck::instance(c);
-  command_add_entry(c, command, 250);
-
-  command = DoLEDPulse::instance(c);
-  command_add_entry(c, command, 33);
 }
 
-void StandbyState::update(RadarContext *c, uint32_t input) {
-  if (input) {
-    auto command = DoPIRCheck::instance(c);
-    command_remove_entry(c, command);
+void RadarState::stop(RadarContext *c, RadarStateId s) {
+  StateDef def = state_def(s);
 
-    command = DoLEDPulse::instance(c);
-    command_remove_entry(c, command);
-
-    auto state = SensingState::instance();
-    c->lcd_clear();
-    change_state(c, state);
-    c->start();
+  if (def.tone != 0) {
+    ArduinoInterface::noTone(CFG::buzzer_pin);
   }
-}
-void StandbyState::delete_instance() {
-  delete instance_;
-  instance_ = nullptr;
-}
-
-/* * * * * * * * *
- * SensingState  *
- * * * * * * * * *
- */
-RadarState *SensingState::instance() {
-  if (instance_ == nullptr) {
-    instance_ = new SensingState;
+  for (auto& command : def.commands) {
+    if (command.function != nullptr) {
+      c->command_remove_entry(command.function);
+    }
+  }
+  if (def.parent != RadarStateId::NONE) {
+    StateDef parent_def = state_def(def.parent);
+    c->led_set_effect(parent_def.effect, parent_def.period);
   }
-  return instance_;
 }
 
-void SensingState::start(RadarContext *c) {
-  auto command = DoMove::instance(c);
-  command_add_entry(c, command, 25);
-
-  command = DoPing::instance(c);
-  command_add_entry(c, command, 550);
-
+RadarStateId RadarState::parent(RadarStateId s) {
+  return state_def(s).parent;
 }
-void SensingState::update(RadarContext *c, uint32_t distance) {
-  using namespace CFG;
-
-  if (distance < distance_warning) {
-    set_timer(c);
-    led_set_colour(c, LEDColour::RED);
-    change_warning(c);
-  } else if (distance < distance_red) {
-    set_timer(c);
-    led_set_colour(c, LEDColour::RED);
-  } else if (distance < distance_yellow) {
-    set_timer(c);
-    led_set_colour(c, LEDColour::YELLOW);
-  } else {
-    led_set_colour(c, LEDColour::GREEN);
 
-    uint32_t time = ArduinoInterface::millis();
-    uint32_t last_time = get_timer(c);
-    // if more than 30s have passed
-    if (time - last_time >= standby_timeout) {
-      change_standby(c);
+RadarStateId RadarState::next_state(RadarStateId s, StateEvent event) {
+  for (auto& entry : transition_table) {
+    Transition t;
+    memcpy_P(&t, &entry, sizeof(t));
+    if (t.from == s && t.event == event) {
+      return t.to;
     }
   }
+  return s;
+}
+
+StateEvent RadarState::react(RadarContext *c, RadarStateId s, uint32_t input) {
+  switch (s) {
+    case RadarStateId::STANDBY:
+      return standby_react(c, input);
+    case RadarStateId::SENSING:
+      return sensing_react(c, input);
+    case RadarStateId::WARNING:
+      return warning_react(c, input);
+    default:
+      return StateEvent::NONE;
+  }
 }
 
-void SensingState::change_standby(RadarContext *c) {
-  auto command = DoMove::instance(c);
-  command_remove_entry(c, command);
+/*
+ * Update
+ *
+ * Moving into a child state (SENSING -> WARNING) doesn't leave the parent, and
+ * moving back out to the parent (WARNING -> SENSING) doesn't enter it again,
+ * so the radar keeps sweeping throughout. Entry actions are run through the
+ * context's start() rather than directly.
+ */
+void RadarState::update(RadarContext *c, RadarStateId s, uint32_t input) {
+  StateEvent event = react(c, s, input);
+  if (event == StateEvent::NONE) {
+    return;
+  }
 
-  command = DoPing::instance(c);
-  command_remove_entry(c, command);
+  RadarStateId next = next_state(s, event);
+  if (next == s) {
+    return;
+  }
 
-  auto state = StandbyState::instance();
-  change_state(c, state);
-  c->start();
-}
-void SensingState::change_warning(RadarContext *c) {
-  auto state = WarningState::instance();
-  change_state(c, state);
-  c->start();
-}
-void SensingState::delete_instance() {
-  delete instance_;
-  instance_ = nullptr;
-}
+  RadarStateId s_parent = parent(s);
+  bool into_child = parent(next) == s;
+  bool to_parent = s_parent == next;
 
-/* * * * * * * * *
- * WarningState  *
- * * * * * * * * *
- */
-RadarState *WarningState::instance() {
-  if (instance_ == nullptr) {
-    instance_ = new WarningState;
+  if (!into_child) {
+    stop(c, s);
+    if (!to_parent && s_parent != RadarStateId::NONE) {
+      stop(c, s_parent);
+    }
   }
-  return instance_;
-}
 
-void WarningState::start(RadarContext *c) {
-  led_set_pulse(c, 12);
-  led_set_colour(c, LEDColour::RED);
+  c->change_state(next);
 
-  auto command = DoLEDPulse::instance(c);
-  command_add_entry(c, command, 10);
-  ArduinoInterface::tone(CFG::buzzer_pin, 500);
+  if (!to_parent) {
+    c->start();
+  }
 }
 
-void WarningState::update(RadarContext *c, uint32_t distance) {
-  if (distance >= CFG::distance_warning) {
-    ArduinoInterface::noTone(CFG::buzzer_pin);
-
-    auto command = DoLEDPulse::instance(c);
-    command_remove_entry(c, command);
+StateEvent RadarState::standby_react(RadarContext *c, uint32_t input) {
+  if (!input) {
+    return StateEvent::NONE;
+  }
+  // the PIR has just seen something, so SENSING has its full timeout to find
+  // it. Otherwise, after a while in standby, the first ping times it out.
+  c->set_timer();
+  return StateEvent::MOTION;
+}
+
+StateEvent RadarState::sensing_react(RadarContext *c, uint32_t distance) {
+  using S = Settings;
+  using Id = Settings::Id;
+
+  if (distance < S::get(Id::DISTANCE_WARNING)) {
+    c->set_timer();
+    c->led_set_colour(LEDColour::RED);
+    return StateEvent::TOO_CLOSE;
+  } else if (distance < S::get(Id::DISTANCE_RED)) {
+    c->set_timer();
+    c->led_set_colour(LEDColour::RED);
+  } else if (distance < S::get(Id::DISTANCE_ORANGE)) {
+    c->set_timer();
+    c->led_set_colour(LEDColour::ORANGE);
+  } else if (distance < S::get(Id::DISTANCE_YELLOW)) {
+    c->set_timer();
+    c->led_set_colour(LEDColour::YELLOW);
+  } else {
+    // seen, but too far off to keep us out of standby
+    c->led_set_colour((distance < S::get(Id::DISTANCE_GREEN))
+                          ? LEDColour::LIME
+                          : LEDColour::GREEN);
 
-    auto state = SensingState::instance();
-    change_state(c, state);
+    uint32_t time = ArduinoInterface::millis();
+    uint32_t last_time = c->get_timer();
+    // if nothing has been in range for a while
+    if (time - last_time >= S::get(Id::STANDBY_TIMEOUT)) {
+      return StateEvent::TIMEOUT;
+    }
   }
+  return StateEvent::NONE;
 }
-void WarningState::delete_instance() {
-  delete instance_;
-  instance_ = nullptr;
+
+StateEvent RadarState::warning_react(RadarContext *, uint32_t distance) {
+  return (distance >= Settings::get(Settings::Id::DISTANCE_WARNING))
+             ? StateEvent::CLEAR
+             : StateEvent::NONE;
 }
@@ -0,0 +1,199 @@
+#include <Settings.h>
+#include <RadarState.h>
+
+namespace {
+
+using Id = Settings::Id;
+
+/*
+ * Settings table
+ *
+ * One Entry per Settings::Id, in the same order. Lives in flash, and is
+ * worked out at compile time, defaults and all.
+ */
+constexpr Settings::Entry table[] PROGMEM {
+    {"distance_warning", CFG::distance_warning, 0, 4000},
+    {"distance_red", CFG::distance_red, 0, 4000},
+    {"distance_orange", CFG::distance_orange, 0, 4000},
+    {"distance_yellow", CFG::distance_yellow, 0, 4000},
+    {"distance_green", CFG::distance_green, 0, 4000},
+    {"standby_timeout", CFG::standby_timeout, 1000, 3600000},
+    {"move_ms", CFG::move_ms, 10, 1000},
+    // the echo can take this long, see RadarContext::radar_ping()
+    {"ping_ms", CFG::ping_ms, 500, 10000},
+    {"pir_check_ms", CFG::pir_check_ms, 50, 5000},
+    {"lcd_flush_ms", CFG::lcd_flush_ms, 20, 1000},
+    {"lcd_graph_ms", CFG::lcd_graph_ms, 50, 5000},
+};
+
+static_assert(sizeof(table) / sizeof(table[0]) == Settings::count,
+              "table needs one entry per Settings::Id");
+
+const uint8_t magic[2] {'R', 'S'};
+
+// where the checksum goes, after the header and values
+constexpr uint16_t checksum_at {Settings::stored_size - 2};
+
+Settings::Entry entry_of(uint8_t i) {
+  Settings::Entry entry;
+  memcpy_P(&entry, &table[i], sizeof(entry));
+  return entry;
+}
+
+// the byte save() writes at address, from the header and values
+uint8_t stored_byte(uint16_t address) {
+  switch (address) {
+    case 0:
+    case 1:
+      return magic[address];
+    case 2:
+      return Settings::version;
+    case 3:
+      return Settings::count;
+    default:
+      address -= Settings::header_size;
+      return (uint8_t)(Settings::get((Id)(address / 4)) >> (address % 4 * 8));
+  }
+}
+
+// Fletcher-16 of what's in EEPROM before the checksum
+uint16_t eeprom_checksum() {
+  uint16_t sum1 = 0, sum2 = 0;
+  for (uint16_t address = 0; address < checksum_at; ++address) {
+    sum1 = (sum1 + ArduinoInterface::eeprom_read(address)) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return (uint16_t)(sum2 << 8 | sum1);
+}
+
+/*
+ * Range In
+ *
+ * What setting i can be, with the rest as they are in values. A distance
+ * has to be more than the one before it and less than the one after.
+ */
+Settings::Range range_in(const Settings::Values& values, uint8_t i) {
+  Settings::Entry e = entry_of(i);
+  Settings::Range range {e.min, e.max};
+  constexpr uint8_t nearest = (uint8_t)Id::DISTANCE_WARNING;
+  constexpr uint8_t furthest = (uint8_t)Id::DISTANCE_GREEN;
+  if (i > nearest && i <= furthest) {
+    uint32_t before = values.values[i - 1] + 1;
+    range.min = before > range.min ? before : range.min;
+  }
+  if (i >= nearest && i < furthest && values.values[i + 1] > 0) {
+    uint32_t after = values.values[i + 1] - 1;
+    range.max = after < range.max ? after : range.max;
+  }
+  return range;
+}
+
+// a constant expression, so the AVR copies it in at start up like any
+// other initialised data, and there's no code to run
+constexpr Settings::Values default_values() {
+  Settings::Values v {};
+  for (uint8_t i = 0; i < Settings::count; ++i) {
+    v.values[i] = table[i].value;
+  }
+  return v;
+}
+
+} // namespace
+
+INSTANCE_LOCAL Settings::Values Settings::values_ {default_values()};
+
+void Settings::put_(Id id, uint32_t value) {
+  if (values_.values[(uint8_t)id] != value) {
+    values_.values[(uint8_t)id] = value;
+    changed_ |= (uint16_t)(1 << (uint8_t)id);
+  }
+}
+
+bool Settings::set(Id id, uint32_t value) {
+  if (id >= Id::COUNT) {
+    return false;
+  }
+  Range r = range(id);
+  if (value < r.min || value > r.max) {
+    return false;
+  }
+  put_(id, value);
+  return true;
+}
+
+Settings::Range Settings::range(Id id) {
+  return range_in(values_, (uint8_t)id);
+}
+
+Settings::Entry Settings::entry(Id id) {
+  return entry_of((uint8_t)id);
+}
+
+Settings::Id Settings::find(const char* name) {
+  for (uint8_t i = 0; i < count; ++i) {
+    if (strcmp(name, entry_of(i).name) == 0) {
+      return (Id)i;
+    }
+  }
+  return Id::COUNT;
+}
+
+void Settings::defaults() {
+  for (uint8_t i = 0; i < count; ++i) {
+    put_((Id)i, entry_of(i).value);
+  }
+}
+
+bool Settings::load() {
+  using AI = ArduinoInterface;
+
+  for (uint16_t address = 0; address < header_size; ++address) {
+    if (AI::eeprom_read(address) != stored_byte(address)) {
+      return false;
+    }
+  }
+  // widened first, a uint8_t shifts as a 16 bit int on the AVR
+  uint16_t checksum = AI::eeprom_read(checksum_at)
+                      | (uint16_t)AI::eeprom_read(checksum_at + 1) << 8;
+  if (eeprom_checksum() != checksum) {
+    return false;
+  }
+
+  // all of them checked before any are used, so it's the lot or nothing
+  Values loaded;
+  for (uint8_t i = 0; i < count; ++i) {
+    uint32_t value = 0;
+    for (uint8_t b = 0; b < 4; ++b) {
+      value |= (uint32_t)AI::eeprom_read(header_size + i * 4 + b) << (b * 8);
+    }
+    loaded.values[i] = value;
+  }
+  // each against the others as they'd be, so the distances are in order too
+  for (uint8_t i = 0; i < count; ++i) {
+    Range r = range_in(loaded, i);
+    if (loaded.values[i] < r.min || loaded.values[i] > r.max) {
+      return false;
+    }
+  }
+  for (uint8_t i = 0; i < count; ++i) {
+    put_((Id)i, loaded.values[i]);
+  }
+  return true;
+}
+
+void Settings::save() {
+  using AI = ArduinoInterface;
+
+  for (uint16_t address = 0; address < checksum_at; ++address) {
+    AI::eeprom_update(address, stored_byte(address));
+  }
+  uint16_t checksum = eeprom_checksum();
+  AI::eeprom_update(checksum_at, (uint8_t)checksum);
+  AI::eeprom_update(checksum_at + 1, (uint8_t)(checksum >> 8));
+}
+
+uint16_t Settings::take_changed() {
+  uint16_t changed = changed_;
+  changed_ = 0;
+  return changed;
+}
@@ -4,25 +4,80 @@
 #include <RadarState.h>
 #include <LiquidCrystal.h>
 
-RadarContext* context;
+INSTANCE_LOCAL RadarContext* context;
+
+#if defined(TRACE_RECORD) || defined(PROFILE)
+// a trace is a few hundred bytes a second while sweeping, too much for 9600,
+// and a profile dump would hold the radar up for a second at it
+const unsigned long baud {115200};
+#else
+const unsigned long baud {9600};
+#endif // TRACE_RECORD, PROFILE
 
 void setup() {
-  Serial.begin(9600);
-  context = new RadarContext;
-  context->init();
+  Serial.begin(baud);
+#ifdef TRACE_RECORD
+  TraceRecorder::start();
+#endif // TRACE_RECORD
+#ifdef PROFILE
+  Profiler::clear();
+#endif // PROFILE
+#ifdef TELEMETRY
+  TelemetrySender::start();
+#endif // TELEMETRY
+#ifdef CONSOLE
+  Console::reset();
+#endif // CONSOLE
+  Memory::clear();
+#ifdef MEMORY_STATS
+  // before anything's on the heap, so all of it is counted against the stack
+  Memory::paint();
+#endif // MEMORY_STATS
+  // the saved settings, if there are any, before anything uses them. The
+  // defaults first, as on the host a run before this one on the same thread
+  // may have changed them, and they're what a power on starts with.
+  Settings::defaults();
+  Settings::load();
+  context = new (Memory::heap) RadarContext;
+  // without it there's nothing to run, Memory::stats() counts why
+  if (context != nullptr) {
+    context->init();
+  }
 }
 
 void loop() {
 
 uint32_t next_time {0};
 
-  next_time = context->execute_current_entry();
-  uint32_t current_time = millis();
+  if (context == nullptr) {
+    return;
+  }
 
-  // make sure we don't underflow next_time
-  next_time -= (current_time < next_time) ? current_time : next_time;
+  next_time = context->execute_current_entry();
 
-  delay(next_time);
+  // feed the LCD until the next command is due, rather than sitting in delay()
+  while ((int32_t)(next_time - millis()) > 0) {
+    context->lcd_poll();
+#ifdef TRACE_RECORD
+    // only as much as Serial can take without waiting
+    uint8_t byte;
+    while (Serial.availableForWrite() > 0 && TraceRecorder::read(byte)) {
+      Serial.write(byte);
+    }
+#endif // TRACE_RECORD
+#ifdef CONSOLE
+    // the same for telemetry, which has Serial when a trace doesn't, and the
+    // console's replies. Whatever telemetry had left goes out first when the
+    // console takes over, and the console's last reply when it hands back.
+    uint8_t byte;
+    while (Serial.availableForWrite() > 0
+           && (Console::active()
+               ? TelemetrySender::read(byte) || Console::read(byte)
+               : Console::read(byte) || TelemetrySender::read(byte))) {
+      Serial.write(byte);
+    }
+#endif // CONSOLE
+  }
 }
 
 
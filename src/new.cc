@@ -1,19 +1,43 @@
 //
 // Created by Nicholas Ives on 13/04/2020.
 //
-//#include <stdlib.h>
-#include <new.h>
+#include <Memory.h>
+#include <stdlib.h>
 
-//volatile uint32_t current_alloc, max_alloc;
+namespace {
 
-void *operator new(size_t size, unsigned int) {
+// the size goes in front of each allocation, as free() won't say, padded so
+// what comes after is still aligned
+const size_t header {alignof(max_align_t) > sizeof(size_t)
+                         ? alignof(max_align_t) : sizeof(size_t)};
 
-  /*++current_alloc;
-  max_alloc = (max_alloc < current_alloc ) ? current_alloc : max_alloc;*/
-  return malloc(size);
+} // namespace
+
+void* operator new(size_t size, Memory::Heap) noexcept {
+#ifdef UNIT_TEST
+  if (Memory::take_failure()) {
+    Memory::failed();
+    return nullptr;
+  }
+#endif // UNIT_TEST
+  uint8_t* block = (size <= SIZE_MAX - header)
+                       ? (uint8_t*)malloc(size + header) : nullptr;
+  if (block == nullptr) {
+    Memory::failed();
+    return nullptr;
+  }
+
+  *(size_t*)block = size;
+  Memory::allocated(size);
+  return block + header;
 }
 
-void operator delete(void * ptr, unsigned int) {
-  free(ptr);
-  //--current_alloc;
-}
\ No newline at end of file
+void operator delete(void* ptr, Memory::Heap) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  uint8_t* block = (uint8_t*)ptr - header;
+  Memory::released(*(size_t*)block);
+  free(block);
+}
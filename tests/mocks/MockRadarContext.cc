@@ -10,6 +10,4 @@
 
 MockRadarContext::MockRadarContext() {}
 MockRadarContext::~MockRadarContext() {}
-MockRadarState::MockRadarState() {}
-MockRadarState::~MockRadarState() {}
 
@@ -5,28 +5,26 @@
 #include <gmock/gmock.h>
 #include <CommandQueue.h>
 #include <ArduinoInterface.h>
+#include <Memory.h>
 
 //void function_a();
 //void function_b();
 bool a_result = false;
 bool b_result = false;
+void* last_context = nullptr;
 
-class FunctorA : public FunctionObject {
- public:
-  void operator()() {
-    a_result = true;
-  }
-};
+void function_a(void* context) {
+  a_result = true;
+  last_context = context;
+}
 
-class FunctorB : public FunctionObject {
- public:
-  void operator()() {
-    b_result = true;
-  }
-};
+void function_b(void* context) {
+  b_result = true;
+}
 
-FunctorA function_a;
-FunctorB function_b;
+// the same functions can be queued more than once with different contexts
+int context_a;
+int context_b;
 
  class CommandQueueEntryTest : public ::testing::Test {
  protected:
@@ -37,8 +35,10 @@ FunctorB function_b;
   uint8_t frequency_a_ = 5;
   uint8_t frequency_b_ = 15;
 
-  CommandQueueEntry command_a {&function_a, call_time_a_, frequency_a_};
-  CommandQueueEntry command_b {&function_b, call_time_b_, frequency_b_};
+  CommandQueueEntry command_a {function_a, &context_a, call_time_a_,
+                               frequency_a_};
+  CommandQueueEntry command_b {function_b, &context_a, call_time_b_,
+                               frequency_b_};
 
 };
 
@@ -56,6 +56,7 @@ class CommandQueueTest : public CommandQueueEntryTest {
   ~CommandQueueTest() {
     a_result = false;
     b_result = false;
+    last_context = nullptr;
   }
 };
 
@@ -72,7 +73,7 @@ TEST_F(CommandQueueTest, TestAddAndExecute) {
       .Times(2)
       .WillRepeatedly(Return(millis_time));;
 
-  queue_.add_entry(&function_a, frequency_a_);
+  queue_.add_entry(function_a, &context_a, frequency_a_);
   returned_time = queue_.execute_current_entry();
 
   ASSERT_EQ(a_result, true);
@@ -94,12 +95,12 @@ TEST_F(CommandQueueTest, TestMultipleAddAndExecute) {
   ON_CALL(mock_arduino_, millis())
       .WillByDefault(Return(millis_time_a));
 
-  queue_.add_entry(&function_a, frequency_a_);
+  queue_.add_entry(function_a, &context_a, frequency_a_);
 
   ON_CALL(mock_arduino_, millis())
       .WillByDefault(Return(millis_time_b));
 
-  queue_.add_entry(&function_b, frequency_b_);
+  queue_.add_entry(function_b, &context_a, frequency_b_);
 
   ON_CALL(mock_arduino_, millis())
       .WillByDefault(Return(millis_time_c));
@@ -126,10 +127,10 @@ TEST_F(CommandQueueTest, TestAddAndRemove) {
       .Times(4)
       .WillRepeatedly(Return(millis_time));
 
-  queue_.add_entry(&function_a, frequency_a_);
-  queue_.add_entry(&function_b, frequency_b_);
+  queue_.add_entry(function_a, &context_a, frequency_a_);
+  queue_.add_entry(function_b, &context_a, frequency_b_);
 
-  queue_.remove_entry(&function_a);
+  queue_.remove_entry(function_a, &context_a);
 
   returned_time = queue_.execute_current_entry();
   ASSERT_EQ(returned_time, millis_time + frequency_b_);
@@ -145,8 +146,8 @@ TEST_F(CommandQueueTest, TestClearQueue) {
   EXPECT_CALL(mock_arduino_, millis())
       .Times(2);
 
-  queue_.add_entry(&function_a, frequency_a_);
-  queue_.add_entry(&function_b, frequency_b_);
+  queue_.add_entry(function_a, &context_a, frequency_a_);
+  queue_.add_entry(function_b, &context_a, frequency_b_);
 
   queue_.clear_queue();
 
@@ -156,6 +157,150 @@ TEST_F(CommandQueueTest, TestClearQueue) {
   ASSERT_EQ(time, zero);
 }
 
+// each entry gets called with the context it was added with, and removing
+// one doesn't remove the other
+TEST_F(CommandQueueTest, TestContext) {
+  using ::testing::Return;
+
+  EXPECT_CALL(mock_arduino_, millis())
+      .WillRepeatedly(Return(100));
+
+  queue_.add_entry(function_a, &context_a, 10);
+  queue_.add_entry(function_a, &context_b, 20);
+
+  queue_.execute_current_entry();
+  ASSERT_EQ(last_context, &context_a);
+
+  queue_.remove_entry(function_a, &context_a);
+  queue_.execute_current_entry();
+  ASSERT_EQ(last_context, &context_b);
+  queue_.execute_current_entry();
+  ASSERT_EQ(last_context, &context_b);
+}
+
+/*
+ * Scan counting tests
+ *
+ * Working out which command is next means walking the whole list. It should
+ * only need doing at most once per command run, even when the commands run
+ * are changed in between, as happens on a state change.
+ */
+
+TEST_F(CommandQueueTest, TestOneScanPerExecute) {
+  using ::testing::Return;
+
+  EXPECT_CALL(mock_arduino_, millis())
+      .WillRepeatedly(Return(100));
+
+  queue_.add_entry(function_a, &context_a, frequency_a_);
+  queue_.add_entry(function_b, &context_a, frequency_b_);
+  ASSERT_EQ(queue_.scans(), 0u); // adding doesn't need a scan
+
+  for (uint32_t i = 1; i <= 5; ++i) {
+    queue_.execute_current_entry();
+    ASSERT_EQ(queue_.scans(), i);
+  }
+}
+
+// swap every command for new ones between running and asking for the next,
+// like going from standby to sensing
+TEST_F(CommandQueueTest, TestOneScanPerTransition) {
+  using ::testing::Return;
+
+  EXPECT_CALL(mock_arduino_, millis())
+      .WillRepeatedly(Return(100));
+
+  queue_.add_entry(function_a, &context_a, frequency_a_);
+  queue_.add_entry(function_b, &context_a, frequency_b_);
+
+  queue_.run_current_entry();
+  queue_.remove_entry(function_a, &context_a);
+  queue_.remove_entry(function_b, &context_a);
+  queue_.add_entry(function_a, &context_b, 25);
+  queue_.add_entry(function_b, &context_b, 10);
+
+  // the queue was emptied then refilled, so it already knows b is next
+  ASSERT_EQ(queue_.next_call_time(), 110u);
+  ASSERT_EQ(queue_.scans(), 0u);
+}
+
+// remove one command and keep the one that just ran, like leaving warning for
+// sensing. The command that ran must have its call time saved, or it would be
+// due again straight away.
+TEST_F(CommandQueueTest, TestRemoveAfterRunKeepsCallTime) {
+  using ::testing::Return;
+  using ::testing::ReturnRoundRobin;
+
+  EXPECT_CALL(mock_arduino_, millis())
+      .WillRepeatedly(ReturnRoundRobin<uint32_t>({0, 0, 50}));
+
+  queue_.add_entry(function_a, &context_a, frequency_a_);  // due at 5
+  queue_.add_entry(function_b, &context_a, frequency_b_);  // due at 15
+
+  queue_.run_current_entry();                   // runs a at 50
+  ASSERT_EQ(a_result, true);
+  queue_.remove_entry(function_b, &context_a);
+
+  ASSERT_EQ(queue_.next_call_time(), 50u + frequency_a_);
+  ASSERT_EQ(queue_.scans(), 1u);
+}
+
+// a new period counts from when the command last ran
+TEST_F(CommandQueueTest, TestReschedule) {
+  using ::testing::Return;
+
+  EXPECT_CALL(mock_arduino_, millis())
+      .WillRepeatedly(Return(100));
+
+  queue_.add_entry(function_a, &context_a, frequency_a_);  // due at 105
+  queue_.add_entry(function_b, &context_a, frequency_b_);  // due at 115
+  ASSERT_EQ(queue_.next_call_time(), 105u);
+
+  ASSERT_TRUE(queue_.reschedule(function_a, &context_a, 30));
+  ASSERT_EQ(queue_.next_call_time(), 115u);
+
+  ASSERT_TRUE(queue_.reschedule(function_b, &context_a, 2));
+  ASSERT_EQ(queue_.next_call_time(), 102u);
+  queue_.run_current_entry();
+  ASSERT_EQ(b_result, true);
+  ASSERT_EQ(a_result, false);
+}
+
+TEST_F(CommandQueueTest, TestRescheduleNotQueued) {
+  using ::testing::Return;
+
+  EXPECT_CALL(mock_arduino_, millis())
+      .WillRepeatedly(Return(100));
+
+  queue_.add_entry(function_a, &context_a, frequency_a_);
+
+  ASSERT_FALSE(queue_.reschedule(function_b, &context_a, 30));
+  ASSERT_FALSE(queue_.reschedule(function_a, &context_b, 30));
+  ASSERT_EQ(queue_.next_call_time(), 105u);
+}
+
+// a command there isn't the memory for isn't queued, and the queue carries
+// on without it
+TEST_F(CommandQueueTest, TestAddWithHeapFull) {
+  using ::testing::Return;
+
+  EXPECT_CALL(mock_arduino_, millis())
+      .WillRepeatedly(Return(100));
+
+  Memory::fail_next(1);
+  queue_.add_entry(function_a, &context_a, frequency_a_);
+  ASSERT_EQ(queue_.execute_current_entry(), 0u);
+  ASSERT_EQ(a_result, false);
+
+  queue_.add_entry(function_b, &context_a, frequency_b_);
+  Memory::fail_next(1);
+  queue_.add_entry(function_a, &context_a, frequency_a_);
+  ASSERT_EQ(queue_.execute_current_entry(), 100u + frequency_b_);
+  ASSERT_EQ(b_result, true);
+  ASSERT_EQ(a_result, false);
+  Memory::clear();
+}
+
 // CommandQueueEntry comparison tests
 
 TEST_F(CommandQueueEntryTest, TestCompareEqual) {
@@ -167,6 +312,12 @@ TEST_F(CommandQueueEntryTest, TestCompareNotEqual) {
   ASSERT_NE(command_a, command_b);
 }
 
+TEST_F(CommandQueueEntryTest, TestCompareContext) {
+  CommandQueueEntry command_a_b {function_a, &context_b, call_time_a_,
+                                 frequency_a_};
+  ASSERT_NE(command_a, command_a_b);
+}
+
 TEST_F(CommandQueueEntryTest, TestCompareLessThanOrEqual) {
   ASSERT_LE(command_a, command_b);
 }
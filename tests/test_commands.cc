@@ -9,25 +9,13 @@
  class CommandsTest : public ::testing::Test {
   protected:
   MockRadarContext mock_radar_context_;
-
-  CommandsTest() {
-    RadarAction::context_ = &mock_radar_context_;
-  }
-  ~CommandsTest() {
-    RadarAction::context_ = nullptr;
-  }
 };
 
 TEST_F(CommandsTest, DoMoveTest) {
-
-  auto command = DoMove::instance(&mock_radar_context_);
-
   EXPECT_CALL(mock_radar_context_, radar_move())
       .Times(1);
 
-  (*command)();
-
-  DoMove::delete_instance();
+  Commands::move(&mock_radar_context_);
 }
 
 TEST_F(CommandsTest, DoPingTest) {
@@ -37,9 +25,6 @@ TEST_F(CommandsTest, DoPingTest) {
 
   uint32_t r_value {300};
 
-  auto command = DoPing::instance(&mock_radar_context_);
-
-
   EXPECT_CALL(mock_radar_context_, radar_ping())
       .Times(1)
       .WillRepeatedly(Return(r_value));
@@ -48,18 +33,19 @@ TEST_F(CommandsTest, DoPingTest) {
       .Times(1);
 
   EXPECT_CALL(mock_radar_context_, lcd_print(Matcher<const char *>(_)))
-      .Times(2);
-
-  EXPECT_CALL(mock_radar_context_, lcd_print(r_value))
       .Times(1);
 
-  EXPECT_CALL(mock_radar_context_, update(r_value))
+  EXPECT_CALL(mock_radar_context_, lcd_print(r_value, 6))
       .Times(1);
 
+  EXPECT_CALL(mock_radar_context_, post_event(r_value))
+      .Times(1);
 
-  (*command)();
+  // the state mustn't change while the command queue is running us
+  EXPECT_CALL(mock_radar_context_, update(_))
+      .Times(0);
 
-  DoPing::delete_instance();
+  Commands::ping(&mock_radar_context_);
 }
 
 TEST_F(CommandsTest, DoPingOutOfRangeTest) {
@@ -69,9 +55,6 @@ TEST_F(CommandsTest, DoPingOutOfRangeTest) {
 
   uint32_t r_value {UINT32_MAX};
 
-  auto command = DoPing::instance(&mock_radar_context_);
-
-
   EXPECT_CALL(mock_radar_context_, radar_ping())
       .Times(1)
       .WillRepeatedly(Return(r_value));
@@ -82,13 +65,11 @@ TEST_F(CommandsTest, DoPingOutOfRangeTest) {
   EXPECT_CALL(mock_radar_context_, lcd_print(Matcher<const char *>(_)))
       .Times(2);
 
-  EXPECT_CALL(mock_radar_context_, update(r_value))
+  EXPECT_CALL(mock_radar_context_, post_event(r_value))
       .Times(1);
 
 
-  (*command)();
-
-  DoPing::delete_instance();
+  Commands::ping(&mock_radar_context_);
 }
 
 // check PIR sensor returns LOW and state does not change
@@ -100,19 +81,15 @@ TEST_F(CommandsTest, DoPIRCheckNull) {
   MockArduinoClass mock_arduino_class;
   MockArduino::mock = &mock_arduino_class;
 
-  auto command = DoPIRCheck::instance(&mock_radar_context_);
-
-  // make sure update is NOT called
-  EXPECT_CALL(mock_radar_context_, update(_))
+  // make sure no input is posted
+  EXPECT_CALL(mock_radar_context_, post_event(_))
       .Times(0);
 
   EXPECT_CALL(mock_arduino_class, digitalRead(_))
       .Times(1)
       .WillRepeatedly(Return(LOW));
 
-  (*command)();
-
-  DoPing::delete_instance();
+  Commands::pir_check(&mock_radar_context_);
 }
 
 // Check PIR sensor returns HIGH and state changes
@@ -124,28 +101,21 @@ TEST_F(CommandsTest, DoPIRCheck) {
   MockArduinoClass mock_arduino_class;
   MockArduino::mock = &mock_arduino_class;
 
-  auto command = DoPIRCheck::instance(&mock_radar_context_);
-
-  // make sure update is NOT called
-  EXPECT_CALL(mock_radar_context_, update(_))
+  // make sure an input is posted
+  EXPECT_CALL(mock_radar_context_, post_event(_))
       .Times(1);
 
   EXPECT_CALL(mock_arduino_class, digitalRead(_))
       .Times(1)
       .WillRepeatedly(Return(HIGH));
 
-  (*command)();
-
-  DoPIRCheck::delete_instance();
+  Commands::pir_check(&mock_radar_context_);
 }
 
 
-TEST_F(CommandsTest, DoLEDPulseTest) {
-
-  auto command = DoLEDPulse::instance(&mock_radar_context_);
-
-  EXPECT_CALL(mock_radar_context_, led_pulse())
+TEST_F(CommandsTest, LCDFlushTest) {
+  EXPECT_CALL(mock_radar_context_, lcd_flush())
       .Times(1);
 
-  (*command)();
+  Commands::lcd_flush(&mock_radar_context_);
 }
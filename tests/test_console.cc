@@ -0,0 +1,167 @@
+#include <gmock/gmock.h>
+#include <Console.h>
+#include <RadarState.h>
+
+#include <cstring>
+#include <string>
+
+using Id = Settings::Id;
+
+class ConsoleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::memset(MockArduino::eeprom, 0xff, sizeof(MockArduino::eeprom));
+    Console::reset();
+  }
+
+  void TearDown() override {
+    Settings::defaults();
+    Settings::take_changed();
+    Console::reset();
+  }
+
+  // feed text as Commands::console would, a byte at a time while there's
+  // room, then take the replies
+  std::string type(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+      while (!Console::ready()) {
+        out += read_all();
+        Console::poll();
+      }
+      Console::feed((uint8_t)c);
+    }
+    Console::poll();
+    out += read_all();
+    while (!Console::ready()) {
+      Console::poll();
+      out += read_all();
+    }
+    return out;
+  }
+
+  std::string read_all() {
+    std::string out;
+    uint8_t byte;
+    while (Console::read(byte)) {
+      out += (char)byte;
+    }
+    return out;
+  }
+};
+
+TEST_F(ConsoleTest, TestGet) {
+  ASSERT_FALSE(Console::active());
+  ASSERT_EQ(type("get ping_ms\r\n"), "ping_ms=550\r\n");
+  ASSERT_TRUE(Console::active());
+  // \r, \n or both, and spaces anywhere between words
+  ASSERT_EQ(type("  get   standby_timeout \n"), "standby_timeout=10000\r\n");
+  ASSERT_EQ(type("get distance_warning\r"), "distance_warning=60\r\n");
+}
+
+TEST_F(ConsoleTest, TestSet) {
+  ASSERT_EQ(type("set ping_ms 1000\r\n"), "ping_ms=1000\r\n");
+  ASSERT_EQ(Settings::get(Id::PING_MS), 1000u);
+  ASSERT_EQ(Settings::take_changed(), 1 << (uint8_t)Id::PING_MS);
+
+  ASSERT_EQ(type("set ping_ms 10\r\n"), "error: 500 to 10000\r\n");
+  ASSERT_EQ(type("set ping_ms 1e3\r\n"), "error: not a number\r\n");
+  ASSERT_EQ(type("set ping_ms -1\r\n"), "error: not a number\r\n");
+  ASSERT_EQ(type("set ping_ms 99999999999\r\n"), "error: not a number\r\n");
+  ASSERT_EQ(Settings::get(Id::PING_MS), 1000u);
+}
+
+// the range given is what the distance can be between its neighbours
+TEST_F(ConsoleTest, TestSetDistanceOrder) {
+  ASSERT_EQ(type("set distance_warning 300\r\n"), "error: 0 to 299\r\n");
+  ASSERT_EQ(type("set distance_red 60\r\n"), "error: 61 to 449\r\n");
+  ASSERT_EQ(type("set distance_red 61\r\n"), "distance_red=61\r\n");
+}
+
+TEST_F(ConsoleTest, TestErrors) {
+  ASSERT_EQ(type("fly\r\n"), "error: unknown command\r\n");
+  ASSERT_EQ(type("get warp\r\n"), "error: unknown setting\r\n");
+  ASSERT_EQ(type("get\r\n"), "error: wrong number of words\r\n");
+  ASSERT_EQ(type("set ping_ms\r\n"), "error: wrong number of words\r\n");
+  ASSERT_EQ(type("list all of them\r\n"),
+            "error: wrong number of words\r\n");
+  // blank lines are ignored
+  ASSERT_EQ(type("\r\n\r\n   \r\n"), "");
+}
+
+// a line that doesn't fit is thrown away whole, so none of it runs
+TEST_F(ConsoleTest, TestLineTooLong) {
+  std::string line = "set ping_ms 1000";
+  line += std::string(Console::line_size, ' ');
+  ASSERT_EQ(type(line + "\r\n"), "error: line too long\r\n");
+  ASSERT_EQ(Settings::get(Id::PING_MS), CFG::ping_ms);
+
+  ASSERT_EQ(type("get ping_ms\r\n"), "ping_ms=550\r\n");
+}
+
+TEST_F(ConsoleTest, TestBackspace) {
+  ASSERT_EQ(type("get pong\b\b\bing_ms\x7f\x7fms\r\n"), "ping_ms=550\r\n");
+  // control characters other than those are dropped
+  ASSERT_EQ(type("get\t ping_ms\x1b\r\n"), "ping_ms=550\r\n");
+}
+
+// more than the reply buffer holds, so it goes out a few at a time
+TEST_F(ConsoleTest, TestList) {
+  std::string expected;
+  for (uint8_t i = 0; i < Settings::count; ++i) {
+    Settings::Entry entry = Settings::entry((Id)i);
+    expected += std::string(entry.name) + "=" + std::to_string(entry.value)
+                + "\r\n";
+  }
+  expected += "ok\r\n";
+  ASSERT_GT(expected.size(), Console::buffer_size);
+
+  ASSERT_EQ(type("list\r\n"), expected);
+}
+
+// nothing more is taken until list has finished
+TEST_F(ConsoleTest, TestListHoldsInput) {
+  Console::feed('l');
+  Console::feed('i');
+  Console::feed('s');
+  Console::feed('t');
+  Console::feed('\n');
+  ASSERT_FALSE(Console::ready());
+
+  int rounds = 0;
+  while (!Console::ready()) {
+    read_all();
+    Console::poll();
+    ++rounds;
+  }
+  ASSERT_GT(rounds, 1);
+  ASSERT_TRUE(Console::ready());
+}
+
+TEST_F(ConsoleTest, TestSaveLoadDefaults) {
+  ASSERT_EQ(type("load\r\n"), "error: nothing saved\r\n");
+
+  type("set move_ms 40\r\n");
+  ASSERT_EQ(type("save\r\n"), "ok\r\n");
+  ASSERT_EQ(MockArduino::eeprom[0], 'R');
+
+  ASSERT_EQ(type("defaults\r\n"), "ok\r\n");
+  ASSERT_EQ(Settings::get(Id::MOVE_MS), CFG::move_ms);
+
+  ASSERT_EQ(type("load\r\n"), "ok\r\n");
+  ASSERT_EQ(Settings::get(Id::MOVE_MS), 40u);
+}
+
+TEST_F(ConsoleTest, TestHelp) {
+  ASSERT_EQ(type("help\r\n"),
+            "get set list save load defaults exit help\r\n");
+}
+
+// exit's reply ends with a 0, for a telemetry reader to resync on
+TEST_F(ConsoleTest, TestExit) {
+  type("get ping_ms\r\n");
+  ASSERT_TRUE(Console::active());
+
+  ASSERT_EQ(type("exit\r\n"), std::string("ok\r\n", 5));
+  ASSERT_FALSE(Console::active());
+}
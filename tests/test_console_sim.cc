@@ -0,0 +1,161 @@
+#include <gmock/gmock.h>
+#include <SimArduino.h>
+#include <SimFirmware.h>
+#include <SerialPty.h>
+#include <TelemetryDecoder.h>
+
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+using SA = SimArduino;
+using ::testing::HasSubstr;
+
+/*
+ * The firmware as it's built for the device by default, with the console
+ * typed at over a pty as radar_console runs it, but as fast as it'll go.
+ */
+class ConsoleSimTest : public ::testing::Test {
+ protected:
+  SerialPty pty_;
+  int terminal_ {-1};
+  uint64_t pings_ {0};
+
+  void SetUp() override {
+    SA::reset();
+
+    ASSERT_TRUE(pty_.open()) << std::strerror(errno);
+    terminal_ = ::open(pty_.path().c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    ASSERT_GE(terminal_, 0) << std::strerror(errno);
+    watch_pings();
+  }
+
+  void TearDown() override {
+    if (terminal_ >= 0) {
+      ::close(terminal_);
+    }
+  }
+
+  void watch_pings() {
+    SA::watch([this](SA::Output what, uint8_t pin, uint16_t value) {
+      pings_ += what == SA::Output::DIGITAL && pin == CFG::trigger_pin
+                && value == HIGH;
+    });
+  }
+
+  void run_for(uint64_t ms) {
+    uint64_t end = SA::now() + ms * 1000;
+    while (SA::now() < end) {
+      loop();
+      pty_.pump();
+    }
+  }
+
+  void type(const std::string& text) {
+    ASSERT_EQ(::write(terminal_, text.data(), text.size()),
+              (ssize_t)text.size());
+  }
+
+  std::string received() {
+    std::string out;
+    char in[256];
+    ssize_t got;
+    while ((got = ::read(terminal_, in, sizeof(in))) > 0) {
+      out.append(in, (size_t)got);
+    }
+    return out;
+  }
+};
+
+TEST_F(ConsoleSimTest, TestGet) {
+  setup();
+  run_for(1000);
+
+  type("get ping_ms\r\n");
+  run_for(500);
+  ASSERT_THAT(received(), HasSubstr("ping_ms=550\r\n"));
+}
+
+// set takes effect on the command that's already queued
+TEST_F(ConsoleSimTest, TestSetPingRate) {
+  SA::at(0, []() { SA::drive(CFG::ir_pin, HIGH); });
+  setup();
+  // no targets, so keep it from timing out to standby
+  type("set standby_timeout 3600000\r\n");
+  run_for(2000);
+  ASSERT_EQ(context->get_state(), RadarStateId::SENSING);
+
+  pings_ = 0;
+  run_for(11000);
+  ASSERT_GE(pings_, 19u);
+
+  type("set ping_ms 2000\r\n");
+  run_for(2000);
+  pings_ = 0;
+  run_for(11000);
+  ASSERT_LE(pings_, 6u);
+  ASSERT_GE(pings_, 5u);
+  ASSERT_THAT(received(), HasSubstr("ping_ms=2000\r\n"));
+}
+
+// what's saved is there after the power's been off
+TEST_F(ConsoleSimTest, TestSaveSurvivesPowerCycle) {
+  setup();
+  type("set move_ms 40\r\nsave\r\n");
+  run_for(1000);
+  ASSERT_THAT(received(), HasSubstr("move_ms=40\r\nok\r\n"));
+
+  uint8_t eeprom[ArduinoInterface::eeprom_size];
+  std::memcpy(eeprom, SA::eeprom(), sizeof(eeprom));
+  SA::reset();
+  std::memcpy(SA::eeprom(), eeprom, sizeof(eeprom));
+  watch_pings();
+
+  setup();
+  type("get move_ms\r\n");
+  run_for(1000);
+  ASSERT_THAT(received(), HasSubstr("move_ms=40\r\n"));
+}
+
+// what isn't saved is gone, even with the next run on the same thread
+TEST_F(ConsoleSimTest, TestPowerCycleForgetsUnsaved) {
+  setup();
+  type("set ping_ms 2000\r\n");
+  run_for(1000);
+  ASSERT_EQ(Settings::get(Settings::Id::PING_MS), 2000u);
+
+  SA::reset();
+  setup();
+  ASSERT_EQ(Settings::get(Settings::Id::PING_MS), CFG::ping_ms);
+}
+
+// telemetry stops while the console has Serial, and a reader picks it up
+// again after exit
+TEST_F(ConsoleSimTest, TestExitResumesTelemetry) {
+  TelemetryDecoder decoder;
+  auto decode = [&]() {
+    std::string out = received();
+    decoder.feed((const uint8_t*)out.data(), out.size());
+    return out;
+  };
+
+  SA::at(0, []() { SA::drive(CFG::ir_pin, HIGH); });
+  setup();
+  run_for(3000);
+  decode();
+  ASSERT_GT(decoder.rows().size(), 0u);
+
+  type("get ping_ms\r\n");
+  run_for(1000);
+  ASSERT_THAT(decode(), HasSubstr("ping_ms=550\r\n"));
+  size_t rows = decoder.rows().size();
+  run_for(3000);
+  decode();
+  ASSERT_EQ(decoder.rows().size(), rows);
+
+  type("exit\r\n");
+  run_for(3000);
+  decode();
+  ASSERT_GT(decoder.rows().size(), rows + 3);
+}
@@ -0,0 +1,71 @@
+#include <gmock/gmock.h>
+#include <EventQueue.h>
+
+class EventQueueTest : public ::testing::Test {
+ protected:
+  EventQueue<uint32_t, 4> queue_;
+};
+
+TEST_F(EventQueueTest, TestEmpty) {
+  uint32_t event {123};
+
+  ASSERT_TRUE(queue_.empty());
+  ASSERT_FALSE(queue_.pop(event));
+  ASSERT_EQ(event, 123u); // untouched
+}
+
+TEST_F(EventQueueTest, TestFirstInFirstOut) {
+  uint32_t event {0};
+
+  queue_.post(1);
+  queue_.post(2);
+  queue_.post(3);
+  ASSERT_EQ(queue_.size(), 3);
+
+  ASSERT_TRUE(queue_.pop(event));
+  ASSERT_EQ(event, 1u);
+  ASSERT_TRUE(queue_.pop(event));
+  ASSERT_EQ(event, 2u);
+  ASSERT_TRUE(queue_.pop(event));
+  ASSERT_EQ(event, 3u);
+  ASSERT_TRUE(queue_.empty());
+}
+
+TEST_F(EventQueueTest, TestFullDrops) {
+  uint32_t event {0};
+
+  for (uint32_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue_.post(i));
+  }
+  ASSERT_TRUE(queue_.full());
+  ASSERT_FALSE(queue_.post(99));
+
+  // the oldest events are kept, not the newest
+  ASSERT_TRUE(queue_.pop(event));
+  ASSERT_EQ(event, 0u);
+}
+
+// indexes are uint8_t, so make sure they survive wrapping round many times
+TEST_F(EventQueueTest, TestWrap) {
+  uint32_t event {0};
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(queue_.post(i));
+    ASSERT_TRUE(queue_.post(i + 1));
+    ASSERT_TRUE(queue_.pop(event));
+    ASSERT_EQ(event, i);
+    ASSERT_TRUE(queue_.pop(event));
+    ASSERT_EQ(event, i + 1);
+    ASSERT_TRUE(queue_.empty());
+  }
+}
+
+TEST_F(EventQueueTest, TestClear) {
+  queue_.post(1);
+  queue_.post(2);
+  queue_.clear();
+
+  ASSERT_TRUE(queue_.empty());
+  ASSERT_TRUE(queue_.post(3));
+  ASSERT_EQ(queue_.size(), 1);
+}
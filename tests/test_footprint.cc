@@ -0,0 +1,180 @@
+#include <gmock/gmock.h>
+#include <Footprint.h>
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+// objdump -t -C for two objects, cut down. The template, the inline variable
+// and the vtable are in both, as the compiler emits them wherever they're
+// used.
+const char* const symbols =
+    "\n"
+    "RadarState.cc.o:     file format elf64-x86-64\n"
+    "\n"
+    "SYMBOL TABLE:\n"
+    "0000000000000000 l    df *ABS*\t0000000000000000 RadarState.cc\n"
+    "0000000000000000 l    d  .text._ZN10RadarState4tickEv\t"
+    "0000000000000000 .text._ZN10RadarState4tickEv\n"
+    "0000000000000000 g     F .text._ZN10RadarState4tickEv\t"
+    "0000000000000120 RadarState::tick()\n"
+    "0000000000000000 l     O .bss._ZN12_GLOBAL__N_15countE\t"
+    "0000000000000004 (anonymous namespace)::count\n"
+    "0000000000000000 g     O .progmem.data.table\t"
+    "0000000000000030 state_table\n"
+    "0000000000000000  w    F .text._ZN5RadarI5ServoE4moveEv\t"
+    "0000000000000040 Radar<Servo>::move()\n"
+    "0000000000000000 u     O .bss._ZN13TraceRecorder7buffer_E\t"
+    "0000000000000042 TraceRecorder::buffer_\n"
+    "0000000000000000 u     O .bss._ZGVN13TraceRecorder7buffer_E\t"
+    "0000000000000008 guard variable for TraceRecorder::buffer_\n"
+    "0000000000000000  w    O .data.rel.ro._ZTV5Print\t"
+    "0000000000000010 vtable for Print\n"
+    "0000000000000000         *UND*\t0000000000000000 Serial\n"
+    "0000000000000000 l       .rodata.str1.1\t0000000000000000 .LC0\n"
+    "\n"
+    "radar.cc.o:     file format elf64-x86-64\n"
+    "\n"
+    "SYMBOL TABLE:\n"
+    "0000000000000000 g     F .text._Z10angle_stepv\t"
+    "0000000000000010 angle_step()\n"
+    "0000000000000000 g     O .data.step\t0000000000000002 step\n"
+    "0000000000000000  w    F .text._ZN5RadarI5ServoE4moveEv\t"
+    "0000000000000040 Radar<Servo>::move()\n"
+    "0000000000000000  w    F .text._ZN5RadarI5ServoE4stopEv\t"
+    "0000000000000008 void Radar<Servo>::stop<int>(int)\n"
+    "0000000000000000 g     F .text._ZNK5EntryltERKS_\t"
+    "0000000000000016 Entry::operator<(Entry const&) const\n"
+    "0000000000000000 u     O .bss._ZN13TraceRecorder7buffer_E\t"
+    "0000000000000042 TraceRecorder::buffer_\n"
+    "0000000000000000  w    O .data.rel.ro._ZTV5Print\t"
+    "0000000000000010 vtable for Print\n"
+    "0000000000000000  w    O .data.rel.local.DW.ref.__gxx_personality_v0\t"
+    "0000000000000008 .hidden DW.ref.__gxx_personality_v0\n";
+
+} // namespace
+
+class FootprintTest : public ::testing::Test {
+ protected:
+  Footprint footprint_;
+
+  void SetUp() override {
+    std::istringstream in {symbols};
+    ASSERT_EQ(footprint_.read(in), 14u);
+  }
+
+  Footprint::Module module(const std::string& name) {
+    for (auto& module : footprint_.modules()) {
+      if (module.name == name) {
+        return module;
+      }
+    }
+    ADD_FAILURE() << "no module " << name;
+    return {};
+  }
+
+  bool read_budgets(const std::string& text) {
+    std::istringstream in {text};
+    return footprint_.read_budgets(in);
+  }
+};
+
+// the source file's own, anonymous namespace and all, with PROGMEM as flash
+TEST_F(FootprintTest, TestObject) {
+  auto state = module("RadarState");
+
+  ASSERT_EQ(state.text, 0x120u + 0x30);
+  ASSERT_EQ(state.data, 0u);
+  ASSERT_EQ(state.bss, 4u);
+
+  auto radar = module("radar");
+  ASSERT_EQ(radar.text, 0x10u + 0x16);   // Entry::operator< isn't a template
+  ASSERT_EQ(radar.data, 2u);
+  ASSERT_EQ(radar.flash(), 0x28u);
+  ASSERT_EQ(radar.sram(), 2u);
+}
+
+// counted once between both objects, whatever the return type
+TEST_F(FootprintTest, TestTemplate) {
+  auto radar = module("Radar<Servo>");
+
+  ASSERT_EQ(radar.text, 0x40u + 0x8);
+  ASSERT_EQ(radar.sram(), 0u);
+}
+
+// an inline variable and its guard go to its class, a vtable to its class
+TEST_F(FootprintTest, TestShared) {
+  ASSERT_EQ(module("TraceRecorder").bss, 0x42u + 0x8);
+  ASSERT_EQ(module("Print").data, 0x10u);
+}
+
+TEST_F(FootprintTest, TestTotal) {
+  auto total = footprint_.total();
+
+  ASSERT_EQ(total.name, Footprint::total_name);
+  ASSERT_EQ(total.text, 0x120u + 0x30 + 0x10 + 0x16 + 0x48);
+  ASSERT_EQ(total.data, 2u + 0x10);
+  ASSERT_EQ(total.bss, 4u + 0x4a);
+}
+
+TEST_F(FootprintTest, TestOrder) {
+  auto modules = footprint_.modules();
+
+  ASSERT_EQ(modules.size(), 5u);
+  ASSERT_EQ(modules[0].name, "TraceRecorder");
+  ASSERT_EQ(modules[1].name, "Print");
+  ASSERT_EQ(modules[2].name, "RadarState");
+  ASSERT_EQ(modules[3].name, "radar");
+  ASSERT_EQ(modules[4].name, "Radar<Servo>");
+}
+
+TEST_F(FootprintTest, TestWithinBudget) {
+  ASSERT_TRUE(read_budgets("# module  flash sram\n"
+                           "\n"
+                           "RadarState  400 4\n"
+                           "Radar<Servo>  -  -\n"
+                           "total  1024 256\n"));
+
+  ASSERT_TRUE(footprint_.check().empty());
+}
+
+TEST_F(FootprintTest, TestOverBudget) {
+  ASSERT_TRUE(read_budgets("RadarState 300 -\n"
+                           "TraceRecorder - 64\n"
+                           "total 400 -\n"));
+
+  auto overruns = footprint_.check();
+
+  ASSERT_EQ(overruns.size(), 3u);
+  ASSERT_EQ(overruns[0].module.name, "RadarState");
+  ASSERT_EQ(overruns[0].budget.flash, 300u);
+  ASSERT_EQ(overruns[0].budget.sram, Footprint::Budget::no_limit);
+  ASSERT_EQ(overruns[1].module.name, "TraceRecorder");
+  ASSERT_EQ(overruns[2].module.name, Footprint::total_name);
+}
+
+// a module with a budget but nothing built is within it
+TEST_F(FootprintTest, TestMissingModule) {
+  ASSERT_TRUE(read_budgets("LCDBuffer 0 0\n"));
+
+  ASSERT_TRUE(footprint_.check().empty());
+}
+
+TEST_F(FootprintTest, TestBadBudgets) {
+  ASSERT_FALSE(read_budgets("RadarState 400\n"));
+  ASSERT_FALSE(read_budgets("RadarState 400 lots\n"));
+}
+
+TEST_F(FootprintTest, TestWrite) {
+  ASSERT_TRUE(read_budgets("RadarState 400 -\n"));
+  std::ostringstream out;
+
+  footprint_.write(out);
+
+  std::string table = out.str();
+  ASSERT_THAT(table, ::testing::StartsWith("module"));
+  ASSERT_THAT(table, ::testing::HasSubstr("RadarState"));
+  ASSERT_THAT(table, ::testing::HasSubstr("  400 -\n"));
+  ASSERT_THAT(table, ::testing::HasSubstr("\ntotal"));
+}
@@ -0,0 +1,109 @@
+#include <gmock/gmock.h>
+#include <IntFormat.h>
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace IntFormat;
+
+namespace {
+
+std::string uint_text(uint8_t width, uint32_t value) {
+  char out[max_width];
+  return std::string(out, format_uint(out, width, value));
+}
+
+std::string int_text(uint8_t width, int32_t value) {
+  char out[max_width];
+  return std::string(out, format_int(out, width, value));
+}
+
+std::string fixed_text(uint8_t width, int32_t value, uint8_t decimals) {
+  char out[max_width];
+  return std::string(out, format_fixed(out, width, value, decimals));
+}
+
+} // namespace
+
+/*
+ * Every distance the radar can report. The HC-SR04 gives up after 38ms, which
+ * is 6.5m, so everything below 65536mm is checked against printf(), right
+ * aligned in the 6 characters left after "Distance: ", and with no padding.
+ */
+TEST(IntFormatTest, TestEveryDistance) {
+  char expected[16];
+
+  for (uint32_t distance = 0; distance <= UINT16_MAX; ++distance) {
+    std::snprintf(expected, sizeof(expected), "%6u", distance);
+    ASSERT_EQ(uint_text(6, distance), expected);
+
+    std::snprintf(expected, sizeof(expected), "%u", distance);
+    ASSERT_EQ(uint_text(0, distance), expected);
+  }
+}
+
+// every power of ten either side, where the digit count changes
+TEST(IntFormatTest, TestPowersOfTen) {
+  char expected[16];
+
+  for (uint32_t p = 1; p <= 1000000000; p *= 10) {
+    for (uint32_t value : {p - 1, p, p + 1}) {
+      std::snprintf(expected, sizeof(expected), "%u", value);
+      ASSERT_EQ(uint_text(0, value), expected);
+      std::snprintf(expected, sizeof(expected), "%d", -(int32_t)value);
+      ASSERT_EQ(int_text(0, -(int32_t)value), expected);
+    }
+  }
+}
+
+TEST(IntFormatTest, TestLimits) {
+  ASSERT_EQ(uint_text(0, UINT32_MAX), std::to_string(UINT32_MAX));
+  ASSERT_EQ(int_text(0, INT32_MAX), std::to_string(INT32_MAX));
+  ASSERT_EQ(int_text(0, INT32_MIN), std::to_string(INT32_MIN));
+  ASSERT_EQ(int_text(12, INT32_MIN), " -2147483648");
+}
+
+TEST(IntFormatTest, TestTooWide) {
+  ASSERT_EQ(uint_text(6, 1000000), "******");
+  ASSERT_EQ(uint_text(6, UINT32_MAX), "******");
+  ASSERT_EQ(int_text(3, -100), "***");
+  ASSERT_EQ(int_text(4, -100), "-100");
+}
+
+TEST(IntFormatTest, TestFixed) {
+  ASSERT_EQ(fixed_text(0, 1234, 2), "12.34");
+  ASSERT_EQ(fixed_text(0, 5, 2), "0.05");
+  ASSERT_EQ(fixed_text(0, 0, 1), "0.0");
+  ASSERT_EQ(fixed_text(0, -5, 3), "-0.005");
+  ASSERT_EQ(fixed_text(7, 1234, 1), "  123.4");
+  ASSERT_EQ(fixed_text(4, 1234, 1), "****");
+  ASSERT_EQ(fixed_text(0, INT32_MIN, 9), "-2.147483648");
+  ASSERT_EQ(fixed_text(0, 7, 0), "7");
+}
+
+// fixed point against printf() over the range of a metre in mm
+TEST(IntFormatTest, TestFixedMetres) {
+  char expected[16];
+
+  for (int32_t mm = -1000; mm <= 1000; ++mm) {
+    std::snprintf(expected, sizeof(expected), "%s%d.%03d",
+                  (mm < 0) ? "-" : "", std::abs(mm) / 1000, std::abs(mm) % 1000);
+    std::string padded = std::string(8 - std::strlen(expected), ' ') + expected;
+    ASSERT_EQ(fixed_text(8, mm, 3), padded);
+  }
+}
+
+// nothing written past width
+TEST(IntFormatTest, TestStaysInWidth) {
+  char out[8];
+  std::memset(out, '#', sizeof(out));
+
+  format_uint(out, 4, 12);
+  ASSERT_EQ(std::string(out, 8), "  12####");
+
+  format_uint(out, 2, 12345);
+  ASSERT_EQ(std::string(out, 8), "**12####");
+}
@@ -0,0 +1,259 @@
+#include <gmock/gmock.h>
+#include <LCDBuffer.h>
+
+#include <climits>
+#include <cstring>
+#include <string>
+
+/*
+ * FakeLCD
+ *
+ * Just enough of an HD44780 to check what ends up on screen: each row has 40
+ * characters of display RAM, of which the first 16 are shown, and the address
+ * moves along one each write. Every setCursor(), write() and clear() is one
+ * send() to the controller, and clear() blocks for 2ms on top.
+ *
+ * print() is here so the fake can stand in for LiquidCrystal being written to
+ * directly, the way RadarContext used to, and counts a send per character.
+ */
+class FakeLCD {
+ public:
+  char ddram_[2][40];
+  uint8_t row_ {0}, col_ {0};
+  uint32_t sends_ {0};
+  uint32_t clears_ {0};
+
+  FakeLCD() { std::memset(ddram_, ' ', sizeof(ddram_)); }
+
+  void setCursor(uint8_t col, uint8_t row) {
+    col_ = col;
+    row_ = row;
+    ++sends_;
+  }
+  size_t write(uint8_t c) {
+    ddram_[row_][col_] = (char)c;
+    col_ = (col_ + 1) % 40;
+    ++sends_;
+    return 1;
+  }
+  void clear() {
+    std::memset(ddram_, ' ', sizeof(ddram_));
+    row_ = col_ = 0;
+    ++sends_;
+    ++clears_;
+  }
+  void print(const char str[]) {
+    while (*str != '\0') {
+      write((uint8_t)*str++);
+    }
+  }
+  void print(int n) {
+    print(std::to_string(n).c_str());
+  }
+
+  std::string row(uint8_t r) const { return std::string(ddram_[r], 16); }
+
+  // ~100us for each send to settle, plus 2ms more for each clear
+  uint32_t blocking_us() const { return sends_ * 100 + clears_ * 2000; }
+};
+
+class LCDBufferTest : public ::testing::Test {
+ protected:
+  LCDBuffer screen_;
+  FakeLCD lcd_;
+
+  std::string row(uint8_t r) const {
+    std::string text;
+    for (uint8_t col = 0; col < LCDBuffer::cols; ++col) {
+      text += screen_.at(col, r);
+    }
+    return text;
+  }
+
+  // flush and check the LCD now shows exactly what the buffer does
+  uint8_t flush() {
+    uint8_t sends = screen_.flush(lcd_);
+    EXPECT_EQ(lcd_.row(0), row(0));
+    EXPECT_EQ(lcd_.row(1), row(1));
+    EXPECT_FALSE(screen_.dirty());
+    return sends;
+  }
+
+  // what DoPing puts on screen
+  template<typename Screen>
+  static void show_distance(Screen& screen, int distance) {
+    screen.setCursor(0, 1);
+    screen.print("Distance: ");
+    screen.print(distance);
+    screen.print("  ");
+  }
+};
+
+TEST_F(LCDBufferTest, TestStartsBlank) {
+  ASSERT_EQ(row(0), "                ");
+  ASSERT_EQ(row(1), "                ");
+  ASSERT_FALSE(screen_.dirty());
+  ASSERT_EQ(flush(), 0);
+}
+
+TEST_F(LCDBufferTest, TestPrint) {
+  screen_.setCursor(3, 1);
+  screen_.print("abc");
+  screen_.print(-42);
+  screen_.print(0);
+
+  ASSERT_EQ(row(0), "                ");
+  ASSERT_EQ(row(1), "   abc-420      ");
+  ASSERT_TRUE(screen_.dirty());
+}
+
+TEST_F(LCDBufferTest, TestPrintIntLimits) {
+  screen_.print(INT_MAX);
+  screen_.setCursor(0, 1);
+  screen_.print(INT_MIN);
+
+  std::string max = std::to_string(INT_MAX), min = std::to_string(INT_MIN);
+  ASSERT_EQ(row(0).substr(0, max.size()), max);
+  ASSERT_EQ(row(1).substr(0, min.size()), min);
+}
+
+TEST_F(LCDBufferTest, TestPrintWidth) {
+  screen_.setCursor(10, 1);
+  screen_.print(1234u, 6);
+  ASSERT_EQ(row(1), "            1234");
+
+  screen_.setCursor(10, 1);
+  screen_.print(7u, 6);
+  ASSERT_EQ(row(1), "               7");
+
+  screen_.setCursor(10, 1);
+  screen_.print(1234567u, 6);
+  ASSERT_EQ(row(1), "          ******");
+}
+
+TEST_F(LCDBufferTest, TestEndOfRowDropped) {
+  screen_.setCursor(10, 0);
+  screen_.print("0123456789");
+
+  ASSERT_EQ(row(0), "          012345");
+  ASSERT_EQ(row(1), "                ");
+
+  screen_.setCursor(16, 0);
+  screen_.print("x");
+  ASSERT_EQ(row(0), "          012345");
+}
+
+// runs of changes share one setCursor(), unchanged characters aren't sent
+TEST_F(LCDBufferTest, TestFlushRuns) {
+  screen_.setCursor(0, 1);
+  screen_.print("Distance: 1234");
+
+  // "Distance:", the space was already there, then "1234"
+  ASSERT_EQ(flush(), 1 + 9 + 1 + 4);
+}
+
+TEST_F(LCDBufferTest, TestSameTextNotSent) {
+  screen_.print("Standby");
+  flush();
+
+  screen_.clear();
+  screen_.print("Standby");
+  ASSERT_EQ(flush(), 0);
+}
+
+// the LCD doesn't carry on from the end of row 0 to the start of row 1
+TEST_F(LCDBufferTest, TestFlushAcrossRows) {
+  screen_.setCursor(14, 0);
+  screen_.print("ab");
+  screen_.setCursor(0, 1);
+  screen_.print("cd");
+
+  ASSERT_EQ(flush(), 1 + 2 + 1 + 2);
+}
+
+TEST_F(LCDBufferTest, TestClearOnlySendsText) {
+  screen_.print("Standby");
+  flush();
+
+  screen_.clear();
+  ASSERT_EQ(flush(), 1 + 7);
+  ASSERT_EQ(lcd_.clears_, 0u);
+}
+
+TEST_F(LCDBufferTest, TestReset) {
+  screen_.print("Standby");
+  screen_.reset();
+
+  ASSERT_FALSE(screen_.dirty());
+  ASSERT_EQ(row(0), "                ");
+}
+
+/*
+ * Typical screens
+ *
+ * Count send()s for the screens the radar actually shows, written straight to
+ * the LCD as before, and through the buffer.
+ */
+
+// a ping where the distance has moved a little
+TEST_F(LCDBufferTest, TestTypicalPing) {
+  FakeLCD direct;
+
+  show_distance(screen_, 1234);
+  flush();
+  lcd_.sends_ = 0;
+
+  show_distance(direct, 1240);
+  show_distance(screen_, 1240);
+
+  ASSERT_EQ(direct.sends_, 17u);  // setCursor, "Distance: ", "1240", "  "
+  ASSERT_EQ(flush(), 3);          // setCursor, "40"
+}
+
+// standby, then motion, then the first ping
+TEST_F(LCDBufferTest, TestTypicalStateChange) {
+  FakeLCD direct;
+
+  direct.clear();
+  direct.setCursor(0, 0);
+  direct.print("Standby");
+  screen_.clear();
+  screen_.setCursor(0, 0);
+  screen_.print("Standby");
+  flush();
+
+  ASSERT_EQ(direct.sends_, 9u);
+  ASSERT_EQ(lcd_.sends_, 8u);
+
+  direct.sends_ = direct.clears_ = 0;
+  lcd_.sends_ = 0;
+
+  direct.clear();
+  show_distance(direct, 800);
+  screen_.clear();
+  show_distance(screen_, 800);
+  flush();
+
+  ASSERT_EQ(lcd_.row(0), "                ");
+  ASSERT_EQ(lcd_.row(1), direct.row(1));
+  ASSERT_EQ(lcd_.clears_, 0u);
+  ASSERT_LT(lcd_.blocking_us(), direct.blocking_us());
+}
+
+// a minute of pings with something moving about in front of the radar
+TEST_F(LCDBufferTest, TestTypicalMinute) {
+  FakeLCD direct;
+  int distance = 1500;
+
+  for (int ping = 0; ping < 60 * 1000 / 550; ++ping) {
+    distance += (ping % 7) - 3;
+    show_distance(direct, distance);
+    show_distance(screen_, distance);
+    flush();
+  }
+
+  ASSERT_EQ(lcd_.row(1), direct.row(1));
+
+  // at least three quarters of the traffic gone
+  ASSERT_LT(lcd_.sends_ * 4, direct.sends_);
+}
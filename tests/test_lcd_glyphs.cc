@@ -0,0 +1,234 @@
+#include <gmock/gmock.h>
+#include <LCDGlyphs.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+/*
+ * GlyphLCD
+ *
+ * Keeps the 8 CGRAM slots and counts createChar() calls, each of which is
+ * nine send()s to a real HD44780.
+ */
+class GlyphLCD {
+ public:
+  uint8_t cgram_[8][8] {};
+  uint32_t uploads_ {0};
+
+  void createChar(uint8_t location, uint8_t charmap[]) {
+    std::memcpy(cgram_[location & 7], charmap, 8);
+    ++uploads_;
+  }
+
+  // true if character code c shows glyph id
+  bool shows(char c, uint8_t id) const {
+    uint8_t rows[8];
+    Glyphs::pattern(id, rows);
+    return std::memcmp(cgram_[c & 7], rows, 8) == 0;
+  }
+};
+
+class GlyphCacheTest : public ::testing::Test {
+ protected:
+  GlyphCache cache_;
+  GlyphLCD lcd_;
+};
+
+TEST_F(GlyphCacheTest, TestUploadOnce) {
+  cache_.begin_frame();
+  char c = cache_.glyph(lcd_, Glyphs::NEEDLE_0);
+  ASSERT_EQ(cache_.glyph(lcd_, Glyphs::NEEDLE_0), c);
+
+  cache_.begin_frame();
+  ASSERT_EQ(cache_.glyph(lcd_, Glyphs::NEEDLE_0), c);
+
+  ASSERT_EQ(lcd_.uploads_, 1u);
+  ASSERT_EQ(cache_.uploads(), 1u);
+  ASSERT_TRUE(lcd_.shows(c, Glyphs::NEEDLE_0));
+}
+
+// 8 to 15, never 0, which would end a string
+TEST_F(GlyphCacheTest, TestCodes) {
+  cache_.begin_frame();
+  for (uint8_t id = 0; id < GlyphCache::slots; ++id) {
+    char c = cache_.glyph(lcd_, id);
+    ASSERT_EQ(c, (char)(8 + id));
+    ASSERT_TRUE(lcd_.shows(c, id));
+  }
+}
+
+TEST_F(GlyphCacheTest, TestEvictsLeastRecentlyUsed) {
+  // one glyph per frame, so glyph 0 is the oldest
+  for (uint8_t id = 0; id < GlyphCache::slots; ++id) {
+    cache_.begin_frame();
+    cache_.glyph(lcd_, id);
+  }
+  // using glyph 0 again makes glyph 1 the oldest
+  cache_.begin_frame();
+  char zero = cache_.glyph(lcd_, 0);
+  char one = cache_.glyph(lcd_, 1);
+
+  cache_.begin_frame();
+  char c = cache_.glyph(lcd_, Glyphs::count - 1);
+
+  ASSERT_EQ(c, (char)(8 + 2));
+  ASSERT_TRUE(lcd_.shows(zero, 0));
+  ASSERT_TRUE(lcd_.shows(one, 1));
+  ASSERT_TRUE(lcd_.shows(c, Glyphs::count - 1));
+}
+
+// a slot asked for this frame may be on screen, so isn't reused
+TEST_F(GlyphCacheTest, TestNeverEvictsThisFrame) {
+  cache_.begin_frame();
+  for (uint8_t id = 0; id < GlyphCache::slots; ++id) {
+    cache_.glyph(lcd_, id);
+  }
+
+  ASSERT_EQ(cache_.glyph(lcd_, GlyphCache::slots), ' ');
+  ASSERT_EQ(lcd_.uploads_, (uint32_t)GlyphCache::slots);
+  for (uint8_t id = 0; id < GlyphCache::slots; ++id) {
+    ASSERT_TRUE(lcd_.shows((char)(8 + id), id));
+  }
+}
+
+TEST_F(GlyphCacheTest, TestReset) {
+  cache_.begin_frame();
+  cache_.glyph(lcd_, 0);
+  cache_.reset();
+  cache_.begin_frame();
+  cache_.glyph(lcd_, 0);
+
+  ASSERT_EQ(lcd_.uploads_, 2u);
+}
+
+/*
+ * TargetDisplay tests
+ *
+ * The bar is 11 cells of 5 steps over 1000mm, so a step is about 18mm.
+ */
+class TargetDisplayTest : public ::testing::Test {
+ protected:
+  LCDBuffer screen_;
+  GlyphLCD lcd_;
+  TargetDisplay display_ {1000};
+
+  std::string row(uint8_t r) const {
+    std::string text;
+    for (uint8_t col = 0; col < LCDBuffer::cols; ++col) {
+      text += screen_.at(col, r);
+    }
+    return text;
+  }
+
+  static Target target(uint8_t bearing, uint32_t range) {
+    Target t;
+    t.bearing_min = t.bearing_max = bearing;
+    t.range = range;
+    return t;
+  }
+
+  // draw a frame, returning the createChar() calls it took
+  uint32_t frame(const Target* t) {
+    uint32_t before = lcd_.uploads_;
+    display_.draw(screen_, lcd_, t, 0);
+    return lcd_.uploads_ - before;
+  }
+};
+
+TEST_F(TargetDisplayTest, TestBarSteps) {
+  ASSERT_EQ(display_.bar_steps(0), 0);
+  ASSERT_EQ(display_.bar_steps(500), 27);
+  ASSERT_EQ(display_.bar_steps(999), 54);
+  ASSERT_EQ(display_.bar_steps(1000), 55);
+  ASSERT_EQ(display_.bar_steps(UINT32_MAX), 55);
+}
+
+TEST_F(TargetDisplayTest, TestNeedle) {
+  ASSERT_EQ(TargetDisplay::needle(0), Glyphs::NEEDLE_0);
+  ASSERT_EQ(TargetDisplay::needle(11), Glyphs::NEEDLE_0);
+  ASSERT_EQ(TargetDisplay::needle(12), Glyphs::NEEDLE_0 + 1);
+  ASSERT_EQ(TargetDisplay::needle(90), Glyphs::NEEDLE_0 + 4);
+  ASSERT_EQ(TargetDisplay::needle(180), Glyphs::NEEDLE_0 + 8);
+  ASSERT_EQ(TargetDisplay::needle(255), Glyphs::NEEDLE_0 + 8);
+}
+
+TEST_F(TargetDisplayTest, TestDraw) {
+  Target t = target(45, 500);  // 27 steps: 5 blocks and 2 columns
+  ASSERT_EQ(frame(&t), 2u);
+
+  std::string text = row(0);
+  ASSERT_EQ(text.substr(0, 5), std::string(5, TargetDisplay::block));
+  ASSERT_TRUE(lcd_.shows(text[5], Glyphs::BAR_1 + 1));
+  ASSERT_EQ(text.substr(6, 9), "       45");
+  ASSERT_TRUE(lcd_.shows(text[15], TargetDisplay::needle(45)));
+  ASSERT_EQ(row(1), std::string(16, ' '));
+}
+
+TEST_F(TargetDisplayTest, TestDrawWholeCells) {
+  Target t = target(90, 1000);
+  ASSERT_EQ(frame(&t), 1u);  // just the needle
+
+  ASSERT_EQ(row(0).substr(0, 11), std::string(11, TargetDisplay::block));
+  ASSERT_EQ(row(0).substr(11, 4), "  90");
+}
+
+TEST_F(TargetDisplayTest, TestDrawNoTarget) {
+  ASSERT_EQ(frame(nullptr), 0u);
+  ASSERT_EQ(row(0), "            --- ");
+}
+
+/*
+ * CGRAM writes per frame
+ *
+ * A target wandering about in front of the radar, one frame per 250ms redraw.
+ * No frame can need more than the two glyphs it shows, and once the glyphs
+ * for the ranges and bearings it moves between have been seen, they stay in
+ * CGRAM and frames need none.
+ */
+TEST_F(TargetDisplayTest, TestCGRAMWritesPerFrame) {
+  uint32_t worst = 0, total = 0, frames = 0;
+
+  for (int pass = 0; pass < 4; ++pass) {
+    for (int i = 0; i < 100; ++i, ++frames) {
+      // drifts between 400 and 470mm, and 80° and 100°
+      Target t = target((uint8_t)(80 + (i * 7) % 21), 400 + (i * 13) % 71);
+      uint32_t uploads = frame(&t);
+
+      worst = std::max(worst, uploads);
+      total += uploads;
+
+      // what's on screen is what was asked for
+      std::string text = row(0);
+      uint8_t steps = display_.bar_steps(t.range);
+      if (steps % 5 != 0) {
+        ASSERT_TRUE(lcd_.shows(text[steps / 5], Glyphs::BAR_1 + steps % 5 - 1));
+      }
+      ASSERT_TRUE(lcd_.shows(text[15], TargetDisplay::needle(t.bearing_min)));
+    }
+  }
+
+  ASSERT_LE(worst, 2u);
+  // 3 bar ends, 22 to 24 steps, and the 90° needle, each uploaded once
+  ASSERT_EQ(total, 4u);
+  ASSERT_EQ(frames, 400u);
+}
+
+// a sweep all the way round needs more glyphs than there are slots, but
+// still no more than two uploads a frame
+TEST_F(TargetDisplayTest, TestCGRAMWritesSweep) {
+  uint32_t worst = 0, total = 0;
+
+  for (int i = 0; i < 360; ++i) {
+    int bearing = (i < 180) ? i : 359 - i;
+    Target t = target((uint8_t)bearing, (uint32_t)(i * 37) % 1000);
+    uint32_t uploads = frame(&t);
+    worst = std::max(worst, uploads);
+    total += uploads;
+
+    ASSERT_TRUE(lcd_.shows(row(0)[15], TargetDisplay::needle(t.bearing_min)));
+  }
+
+  ASSERT_LE(worst, 2u);
+  ASSERT_LT(total, 360u);
+}
@@ -0,0 +1,255 @@
+#include <gmock/gmock.h>
+#include <LCDQueue.h>
+
+#include <climits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using Queue = LCDQueue<32>;
+
+TEST(LCDQueueTest, TestExecTime) {
+  ASSERT_EQ(Queue::exec_time(0x01, 0), Queue::clear_us);  // clear
+  ASSERT_EQ(Queue::exec_time(0x02, 0), Queue::clear_us);  // home
+  ASSERT_EQ(Queue::exec_time(0x03, 0), Queue::clear_us);  // home
+  ASSERT_EQ(Queue::exec_time(0x01, 1), Queue::exec_us);   // data, not clear
+  ASSERT_EQ(Queue::exec_time(0x80, 0), Queue::exec_us);   // set DDRAM address
+}
+
+TEST(LCDQueueTest, TestWaitsForLastByte) {
+  Queue queue;
+  uint8_t value, mode;
+
+  queue.push('a', 1);
+  queue.push('b', 1);
+
+  ASSERT_TRUE(queue.pop(1000, value, mode));
+  ASSERT_EQ(value, 'a');
+  ASSERT_EQ(mode, 1);
+  queue.sent(1010);
+
+  ASSERT_FALSE(queue.pop(1010 + Queue::exec_us - 1, value, mode));
+  ASSERT_TRUE(queue.pop(1010 + Queue::exec_us, value, mode));
+  ASSERT_EQ(value, 'b');
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST(LCDQueueTest, TestClearHoldsBack) {
+  Queue queue;
+  uint8_t value, mode;
+
+  queue.push(0x01, 0);
+  queue.push('a', 1);
+
+  ASSERT_TRUE(queue.pop(0, value, mode));
+  queue.sent(0);
+  ASSERT_FALSE(queue.pop(Queue::clear_us - 1, value, mode));
+  ASSERT_TRUE(queue.pop(Queue::clear_us, value, mode));
+}
+
+// the busy flag lets a byte go early, but a stuck one only holds it so long
+TEST(LCDQueueTest, TestBusyFlag) {
+  Queue queue;
+  uint8_t value, mode;
+
+  queue.push('a', 1);
+  queue.push('b', 1);
+  queue.push('c', 1);
+  queue.pop(0, value, mode);
+  queue.sent(0);
+
+  ASSERT_TRUE(queue.pop(40, value, mode, false));
+  ASSERT_EQ(value, 'b');
+  queue.sent(40);
+
+  ASSERT_FALSE(queue.pop(40 + Queue::exec_us - 1, value, mode, true));
+  ASSERT_TRUE(queue.pop(40 + Queue::exec_us, value, mode, true));
+}
+
+TEST(LCDQueueTest, TestMicrosWraps) {
+  Queue queue;
+  uint8_t value, mode;
+
+  queue.push('a', 1);
+  queue.push('b', 1);
+  queue.pop(UINT32_MAX - 10, value, mode);
+  queue.sent(UINT32_MAX - 10);
+
+  ASSERT_FALSE(queue.pop(20, value, mode));
+  ASSERT_TRUE(queue.pop(Queue::exec_us, value, mode));
+}
+
+TEST(LCDQueueTest, TestFull) {
+  Queue queue;
+
+  for (uint8_t i = 0; i < 32; ++i) {
+    ASSERT_TRUE(queue.push(i, 1));
+  }
+  ASSERT_TRUE(queue.full());
+  ASSERT_FALSE(queue.push(32, 1));
+  ASSERT_EQ(queue.size(), 32);
+}
+
+/*
+ * Simulation
+ *
+ * SimHD44780 checks nothing is latched while the controller is still busy,
+ * using the datasheet execution times, scaled for its oscillator, and reports
+ * its busy flag from the same times. It also keeps everything it was sent, so
+ * the order can be checked.
+ *
+ * The fixture plays the part of LiquidCrystal::poll() being called from the
+ * main loop: after each poll the loop goes off and does something else for a
+ * random time. Writing a byte out on the pins takes write_us, and reading the
+ * busy flag read_us.
+ *
+ * Each test runs at the slowest oscillator the datasheet allows, the usual
+ * one and the fastest, going by time and by the busy flag.
+ */
+class SimHD44780 {
+ public:
+  struct Byte {
+    uint8_t value;
+    uint8_t mode;
+    bool operator==(const Byte& b) const {
+      return value == b.value && mode == b.mode;
+    }
+  };
+
+  uint32_t osc_khz_;
+  uint32_t busy_until_ {0};
+  std::vector<Byte> received_;
+
+  explicit SimHD44780(uint32_t osc_khz) : osc_khz_{osc_khz} {}
+
+  bool busy(uint32_t now) const { return now < busy_until_; }
+
+  void latch(uint32_t now, uint8_t value, uint8_t mode) {
+    EXPECT_GE(now, busy_until_) << "byte " << received_.size()
+                                << " latched while busy";
+
+    // 37us and 1.52ms at 270kHz, rounded up
+    uint32_t us = (mode == 0 && value != 0 && value < 0x04) ? 1520 : 37;
+    busy_until_ = now + (us * 270 + osc_khz_ - 1) / osc_khz_;
+    received_.push_back({value, mode});
+  }
+};
+
+class LCDQueueSimTest
+    : public ::testing::TestWithParam<std::tuple<uint32_t, bool>> {
+ protected:
+  static constexpr uint32_t write_us {20};
+  static constexpr uint32_t read_us {12};
+
+  Queue queue_;
+  SimHD44780 lcd_ {std::get<0>(GetParam())};
+  bool busy_flag_ {std::get<1>(GetParam())};
+  std::mt19937 random_ {1234};
+  std::vector<SimHD44780::Byte> sent_;
+
+  uint32_t now_ {0};
+  uint32_t longest_poll_ {0};
+  uint32_t max_gap_ {150};  // longest the loop spends elsewhere between polls
+
+  void send(uint8_t value, uint8_t mode) {
+    while (!queue_.push(value, mode)) {
+      poll();
+    }
+    sent_.push_back({value, mode});
+  }
+
+  void print(const char* str) {
+    while (*str != '\0') {
+      send((uint8_t)*str++, 1);
+    }
+  }
+
+  void poll() {
+    uint32_t start = now_;
+    uint8_t value, mode;
+    for (uint8_t i = 0; i < 4 && !queue_.empty(); ++i) {
+      bool busy = true;
+      if (busy_flag_ && !queue_.ready(now_)) {
+        now_ += read_us;
+        busy = lcd_.busy(now_);
+      }
+      if (!queue_.pop(now_, value, mode, busy)) {
+        break;
+      }
+      now_ += write_us;
+      lcd_.latch(now_, value, mode);
+      queue_.sent(now_);
+    }
+    longest_poll_ = std::max(longest_poll_, now_ - start);
+
+    // off to do something else
+    now_ += std::uniform_int_distribution<uint32_t>(1, max_gap_)(random_);
+  }
+
+  void drain() {
+    while (!queue_.empty()) {
+      poll();
+    }
+  }
+};
+
+// standby banner, then a screen of distances, sent as fast as they queue
+TEST_P(LCDQueueSimTest, TestTiming) {
+  send(0x01, 0);
+  send(0x80, 0);
+  print("Standby");
+
+  for (int distance = 1000; distance < 1100; distance += 7) {
+    send(0x80 | 0x40, 0);
+    print("Distance: ");
+    print(std::to_string(distance).c_str());
+    send(0x02, 0);
+  }
+  drain();
+
+  ASSERT_EQ(lcd_.received_, sent_);
+}
+
+// bytes from several polls apart still wait for each other
+TEST_P(LCDQueueSimTest, TestTimingTrickle) {
+  for (int i = 0; i < 200; ++i) {
+    send((i % 17 == 0) ? 0x01 : 'a', (i % 17 == 0) ? 0 : 1);
+    poll();
+  }
+  drain();
+
+  ASSERT_EQ(lcd_.received_, sent_);
+}
+
+// a poll sends a few bytes at most, however long it has been since the last
+TEST_P(LCDQueueSimTest, TestPollNeverWaits) {
+  for (int i = 0; i < 32; ++i) {
+    send('a', 1);
+  }
+  now_ += 1000000;
+  drain();
+
+  ASSERT_LE(longest_poll_, 4 * (read_us + write_us));
+}
+
+// polling flat out, the busy flag gets a screen out at least a quarter sooner,
+// even with the slowest oscillator
+TEST_P(LCDQueueSimTest, TestThroughput) {
+  max_gap_ = 1;
+  for (int i = 0; i < 32; ++i) {
+    send('a', 1);
+  }
+  drain();
+
+  uint32_t timed = 32 * (Queue::exec_us + write_us);
+  if (busy_flag_) {
+    ASSERT_LT(now_ * 4, timed * 3);
+  } else {
+    ASSERT_GE(now_, timed - Queue::exec_us - write_us);
+  }
+  ASSERT_EQ(lcd_.received_, sent_);
+}
+
+INSTANTIATE_TEST_SUITE_P(Oscillator, LCDQueueSimTest,
+                         ::testing::Combine(::testing::Values(190u, 270u, 350u),
+                                            ::testing::Bool()));
@@ -6,6 +6,10 @@
 #include <MyLED.h>
 #include <ArduinoInterface.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 /*
  * MockArduinoSetup - Set up mock Arduino interface
  *
@@ -63,23 +67,28 @@ TEST_F(MyLEDTest, ConstructorTest) {
 };
 
 
+// colours are written as soon as they're set, if they don't fade
 TEST_F(MyLEDTest, SetColourTestRed) {
+  using testing::_;
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(red_pin_, HIGH))
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, UINT8_MAX))
       .Times(1);
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(green_pin_, LOW))
-      .Times(1);
+  // were never on
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, _))
+      .Times(0);
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(blue_pin_, _))
+      .Times(0);
 
   my_led_.set_colour(LEDColour::RED);
 }
 
 TEST_F(MyLEDTest, SetColourTestYellow) {
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(red_pin_, HIGH))
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, UINT8_MAX))
       .Times(1);
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(green_pin_, HIGH))
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, UINT8_MAX))
       .Times(1);
 
   my_led_.set_colour(LEDColour::YELLOW);
@@ -87,192 +96,329 @@ TEST_F(MyLEDTest, SetColourTestYellow) {
 
 // Green is the default state, so we have to change to another colour to test it
 TEST_F(MyLEDTest, SetColourTestRedThenGreen) {
+  using testing::InSequence;
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(red_pin_, HIGH))
-      .Times(1);
+  InSequence s;
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(green_pin_, LOW))
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, UINT8_MAX))
       .Times(1);
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(red_pin_, LOW))
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, 0))
       .Times(1);
 
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(green_pin_, HIGH))
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, UINT8_MAX))
       .Times(1);
 
   my_led_.set_colour(LEDColour::RED);
   my_led_.set_colour(LEDColour::GREEN);
 }
 
-TEST_F(MyLEDTest, PulseTestGreen) {
-
-  using testing::Sequence;
+TEST_F(MyLEDTest, StartTest) {
   using testing::_;
-  using testing::AnyNumber;
-
-  Sequence s1, s2;
-
-  int8_t increment = 7; // odd number to really test method
-  uint8_t max_brightness = UINT8_MAX;
-  uint8_t iterations = 90;
-
-  uint8_t  remainder = max_brightness % increment;
-
-
-  // do we get calls?
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(_, _))
-      .Times(AnyNumber());
-
-  // Test top edge
-
-  EXPECT_CALL(mock_arduino_class_,analogueWrite(green_pin_, max_brightness - remainder - increment))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-      analogueWrite(green_pin_, max_brightness - remainder))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-      analogueWrite(green_pin_, max_brightness))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-      analogueWrite(green_pin_, max_brightness - increment))
-      .InSequence(s1);
-
-  // and bottom edge
-  EXPECT_CALL(mock_arduino_class_,analogueWrite(green_pin_, remainder + increment))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, remainder))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, 0))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, increment))
-      .InSequence(s2);
-
-  my_led_.set_colour(LEDColour::GREEN); //set green
-  my_led_.set_pulse(increment); //set pulse
-  for (uint8_t i =0; i <= iterations; i++) {
-    my_led_.pulse();
+  using testing::SaveArg;
+
+  void (*isr)() = nullptr;
+  EXPECT_CALL(mock_arduino_class_, timer_tick(_))
+      .WillOnce(SaveArg<0>(&isr));
+
+  my_led_.start();
+  ASSERT_NE(isr, nullptr);
+
+  // the interrupt ticks the LED that was started
+  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, UINT8_MAX))
+      .Times(1);
+  isr();
+}
+
+TEST_F(MyLEDTest, BreathTableTest) {
+  ASSERT_EQ(MyLED::breath(0), 0);
+  ASSERT_EQ(MyLED::breath(MyLED::peak), UINT8_MAX);
+
+  for (uint32_t i = 1; i < 128; ++i) {
+    uint8_t rising = MyLED::breath(i << 24);
+    uint8_t falling = MyLED::breath((256 - i) << 24);
+
+    // symmetrical, and never getting dimmer on the way up
+    ASSERT_EQ(rising, falling);
+    ASSERT_GE(MyLED::breath((i + 1) << 24), rising);
+
+    // gamma corrected, so below a straight raised cosine
+    double level = (1 - std::cos(2 * M_PI * i / 256)) / 2;
+    ASSERT_NEAR(rising, 255 * std::pow(level, 2.2), 1.0);
   }
+  // dim for longer than bright
+  ASSERT_LT(MyLED::breath(0x40000000), 64);
 }
 
-TEST_F(MyLEDTest, PulseTestRed) {
+/*
+ * Effect tests
+ *
+ * The timer interrupt is the test calling tick(), and analogueWrite() is
+ * recorded with the time it was called at.
+ */
+class MyLEDEffectTest : public MyLEDTest {
+ protected:
+  struct Write {
+    uint32_t us;
+    uint8_t value;
+  };
+
+  uint32_t now_us_ {0};
+  std::vector<Write> red_, green_, blue_;
+
+  MyLEDEffectTest() {
+    using testing::_;
+    using testing::Invoke;
+
+    ON_CALL(mock_arduino_class_, analogueWrite(_, _))
+        .WillByDefault(Invoke([this](uint8_t pin, uint8_t value) {
+          auto& writes = (pin == red_pin_) ? red_
+                         : (pin == green_pin_) ? green_ : blue_;
+          writes.push_back({now_us_, value});
+        }));
+  }
 
-  using testing::Sequence;
-  using testing::_;
-  using testing::AnyNumber;
-
-  Sequence s1, s2;
-
-  int8_t increment = 7; // odd number to really test method
-  uint8_t max_brightness = UINT8_MAX;
-  uint8_t iterations = 90;
-
-  uint8_t  remainder = max_brightness % increment;
-
-
-  // do we get calls?
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(_, _))
-      .Times(AnyNumber());
-
-  // Test top edge
-  EXPECT_CALL(mock_arduino_class_,analogueWrite(red_pin_, max_brightness - remainder - increment))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(red_pin_, max_brightness - remainder))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(red_pin_, max_brightness))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(red_pin_, max_brightness - increment))
-      .InSequence(s1);
-
-  // and bottom edge
-  EXPECT_CALL(mock_arduino_class_,analogueWrite(red_pin_, remainder + increment))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, remainder))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, 0))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, increment))
-      .InSequence(s2);
-
-  my_led_.set_colour(LEDColour::RED); //set red
-  my_led_.set_pulse(increment); //set pulse
-  for (uint8_t i =0; i <= iterations; i++) {
-    my_led_.pulse();
+  // duties the pins were last set to
+  RGB duty() const {
+    auto last = [](const std::vector<Write>& w) {
+      return w.empty() ? (uint8_t)0 : w.back().value;
+    };
+    return {last(red_), last(green_), last(blue_)};
+  }
+
+  // tick for ms
+  void run(uint32_t ms) {
+    uint32_t end = now_us_ + ms * 1000;
+    while (now_us_ < end) {
+      now_us_ += ArduinoInterface::tick_us;
+      my_led_.tick();
+    }
+  }
+
+  // us between brightness crossing half way going up, averaged
+  static double period(const std::vector<Write>& writes) {
+    std::vector<uint32_t> rising;
+    for (size_t i = 1; i < writes.size(); ++i) {
+      if (writes[i - 1].value < 128 && writes[i].value >= 128) {
+        rising.push_back(writes[i].us);
+      }
+    }
+    if (rising.size() < 2) {
+      return 0;
+    }
+    return (double)(rising.back() - rising.front())
+           / (double)(rising.size() - 1);
+  }
+};
+
+TEST_F(MyLEDEffectTest, StepFor) {
+  // a period of ms is ms * 1000 / tick_us ticks
+  for (uint32_t ms : {10u, 400u, 3000u, 65535u}) {
+    double ticks = 4294967296.0 / MyLED::step_for(ms);
+    ASSERT_NEAR(ticks, ms * 1000.0 / ArduinoInterface::tick_us, ticks / 1000);
+  }
+  ASSERT_EQ(MyLED::step_for(0), 0u);
+}
+
+TEST_F(MyLEDEffectTest, PulsePeriod) {
+  for (uint16_t ms : {400, 1000, 3000}) {
+    green_.clear();
+    my_led_.set_effect(LEDEffect::PULSE, ms);
+    run(10 * ms);
+    ASSERT_NEAR(period(green_), ms * 1000.0, ArduinoInterface::tick_us);
   }
 }
 
-TEST_F(MyLEDTest, PulseTestYellow) {
+TEST_F(MyLEDEffectTest, PulseStartsAtPeak) {
+  my_led_.set_colour(LEDColour::RED);
+  my_led_.set_effect(LEDEffect::PULSE, 1000);
+  ASSERT_EQ(red_.back().value, UINT8_MAX);
 
-  using testing::Sequence;
-  using testing::_;
-  using testing::AnyNumber;
-
-  Sequence s1, s2, s3, s4;
-
-  int8_t increment = 7; // odd number to really test method
-  uint8_t max_brightness = UINT8_MAX;
-  uint8_t iterations = 90;
-
-  uint8_t  remainder = max_brightness % increment;
-
-
-  // do we get calls?
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(_, _))
-      .Times(AnyNumber());
-
-  // Test top edge
-
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(green_pin_, max_brightness - remainder - increment))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(green_pin_, max_brightness - remainder))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(green_pin_, max_brightness))
-      .InSequence(s1);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(green_pin_, max_brightness - increment))
-      .InSequence(s1);
-
-  // need red and green pins for yellow
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(red_pin_, max_brightness - remainder - increment))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(red_pin_, max_brightness - remainder))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(red_pin_, max_brightness))
-      .InSequence(s2);
-  EXPECT_CALL(mock_arduino_class_,
-              analogueWrite(red_pin_, max_brightness - increment))
-      .InSequence(s2);
-
-  // and bottom edge
-  EXPECT_CALL(mock_arduino_class_,analogueWrite(green_pin_, remainder + increment))
-      .InSequence(s3);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, remainder))
-      .InSequence(s3);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, 0))
-      .InSequence(s3);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(green_pin_, increment))
-      .InSequence(s3);
-
-  EXPECT_CALL(mock_arduino_class_,analogueWrite(red_pin_, remainder + increment))
-      .InSequence(s4);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, remainder))
-      .InSequence(s4);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, 0))
-      .InSequence(s4);
-  EXPECT_CALL(mock_arduino_class_, analogueWrite(red_pin_, increment))
-      .InSequence(s4);
-
-  my_led_.set_colour(LEDColour::YELLOW); //set green
-  my_led_.set_pulse(increment); //set pulse
-  for (uint8_t i =0; i <= iterations; i++) {
-    my_led_.pulse();
+  // dark by half a period on, and not before it's started dimming
+  run(500);
+  ASSERT_EQ(red_.back().value, 0);
+  ASSERT_GT(red_.back().us, 250000u);
+}
+
+TEST_F(MyLEDEffectTest, Blink) {
+  my_led_.set_effect(LEDEffect::BLINK, 500);
+  run(2000);
+
+  // only ever fully on or off, for half a period each
+  ASSERT_EQ(green_.size(), 9u);
+  for (size_t i = 1; i < green_.size(); ++i) {
+    ASSERT_EQ(green_[i].value, (i % 2) ? 0 : UINT8_MAX);
+    ASSERT_NEAR(green_[i].us - green_[i - 1].us, (i == 1) ? 125000.0 : 250000.0,
+                ArduinoInterface::tick_us);
+  }
+}
+
+// steady doesn't write anything it doesn't need to
+TEST_F(MyLEDEffectTest, SteadyWritesOnce) {
+  my_led_.set_effect(LEDEffect::STEADY);
+  run(1000);
+  ASSERT_EQ(green_.size(), 1u);
+  ASSERT_TRUE(red_.empty());
+}
+
+TEST_F(MyLEDEffectTest, Crossfade) {
+  my_led_.set_colour(LEDColour::RED);
+  red_.clear();
+  green_.clear();
+
+  my_led_.set_colour(LEDColour::GREEN, 200);
+  run(400);
+
+  // red only goes down and green only up, ending up changed over when the
+  // fade is done
+  for (size_t i = 1; i < red_.size(); ++i) {
+    ASSERT_LT(red_[i].value, red_[i - 1].value);
+  }
+  for (size_t i = 1; i < green_.size(); ++i) {
+    ASSERT_GT(green_[i].value, green_[i - 1].value);
+  }
+  // the top of the curve is flat, so it can get there a few ticks early
+  ASSERT_EQ(red_.back().value, 0);
+  ASSERT_EQ(green_.back().value, UINT8_MAX);
+  ASSERT_GE(green_.back().us, 195000u);
+  ASSERT_LE(green_.back().us, 200000u + ArduinoInterface::tick_us);
+
+  // half way through, it looks half way across, which is gamma corrected to
+  // nearer a fifth of the duty
+  auto half = std::find_if(green_.begin(), green_.end(),
+                           [](const Write& w) { return w.us >= 100000; });
+  ASSERT_NEAR(half->value, MyLED::breath(MyLED::peak / 2), 2);
+  ASSERT_LT(half->value, 64);
+}
+
+// a fade started part way through another carries on from where it got to
+TEST_F(MyLEDEffectTest, CrossfadeInterrupted) {
+  my_led_.set_colour(LEDColour::RED);
+  my_led_.set_colour(LEDColour::GREEN, 200);
+  run(100);
+  uint8_t red = red_.back().value, green = green_.back().value;
+
+  my_led_.set_colour(LEDColour::RED, 200);
+  run(1);
+
+  ASSERT_NEAR(red_.back().value, red, 2);
+  ASSERT_NEAR(green_.back().value, green, 2);
+  run(300);
+  ASSERT_EQ(red_.back().value, UINT8_MAX);
+  ASSERT_EQ(green_.back().value, 0);
+}
+
+// the pulse is applied on top of the colour, so yellow pulses both
+TEST_F(MyLEDEffectTest, PulseYellow) {
+  my_led_.set_colour(LEDColour::YELLOW);
+  my_led_.set_effect(LEDEffect::PULSE, 400);
+  run(2000);
+
+  ASSERT_NEAR(period(red_), 400000.0, ArduinoInterface::tick_us);
+  ASSERT_EQ(red_.size(), green_.size());
+}
+
+/*
+ * Colour tests
+ */
+
+// every named colour gets to the pins as it is in the palette, and no two
+// are the same
+TEST_F(MyLEDEffectTest, Palette) {
+  std::vector<RGB> seen;
+
+  for (uint8_t c = 0; c <= (uint8_t)LEDColour::WHITE; ++c) {
+    RGB rgb = MyLED::colour((LEDColour)c);
+    my_led_.set_colour((LEDColour)c);
+    ASSERT_EQ(duty(), rgb) << "colour " << (int)c;
+
+    for (const RGB& other : seen) {
+      ASSERT_NE(rgb, other);
+    }
+    seen.push_back(rgb);
+  }
+  ASSERT_EQ(MyLED::colour(LEDColour::BLUE), (RGB{0, 0, UINT8_MAX}));
+}
+
+TEST_F(MyLEDEffectTest, SetRGB) {
+  my_led_.set_colour(RGB{10, 20, 30});
+  ASSERT_EQ(duty(), (RGB{10, 20, 30}));
+}
+
+// balance is applied when the colour is set
+TEST_F(MyLEDEffectTest, Balance) {
+  my_led_.set_balance({UINT8_MAX, 128, 64});
+  my_led_.set_colour(LEDColour::WHITE);
+  ASSERT_EQ(duty(), (RGB{UINT8_MAX, 128, 64}));
+
+  my_led_.set_colour(RGB{128, 128, 128});
+  ASSERT_EQ(duty(), (RGB{128, 64, 32}));
+}
+
+// the pulse scales all three channels alike
+TEST_F(MyLEDEffectTest, PulseRGB) {
+  my_led_.set_colour(RGB{UINT8_MAX, 128, 64});
+  my_led_.set_effect(LEDEffect::PULSE, 400);
+
+  for (int i = 0; i < 1000; ++i) {
+    run(1);
+    RGB d = duty();
+    ASSERT_NEAR(d.green, d.red * 128 / 255.0, 1.0);
+    ASSERT_NEAR(d.blue, d.red * 64 / 255.0, 1.0);
+  }
+  ASSERT_NEAR(period(red_), 400000.0, ArduinoInterface::tick_us);
+}
+
+TEST_F(MyLEDEffectTest, CrossfadeRGB) {
+  my_led_.set_colour(LEDColour::BLUE);
+  my_led_.set_colour(LEDColour::ORANGE, 100);
+  run(200);
+
+  ASSERT_EQ(duty(), MyLED::colour(LEDColour::ORANGE));
+  for (size_t i = 1; i < blue_.size(); ++i) {
+    ASSERT_LT(blue_[i].value, blue_[i - 1].value);
+  }
+}
+
+TEST(MyLEDHSVTest, Primaries) {
+  ASSERT_EQ(MyLED::hsv(0, 255, 255), (RGB{255, 0, 0}));
+  ASSERT_EQ(MyLED::hsv(43, 255, 255), (RGB{255, 255, 0}));
+  ASSERT_EQ(MyLED::hsv(86, 255, 255), (RGB{0, 255, 0}));
+  ASSERT_EQ(MyLED::hsv(129, 255, 255), (RGB{0, 255, 255}));
+  ASSERT_EQ(MyLED::hsv(172, 255, 255), (RGB{0, 0, 255}));
+  ASSERT_EQ(MyLED::hsv(215, 255, 255), (RGB{255, 0, 255}));
+
+  // no saturation is grey, whatever the hue
+  for (int hue = 0; hue < 256; ++hue) {
+    ASSERT_EQ(MyLED::hsv((uint8_t)hue, 0, 100), (RGB{100, 100, 100}));
+  }
+
+  // worked out at compile time
+  static_assert(MyLED::hsv(0, 255, 128) == RGB{128, 0, 0}, "");
+}
+
+// round the wheel against the usual floating point conversion
+TEST(MyLEDHSVTest, Wheel) {
+  for (int hue = 0; hue < 256; ++hue) {
+    for (int sat : {64, 255}) {
+      double h = hue / 43.0, s = sat / 255.0, v = 200;
+      int region = (int)h;
+      double f = h - region;
+      double p = v * (1 - s), q = v * (1 - s * f), t = v * (1 - s * (1 - f));
+      double r, g, b;
+      switch (region) {
+        case 0: r = v, g = t, b = p; break;
+        case 1: r = q, g = v, b = p; break;
+        case 2: r = p, g = v, b = t; break;
+        case 3: r = p, g = q, b = v; break;
+        case 4: r = t, g = p, b = v; break;
+        default: r = v, g = p, b = q; break;
+      }
+
+      RGB rgb = MyLED::hsv((uint8_t)hue, (uint8_t)sat, 200);
+      ASSERT_NEAR(rgb.red, r, 3) << "hue " << hue;
+      ASSERT_NEAR(rgb.green, g, 3) << "hue " << hue;
+      ASSERT_NEAR(rgb.blue, b, 3) << "hue " << hue;
+    }
   }
 }
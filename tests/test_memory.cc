@@ -0,0 +1,152 @@
+#include <gmock/gmock.h>
+#include <Memory.h>
+#include <LinkedList.h>
+
+namespace {
+
+struct Block {
+  uint8_t bytes[100];
+};
+
+// takes at least depth * 256 bytes of stack
+__attribute__((noinline)) uint32_t use_stack(uint32_t depth) {
+  volatile uint8_t buffer[256];
+  buffer[0] = (uint8_t)depth;
+  buffer[255] = (uint8_t)depth;
+  return (depth == 0) ? buffer[0] : use_stack(depth - 1) + buffer[255];
+}
+
+} // namespace
+
+class MemoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Memory::clear();
+  }
+
+  void TearDown() override {
+    Memory::clear();
+  }
+};
+
+TEST_F(MemoryTest, TestCounts) {
+  auto a = new (Memory::heap) Block;
+  auto b = new (Memory::heap) uint32_t {7};
+
+  ASSERT_EQ(*b, 7u);
+  ASSERT_EQ(Memory::stats().count, 2);
+  ASSERT_EQ(Memory::stats().bytes, sizeof(Block) + sizeof(uint32_t));
+
+  heap_delete(a);
+  heap_delete(b);
+
+  ASSERT_EQ(Memory::stats().count, 0);
+  ASSERT_EQ(Memory::stats().bytes, 0u);
+}
+
+TEST_F(MemoryTest, TestPeak) {
+  Block* blocks[3];
+  for (auto& block : blocks) {
+    block = new (Memory::heap) Block;
+  }
+  heap_delete(blocks[0]);
+  heap_delete(blocks[1]);
+  auto more = new (Memory::heap) uint8_t;
+
+  auto stats = Memory::stats();
+  ASSERT_EQ(stats.count, 2);
+  ASSERT_EQ(stats.peak_count, 3);
+  ASSERT_EQ(stats.peak_bytes, 3 * sizeof(Block));
+
+  heap_delete(blocks[2]);
+  heap_delete(more);
+}
+
+TEST_F(MemoryTest, TestFailed) {
+  // too big to put the size in front of, and too big for malloc
+  ASSERT_EQ(operator new(SIZE_MAX - 1, Memory::heap), nullptr);
+  ASSERT_EQ(operator new(SIZE_MAX / 2, Memory::heap), nullptr);
+
+  ASSERT_EQ(Memory::stats().failed, 2);
+  ASSERT_EQ(Memory::stats().count, 0);
+}
+
+TEST_F(MemoryTest, TestNullDelete) {
+  heap_delete((Block*)nullptr);
+
+  ASSERT_EQ(Memory::stats().count, 0);
+}
+
+// freed after clear(), so never counted
+TEST_F(MemoryTest, TestClear) {
+  auto block = new (Memory::heap) Block;
+  Memory::clear();
+
+  heap_delete(block);
+
+  ASSERT_EQ(Memory::stats().count, 0);
+  ASSERT_EQ(Memory::stats().bytes, 0u);
+  ASSERT_EQ(Memory::stats().peak_count, 0);
+}
+
+TEST_F(MemoryTest, TestLinkedList) {
+  {
+    LinkedList<int> list;
+    list.insert(1);
+    list.insert(2);
+    list.insert(3);
+    ASSERT_EQ(Memory::stats().count, 3);
+
+    list.remove(2);
+    ASSERT_EQ(Memory::stats().count, 2);
+  }
+
+  ASSERT_EQ(Memory::stats().count, 0);
+  ASSERT_EQ(Memory::stats().peak_count, 3);
+}
+
+// a node that can't be had leaves the list as it was
+TEST_F(MemoryTest, TestLinkedListFull) {
+  LinkedList<int> list;
+  Memory::fail_next(1);
+  ASSERT_FALSE(list.insert(1));
+  ASSERT_EQ(list.begin(), list.end());
+
+  ASSERT_TRUE(list.insert(2));
+  Memory::fail_next(1);
+  ASSERT_FALSE(list.insert(3));
+  ASSERT_EQ(**list.begin(), 2);
+  ASSERT_EQ(Memory::stats().failed, 2);
+}
+
+TEST_F(MemoryTest, TestUnpainted) {
+  ASSERT_EQ(Memory::measure(), 0u);
+  ASSERT_EQ(Memory::min_free_stack(), 0u);
+}
+
+// the paint the stack wrote over stays gone once it's come back up
+TEST_F(MemoryTest, TestStack) {
+  Memory::paint();
+  size_t painted = Memory::measure();
+  ASSERT_GT(painted, Memory::host_stack / 2);
+
+  use_stack(16);
+  size_t used = painted - Memory::measure();
+
+  ASSERT_GE(used, 16u * 256);
+  ASSERT_LT(used, painted);
+  ASSERT_EQ(Memory::measure(), painted - used);
+  ASSERT_EQ(Memory::min_free_stack(), painted - used);
+  ASSERT_EQ(Memory::free_stack(), painted - used);
+}
+
+TEST_F(MemoryTest, TestFailNext) {
+  Memory::fail_next(1);
+  ASSERT_EQ(new (Memory::heap) Block, nullptr);
+  auto block = new (Memory::heap) Block;
+  ASSERT_NE(block, nullptr);
+  heap_delete(block);
+
+  ASSERT_EQ(Memory::stats().failed, 1);
+  ASSERT_EQ(Memory::stats().peak_count, 1);
+}
@@ -0,0 +1,201 @@
+#include <gmock/gmock.h>
+#include <MonteCarlo.h>
+#include <RadarState.h>
+#include <WorkStealingPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/*
+ * WorkStealingPool tests
+ */
+
+TEST(WorkStealingPoolTest, TestRunsEveryJobOnce) {
+  WorkStealingPool pool {4};
+  std::vector<std::atomic<int>> counts(1000);
+
+  pool.run(counts.size(), [&](size_t i, unsigned worker) {
+    ASSERT_LT(worker, 4u);
+    ++counts[i];
+  });
+
+  for (size_t i = 0; i < counts.size(); ++i) {
+    ASSERT_EQ(counts[i], 1) << "i = " << i;
+  }
+}
+
+// worker 0 is dealt all the slow jobs, so the others come and take them
+TEST(WorkStealingPoolTest, TestSteals) {
+  WorkStealingPool pool {4};
+  std::atomic<int> done {0};
+
+  pool.run(200, [&](size_t i, unsigned) {
+    if (i < 50) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ++done;
+  });
+
+  ASSERT_EQ(done, 200);
+  ASSERT_GT(pool.steals(), 0u);
+}
+
+TEST(WorkStealingPoolTest, TestOneThread) {
+  WorkStealingPool pool {1};
+  std::vector<size_t> order;
+
+  pool.run(5, [&](size_t i, unsigned) { order.push_back(i); });
+
+  // own work comes off the back
+  ASSERT_THAT(order, ::testing::ElementsAre(4, 3, 2, 1, 0));
+  ASSERT_EQ(pool.steals(), 0u);
+}
+
+TEST(WorkStealingPoolTest, TestNoJobs) {
+  WorkStealingPool pool {3};
+  pool.run(0, [](size_t, unsigned) { FAIL(); });
+}
+
+/*
+ * MonteCarlo tests
+ */
+
+TEST(MonteCarloTest, TestScenarioRepeats) {
+  auto a = MonteCarlo::make_scenario(42);
+  auto b = MonteCarlo::make_scenario(42);
+
+  ASSERT_EQ(a.intruder, b.intruder);
+  ASSERT_EQ(a.scene.targets().size(), b.scene.targets().size());
+  ASSERT_EQ(a.sensor.seed, b.sensor.seed);
+  ASSERT_EQ(a.pir_from_ms, b.pir_from_ms);
+  ASSERT_EQ(MonteCarlo::run(a), MonteCarlo::run(b));
+}
+
+// something walking straight up close is seen, soon after it's in range
+TEST(MonteCarloTest, TestIntruderDetected) {
+  MonteCarlo::Scenario s;
+  s.intruder = true;
+  s.duration_s = 11;
+  s.sensor.trigger_pin = CFG::trigger_pin;
+  s.sensor.echo_pin = CFG::echo_pin;
+  s.sensor.noise_mm = 0;
+  s.sensor.dropout = 0;
+  s.sensor.multipath = 0;
+  // from 2.5m at 90°, in range after 8.75s and 150mm off at the end
+  s.scene.add(90, 2500, 150, 0, -200);
+  s.pir_from_ms = 1000;
+  s.pir_to_ms = 11000;
+
+  auto outcome = MonteCarlo::run(s);
+
+  ASSERT_TRUE(outcome.entered);
+  ASSERT_TRUE(outcome.detected);
+  ASSERT_LT(outcome.latency_ms, 5000u);
+  ASSERT_EQ(outcome.false_alarms, 0u);
+}
+
+// with distance_yellow raised the same walk is in range, and seen, seconds
+// sooner, and scored against the setting rather than CFG
+TEST(MonteCarloTest, TestSettings) {
+  MonteCarlo::Scenario s;
+  s.intruder = true;
+  s.duration_s = 7;
+  s.sensor.trigger_pin = CFG::trigger_pin;
+  s.sensor.echo_pin = CFG::echo_pin;
+  s.sensor.noise_mm = 0;
+  s.sensor.dropout = 0;
+  s.sensor.multipath = 0;
+  // in range of 1500mm after 4.25s, but never of the default 600mm
+  s.scene.add(90, 2500, 150, 0, -200);
+  s.pir_from_ms = 1000;
+  s.pir_to_ms = 7000;
+
+  auto outcome = MonteCarlo::run(s);
+  ASSERT_FALSE(outcome.entered);
+  ASSERT_EQ(outcome.decisions, 0u);
+
+  s.settings = {{Settings::Id::DISTANCE_GREEN, 2000},
+                {Settings::Id::DISTANCE_YELLOW, 1500}};
+  outcome = MonteCarlo::run(s);
+  ASSERT_TRUE(outcome.entered);
+  ASSERT_TRUE(outcome.detected);
+  ASSERT_LT(outcome.latency_ms, 2000u);
+  ASSERT_GT(outcome.decisions, 0u);
+  ASSERT_EQ(outcome.false_alarms, 0u);
+  ASSERT_EQ(Settings::get(Settings::Id::DISTANCE_YELLOW), 1500u);
+  Settings::defaults();
+}
+
+TEST(MonteCarloTest, TestEmptyRoomQuiet) {
+  MonteCarlo::Scenario s;
+  s.duration_s = 60;
+  s.sensor.trigger_pin = CFG::trigger_pin;
+  s.sensor.echo_pin = CFG::echo_pin;
+  s.sensor.noise_mm = 0;
+  s.scene.add(45, 2000, 300);
+  s.pir_from_ms = 10000;   // the cat
+  s.pir_to_ms = 12000;
+
+  auto outcome = MonteCarlo::run(s);
+
+  ASSERT_FALSE(outcome.entered);
+  ASSERT_EQ(outcome.decisions, 0u);
+  ASSERT_EQ(outcome.false_alarms, 0u);
+}
+
+// a clean room with a noisy sensor: anything decided is a false alarm
+TEST(MonteCarloTest, TestFalseAlarm) {
+  MonteCarlo::Scenario s;
+  s.duration_s = 60;
+  s.sensor.trigger_pin = CFG::trigger_pin;
+  s.sensor.echo_pin = CFG::echo_pin;
+  s.sensor.noise_mm = 150;
+  s.scene.add(90, 800, 50);
+  s.pir_from_ms = 1000;
+  s.pir_to_ms = 60000;
+
+  auto outcome = MonteCarlo::run(s);
+
+  ASSERT_GT(outcome.decisions, 0u);
+  ASSERT_EQ(outcome.false_alarms, outcome.decisions);
+}
+
+// each thread has its own simulator and firmware globals, so running in
+// parallel can't change the answer
+TEST(MonteCarloTest, TestParallelMatchesSerial) {
+  const size_t n = 16;
+  MonteCarlo::Ranges ranges;
+  ranges.duration_s = 30;
+
+  std::vector<MonteCarlo::Outcome> serial;
+  for (size_t i = 0; i < n; ++i) {
+    serial.push_back(MonteCarlo::run(MonteCarlo::make_scenario(i, ranges)));
+  }
+
+  std::vector<MonteCarlo::Outcome> parallel(n);
+  WorkStealingPool pool {4};
+  pool.run(n, [&](size_t i, unsigned) {
+    parallel[i] = MonteCarlo::run(MonteCarlo::make_scenario(i, ranges));
+  });
+
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(serial[i], parallel[i]) << "i = " << i;
+  }
+}
+
+TEST(MonteCarloTest, TestSummary) {
+  MonteCarlo::Summary summary;
+  summary.add({1, true, true, true, 400, 10, 0, 120});
+  summary.add({2, true, true, true, 200, 12, 1, 120});
+  summary.add({3, true, true, false, 0, 0, 0, 120});
+  summary.add({4, false, false, false, 0, 2, 2, 120});
+
+  ASSERT_EQ(summary.runs(), 4u);
+  ASSERT_EQ(summary.detected(), 2u);
+  ASSERT_EQ(summary.missed(), 1u);
+  ASSERT_EQ(summary.false_alarms(), 3u);
+  ASSERT_EQ(summary.latency_percentile(0), 200u);
+  ASSERT_EQ(summary.latency_percentile(1), 400u);
+}
@@ -0,0 +1,166 @@
+#include <gmock/gmock.h>
+#include <OccupancyGrid.h>
+
+#include <cmath>
+#include <sstream>
+
+class OccupancyGridTest : public ::testing::Test {
+ protected:
+  OccupancyGrid::Params params_;
+  OccupancyGrid grid_ {params_};
+
+  // the radar's cell
+  uint32_t centre_x_ {grid_.width() / 2};
+};
+
+TEST_F(OccupancyGridTest, TestSize) {
+  // 4000mm / 20mm = 200 cells each way, plus the radar's cell
+  ASSERT_EQ(grid_.width(), 401u);
+  ASSERT_EQ(grid_.height(), 201u);
+}
+
+// part of a cell at the end is a whole one
+TEST_F(OccupancyGridTest, TestSizeRoundsUp) {
+  OccupancyGrid::Params params;
+  params.max_range_mm = 4001;
+  OccupancyGrid grid {params};
+  ASSERT_EQ(grid.width(), 403u);
+  ASSERT_EQ(grid.height(), 202u);
+}
+
+// straight ahead, cells up to the hit are free, the hit is occupied and
+// anything past it is still unknown
+TEST_F(OccupancyGridTest, TestRayStraightAhead) {
+  ASSERT_TRUE(grid_.add_ray(90, 1000));
+
+  for (uint32_t y = 0; y < 50; ++y) {
+    ASSERT_EQ(grid_.at(centre_x_, y), params_.miss) << "y = " << y;
+  }
+  ASSERT_EQ(grid_.at(centre_x_, 50), params_.hit);
+  ASSERT_EQ(grid_.at(centre_x_, 51), 0);
+
+  // nothing either side
+  ASSERT_EQ(grid_.at(centre_x_ - 1, 25), 0);
+  ASSERT_EQ(grid_.at(centre_x_ + 1, 25), 0);
+}
+
+TEST_F(OccupancyGridTest, TestRayRightAndLeft) {
+  grid_.add_ray(0, 200);
+  grid_.add_ray(180, 200);
+
+  ASSERT_EQ(grid_.at(centre_x_ + 10, 0), params_.hit);
+  ASSERT_EQ(grid_.at(centre_x_ - 10, 0), params_.hit);
+  ASSERT_EQ(grid_.at(centre_x_ + 5, 0), params_.miss);
+  ASSERT_EQ(grid_.at(centre_x_ - 5, 0), params_.miss);
+}
+
+TEST_F(OccupancyGridTest, TestIgnoredRays) {
+  ASSERT_FALSE(grid_.add_ray(90, UINT32_MAX));
+  ASSERT_FALSE(grid_.add_ray(90, params_.max_range_mm + 1));
+  ASSERT_FALSE(grid_.add_ray(-1, 1000));
+  ASSERT_FALSE(grid_.add_ray(181, 1000));
+  ASSERT_EQ(grid_.rays(), 0u);
+
+  ASSERT_TRUE(grid_.add_ray(90, params_.max_range_mm));
+  ASSERT_EQ(grid_.rays(), 1u);
+}
+
+TEST_F(OccupancyGridTest, TestSaturate) {
+  for (int i = 0; i < 100; ++i) {
+    grid_.add_ray(90, 1000);
+  }
+
+  ASSERT_EQ(grid_.at(centre_x_, 50), params_.max);
+  ASSERT_EQ(grid_.at(centre_x_, 10), params_.min);
+}
+
+/*
+ * Compare the vectorised ray march against a plain scalar walk for every
+ * whole degree, at a range that's not a multiple of the cell size.
+ */
+TEST_F(OccupancyGridTest, TestMarchMatchesScalar) {
+  const float pi {3.14159265358979f};
+
+  for (int angle = 0; angle <= 180; ++angle) {
+    grid_.clear();
+    grid_.add_ray((float)angle, 3333);
+
+    float radians = (float)angle * pi / 180;
+    float range = 3333.0f / params_.cell_mm;
+    float origin_x = (float)centre_x_ + 0.5f, origin_y = 0.5f;
+    float dx = range * std::cos(radians), dy = range * std::sin(radians);
+    float length = std::fmax(std::fabs(dx), std::fabs(dy));
+
+    auto steps = (uint32_t)length;
+    for (uint32_t i = 0; i < steps; ++i) {
+      auto x = (uint32_t)(origin_x + (float)i * (dx / length));
+      auto y = (uint32_t)(origin_y + (float)i * (dy / length));
+      ASSERT_EQ(grid_.at(x, y), params_.miss)
+          << "angle = " << angle << ", step " << i;
+    }
+
+    // the hit must never be overwritten by the free space march
+    auto hit_x = (uint32_t)(origin_x + dx), hit_y = (uint32_t)(origin_y + dy);
+    ASSERT_EQ(grid_.at(hit_x, hit_y), params_.hit) << "angle = " << angle;
+  }
+}
+
+TEST_F(OccupancyGridTest, TestCellOf) {
+  uint32_t x = 0, y = 0;
+
+  ASSERT_TRUE(grid_.cell_of(0, 1000, x, y));
+  ASSERT_EQ(x, centre_x_);
+  ASSERT_EQ(y, 50u);
+
+  ASSERT_FALSE(grid_.cell_of(0, -100, x, y));
+}
+
+TEST_F(OccupancyGridTest, TestIngest) {
+  std::istringstream in {
+      "time_ms,angle,range_mm,state\n"
+      "# a comment\n"
+      "0,90,1000,1\n"
+      "550 45 2000\n"
+      "1100,\t0,4294967295\n"
+      "1650,bad,1000\n"};
+
+  ASSERT_EQ(ingest(in, grid_), 3u);
+  ASSERT_EQ(grid_.rays(), 2u); // no echo isn't a ray
+  ASSERT_EQ(grid_.at(centre_x_, 50), params_.hit);
+}
+
+// strtod() reads these happily, but none of them is a range or an angle
+TEST_F(OccupancyGridTest, TestIngestBadNumbers) {
+  std::istringstream in {
+      "0,90,nan\n"
+      "550,90,inf\n"
+      "1100,90,-1000\n"
+      "1650,90,1e20\n"
+      "2200,nan,1000\n"
+      "2750,-inf,1000\n"
+      "3300,90,1000\n"};
+
+  ASSERT_EQ(ingest(in, grid_), 1u);
+  ASSERT_EQ(grid_.rays(), 1u);
+}
+
+TEST_F(OccupancyGridTest, TestWritePGM) {
+  grid_.add_ray(90, 1000);
+
+  std::ostringstream out;
+  grid_.write_pgm(out);
+  std::string image = out.str();
+
+  std::string header {"P5\n401 201\n255\n"};
+  ASSERT_EQ(image.compare(0, header.size(), header), 0);
+  ASSERT_EQ(image.size(), header.size() + 401 * 201);
+
+  // image rows go top to bottom, so the radar's row is last
+  auto pixel = [&](uint32_t x, uint32_t y) {
+    return (uint8_t)image[header.size() + (200 - y) * 401 + x];
+  };
+
+  ASSERT_EQ(pixel(0, 200), 128);            // unknown
+  ASSERT_LT(pixel(centre_x_, 50), 128);     // occupied is dark
+  ASSERT_GT(pixel(centre_x_, 10), 128);     // free is light
+}
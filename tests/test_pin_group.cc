@@ -0,0 +1,117 @@
+#include <gmock/gmock.h>
+#include <PinGroup.h>
+
+#include <test/MockArduino.h>
+
+/*
+ * PinGroupTest
+ *
+ * Ports B, C and D are plain bytes here, mapped to pins the way an Uno maps
+ * them: 0-7 are PD0-PD7, 8-13 are PB0-PB5 and A0-A5 (14-19) are PC0-PC5.
+ * write() is checked bit for bit against writing each pin on its own, which
+ * is what digitalWrite() would have done.
+ */
+class PinGroupTest : public ::testing::Test {
+ protected:
+  testing::NiceMock<MockArduinoClass> mock_arduino_;
+
+  // ports as they'd look with nothing else on them
+  static constexpr uint8_t background_ {0b10100101};
+  volatile uint8_t port_b_ {background_};
+  volatile uint8_t port_c_ {background_};
+  volatile uint8_t port_d_ {background_};
+  volatile uint8_t spare_[2] {};
+
+  PinGroup group_;
+
+  volatile uint8_t* port_of(uint8_t pin) {
+    if (pin < 8) return &port_d_;
+    if (pin < 14) return &port_b_;
+    if (pin < 20) return &port_c_;
+    return &spare_[pin & 1];  // pretend 20+ are on other ports
+  }
+  static uint8_t bit_of(uint8_t pin) {
+    if (pin < 8) return 1 << pin;
+    if (pin < 14) return 1 << (pin - 8);
+    return 1 << ((pin - 14) % 6);
+  }
+
+  void SetUp() override {
+    using testing::_;
+    using testing::Invoke;
+
+    MockArduino::mock = &mock_arduino_;
+    ON_CALL(mock_arduino_, port_output_register(_))
+        .WillByDefault(Invoke([this](uint8_t pin) { return port_of(pin); }));
+    ON_CALL(mock_arduino_, pin_bit_mask(_))
+        .WillByDefault(Invoke(bit_of));
+  }
+
+  // write every value, and check each port against setting pin by pin
+  void check_every_value(const uint8_t pins[], uint8_t n) {
+    for (uint16_t value = 0; value < (1u << n); ++value) {
+      group_.write((uint8_t)value);
+
+      uint8_t b = background_, c = background_, d = background_;
+      for (uint8_t i = 0; i < n; ++i) {
+        uint8_t* port = (pins[i] < 8) ? &d : (pins[i] < 14) ? &b : &c;
+        if ((value >> i) & 1) {
+          *port |= bit_of(pins[i]);
+        } else {
+          *port &= ~bit_of(pins[i]);
+        }
+      }
+
+      ASSERT_EQ(port_b_, b) << "value " << value;
+      ASSERT_EQ(port_c_, c) << "value " << value;
+      ASSERT_EQ(port_d_, d) << "value " << value;
+
+      port_b_ = port_c_ = port_d_ = background_;
+    }
+  }
+};
+
+// the radar's LCD data pins, from CFG
+TEST_F(PinGroupTest, TestLCDPins) {
+  const uint8_t pins[] {16, 17, 18, 19, 13, 12, 8, 7};
+
+  ASSERT_TRUE(group_.init(pins, 8));
+  ASSERT_EQ(group_.ports(), 3);
+  check_every_value(pins, 8);
+}
+
+// the way round the LiquidCrystal examples wire a 4 bit LCD
+TEST_F(PinGroupTest, TestNibble) {
+  const uint8_t pins[] {5, 4, 3, 2};
+
+  ASSERT_TRUE(group_.init(pins, 4));
+  ASSERT_EQ(group_.ports(), 1);
+  check_every_value(pins, 4);
+}
+
+TEST_F(PinGroupTest, TestBitsPastLastPinIgnored) {
+  const uint8_t pins[] {8, 9};
+
+  group_.init(pins, 2);
+  group_.write(0xFC);
+
+  ASSERT_EQ(port_b_, background_ & ~0b11);
+  ASSERT_EQ(port_c_, background_);
+  ASSERT_EQ(port_d_, background_);
+}
+
+TEST_F(PinGroupTest, TestTooManyPorts) {
+  const uint8_t pins[] {0, 8, 14, 20, 21};
+
+  ASSERT_FALSE(group_.init(pins, 5));
+  ASSERT_EQ(group_.ports(), 0);
+
+  group_.write(0xFF);
+  ASSERT_EQ(port_b_, background_);
+}
+
+TEST_F(PinGroupTest, TestTooManyPins) {
+  const uint8_t pins[9] {};
+
+  ASSERT_FALSE(group_.init(pins, 9));
+}
@@ -0,0 +1,123 @@
+#include <gmock/gmock.h>
+#include <Profiler.h>
+
+using ::testing::Return;
+
+namespace {
+
+// stand ins for commands, only their addresses matter
+void command_a(void*) {}
+void command_b(void*) {}
+
+} // namespace
+
+class ProfilerTest : public ::testing::Test {
+ protected:
+  MockArduinoClass mock_arduino_;
+
+  void SetUp() override {
+    MockArduino::mock = &mock_arduino_;
+    EXPECT_CALL(mock_arduino_, millis()).WillOnce(Return(0));
+    Profiler::clear();
+  }
+};
+
+TEST_F(ProfilerTest, TestBucket) {
+  ASSERT_EQ(Profiler::bucket(0), 0);
+  ASSERT_EQ(Profiler::bucket(1), 0);
+  ASSERT_EQ(Profiler::bucket(2), 1);
+  ASSERT_EQ(Profiler::bucket(3), 1);
+  ASSERT_EQ(Profiler::bucket(4), 2);
+  ASSERT_EQ(Profiler::bucket(ArduinoInterface::frame_ticks), 15);
+  ASSERT_EQ(Profiler::bucket(UINT16_MAX), Profiler::buckets - 1);
+}
+
+TEST_F(ProfilerTest, TestElapsed) {
+  ASSERT_EQ(Profiler::elapsed(100, 150), 50);
+  ASSERT_EQ(Profiler::elapsed(100, 100), 0);
+  // Servo started a new frame in between
+  ASSERT_EQ(Profiler::elapsed(ArduinoInterface::frame_ticks - 10, 20), 30);
+}
+
+TEST_F(ProfilerTest, TestAdd) {
+  Profiler::add("probe", "probe", 30);
+  Profiler::add("probe", nullptr, 5);
+  Profiler::add_isr("probe", nullptr, 6);
+
+  auto slot = Profiler::find("probe");
+  ASSERT_NE(slot, nullptr);
+  ASSERT_STREQ(slot->name, "probe");
+  ASSERT_EQ(slot->calls, 3u);
+  ASSERT_EQ(slot->total, 41u);
+  ASSERT_EQ(slot->max, 30);
+  ASSERT_EQ(slot->counts[2], 2);
+  ASSERT_EQ(slot->counts[4], 1);
+}
+
+TEST_F(ProfilerTest, TestScope) {
+  EXPECT_CALL(mock_arduino_, timer_ticks())
+      .WillOnce(Return(100))
+      .WillOnce(Return(164))
+      .WillOnce(Return(ArduinoInterface::frame_ticks - 2))
+      .WillOnce(Return(2));
+
+  { Profiler::Scope scope {"main", "main"}; }
+  { Profiler::IsrScope scope {"isr", "isr"}; }
+
+  ASSERT_EQ(Profiler::find("main")->max, 64);
+  ASSERT_EQ(Profiler::find("main")->counts[6], 1);
+  ASSERT_EQ(Profiler::find("isr")->max, 4);
+}
+
+TEST_F(ProfilerTest, TestCommandNames) {
+  Profiler::name((Profiler::Id)command_a, "a");
+  Profiler::add((Profiler::Id)command_b, nullptr, 1);
+  Profiler::add((Profiler::Id)command_a, nullptr, 1);
+
+  ASSERT_STREQ(Profiler::find((Profiler::Id)command_a)->name, "a");
+  ASSERT_EQ(Profiler::find((Profiler::Id)command_a)->calls, 1u);
+  ASSERT_EQ(Profiler::find((Profiler::Id)command_b)->name, nullptr);
+}
+
+// a full bucket halves the lot, so the shape is kept
+TEST_F(ProfilerTest, TestSaturate) {
+  Profiler::add("probe", nullptr, 8);
+  Profiler::add("probe", nullptr, 8);
+  for (uint32_t i = 0; i < UINT16_MAX; ++i) {
+    Profiler::add("probe", nullptr, 0);
+  }
+  ASSERT_EQ(Profiler::find("probe")->counts[0], UINT16_MAX);
+
+  Profiler::add("probe", nullptr, 0);
+
+  auto slot = Profiler::find("probe");
+  ASSERT_EQ(slot->counts[0], UINT16_MAX / 2 + 1);
+  ASSERT_EQ(slot->counts[3], 1);
+  ASSERT_EQ(slot->calls, UINT16_MAX + 3u);
+}
+
+TEST_F(ProfilerTest, TestSlotsFull) {
+  static const char ids[Profiler::slots + 1] {};
+  for (auto& id : ids) {
+    Profiler::add(&id, nullptr, 1);
+  }
+
+  ASSERT_NE(Profiler::find(&ids[Profiler::slots - 1]), nullptr);
+  ASSERT_EQ(Profiler::find(&ids[Profiler::slots]), nullptr);
+  ASSERT_EQ(Profiler::unplaced(), 1);
+}
+
+TEST_F(ProfilerTest, TestReset) {
+  EXPECT_CALL(mock_arduino_, millis()).WillOnce(Return(10000));
+  Profiler::name("probe", "probe");
+  Profiler::add("probe", nullptr, 3);
+
+  Profiler::reset();
+
+  auto slot = Profiler::find("probe");
+  ASSERT_NE(slot, nullptr);
+  ASSERT_STREQ(slot->name, "probe");
+  ASSERT_EQ(slot->calls, 0u);
+  ASSERT_EQ(slot->max, 0);
+  ASSERT_EQ(slot->counts[1], 0);
+}
@@ -58,6 +58,10 @@ TEST_F(RadarTest, InitTest) {
   EXPECT_CALL(mock_arduino_class_, pinMode(trigger_, OUTPUT))
       .Times(1);
 
+  // And is the trigger off to start with?
+  EXPECT_CALL(mock_arduino_class_, digitalWrite(trigger_, LOW))
+      .Times(1);
+
   EXPECT_CALL(mock_arduino_class_, attachInterrupt(_, _, _))
       .Times(1);
 
@@ -106,27 +110,79 @@ TEST_F(RadarTest, PingTest) {
   // All calls must be in sequence.
   Sequence s1;
 
-  // Do we get LOW write to trigger?
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(trigger_, LOW))
-        .InSequence(s1);
-
-  // Do we get a delay?
-  EXPECT_CALL(mock_arduino_class_, delayMicroseconds(_))
-        .InSequence(s1);
-
   // Do we get HIGH write to trigger?
   EXPECT_CALL(mock_arduino_class_, digitalWrite(trigger_, HIGH))
       .InSequence(s1);
 
-  // Do we get a delay?
-  EXPECT_CALL(mock_arduino_class_, delayMicroseconds(_))
+  // Is the timer armed to end the pulse?
+  EXPECT_CALL(mock_arduino_class_,
+              one_shot(TriggerISR::trigger_us, TriggerISR::trigger_isr))
       .InSequence(s1);
 
-  // Do we get LOW write to trigger?
-  EXPECT_CALL(mock_arduino_class_, digitalWrite(trigger_, LOW))
-      .InSequence(s1);
+  // ping() must not wait for the pulse to finish
+  EXPECT_CALL(mock_arduino_class_, delayMicroseconds(_))
+      .Times(0);
+
+  radar_.ping();
+}
+
+/*
+ * Run a ping against a mock clock. The timer one shot is simulated by moving
+ * the clock forward and calling the ISR it was given, which is what the timer
+ * interrupt would do. Checks the pulse is at least 10µs wide and that ping()
+ * returns before the pulse ends.
+ */
+TEST_F(RadarTest, PingPulseTimingTest) {
+  using testing::_;
+  using testing::Invoke;
+  using testing::SaveArg;
+  using testing::DoAll;
+
+  uint32_t clock_us = 1000;   // mock clock
+  uint32_t rise_us = 0, fall_us = 0;
+  uint16_t timer_us = 0;
+  void (*timer_isr)() = nullptr;
+
+  EXPECT_CALL(mock_arduino_class_, micros())
+      .WillRepeatedly(Invoke([&]() { return clock_us; }));
+
+  EXPECT_CALL(mock_arduino_class_, pinMode(_, _))
+      .Times(2);
+  EXPECT_CALL(mock_arduino_class_, attachInterrupt(_, _, _));
+  EXPECT_CALL(mock_servo_, attach(_));
+  EXPECT_CALL(mock_servo_, write(_));
+
+  EXPECT_CALL(mock_arduino_class_, digitalWrite(trigger_, _))
+      .WillRepeatedly(Invoke([&](uint8_t, uint8_t val) {
+        // record edges against the mock clock
+        if (val == HIGH) {
+          rise_us = mock_arduino_class_.micros();
+        } else {
+          fall_us = mock_arduino_class_.micros();
+        }
+      }));
+
+  EXPECT_CALL(mock_arduino_class_, one_shot(_, _))
+      .WillOnce(DoAll(SaveArg<0>(&timer_us), SaveArg<1>(&timer_isr)));
+
+  EXPECT_CALL(mock_arduino_class_, delayMicroseconds(_))
+      .Times(0);
+
+  radar_.init(trigger_, echo_, servo_);
+  fall_us = 0;
 
   radar_.ping();
+
+  // ping has returned and the clock hasn't moved, so the trigger is still high
+  ASSERT_EQ(rise_us, 1000u);
+  ASSERT_EQ(fall_us, 0u);
+  ASSERT_NE(timer_isr, nullptr);
+
+  // timer fires
+  clock_us += timer_us;
+  timer_isr();
+
+  ASSERT_GE(fall_us - rise_us, 10u);
 }
 
 /*
@@ -144,9 +200,9 @@ TEST_F(RadarTest, PingEchoTest) {
   uint32_t distance = 0;
 
   EXPECT_CALL(mock_arduino_class_, digitalWrite(_,_))
-      .Times(3);
-  EXPECT_CALL(mock_arduino_class_, delayMicroseconds(_))
-      .Times(2);
+      .Times(1);
+  EXPECT_CALL(mock_arduino_class_, one_shot(_,_))
+      .Times(1);
 
   distance = radar_.ping();
 
@@ -178,9 +234,9 @@ TEST_F(RadarTest, PingEchoRolloverTest) {
   uint32_t distance = 0;
 
   EXPECT_CALL(mock_arduino_class_, digitalWrite(_,_))
-      .Times(3);
-  EXPECT_CALL(mock_arduino_class_, delayMicroseconds(_))
-      .Times(2);
+      .Times(1);
+  EXPECT_CALL(mock_arduino_class_, one_shot(_,_))
+      .Times(1);
 
   distance = radar_.ping();
 
@@ -208,9 +264,9 @@ TEST_F(RadarTest, PingEchoNothingTest) {
   uint32_t distance = 0;
 
   EXPECT_CALL(mock_arduino_class_, digitalWrite(_,_))
-      .Times(3);
-  EXPECT_CALL(mock_arduino_class_, delayMicroseconds(_))
-      .Times(2);
+      .Times(1);
+  EXPECT_CALL(mock_arduino_class_, one_shot(_,_))
+      .Times(1);
 
   distance = radar_.ping();
 
@@ -12,6 +12,10 @@
 #include <RadarState.h>
 #include <test/MockRadarContext.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 // all these fixtures need to be initialised before our MockRadarContext can be
 // constructed (we SIG11 otherwise) so do this here.
 class RadarContextMockDependancies : public ::testing::Test {
@@ -26,7 +30,9 @@ class RadarContextMockDependancies : public ::testing::Test {
   // The concrete states use these distance measures.
   uint32_t  distance_warning {CFG::distance_warning-1},
             distance_red {CFG::distance_red-1},
+            distance_orange {CFG::distance_orange-1},
             distance_yellow {CFG::distance_yellow-1},
+            distance_lime {CFG::distance_green-1},
             distance_green {CFG::distance_green};
 
   RadarContextMockDependancies() {
@@ -46,33 +52,39 @@ class RadarContextMockDependancies : public ::testing::Test {
 class RadarContextTest : public RadarContextMockDependancies {
  protected:
 
-  MockRadarState mock_radar_state_; // mock state object
-  RadarContext radar_context_ {&mock_radar_state_}; // class under test
+  RadarContext radar_context_; // class under test, starts in standby
 
   RadarContextTest() = default;
   ~RadarContextTest() override = default;
 
 
   // Test class is friend of actual class to test private methods
-  void change_state(RadarState* s) {
+  void change_state(RadarStateId s) {
     radar_context_.change_state(s);
   }
 
-  void command_add_entry(FunctionObject *func, uint16_t frequency) {
+  void command_add_entry(Command func, uint16_t frequency) {
     radar_context_.command_add_entry(func, frequency);
   };
-  void command_remove_entry(FunctionObject *func) {
+  void command_remove_entry(Command func) {
     radar_context_.command_remove_entry(func);
   };
   void led_set_colour(LEDColour colour) {
     radar_context_.led_set_colour(colour);
   };
-  void led_set_pulse(int8_t  increment) {
-    radar_context_.led_set_pulse(increment);
+  void led_set_effect(LEDEffect effect, uint16_t period) {
+    radar_context_.led_set_effect(effect, period);
   };
   uint32_t get_timer() const {
     return radar_context_.get_timer();
   };
+  std::string screen_row(uint8_t row) const {
+    std::string text;
+    for (uint8_t col = 0; col < LCDBuffer::cols; ++col) {
+      text += radar_context_.screen_.at(col, row);
+    }
+    return text;
+  };
   void set_timer() {
     radar_context_.set_timer();
   };
@@ -82,11 +94,7 @@ class RadarContextTest : public RadarContextMockDependancies {
 /*
  * This is used in the command queue tests
  */
-class TestFuncObj : public FunctionObject {
-
- public:
-  void operator()() final {}
-};
+void test_command(void* context) {}
 
 /*
  * RadarContext tests.
@@ -100,9 +108,14 @@ TEST_F(RadarContextTest, TestInit) {
   EXPECT_CALL(mock_command_queue_, clear_queue())
       .Times(1);
 
-  EXPECT_CALL(mock_command_queue_, add_entry(_,_))
+  EXPECT_CALL(mock_command_queue_, add_entry(_,_,_))
       .Times(AnyNumber());
 
+  // the LCD flush runs whatever the state
+  EXPECT_CALL(mock_command_queue_, add_entry(Commands::lcd_flush,
+                                             &radar_context_, lcd_flush_ms))
+      .Times(1);
+
   EXPECT_CALL(mock_arduino_interface_,pinMode(ir_pin, INPUT))
       .Times(1);
 
@@ -112,35 +125,89 @@ TEST_F(RadarContextTest, TestInit) {
   EXPECT_CALL(mock_liquid_crystal_, begin(16,2))
       .Times(1);
 
-  EXPECT_CALL(mock_my_led_, set_colour(_));
-  EXPECT_CALL(mock_my_led_, set_pulse(_));
+  EXPECT_CALL(mock_my_led_, set_colour(_, _));
+  EXPECT_CALL(mock_my_led_, set_effect(_, _));
+  EXPECT_CALL(mock_my_led_, start())
+      .Times(1);
 
   radar_context_.init();
 
-  DoLEDPulse::delete_instance();
+  ASSERT_EQ(radar_context_.get_state(), RadarStateId::STANDBY);
 }
 
+// start() runs the entry actions of whatever state we changed to
 TEST_F(RadarContextTest, TestChangeState) {
-  MockRadarState second_mock_state;
+  using testing::_;
 
-  EXPECT_CALL(second_mock_state, start(&radar_context_))
+  EXPECT_CALL(mock_command_queue_, add_entry(_, &radar_context_, 25))
+      .Times(1);
+  EXPECT_CALL(mock_command_queue_, add_entry(_, &radar_context_, 550))
+      .Times(1);
+  EXPECT_CALL(mock_command_queue_, add_entry(Commands::lcd_graph,
+                                             &radar_context_,
+                                             CFG::lcd_graph_ms))
       .Times(1);
 
-  change_state(&second_mock_state);
+  change_state(RadarStateId::SENSING);
   radar_context_.start();
+
+  ASSERT_EQ(radar_context_.get_state(), RadarStateId::SENSING);
 }
 
 TEST_F(RadarContextTest, TestStart) {
-  EXPECT_CALL(mock_radar_state_, start(&radar_context_))
+  using testing::_;
+  using testing::StrEq;
+
+  EXPECT_CALL(mock_my_led_, set_colour(LEDColour::GREEN, CFG::led_fade_ms))
       .Times(1);
+  EXPECT_CALL(mock_my_led_, set_effect(LEDEffect::PULSE,
+                                       CFG::standby_pulse_ms))
+      .Times(1);
+  EXPECT_CALL(mock_command_queue_, add_entry(_, _, _))
+      .Times(1);
+
+  // the screen is only drawn in RAM, the LCD gets it on the next flush
+  EXPECT_CALL(mock_liquid_crystal_, clear())
+      .Times(0);
+  EXPECT_CALL(mock_liquid_crystal_, write(_))
+      .Times(0);
+
   radar_context_.start();
+
+  ASSERT_EQ(screen_row(0), "Standby         ");
 }
 
+// motion in standby takes us all the way through to sensing
 TEST_F(RadarContextTest, TestUpdate) {
-  EXPECT_CALL(mock_radar_state_, update(&radar_context_, 1))
+  using testing::_;
+  using testing::Return;
+
+  EXPECT_CALL(mock_arduino_interface_, millis())
+      .WillOnce(Return(50000));
+  EXPECT_CALL(mock_command_queue_, remove_entry(_, _))
       .Times(1);
+  EXPECT_CALL(mock_command_queue_, add_entry(_, _, _))
+      .Times(3);
 
   radar_context_.update(1);
+
+  ASSERT_EQ(radar_context_.get_state(), RadarStateId::SENSING);
+  // the motion restarts the timeout
+  ASSERT_EQ(get_timer(), 50000u);
+}
+
+// no input, no change
+TEST_F(RadarContextTest, TestUpdateNoChange) {
+  using testing::_;
+
+  EXPECT_CALL(mock_command_queue_, remove_entry(_, _))
+      .Times(0);
+  EXPECT_CALL(mock_command_queue_, add_entry(_, _, _))
+      .Times(0);
+
+  radar_context_.update(0);
+
+  ASSERT_EQ(radar_context_.get_state(), RadarStateId::STANDBY);
 }
 
 TEST_F(RadarContextTest, TestRadarMove) {
@@ -159,42 +226,148 @@ TEST_F(RadarContextTest, TestRadarPing) {
       .Times(1)
       .WillRepeatedly(Return(r_value));
 
+  // time stamp for the target tracker
+  EXPECT_CALL(mock_arduino_interface_, millis())
+      .Times(1);
+
   uint32_t result = radar_context_.radar_ping();
 
   ASSERT_EQ(result, r_value);
 }
 
+// ping returns the echo of the previous ping, so the tracker should get the
+// angle the radar was at when that previous ping was sent
+TEST_F(RadarContextTest, TestNearestTargets) {
+  using testing::Return;
+  using testing::ReturnRoundRobin;
+
+  Target targets[2];
+
+  EXPECT_CALL(mock_arduino_interface_, millis())
+      .WillRepeatedly(Return(1000));
+
+  EXPECT_CALL(mock_radar_, move())
+      .WillRepeatedly(ReturnRoundRobin<uint8_t>({120, 150}));
+
+  EXPECT_CALL(mock_radar_, ping())
+      .WillRepeatedly(ReturnRoundRobin<uint32_t>({UINT32_MAX, 800, 2000}));
+
+  radar_context_.radar_move();    // 120°
+  radar_context_.radar_ping();    // nothing yet, ping sent at 120°
+  radar_context_.radar_move();    // 150°
+  radar_context_.radar_ping();    // 800mm from the ping at 120°
+  radar_context_.radar_ping();    // 2000mm from the ping at 150°
+
+  ASSERT_EQ(radar_context_.nearest_targets(targets, 2), 2);
+  ASSERT_EQ(targets[0].range, 800u);
+  ASSERT_EQ(targets[0].bearing_min, 120);
+  ASSERT_EQ(targets[1].range, 2000u);
+  ASSERT_EQ(targets[1].bearing_min, 150);
+}
+
 TEST_F(RadarContextTest, TestCommandAddExecuteRemoveEntry) {
-  TestFuncObj test_fun;
   uint16_t frequency {100};
 
-  EXPECT_CALL(mock_command_queue_, add_entry(&test_fun, frequency))
+  EXPECT_CALL(mock_command_queue_, add_entry(test_command, &radar_context_,
+                                             frequency))
+      .Times(1);
+
+  EXPECT_CALL(mock_command_queue_, run_current_entry())
       .Times(1);
 
-  EXPECT_CALL(mock_command_queue_, execute_current_entry())
+  EXPECT_CALL(mock_command_queue_, next_call_time())
       .Times(1);
 
-  EXPECT_CALL(mock_command_queue_, remove_entry(&test_fun))
+  EXPECT_CALL(mock_command_queue_, remove_entry(test_command, &radar_context_))
       .Times(1);
 
-  command_add_entry(&test_fun, frequency);
+  command_add_entry(test_command, frequency);
   radar_context_.execute_current_entry();
-  command_remove_entry(&test_fun);
+  command_remove_entry(test_command);
 }
 
 
+// an input posted by a command is handled once the command has run, and
+// before the queue works out what's next
+TEST_F(RadarContextTest, TestExecuteDispatchesEvents) {
+  using testing::_;
+  using testing::Invoke;
+  using testing::Return;
+
+  testing::InSequence sequence;
+
+  EXPECT_CALL(mock_command_queue_, run_current_entry())
+      .WillOnce(Invoke([this]() { radar_context_.post_event(1); }));
+  EXPECT_CALL(mock_arduino_interface_, millis())
+      .WillOnce(Return(0));
+  EXPECT_CALL(mock_command_queue_, remove_entry(_, _))
+      .Times(1);
+  EXPECT_CALL(mock_command_queue_, add_entry(_, _, _))
+      .Times(3);
+  EXPECT_CALL(mock_command_queue_, next_call_time())
+      .WillOnce(Return(123));
+
+  ASSERT_EQ(radar_context_.execute_current_entry(), 123u);
+  ASSERT_EQ(radar_context_.get_state(), RadarStateId::SENSING);
+}
+
+// a period set from the console reschedules its command once the command
+// that set it has run, and a threshold doesn't reschedule anything
+TEST_F(RadarContextTest, TestExecuteAppliesSettings) {
+  using testing::_;
+  using testing::InSequence;
+  using testing::Return;
+
+  Settings::take_changed();
+  Settings::set(Settings::Id::PING_MS, 1000);
+  Settings::set(Settings::Id::LCD_FLUSH_MS, 40);
+  Settings::set(Settings::Id::DISTANCE_RED, 200);
+
+  // anything but these
+  EXPECT_CALL(mock_command_queue_, reschedule(_, _, _))
+      .Times(0);
+  {
+    InSequence sequence;
+    EXPECT_CALL(mock_command_queue_, run_current_entry());
+    EXPECT_CALL(mock_command_queue_, reschedule(Commands::lcd_flush,
+                                                &radar_context_, 40))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_command_queue_, reschedule(Commands::ping,
+                                                &radar_context_, 1000))
+        .WillOnce(Return(false));
+    EXPECT_CALL(mock_command_queue_, next_call_time());
+  }
+  radar_context_.execute_current_entry();
+  testing::Mock::VerifyAndClearExpectations(&mock_command_queue_);
+
+  // nothing changed since, so nothing more to do
+  EXPECT_CALL(mock_command_queue_, reschedule(_, _, _))
+      .Times(0);
+  radar_context_.execute_current_entry();
+
+  Settings::defaults();
+  Settings::take_changed();
+}
+
+TEST_F(RadarContextTest, TestPostEventFull) {
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(radar_context_.post_event(0));
+  }
+  ASSERT_FALSE(radar_context_.post_event(0));
+}
+
 TEST_F(RadarContextTest, TestLedSetColour) {
-  EXPECT_CALL(mock_my_led_, set_colour(LEDColour::YELLOW))
+  EXPECT_CALL(mock_my_led_, set_colour(LEDColour::YELLOW, CFG::led_fade_ms))
       .Times(1);
 
   led_set_colour(LEDColour::YELLOW);
 }
 
-TEST_F(RadarContextTest, TestLedSetPulse) {
-  EXPECT_CALL(mock_my_led_, set_pulse(5))
+TEST_F(RadarContextTest, TestLedSetEffect) {
+  EXPECT_CALL(mock_my_led_, set_effect(LEDEffect::BLINK, 1500))
       .Times(1);
 
-  led_set_pulse(5);
+  led_set_effect(LEDEffect::BLINK, 1500);
 }
 
 TEST_F(RadarContextTest, TestSetGetTimer) {
@@ -212,31 +385,137 @@ TEST_F(RadarContextTest, TestSetGetTimer) {
   ASSERT_EQ(input, result);
 }
 
-TEST_F(RadarContextTest, TestLedPulse) {
-  EXPECT_CALL(mock_my_led_, pulse())
-      .Times(1);
-
-  radar_context_.led_pulse();
-}
-
 TEST_F(RadarContextTest, TestLCDSetCursor) {
-  EXPECT_CALL(mock_liquid_crystal_, setCursor(16,2))
-      .Times(1);
+  radar_context_.lcd_setCursor(14,1);
+  radar_context_.lcd_print("x");
 
-  radar_context_.lcd_setCursor(16,2);
+  ASSERT_EQ(screen_row(1), "              x ");
 }
 
 TEST_F(RadarContextTest, TestLCDPrint) {
   const char test_str[5] {"test"};
   const int test_int {10};
 
-  EXPECT_CALL(mock_liquid_crystal_, print(test_int))
+  radar_context_.lcd_print(test_int);
+  radar_context_.lcd_print(test_str);
+
+  ASSERT_EQ(screen_row(0), "10test          ");
+}
+
+TEST_F(RadarContextTest, TestLCDPrintWidth) {
+  radar_context_.lcd_print((uint32_t)42, 4);
+
+  ASSERT_EQ(screen_row(0), "  42            ");
+}
+
+TEST_F(RadarContextTest, TestLCDClear) {
+  radar_context_.lcd_print("test");
+  radar_context_.lcd_clear();
+
+  ASSERT_EQ(screen_row(0), "                ");
+}
+
+// only what has changed is sent, and only once
+TEST_F(RadarContextTest, TestLCDFlush) {
+  using testing::_;
+
+  radar_context_.lcd_setCursor(2, 1);
+  radar_context_.lcd_print("ab");
+
+  EXPECT_CALL(mock_liquid_crystal_, setCursor(2, 1))
+      .Times(1);
+  EXPECT_CALL(mock_liquid_crystal_, write('a'))
       .Times(1);
-  EXPECT_CALL(mock_liquid_crystal_, print(test_str))
+  EXPECT_CALL(mock_liquid_crystal_, write('b'))
       .Times(1);
 
-  radar_context_.lcd_print(test_int);
-  radar_context_.lcd_print(test_str);
+  radar_context_.lcd_flush();
+  radar_context_.lcd_flush();
+}
+
+// nothing tracked yet, so no custom characters are needed
+TEST_F(RadarContextTest, TestLCDGraphNoTarget) {
+  using testing::_;
+
+  EXPECT_CALL(mock_liquid_crystal_, createChar(_, _))
+      .Times(0);
+
+  radar_context_.lcd_graph();
+
+  ASSERT_EQ(screen_row(0), "            --- ");
+}
+
+TEST_F(RadarContextTest, TestLCDPoll) {
+  EXPECT_CALL(mock_liquid_crystal_, poll())
+      .Times(1);
+
+  radar_context_.lcd_poll();
+}
+
+/*
+ * Dispatch rate
+ *
+ * Runs the command queue the context sets up in each state for 10 simulated
+ * seconds, a ms at a time, and counts the commands dispatched. The LED runs
+ * from its own timer interrupt, so it adds nothing: before that, pulsing it
+ * was another 30 dispatches a second in standby and 100 in warning.
+ */
+TEST_F(RadarContextTest, TestDispatchRate) {
+  using testing::_;
+  using testing::AnyNumber;
+  using testing::Invoke;
+
+  struct Entry {
+    Command function;
+    uint16_t frequency;
+  };
+  std::vector<Entry> entries;
+
+  ON_CALL(mock_command_queue_, add_entry(_, _, _))
+      .WillByDefault(Invoke([&](Command f, void*, uint16_t frequency) {
+        entries.push_back({f, frequency});
+      }));
+  ON_CALL(mock_command_queue_, remove_entry(_, _))
+      .WillByDefault(Invoke([&](Command f, void*) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [f](const Entry& e) {
+                                       return e.function == f;
+                                     }),
+                      entries.end());
+      }));
+  EXPECT_CALL(mock_arduino_interface_, pinMode(_, _)).Times(AnyNumber());
+  EXPECT_CALL(mock_arduino_interface_, millis()).Times(AnyNumber());
+  EXPECT_CALL(mock_arduino_interface_, tone(_, _, _)).Times(AnyNumber());
+
+  // dispatches a second over 10 seconds
+  auto rate = [&entries]() {
+    uint32_t dispatches = 0;
+    for (uint32_t ms = 1; ms <= 10000; ++ms) {
+      for (auto& entry : entries) {
+        dispatches += (ms % entry.frequency == 0) ? 1 : 0;
+      }
+    }
+    return dispatches / 10.0;
+  };
+
+  radar_context_.init();
+  double standby = rate();
+  radar_context_.update(1);
+  double sensing = rate();
+  radar_context_.update(distance_warning);
+  ASSERT_EQ(radar_context_.get_state(), RadarStateId::WARNING);
+  double warning = rate();
+
+  RecordProperty("standby_per_s", std::to_string(standby));
+  RecordProperty("sensing_per_s", std::to_string(sensing));
+  RecordProperty("warning_per_s", std::to_string(warning));
+
+  // PIR check and LCD flush
+  ASSERT_DOUBLE_EQ(standby, 4 + 10);
+  // move, ping, graph and LCD flush
+  ASSERT_NEAR(sensing, 40 + 1.8 + 4 + 10, 0.1);
+  // warning adds nothing to sensing
+  ASSERT_DOUBLE_EQ(warning, sensing);
 }
 
 /*
@@ -246,23 +525,8 @@ TEST_F(RadarContextTest, TestLCDPrint) {
 class StandbyStateTest : public RadarContextMockDependancies {
  protected:
 
-  RadarState* standby_state_;
   MockRadarContext mock_radar_context_;
-  RadarAction* pir_command_;
-  RadarAction* led_command_;
-
-  StandbyStateTest() {
-   standby_state_ = StandbyState::instance();
-
-    pir_command_ = DoPIRCheck::instance(&mock_radar_context_);
-    led_command_ = DoLEDPulse::instance(&mock_radar_context_);
-  }
-  ~StandbyStateTest() {
-    StandbyState::delete_instance();
-
-    DoPIRCheck::delete_instance();
-    DoLEDPulse::delete_instance();
-  }
+  Command pir_command_ {Commands::pir_check};
 };
 
 TEST_F(StandbyStateTest, TestStart) {
@@ -273,8 +537,8 @@ TEST_F(StandbyStateTest, TestStart) {
   EXPECT_CALL(mock_radar_context_, led_set_colour(LEDColour::GREEN))
       .Times(1);
 
-  // Is a pulse set? (value doesn't really matter)
-  EXPECT_CALL(mock_radar_context_, led_set_pulse(_))
+  // Is it pulsing? (period doesn't really matter)
+  EXPECT_CALL(mock_radar_context_, led_set_effect(LEDEffect::PULSE, _))
       .Times(1);
 
   // Is the PIR sensor check function added? Frequency not important
@@ -282,36 +546,29 @@ TEST_F(StandbyStateTest, TestStart) {
       pir_command_, _))
       .Times(1);
 
-  // Is the DoPulse function added? Frequency not important
-  EXPECT_CALL(mock_radar_context_, command_add_entry(
-      led_command_, _))
-      .Times(1);
-
   EXPECT_CALL(mock_radar_context_, lcd_print(Matcher<const char *>(_)))
       .Times(1);
 
   EXPECT_CALL(mock_radar_context_, lcd_setCursor(0,0))
       .Times(1);
 
-  standby_state_->start(&mock_radar_context_);
+  RadarState::start(&mock_radar_context_, RadarStateId::STANDBY);
 
 }
 
 TEST_F(StandbyStateTest, TestUpdate) {
-  RadarState* sensing_state = SensingState::instance();
-
-  EXPECT_CALL(mock_radar_context_, command_remove_entry(
-      pir_command_))
+  // SENSING's timeout starts from the motion
+  EXPECT_CALL(mock_radar_context_, set_timer())
       .Times(1);
   EXPECT_CALL(mock_radar_context_, command_remove_entry(
-      led_command_))
+      pir_command_))
       .Times(1);
-  EXPECT_CALL(mock_radar_context_, change_state(sensing_state))
+  EXPECT_CALL(mock_radar_context_, change_state(RadarStateId::SENSING))
       .Times(1);
   EXPECT_CALL(mock_radar_context_, start())
       .Times(1);
 
-  standby_state_->update(&mock_radar_context_, 1);
+  RadarState::update(&mock_radar_context_, RadarStateId::STANDBY, 1);
 
 }
 
@@ -322,29 +579,17 @@ TEST_F(StandbyStateTest, TestUpdate) {
 class SensingStateTest : public RadarContextMockDependancies {
  protected:
 
-  RadarState* sensing_state_;
   MockRadarContext mock_radar_context_;
-  RadarAction* move_command_;
-  RadarAction* ping_command_;
-
-  SensingStateTest() {
-    sensing_state_ = SensingState::instance();
-    move_command_ = DoMove::instance(&mock_radar_context_);
-    ping_command_ = DoPing::instance(&mock_radar_context_);
-  }
-
-  ~SensingStateTest() {
-    SensingState::delete_instance();
-    DoMove::delete_instance();
-    DoPing::delete_instance();
-  }
+  Command move_command_ {Commands::move};
+  Command ping_command_ {Commands::ping};
+  Command graph_command_ {Commands::lcd_graph};
 };
 
 TEST_F(SensingStateTest, TestStart) {
   using testing::_;
   using testing::Ge;
 
-  // Does DoMove get added?
+  // Does move get added?
   EXPECT_CALL(mock_radar_context_, command_add_entry(
       move_command_, _))
       .Times(1);
@@ -354,12 +599,20 @@ TEST_F(SensingStateTest, TestStart) {
       ping_command_, Ge(500)))
       .Times(1);
 
-  sensing_state_->start(&mock_radar_context_);
+  // Is the display redrawn, but not so often it gets in the way?
+  EXPECT_CALL(mock_radar_context_, command_add_entry(
+      graph_command_, Ge(100)))
+      .Times(1);
+
+  // Does the LED stop pulsing?
+  EXPECT_CALL(mock_radar_context_, led_set_effect(LEDEffect::STEADY, _))
+      .Times(1);
+
+  RadarState::start(&mock_radar_context_, RadarStateId::SENSING);
 }
 
 TEST_F(SensingStateTest, TestUpdateRedWarning) {
-
-  auto warning_state = WarningState::instance();
+  using testing::_;
 
   EXPECT_CALL(mock_radar_context_, set_timer())
       .Times(1);
@@ -367,15 +620,18 @@ TEST_F(SensingStateTest, TestUpdateRedWarning) {
   EXPECT_CALL(mock_radar_context_, led_set_colour(LEDColour::RED))
       .Times(1);
 
-  EXPECT_CALL(mock_radar_context_, change_state(warning_state))
+  EXPECT_CALL(mock_radar_context_, change_state(RadarStateId::WARNING))
       .Times(1);
 
   EXPECT_CALL(mock_radar_context_, start())
       .Times(1);
 
-  sensing_state_->update(&mock_radar_context_, distance_warning);
+  // warning runs inside sensing, so the radar must keep sweeping
+  EXPECT_CALL(mock_radar_context_, command_remove_entry(_))
+      .Times(0);
 
-  WarningState::delete_instance();
+  RadarState::update(&mock_radar_context_, RadarStateId::SENSING,
+                     distance_warning);
 }
 
 TEST_F(SensingStateTest, TestUpdateRed) {
@@ -385,7 +641,19 @@ TEST_F(SensingStateTest, TestUpdateRed) {
   EXPECT_CALL(mock_radar_context_, led_set_colour(LEDColour::RED))
       .Times(1);
 
-  sensing_state_->update(&mock_radar_context_, distance_red);
+  RadarState::update(&mock_radar_context_, RadarStateId::SENSING,
+                     distance_red);
+}
+
+TEST_F(SensingStateTest, TestUpdateOrange) {
+  EXPECT_CALL(mock_radar_context_, set_timer())
+      .Times(1);
+
+  EXPECT_CALL(mock_radar_context_, led_set_colour(LEDColour::ORANGE))
+      .Times(1);
+
+  RadarState::update(&mock_radar_context_, RadarStateId::SENSING,
+                     distance_orange);
 }
 
 TEST_F(SensingStateTest, TestUpdateYellow) {
@@ -395,7 +663,8 @@ TEST_F(SensingStateTest, TestUpdateYellow) {
   EXPECT_CALL(mock_radar_context_, led_set_colour(LEDColour::YELLOW))
       .Times(1);
 
-  sensing_state_->update(&mock_radar_context_, distance_yellow);
+  RadarState::update(&mock_radar_context_, RadarStateId::SENSING,
+                     distance_yellow);
 }
 
 TEST_F(SensingStateTest, TestUpdateGreen) {
@@ -418,7 +687,39 @@ TEST_F(SensingStateTest, TestUpdateGreen) {
   EXPECT_CALL(mock_radar_context_, change_state(_))
       .Times(0);
 
-  sensing_state_->update(&mock_radar_context_, distance_green);
+  RadarState::update(&mock_radar_context_, RadarStateId::SENSING,
+                     distance_green);
+}
+
+// further than yellow is lime, but doesn't hold off standby
+TEST_F(SensingStateTest, TestUpdateLime) {
+  using testing::Return;
+  using testing::_;
+
+  EXPECT_CALL(mock_arduino_interface_, millis())
+      .Times(1)
+      .WillRepeatedly(Return(30000));
+
+  EXPECT_CALL(mock_radar_context_, led_set_colour(LEDColour::LIME))
+      .Times(1);
+
+  EXPECT_CALL(mock_radar_context_, set_timer())
+      .Times(0);
+
+  EXPECT_CALL(mock_radar_context_, get_timer())
+      .Times(1);
+
+  EXPECT_CALL(mock_radar_context_, change_state(RadarStateId::STANDBY))
+      .Times(1);
+
+  EXPECT_CALL(mock_radar_context_, command_remove_entry(_))
+      .Times(3);
+
+  EXPECT_CALL(mock_radar_context_, start())
+      .Times(1);
+
+  RadarState::update(&mock_radar_context_, RadarStateId::SENSING,
+                     distance_lime);
 }
 
 TEST_F(SensingStateTest, TestUpdateGreenStandby) {
@@ -445,14 +746,19 @@ TEST_F(SensingStateTest, TestUpdateGreenStandby) {
           ping_command_))
       .Times(1);
 
+  EXPECT_CALL(mock_radar_context_, command_remove_entry(
+          graph_command_))
+      .Times(1);
+
   // make sure change_state is called
-  EXPECT_CALL(mock_radar_context_, change_state(_))
+  EXPECT_CALL(mock_radar_context_, change_state(RadarStateId::STANDBY))
       .Times(1);
 
   EXPECT_CALL(mock_radar_context_, start())
       .Times(1);
 
-  sensing_state_->update(&mock_radar_context_, distance_green);
+  RadarState::update(&mock_radar_context_, RadarStateId::SENSING,
+                     distance_green);
 }
 
 /*
@@ -462,38 +768,27 @@ TEST_F(SensingStateTest, TestUpdateGreenStandby) {
 class WarningStateTest : public RadarContextMockDependancies {
  protected:
 
-  RadarState* warning_state_;
   MockRadarContext mock_radar_context_;
-  RadarAction* led_command_;
-
-  WarningStateTest() {
-    warning_state_ = WarningState::instance();
-    led_command_ = DoLEDPulse::instance(&mock_radar_context_);
-  }
-
-  ~WarningStateTest() {
-    WarningState::delete_instance();
-    DoLEDPulse::delete_instance();
-  }
 };
 
 TEST_F(WarningStateTest, TestStart) {
   using testing::_;
 
-  EXPECT_CALL(mock_radar_context_, led_set_pulse(_))
+  EXPECT_CALL(mock_radar_context_, led_set_effect(LEDEffect::PULSE,
+                                                 CFG::warning_pulse_ms))
       .Times(1);
 
   EXPECT_CALL(mock_radar_context_, led_set_colour(LEDColour::RED))
       .Times(1);
 
-  EXPECT_CALL(mock_radar_context_, command_add_entry(
-          led_command_, _))
-      .Times(1);
+  // the LED pulses by itself, so no commands
+  EXPECT_CALL(mock_radar_context_, command_add_entry(_, _))
+      .Times(0);
 
   EXPECT_CALL(mock_arduino_interface_, tone(CFG::buzzer_pin, _, _))
       .Times(1);
 
-  warning_state_->start(&mock_radar_context_);
+  RadarState::start(&mock_radar_context_, RadarStateId::WARNING);
 
 }
 
@@ -504,22 +799,52 @@ TEST_F(WarningStateTest, TestUpdate) {
   EXPECT_CALL(mock_radar_context_, change_state(_))
       .Times(0);
 
-  warning_state_->update(&mock_radar_context_, distance_warning);
+  RadarState::update(&mock_radar_context_, RadarStateId::WARNING,
+                     distance_warning);
 }
 
 TEST_F(WarningStateTest, TestUpdateSensing) {
+  using testing::_;
 
-  // make sure change_state is NOT called
-  EXPECT_CALL(mock_radar_context_, change_state(SensingState::instance()))
+  EXPECT_CALL(mock_radar_context_, change_state(RadarStateId::SENSING))
       .Times(1);
 
-  EXPECT_CALL(mock_radar_context_, command_remove_entry(
-          led_command_))
+  // sensing was never left, so it must not be started again
+  EXPECT_CALL(mock_radar_context_, start())
+      .Times(0);
+
+  // back to sensing's steady LED
+  EXPECT_CALL(mock_radar_context_, led_set_effect(LEDEffect::STEADY, _))
       .Times(1);
 
   EXPECT_CALL(mock_arduino_interface_, noTone(CFG::buzzer_pin))
       .Times(1);
 
-  warning_state_->update(&mock_radar_context_, distance_red);
+  RadarState::update(&mock_radar_context_, RadarStateId::WARNING,
+                     distance_red);
+}
+
+/*
+ * Transition table tests
+ */
+
+TEST(RadarStateTableTest, TestNextState) {
+  using S = RadarStateId;
+  using E = StateEvent;
+
+  ASSERT_EQ(RadarState::next_state(S::STANDBY, E::MOTION), S::SENSING);
+  ASSERT_EQ(RadarState::next_state(S::SENSING, E::TOO_CLOSE), S::WARNING);
+  ASSERT_EQ(RadarState::next_state(S::SENSING, E::TIMEOUT), S::STANDBY);
+  ASSERT_EQ(RadarState::next_state(S::WARNING, E::CLEAR), S::SENSING);
+
+  // anything else stays put
+  ASSERT_EQ(RadarState::next_state(S::STANDBY, E::TOO_CLOSE), S::STANDBY);
+  ASSERT_EQ(RadarState::next_state(S::WARNING, E::TIMEOUT), S::WARNING);
+  ASSERT_EQ(RadarState::next_state(S::SENSING, E::NONE), S::SENSING);
+}
 
+TEST(RadarStateTableTest, TestParent) {
+  ASSERT_EQ(RadarState::parent(RadarStateId::WARNING), RadarStateId::SENSING);
+  ASSERT_EQ(RadarState::parent(RadarStateId::SENSING), RadarStateId::NONE);
+  ASSERT_EQ(RadarState::parent(RadarStateId::STANDBY), RadarStateId::NONE);
 }
\ No newline at end of file
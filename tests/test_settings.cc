@@ -0,0 +1,200 @@
+#include <gmock/gmock.h>
+#include <Settings.h>
+#include <RadarState.h>
+
+#include <cstring>
+
+using Id = Settings::Id;
+
+class SettingsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::memset(MockArduino::eeprom, 0xff, sizeof(MockArduino::eeprom));
+    Settings::defaults();
+    Settings::take_changed();
+  }
+
+  // every other test expects the defaults
+  void TearDown() override {
+    Settings::defaults();
+    Settings::take_changed();
+  }
+};
+
+TEST_F(SettingsTest, TestDefaults) {
+  ASSERT_EQ(Settings::get(Id::DISTANCE_WARNING), CFG::distance_warning);
+  ASSERT_EQ(Settings::get(Id::STANDBY_TIMEOUT), CFG::standby_timeout);
+  ASSERT_EQ(Settings::get(Id::PING_MS), CFG::ping_ms);
+  ASSERT_EQ(Settings::get(Id::LCD_GRAPH_MS), CFG::lcd_graph_ms);
+
+  Settings::set(Id::PING_MS, 1000);
+  Settings::defaults();
+  ASSERT_EQ(Settings::get(Id::PING_MS), CFG::ping_ms);
+}
+
+TEST_F(SettingsTest, TestSetInRange) {
+  Settings::Entry entry = Settings::entry(Id::PING_MS);
+  ASSERT_STREQ(entry.name, "ping_ms");
+
+  ASSERT_TRUE(Settings::set(Id::PING_MS, entry.min));
+  ASSERT_EQ(Settings::get(Id::PING_MS), entry.min);
+  ASSERT_TRUE(Settings::set(Id::PING_MS, entry.max));
+  ASSERT_EQ(Settings::get(Id::PING_MS), entry.max);
+
+  ASSERT_FALSE(Settings::set(Id::PING_MS, entry.min - 1));
+  ASSERT_FALSE(Settings::set(Id::PING_MS, entry.max + 1));
+  ASSERT_EQ(Settings::get(Id::PING_MS), entry.max);
+
+  ASSERT_FALSE(Settings::set(Id::COUNT, 0));
+}
+
+// a distance can't pass the ones either side of it
+TEST_F(SettingsTest, TestDistancesStayInOrder) {
+  Settings::Range warning = Settings::range(Id::DISTANCE_WARNING);
+  ASSERT_EQ(warning.min, 0u);
+  ASSERT_EQ(warning.max, CFG::distance_red - 1);
+  Settings::Range red = Settings::range(Id::DISTANCE_RED);
+  ASSERT_EQ(red.min, CFG::distance_warning + 1);
+  ASSERT_EQ(red.max, CFG::distance_orange - 1);
+  Settings::Range green = Settings::range(Id::DISTANCE_GREEN);
+  ASSERT_EQ(green.min, CFG::distance_yellow + 1);
+  ASSERT_EQ(green.max, Settings::entry(Id::DISTANCE_GREEN).max);
+
+  ASSERT_FALSE(Settings::set(Id::DISTANCE_WARNING, CFG::distance_red));
+  ASSERT_FALSE(Settings::set(Id::DISTANCE_YELLOW, CFG::distance_orange));
+  ASSERT_FALSE(Settings::set(Id::DISTANCE_YELLOW, CFG::distance_green));
+  ASSERT_EQ(Settings::take_changed(), 0);
+
+  // moving one out of the way makes room for the other
+  ASSERT_TRUE(Settings::set(Id::DISTANCE_RED, 400));
+  ASSERT_TRUE(Settings::set(Id::DISTANCE_WARNING, 300));
+  ASSERT_EQ(Settings::range(Id::DISTANCE_RED).min, 301u);
+}
+
+// periods go in the command queue's uint16_t
+TEST_F(SettingsTest, TestPeriodsFit) {
+  for (Id id : {Id::MOVE_MS, Id::PING_MS, Id::PIR_CHECK_MS, Id::LCD_FLUSH_MS,
+                Id::LCD_GRAPH_MS}) {
+    ASSERT_LE(Settings::entry(id).max, UINT16_MAX);
+  }
+}
+
+TEST_F(SettingsTest, TestFind) {
+  for (uint8_t i = 0; i < Settings::count; ++i) {
+    ASSERT_EQ(Settings::find(Settings::entry((Id)i).name), (Id)i);
+  }
+  ASSERT_EQ(Settings::find("standby_timeout"), Id::STANDBY_TIMEOUT);
+  ASSERT_EQ(Settings::find("ping"), Id::COUNT);
+  ASSERT_EQ(Settings::find(""), Id::COUNT);
+}
+
+// only a value that's different counts as a change
+TEST_F(SettingsTest, TestTakeChanged) {
+  Settings::set(Id::PING_MS, CFG::ping_ms);
+  ASSERT_EQ(Settings::take_changed(), 0);
+
+  Settings::set(Id::PING_MS, 1000);
+  Settings::set(Id::MOVE_MS, 40);
+  Settings::set(Id::MOVE_MS, 50);
+  ASSERT_EQ(Settings::take_changed(),
+            1 << (uint8_t)Id::PING_MS | 1 << (uint8_t)Id::MOVE_MS);
+  ASSERT_EQ(Settings::take_changed(), 0);
+
+  Settings::defaults();
+  ASSERT_EQ(Settings::take_changed(),
+            1 << (uint8_t)Id::PING_MS | 1 << (uint8_t)Id::MOVE_MS);
+}
+
+TEST_F(SettingsTest, TestSaveLoad) {
+  Settings::set(Id::DISTANCE_WARNING, 123);
+  Settings::set(Id::STANDBY_TIMEOUT, 3600000);
+  Settings::save();
+
+  ASSERT_EQ(MockArduino::eeprom[0], 'R');
+  ASSERT_EQ(MockArduino::eeprom[1], 'S');
+  ASSERT_EQ(MockArduino::eeprom[2], Settings::version);
+  ASSERT_EQ(MockArduino::eeprom[3], Settings::count);
+  // little endian, after the header
+  uint8_t at = Settings::header_size + (uint8_t)Id::STANDBY_TIMEOUT * 4;
+  ASSERT_EQ(MockArduino::eeprom[at], 0x80);
+  ASSERT_EQ(MockArduino::eeprom[at + 1], 0xee);
+  ASSERT_EQ(MockArduino::eeprom[at + 2], 0x36);
+  ASSERT_EQ(MockArduino::eeprom[at + 3], 0x00);
+  // nothing past the end
+  ASSERT_EQ(MockArduino::eeprom[Settings::stored_size], 0xff);
+
+  Settings::defaults();
+  Settings::take_changed();
+  ASSERT_TRUE(Settings::load());
+  ASSERT_EQ(Settings::get(Id::DISTANCE_WARNING), 123u);
+  ASSERT_EQ(Settings::get(Id::STANDBY_TIMEOUT), 3600000u);
+  ASSERT_EQ(Settings::get(Id::PING_MS), CFG::ping_ms);
+  ASSERT_EQ(Settings::take_changed(),
+            1 << (uint8_t)Id::DISTANCE_WARNING
+            | 1 << (uint8_t)Id::STANDBY_TIMEOUT);
+}
+
+TEST_F(SettingsTest, TestLoadErased) {
+  Settings::set(Id::PING_MS, 1000);
+
+  ASSERT_FALSE(Settings::load());
+  ASSERT_EQ(Settings::get(Id::PING_MS), 1000u);
+}
+
+// any one byte wrong and nothing is loaded
+TEST_F(SettingsTest, TestLoadCorrupt) {
+  Settings::set(Id::PING_MS, 1000);
+  Settings::save();
+  Settings::defaults();
+
+  for (uint8_t at = 0; at < Settings::stored_size; ++at) {
+    MockArduino::eeprom[at] ^= 0x01;
+    ASSERT_FALSE(Settings::load()) << "byte " << (int)at;
+    ASSERT_EQ(Settings::get(Id::PING_MS), CFG::ping_ms);
+    MockArduino::eeprom[at] ^= 0x01;
+  }
+  ASSERT_TRUE(Settings::load());
+  ASSERT_EQ(Settings::get(Id::PING_MS), 1000u);
+}
+
+// a value outside its range, as a table with a new range would find, stops
+// the lot loading even with the checksum right
+TEST_F(SettingsTest, TestLoadOutOfRange) {
+  Settings::set(Id::DISTANCE_RED, 200);
+  Settings::save();
+  Settings::defaults();
+
+  uint8_t at = Settings::header_size + (uint8_t)Id::PING_MS * 4;
+  MockArduino::eeprom[at] = 0;
+  MockArduino::eeprom[at + 1] = 0;
+  uint16_t sum1 = 0, sum2 = 0;
+  for (uint8_t i = 0; i < Settings::stored_size - 2; ++i) {
+    sum1 = (sum1 + MockArduino::eeprom[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  MockArduino::eeprom[Settings::stored_size - 2] = (uint8_t)sum1;
+  MockArduino::eeprom[Settings::stored_size - 1] = (uint8_t)sum2;
+
+  ASSERT_FALSE(Settings::load());
+  ASSERT_EQ(Settings::get(Id::DISTANCE_RED), CFG::distance_red);
+}
+
+// in range each on its own, but out of order, as no set() could have left
+// them
+TEST_F(SettingsTest, TestLoadOutOfOrder) {
+  Settings::save();
+
+  uint8_t at = Settings::header_size + (uint8_t)Id::DISTANCE_WARNING * 4;
+  MockArduino::eeprom[at] = 0xe8;     // 1000, past red
+  MockArduino::eeprom[at + 1] = 0x03;
+  uint16_t sum1 = 0, sum2 = 0;
+  for (uint8_t i = 0; i < Settings::stored_size - 2; ++i) {
+    sum1 = (sum1 + MockArduino::eeprom[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  MockArduino::eeprom[Settings::stored_size - 2] = (uint8_t)sum1;
+  MockArduino::eeprom[Settings::stored_size - 1] = (uint8_t)sum2;
+
+  ASSERT_FALSE(Settings::load());
+  ASSERT_EQ(Settings::get(Id::DISTANCE_WARNING), CFG::distance_warning);
+}
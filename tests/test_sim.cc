@@ -0,0 +1,371 @@
+#include <gmock/gmock.h>
+#include <SimArduino.h>
+#include <SimFirmware.h>
+#include <Commands.h>
+
+#include <string>
+#include <vector>
+
+using SA = SimArduino;
+
+namespace {
+
+int isr_count {0};
+std::vector<int> isr_order;
+
+void count_isr() {
+  ++isr_count;
+}
+
+void first_isr() {
+  isr_order.push_back(1);
+  // raises interrupt 1 while this one is still running
+  SA::drive(3, HIGH);
+  isr_order.push_back(2);
+}
+
+void second_isr() {
+  isr_order.push_back(3);
+}
+
+} // namespace
+
+class SimArduinoTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SA::reset();
+    isr_count = 0;
+    isr_order.clear();
+  }
+};
+
+TEST_F(SimArduinoTest, TestDelayIsInstant) {
+  SA::delay(90 * 60 * 1000UL);
+
+  ASSERT_EQ(SA::now(), 90 * 60 * 1000000ULL);
+  // millis() itself costs a call
+  ASSERT_EQ(SA::millis(), 90 * 60 * 1000UL);
+  ASSERT_EQ(SA::micros(), (uint32_t)(90 * 60 * 1000000ULL + SA::call_us));
+}
+
+TEST_F(SimArduinoTest, TestCallsCostTime) {
+  SA::digitalRead(4);
+  SA::digitalRead(4);
+  SA::delayMicroseconds(10);
+
+  ASSERT_EQ(SA::now(), 2 * SA::call_us + 10);
+  ASSERT_EQ(SA::stats().calls, 3u);
+}
+
+TEST_F(SimArduinoTest, TestEventsInOrder) {
+  std::string order;
+  SA::at(300, [&]() { order += 'd'; });
+  SA::at(100, [&]() { order += 'a'; });
+  SA::at(200, [&]() { order += 'b'; });
+  SA::at(200, [&]() { order += 'c'; }); // same time, so after b
+
+  SA::run_for(250);
+  ASSERT_EQ(order, "abc");
+  ASSERT_EQ(SA::now(), 250u);
+
+  SA::run_for(50);
+  ASSERT_EQ(order, "abcd");
+
+  // in the past runs straight away
+  SA::at(0, [&]() { order += 'e'; });
+  SA::run_for(0);
+  ASSERT_EQ(order, "abcde");
+}
+
+// a loop waiting on the clock shouldn't cost a call a µs
+TEST_F(SimArduinoTest, TestIdleMillisSkipsAhead) {
+  while (SA::millis() < 5000) {
+  }
+
+  ASSERT_GE(SA::now(), 5000000u);
+  ASSERT_LT(SA::now(), 5001000u);
+  ASSERT_LT(SA::stats().calls, 3u * 5000);
+}
+
+// something due part way through a millisecond still happens on time
+TEST_F(SimArduinoTest, TestIdleMillisStopsForEvents) {
+  uint64_t seen = 0;
+  SA::at(1500, [&]() { seen = SA::now(); });
+
+  while (SA::millis() < 3) {
+  }
+
+  ASSERT_EQ(seen, 1500u);
+}
+
+TEST_F(SimArduinoTest, TestAttachInterruptChange) {
+  SA::attachInterrupt(digitalPinToInterrupt(2), count_isr, CHANGE);
+
+  SA::drive(2, HIGH);
+  ASSERT_EQ(isr_count, 1);
+  SA::drive(2, HIGH); // no change
+  ASSERT_EQ(isr_count, 1);
+  SA::drive(2, LOW);
+  ASSERT_EQ(isr_count, 2);
+
+  // not attached
+  SA::drive(3, HIGH);
+  ASSERT_EQ(isr_count, 2);
+}
+
+TEST_F(SimArduinoTest, TestAttachInterruptRising) {
+  SA::attachInterrupt(digitalPinToInterrupt(3), count_isr, RISING);
+
+  SA::drive(3, HIGH);
+  SA::drive(3, LOW);
+  ASSERT_EQ(isr_count, 1);
+}
+
+TEST_F(SimArduinoTest, TestInterruptsDeferred) {
+  SA::attachInterrupt(0, count_isr, CHANGE);
+
+  noInterrupts();
+  ASSERT_FALSE(SA::interrupts_enabled());
+  SA::drive(2, HIGH);
+  SA::drive(2, LOW);
+  ASSERT_EQ(isr_count, 0);
+
+  // one flag, so the two changes only run it once
+  interrupts();
+  ASSERT_EQ(isr_count, 1);
+}
+
+TEST_F(SimArduinoTest, TestNoNestedInterrupts) {
+  SA::attachInterrupt(0, first_isr, CHANGE);
+  SA::attachInterrupt(1, second_isr, CHANGE);
+
+  SA::drive(2, HIGH);
+
+  ASSERT_THAT(isr_order, ::testing::ElementsAre(1, 2, 3));
+  ASSERT_EQ(SA::stats().interrupts, 2u);
+}
+
+// a model driving a pin from an event, as the HC-SR04 will
+TEST_F(SimArduinoTest, TestInterruptFromEvent) {
+  SA::attachInterrupt(0, count_isr, CHANGE);
+  SA::at(100, []() { SA::drive(2, HIGH); });
+
+  SA::run_for(98);  // attachInterrupt() took the other µs
+  ASSERT_EQ(isr_count, 0);
+  SA::run_for(1);
+  ASSERT_EQ(isr_count, 1);
+}
+
+TEST_F(SimArduinoTest, TestOneShot) {
+  SA::one_shot(10, count_isr);   // at 10, and the call takes us to 1
+
+  SA::run_for(8);
+  ASSERT_EQ(isr_count, 0);
+  SA::run_for(1);
+  ASSERT_EQ(isr_count, 1);
+
+  SA::run_for(1000);
+  ASSERT_EQ(isr_count, 1);
+}
+
+TEST_F(SimArduinoTest, TestOneShotRearm) {
+  SA::one_shot(50, first_isr);
+  SA::one_shot(20, count_isr);  // there's one compare channel, so this wins
+
+  SA::run_for(100);
+  ASSERT_EQ(isr_count, 1);
+  ASSERT_TRUE(isr_order.empty());
+}
+
+TEST_F(SimArduinoTest, TestTimerTick) {
+  SA::timer_tick(count_isr);
+
+  SA::run_for(100 * ArduinoInterface::tick_us);
+  ASSERT_EQ(isr_count, 100);
+
+  SA::timer_tick(nullptr);
+  SA::run_for(100 * ArduinoInterface::tick_us);
+  ASSERT_EQ(isr_count, 100);
+}
+
+// Timer1 as Servo runs it, for free
+TEST_F(SimArduinoTest, TestTimerTicks) {
+  SA::run_for(19999);
+  ASSERT_EQ(SA::timer_ticks(), 39998);
+  SA::run_for(1);
+  ASSERT_EQ(SA::timer_ticks(), 0);
+  ASSERT_EQ(SA::now(), 20000u);
+}
+
+TEST_F(SimArduinoTest, TestPWMCapture) {
+  std::vector<uint16_t> seen;
+  SA::watch([&](SA::Output what, uint8_t pin, uint16_t value) {
+    if (what == SA::Output::PWM && pin == 5) {
+      seen.push_back(value);
+    }
+  });
+  SA::capture_pwm(true);
+
+  SA::analogueWrite(5, 100);
+  ASSERT_EQ(SA::duty(5), 100);
+  SA::analogueWrite(5, 255);
+  ASSERT_EQ(SA::level(5), HIGH);
+  SA::analogueWrite(5, 0);
+  ASSERT_EQ(SA::level(5), LOW);
+
+  ASSERT_THAT(seen, ::testing::ElementsAre(100, 255, 0));
+  auto& log = SA::pwm_log();
+  ASSERT_EQ(log.size(), 3u);
+  ASSERT_EQ(log[0].time, 0u);
+  ASSERT_EQ(log[2].time, 2 * SA::call_us);
+  ASSERT_EQ(log[2].duty, 0);
+}
+
+TEST_F(SimArduinoTest, TestWritePort) {
+  SA::pinMode(8, OUTPUT);
+  SA::pinMode(9, OUTPUT);
+  SA::digitalWrite(8, HIGH);
+
+  volatile uint8_t* port = SA::port_output_register(8);
+  ASSERT_EQ(port, SA::port_output_register(9));
+  uint8_t mask = SA::pin_bit_mask(8) | SA::pin_bit_mask(9);
+  SA::write_port(port, mask, SA::pin_bit_mask(9));
+
+  ASSERT_EQ(SA::level(8), LOW);
+  ASSERT_EQ(SA::level(9), HIGH);
+}
+
+TEST_F(SimArduinoTest, TestTone) {
+  SA::tone(10, 500, 20);
+  ASSERT_EQ(SA::frequency(10), 500);
+
+  SA::run_for(20000);
+  ASSERT_EQ(SA::frequency(10), 0);
+}
+
+TEST_F(SimArduinoTest, TestSerial) {
+  Serial.begin(9600);
+  Serial.print("d=");
+  Serial.println(-42);
+
+  ASSERT_EQ(SA::serial_output(), "d=-42\r\n");
+}
+
+/*
+ * The firmware from main.cpp, run on the simulator
+ */
+class SimFirmwareTest : public SimArduinoTest {
+ protected:
+  void run_until(uint64_t us) {
+    while (SA::now() < us) {
+      loop();
+    }
+  }
+};
+
+// left alone the radar stays in standby with the LED breathing
+TEST_F(SimFirmwareTest, TestStandbyForAnHour) {
+  uint64_t green = 0, servo = 0;
+  SA::watch([&](SA::Output what, uint8_t pin, uint16_t value) {
+    green += what == SA::Output::PWM && pin == CFG::green_pin;
+    servo += what == SA::Output::SERVO;
+  });
+
+  setup();
+  run_until(3600 * 1000000ULL);
+
+  ASSERT_EQ(context->get_state(), RadarStateId::STANDBY);
+  // a breath every standby_pulse_ms, each going up and down a few steps
+  ASSERT_GT(green, 4 * 3600 * 1000u / CFG::standby_pulse_ms);
+  ASSERT_EQ(servo, 1u); // only where init() put it
+  ASSERT_GT(SA::stats().skips, 0u);
+}
+
+TEST_F(SimFirmwareTest, TestMotionStartsSweep) {
+  uint64_t servo = 0, pings = 0;
+  SA::watch([&](SA::Output what, uint8_t pin, uint16_t value) {
+    servo += what == SA::Output::SERVO;
+    pings += what == SA::Output::DIGITAL && pin == CFG::trigger_pin
+             && value == HIGH;
+  });
+  SA::at(2000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+
+  setup();
+  run_until(2000000);
+  ASSERT_EQ(context->get_state(), RadarStateId::STANDBY);
+
+  run_until(5000000);
+  ASSERT_EQ(context->get_state(), RadarStateId::SENSING);
+  ASSERT_GT(servo, 20u);
+  ASSERT_GT(pings, 2u);
+  // the trigger pulse was ended by the one shot
+  ASSERT_EQ(SA::level(CFG::trigger_pin), LOW);
+}
+
+// the same run twice gives the same answer
+TEST_F(SimFirmwareTest, TestDeterministic) {
+  auto run = []() {
+    SA::reset();
+    SA::capture_pwm(true);
+    SA::at(1000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+    setup();
+    while (SA::now() < 20000000) {
+      loop();
+    }
+    return SA::pwm_log();
+  };
+
+  auto first = run();
+  SA::Stats stats = SA::stats();
+  auto second = run();
+
+  ASSERT_EQ(first.size(), second.size());
+  for (size_t i = 0; i < first.size(); ++i) {
+    ASSERT_EQ(first[i].time, second[i].time) << "i = " << i;
+    ASSERT_EQ(first[i].duty, second[i].duty) << "i = " << i;
+  }
+  ASSERT_EQ(stats.calls, SA::stats().calls);
+  ASSERT_EQ(stats.interrupts, SA::stats().interrupts);
+}
+
+// the sim firmware is built with PROFILE, so it times itself as it goes
+TEST_F(SimFirmwareTest, TestProfiles) {
+  SA::at(2000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+
+  setup();
+  run_until(5000000);
+
+  auto move = Profiler::find((Profiler::Id)Commands::move);
+  ASSERT_NE(move, nullptr);
+  ASSERT_STREQ(move->name, "move");
+  ASSERT_GT(move->calls, 20u);
+  // the servo write costs a call
+  ASSERT_GE(move->max, SA::call_us * ArduinoInterface::ticks_per_us);
+  ASSERT_GT(Profiler::find("radar_ping")->calls, 2u);
+  ASSERT_GT(Profiler::find("led_tick")->calls, 4000u);
+  ASSERT_GT(Profiler::find("lcd_poll")->calls, 0u);
+  ASSERT_EQ(Profiler::unplaced(), 0);
+
+  // the trace has Serial, so the dump isn't queued, but it runs all the same
+  size_t before = SA::serial_output().size();
+  Commands::profile_dump(context);
+  std::string dump = SA::serial_output().substr(before);
+
+  // the window is from setup() to the end of the last loop()
+  ASSERT_EQ(dump.rfind("profile 50", 0), 0u) << dump;
+  ASSERT_NE(dump.find(" ms 0 unplaced\r\n"), std::string::npos) << dump;
+  ASSERT_NE(dump.find("\r\nmove n="), std::string::npos) << dump;
+  ASSERT_NE(dump.find("\r\nled_tick n="), std::string::npos) << dump;
+  ASSERT_EQ(Profiler::find((Profiler::Id)Commands::move)->calls, 0u);
+
+  // written out as slowly as Serial really would, the LED's ISR runs while
+  // the dump goes out, and what it counts is kept for the next one
+  struct SlowPrint : Print {
+    size_t write(uint8_t) override {
+      SA::run_for(87);    // a byte at 115200 baud
+      return 1;
+    }
+  } slow;
+  Profiler::dump(slow);
+  ASSERT_GT(Profiler::find("led_tick")->calls, 0u);
+}
@@ -0,0 +1,428 @@
+#include <gmock/gmock.h>
+#include <SimArduino.h>
+#include <SimFirmware.h>
+#include <Commands.h>
+#include <Scene.h>
+#include <ServoModel.h>
+#include <HCSR04Model.h>
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+using SA = SimArduino;
+
+/*
+ * Scene tests
+ */
+
+class SceneTest : public ::testing::Test {
+ protected:
+  Scene scene_;
+};
+
+TEST_F(SceneTest, TestRangeStraightAhead) {
+  scene_.add(90, 1000, 50);
+
+  // to the near side of the disc
+  ASSERT_NEAR(scene_.range(90, 15, 4000, 0), 950, 0.01);
+  ASSERT_LT(scene_.range(0, 15, 4000, 0), 0);
+  ASSERT_LT(scene_.range(180, 15, 4000, 0), 0);
+}
+
+// the beam, widened by the angle the disc takes up (about 2.9°)
+TEST_F(SceneTest, TestBeamWidth) {
+  scene_.add(90, 1000, 50);
+
+  ASSERT_GT(scene_.range(90 + 17.5f, 15, 4000, 0), 0);
+  ASSERT_GT(scene_.range(90 - 17.5f, 15, 4000, 0), 0);
+  ASSERT_LT(scene_.range(90 + 18.5f, 15, 4000, 0), 0);
+  ASSERT_LT(scene_.range(90 - 18.5f, 15, 4000, 0), 0);
+}
+
+TEST_F(SceneTest, TestNearestWins) {
+  scene_.add(90, 2000, 50);
+  scene_.add(95, 500, 50);
+  scene_.add(85, 1000, 50);
+
+  ASSERT_NEAR(scene_.range(90, 15, 4000, 0), 450, 0.01);
+}
+
+TEST_F(SceneTest, TestMaxRange) {
+  scene_.add(90, 2000, 50);
+
+  ASSERT_LT(scene_.range(90, 15, 1000, 0), 0);
+}
+
+TEST_F(SceneTest, TestMoving) {
+  scene_.add(90, 1000, 50, 0, -100);  // coming straight at us at 100mm/s
+
+  ASSERT_NEAR(scene_.range(90, 15, 4000, 5), 450, 0.01);
+}
+
+TEST_F(SceneTest, TestParse) {
+  std::istringstream in {"# a wall and a cat\n"
+                         "90 1000\n"
+                         "\n"
+                         "  45 500 20 0 -10  # walking off\n"};
+
+  ASSERT_TRUE(scene_.parse(in));
+  ASSERT_EQ(scene_.targets().size(), 2u);
+  ASSERT_FLOAT_EQ(scene_.targets()[0].radius, 50);
+  ASSERT_FLOAT_EQ(scene_.targets()[1].radius, 20);
+  ASSERT_FLOAT_EQ(scene_.targets()[1].vy, -10);
+}
+
+TEST_F(SceneTest, TestParseBad) {
+  std::istringstream in {"90 1000\n90 far\n45 500\n"};
+
+  ASSERT_FALSE(scene_.parse(in));
+  ASSERT_EQ(scene_.targets().size(), 1u);
+}
+
+/*
+ * ServoModel tests
+ */
+
+class ServoModelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SA::reset();
+    servo_.reset(new ServoModel {{}});
+  }
+
+  std::unique_ptr<ServoModel> servo_;
+};
+
+TEST_F(ServoModelTest, TestSlew) {
+  ASSERT_FLOAT_EQ(servo_->angle(), 90);
+
+  uint64_t start = SA::now();
+  SA::servo_write(9, 150);
+  ASSERT_EQ(servo_->target(), 150);
+
+  // 600°/s, so 30° in 50ms and there in 100ms
+  ASSERT_NEAR(servo_->angle_at(start + 50000), 120, 0.01);
+  ASSERT_FLOAT_EQ(servo_->angle_at(start + 100000), 150);
+  ASSERT_FLOAT_EQ(servo_->angle_at(start + 200000), 150);
+}
+
+TEST_F(ServoModelTest, TestChangeOfMind) {
+  uint64_t start = SA::now();
+  SA::servo_write(9, 150);
+  SA::run_for(start + 50000 - SA::now());
+  SA::servo_write(9, 90);   // turns back from 120
+
+  ASSERT_NEAR(servo_->angle_at(start + 75000), 105, 0.1);
+  ASSERT_FLOAT_EQ(servo_->angle_at(start + 150000), 90);
+}
+
+TEST_F(ServoModelTest, TestOtherPinsIgnored) {
+  SA::servo_write(10, 0);
+
+  ASSERT_EQ(servo_->writes(), 0u);
+  ASSERT_EQ(servo_->target(), 90);
+}
+
+/*
+ * HCSR04Model tests
+ */
+
+namespace {
+
+std::vector<uint64_t> edges;
+
+void edge_isr() {
+  edges.push_back(SA::now());
+}
+
+} // namespace
+
+class HCSR04ModelTest : public ::testing::Test {
+ protected:
+  Scene scene_;
+  std::unique_ptr<ServoModel> servo_;
+  std::unique_ptr<HCSR04Model> sensor_;
+  HCSR04Model::Params params_;
+
+  void SetUp() override {
+    scene_.add(90, 1000, 50);
+    params_.noise_mm = 0;
+    params_.dropout = 0;
+    params_.multipath = 0;
+    edges.clear();
+  }
+
+  void make() {
+    SA::reset();
+    servo_.reset(new ServoModel {{}});
+    sensor_.reset(new HCSR04Model {scene_, *servo_, params_});
+    SA::pinMode(params_.trigger_pin, OUTPUT);
+    SA::attachInterrupt(0, edge_isr, CHANGE);
+  }
+
+  // trigger for width µs, then wait long enough for any echo
+  uint64_t ping(uint16_t width = 10) {
+    SA::digitalWrite(params_.trigger_pin, HIGH);
+    SA::run_for(width - SA::call_us);
+    uint64_t fall = SA::now();
+    SA::digitalWrite(params_.trigger_pin, LOW);
+    SA::run_for(60000);
+    return fall;
+  }
+};
+
+TEST_F(HCSR04ModelTest, TestEcho) {
+  make();
+  uint64_t fall = ping();
+
+  ASSERT_EQ(sensor_->pings(), 1u);
+  ASSERT_EQ(sensor_->echoes(), 1u);
+  ASSERT_EQ(edges.size(), 2u);
+  ASSERT_EQ(edges[0], fall + params_.burst_us);
+  // there and back, 1900mm at 0.343mm/µs
+  ASSERT_EQ(edges[1] - edges[0], (uint64_t)std::lround(1900 / 0.343f));
+  ASSERT_EQ(SA::level(params_.echo_pin), LOW);
+}
+
+TEST_F(HCSR04ModelTest, TestNoEcho) {
+  make();
+  SA::servo_write(9, 0);
+  SA::run_for(1000000);
+  ping();
+
+  ASSERT_EQ(sensor_->pings(), 1u);
+  ASSERT_EQ(sensor_->echoes(), 0u);
+  ASSERT_LT(sensor_->last_range(), 0);
+  ASSERT_EQ(edges.size(), 2u);
+  ASSERT_EQ(edges[1] - edges[0], params_.no_echo_us);
+}
+
+// the sensor points where the servo has got to, not where it was told to go
+TEST_F(HCSR04ModelTest, TestFollowsServo) {
+  make();
+  SA::servo_write(9, 0);
+  SA::run_for(20000);   // only 12° of the way there
+  ping();
+  ASSERT_EQ(sensor_->echoes(), 1u);
+
+  SA::run_for(1000000);
+  ping();
+  ASSERT_EQ(sensor_->echoes(), 1u);
+  ASSERT_EQ(sensor_->pings(), 2u);
+}
+
+TEST_F(HCSR04ModelTest, TestShortTriggerIgnored) {
+  make();
+  ping(5);
+
+  ASSERT_EQ(sensor_->pings(), 0u);
+  ASSERT_TRUE(edges.empty());
+}
+
+TEST_F(HCSR04ModelTest, TestBusyIgnored) {
+  make();
+  SA::digitalWrite(params_.trigger_pin, HIGH);
+  SA::run_for(10);
+  SA::digitalWrite(params_.trigger_pin, LOW);
+  SA::run_for(1000);    // echo pin high now
+  ping();
+
+  ASSERT_EQ(sensor_->pings(), 1u);
+  ASSERT_EQ(edges.size(), 2u);
+}
+
+TEST_F(HCSR04ModelTest, TestDropout) {
+  params_.dropout = 1;
+  make();
+  ping();
+
+  ASSERT_EQ(sensor_->echoes(), 0u);
+  ASSERT_EQ(edges[1] - edges[0], params_.no_echo_us);
+}
+
+TEST_F(HCSR04ModelTest, TestMultipath) {
+  params_.multipath = 1;
+  make();
+  ping();
+
+  ASSERT_FLOAT_EQ(sensor_->last_range(), 1900);
+}
+
+TEST_F(HCSR04ModelTest, TestNoise) {
+  params_.noise_mm = 3;
+  make();
+
+  double sum = 0, sum_sq = 0;
+  const int n = 2000;
+  for (int i = 0; i < n; ++i) {
+    ping();
+    sum += sensor_->last_range();
+    sum_sq += sensor_->last_range() * sensor_->last_range();
+  }
+  double mean = sum / n;
+  double sd = std::sqrt(sum_sq / n - mean * mean);
+
+  ASSERT_NEAR(mean, 950, 0.5);
+  ASSERT_NEAR(sd, 3, 0.3);
+}
+
+TEST_F(HCSR04ModelTest, TestSeedRepeats) {
+  params_.noise_mm = 3;
+  params_.dropout = 0.2f;
+  auto run = [this]() {
+    make();
+    std::vector<float> ranges;
+    for (int i = 0; i < 50; ++i) {
+      ping();
+      ranges.push_back(sensor_->last_range());
+    }
+    return ranges;
+  };
+
+  auto first = run();
+  ASSERT_EQ(first, run());
+  params_.seed = 2;
+  ASSERT_NE(first, run());
+}
+
+/*
+ * The firmware sweeping a scene through the models
+ */
+
+class SimSweepTest : public ::testing::Test {
+ protected:
+  Scene scene_;
+  std::unique_ptr<ServoModel> servo_;
+  std::unique_ptr<HCSR04Model> sensor_;
+
+  void start() {
+    SA::reset();
+    servo_.reset(new ServoModel {{CFG::servo_pin}});
+    HCSR04Model::Params params;
+    params.trigger_pin = CFG::trigger_pin;
+    params.echo_pin = CFG::echo_pin;
+    sensor_.reset(new HCSR04Model {scene_, *servo_, params});
+    setup();
+  }
+
+  void run_until(uint64_t us) {
+    while (SA::now() < us) {
+      loop();
+    }
+  }
+};
+
+// something in range keeps the radar sweeping, and it's found where it is
+TEST_F(SimSweepTest, TestTracksTarget) {
+  scene_.add(60, 500, 50);
+  start();
+  // a while in standby first, then the PIR sees something for a second
+  SA::at(30000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+  SA::at(31000000, []() { SA::drive(CFG::ir_pin, LOW); });
+
+  run_until(10 * 60 * 1000000ULL);
+
+  ASSERT_EQ(context->get_state(), RadarStateId::SENSING);
+  ASSERT_GT(sensor_->echoes(), 100u);
+
+  Target nearest;
+  ASSERT_EQ(context->nearest_targets(&nearest, 1), 1);
+  ASSERT_NEAR(nearest.range, 450, 15);
+  ASSERT_LE(nearest.bearing_min, 60);
+  ASSERT_GE(nearest.bearing_max, 60);
+}
+
+// once it walks off, the radar goes back to standby
+TEST_F(SimSweepTest, TestTargetLeaves) {
+  scene_.add(90, 400, 50, 0, 20);   // 20mm/s away, out of range by 10s
+  start();
+  SA::at(1000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+  SA::at(2000000, []() { SA::drive(CFG::ir_pin, LOW); });
+
+  run_until(15000000);
+  ASSERT_EQ(context->get_state(), RadarStateId::SENSING);
+
+  run_until(40000000);
+  ASSERT_EQ(context->get_state(), RadarStateId::STANDBY);
+}
+
+// motion after a long while in standby gets a sweep of the full timeout,
+// rather than one ping and straight back to standby
+TEST_F(SimSweepTest, TestMotionGetsFullTimeout) {
+  start();
+  SA::at(60000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+  SA::at(61000000, []() { SA::drive(CFG::ir_pin, LOW); });
+
+  uint64_t sensing_from = 0, sensing_to = 0;
+  while (SA::now() < 90000000 && sensing_to == 0) {
+    loop();
+    bool sensing = context->get_state() != RadarStateId::STANDBY;
+    if (sensing && sensing_from == 0) {
+      sensing_from = SA::now();
+    } else if (!sensing && sensing_from != 0) {
+      sensing_to = SA::now();
+    }
+  }
+
+  ASSERT_NE(sensing_from, 0u);
+  ASSERT_NE(sensing_to, 0u);
+  // from the first ping after the timeout's up
+  ASSERT_GE((sensing_to - sensing_from) / 1000, CFG::standby_timeout);
+  ASSERT_LT((sensing_to - sensing_from) / 1000,
+            CFG::standby_timeout + 2 * CFG::ping_ms);
+}
+
+// the sim firmware is built with MEMORY_STATS. Over half an hour of it going
+// from standby to sweeping and back, the heap comes back to where it was and
+// never runs out, and the stack never reaches the heap.
+TEST_F(SimSweepTest, TestMemoryCeiling) {
+  scene_.add(90, 400, 50, 0, 20);
+  start();
+  run_until(5000000);
+  Memory::Stats settled = Memory::stats();
+  ASSERT_EQ(context->get_state(), RadarStateId::STANDBY);
+
+  // the PIR sees something for a second every minute
+  for (uint64_t s = 60; s < 30 * 60; s += 60) {
+    SA::at(s * 1000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+    SA::at((s + 1) * 1000000, []() { SA::drive(CFG::ir_pin, LOW); });
+  }
+  uint32_t sweeps = 0;
+  RadarStateId last = RadarStateId::STANDBY;
+  while (SA::now() < 30 * 60 * 1000000ULL) {
+    loop();
+    RadarStateId state = context->get_state();
+    sweeps += state == RadarStateId::SENSING && last == RadarStateId::STANDBY;
+    last = state;
+  }
+  ASSERT_EQ(context->get_state(), RadarStateId::STANDBY);
+  ASSERT_EQ(sweeps, 29u);
+
+  Memory::Stats stats = Memory::stats();
+  ASSERT_EQ(stats.count, settled.count);
+  ASSERT_EQ(stats.bytes, settled.bytes);
+  ASSERT_EQ(stats.failed, 0);
+  // sweeping queues move, ping and lcd_graph in place of pir_check
+  ASSERT_EQ(stats.peak_count, settled.count + 2);
+  ASSERT_LT(stats.peak_bytes, settled.bytes + 2 * 64);
+
+  // measured every second, and the paint's still there under the deepest
+  // the stack went
+  ASSERT_GT(Memory::min_free_stack(), 0u);
+  ASSERT_LT(Memory::min_free_stack(), Memory::host_stack);
+  ASSERT_LE(Memory::min_free_stack(), Memory::free_stack());
+
+  // the trace has Serial, so the report isn't queued, but it runs all the same
+  size_t before = SA::serial_output().size();
+  Commands::memory_report(context);
+  std::string report = SA::serial_output().substr(before);
+
+  std::ostringstream expected;
+  expected << "memory n=" << settled.count << " bytes=" << settled.bytes
+           << " peak_n=" << stats.peak_count << " peak=" << stats.peak_bytes
+           << " failed=0 stack=";
+  ASSERT_EQ(report.rfind(expected.str(), 0), 0u) << report;
+  ASSERT_NE(report.find(" min=" + std::to_string(Memory::min_free_stack())
+                        + "\r\n"), std::string::npos) << report;
+}
@@ -0,0 +1,120 @@
+#include <gmock/gmock.h>
+#include <TargetTracker.h>
+
+class TargetTrackerTest : public ::testing::Test {
+ protected:
+  // 30° angle gap, 150mm range gate, 4m max range, 10s expiry
+  TargetTracker tracker_ {30, 150, 4000, 10000};
+  Target targets_[TargetTracker::max_targets];
+};
+
+TEST_F(TargetTrackerTest, TestEmpty) {
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 0);
+}
+
+// nothing in range should never make a target
+TEST_F(TargetTrackerTest, TestOutOfRange) {
+  tracker_.add_sample(90, UINT32_MAX, 0);
+  tracker_.add_sample(100, 4001, 10);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 0);
+}
+
+// consecutive samples close in angle and range are one target
+TEST_F(TargetTrackerTest, TestSingleCluster) {
+  tracker_.add_sample(40, 1000, 0);
+  tracker_.add_sample(60, 950, 550);
+  tracker_.add_sample(80, 1020, 1100);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 1);
+  ASSERT_EQ(targets_[0].bearing_min, 40);
+  ASSERT_EQ(targets_[0].bearing_max, 80);
+  ASSERT_EQ(targets_[0].range, 950u);
+  ASSERT_EQ(targets_[0].last_seen, 1100u);
+}
+
+// a jump in range splits the samples into two targets, nearest first
+TEST_F(TargetTrackerTest, TestSplitOnRange) {
+  tracker_.add_sample(40, 2000, 0);
+  tracker_.add_sample(60, 2050, 550);
+  tracker_.add_sample(80, 500, 1100);
+  tracker_.add_sample(100, 520, 1650);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 2);
+  ASSERT_EQ(targets_[0].range, 500u);
+  ASSERT_EQ(targets_[0].bearing_min, 80);
+  ASSERT_EQ(targets_[0].bearing_max, 100);
+  ASSERT_EQ(targets_[1].range, 2000u);
+  ASSERT_EQ(targets_[1].bearing_min, 40);
+  ASSERT_EQ(targets_[1].bearing_max, 60);
+}
+
+// a gap in the sweep with nothing in range splits the samples too
+TEST_F(TargetTrackerTest, TestSplitOnGap) {
+  tracker_.add_sample(20, 1000, 0);
+  tracker_.add_sample(42, UINT32_MAX, 550);
+  tracker_.add_sample(64, 1000, 1100);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 2);
+}
+
+// seeing a target again on the next sweep updates it rather than adding one
+TEST_F(TargetTrackerTest, TestRevisit) {
+  tracker_.add_sample(60, 1000, 0);
+  tracker_.add_sample(80, 1010, 550);
+  tracker_.add_sample(120, UINT32_MAX, 1100);
+
+  // sweep back the other way, object has moved closer
+  tracker_.add_sample(70, 900, 5000);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 1);
+  ASSERT_EQ(targets_[0].range, 900u);
+  ASSERT_EQ(targets_[0].last_seen, 5000u);
+}
+
+TEST_F(TargetTrackerTest, TestExpiry) {
+  tracker_.add_sample(60, 1000, 0);
+  tracker_.add_sample(150, UINT32_MAX, 9999);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 1);
+
+  tracker_.add_sample(150, UINT32_MAX, 10000);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 0);
+}
+
+// when every slot is used, the stalest target makes way for a new one
+TEST_F(TargetTrackerTest, TestEvictStalest) {
+  uint32_t time = 0;
+  for (uint8_t i = 0; i < TargetTracker::max_targets; ++i) {
+    tracker_.add_sample(i * 30, 500 + i * 500, time);
+    time += 550;
+  }
+
+  tracker_.add_sample(180, 3900, time);
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets),
+            TargetTracker::max_targets);
+
+  // the first (and nearest) target was the stalest, so 1000mm is now nearest
+  ASSERT_EQ(targets_[0].range, 1000u);
+  ASSERT_EQ(targets_[TargetTracker::max_targets - 1].range, 3900u);
+}
+
+// only copy as many targets as asked for
+TEST_F(TargetTrackerTest, TestNearestN) {
+  tracker_.add_sample(0, 3000, 0);
+  tracker_.add_sample(60, 1000, 550);
+  tracker_.add_sample(120, 2000, 1100);
+
+  ASSERT_EQ(tracker_.nearest(targets_, 2), 2);
+  ASSERT_EQ(targets_[0].range, 1000u);
+  ASSERT_EQ(targets_[1].range, 2000u);
+}
+
+TEST_F(TargetTrackerTest, TestClear) {
+  tracker_.add_sample(60, 1000, 0);
+  tracker_.clear();
+
+  ASSERT_EQ(tracker_.nearest(targets_, TargetTracker::max_targets), 0);
+}
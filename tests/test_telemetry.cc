@@ -0,0 +1,233 @@
+#include <gmock/gmock.h>
+#include <TelemetrySender.h>
+
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+/*
+ * The format's pieces
+ */
+
+TEST(TelemetryTest, TestCRC) {
+  const uint8_t check[] {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+  // the check value for CRC-16/CCITT-FALSE
+  ASSERT_EQ(Telemetry::crc16(check, sizeof(check)), 0x29b1);
+  ASSERT_EQ(Telemetry::crc16(check, 0), 0xffff);
+}
+
+namespace {
+
+std::vector<uint8_t> encode(const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> out(data.size() + data.size() / 254 + 1);
+  out.resize(Telemetry::cobs_encode(data.data(), data.size(), out.data()));
+  return out;
+}
+
+std::vector<uint8_t> decode(const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> out(data.size());
+  out.resize(Telemetry::cobs_decode(data.data(), data.size(), out.data()));
+  return out;
+}
+
+} // namespace
+
+// the examples from the COBS paper and Wikipedia
+TEST(TelemetryTest, TestCOBS) {
+  ASSERT_THAT(encode({0x00}), ElementsAre(0x01, 0x01));
+  ASSERT_THAT(encode({0x00, 0x00}), ElementsAre(0x01, 0x01, 0x01));
+  ASSERT_THAT(encode({0x11, 0x22, 0x00, 0x33}),
+              ElementsAre(0x03, 0x11, 0x22, 0x02, 0x33));
+  ASSERT_THAT(encode({0x11, 0x00, 0x00, 0x00}),
+              ElementsAre(0x02, 0x11, 0x01, 0x01, 0x01));
+
+  for (auto data : std::vector<std::vector<uint8_t>> {
+           {0x00}, {0x11, 0x22, 0x00, 0x33}, {0x11, 0x00, 0x00, 0x00},
+           {0x01}}) {
+    ASSERT_EQ(decode(encode(data)), data);
+  }
+}
+
+// 254 bytes without a 0 fill a block, which ends without one
+TEST(TelemetryTest, TestCOBSLongBlock) {
+  std::vector<uint8_t> data;
+  for (int i = 1; i <= 254; ++i) {
+    data.push_back((uint8_t)i);
+  }
+
+  auto encoded = encode(data);
+  ASSERT_EQ(encoded.size(), 255u);
+  ASSERT_EQ(encoded[0], 0xff);
+  ASSERT_EQ(decode(encoded), data);
+
+  data.push_back(0x00);
+  data.push_back(0x42);
+  ASSERT_EQ(decode(encode(data)), data);
+}
+
+TEST(TelemetryTest, TestCOBSInvalid) {
+  ASSERT_TRUE(decode({0x05, 0x11, 0x22}).empty());   // runs off the end
+  ASSERT_TRUE(decode({0x03, 0x11, 0x00}).empty());   // a 0 inside
+  ASSERT_TRUE(decode({0x00}).empty());
+}
+
+TEST(TelemetryTest, TestVarint) {
+  uint8_t bytes[5];
+
+  ASSERT_EQ(Telemetry::put_varint(0, bytes), 1);
+  ASSERT_EQ(Telemetry::put_varint(300, bytes), 2);
+  ASSERT_THAT(std::vector<uint8_t>(bytes, bytes + 2), ElementsAre(0xac, 0x02));
+  ASSERT_EQ(Telemetry::put_varint(UINT32_MAX, bytes), 5);
+
+  const uint8_t* p = bytes;
+  uint32_t value;
+  ASSERT_TRUE(Telemetry::get_varint(p, bytes + 5, value));
+  ASSERT_EQ(value, UINT32_MAX);
+  ASSERT_EQ(p, bytes + 5);
+
+  p = bytes;
+  ASSERT_FALSE(Telemetry::get_varint(p, bytes + 3, value));
+}
+
+TEST(TelemetryTest, TestZigzag) {
+  ASSERT_EQ(Telemetry::zigzag(0), 0u);
+  ASSERT_EQ(Telemetry::zigzag(-1), 1u);
+  ASSERT_EQ(Telemetry::zigzag(1), 2u);
+  ASSERT_EQ(Telemetry::zigzag(INT32_MIN), UINT32_MAX);
+  for (int32_t v : {0, 1, -1, 180, -180, INT32_MAX, INT32_MIN}) {
+    ASSERT_EQ(Telemetry::unzigzag(Telemetry::zigzag(v)), v);
+  }
+}
+
+/*
+ * TelemetrySender tests
+ */
+
+class TelemetrySenderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TelemetrySender::start();
+  }
+
+  void TearDown() override {
+    TelemetrySender::stop();
+  }
+
+  // the payload of each frame in the buffer, CRC checked
+  static std::vector<std::vector<uint8_t>> frames() {
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<uint8_t> encoded;
+    uint8_t byte;
+    while (TelemetrySender::read(byte)) {
+      if (byte != 0) {
+        encoded.push_back(byte);
+        continue;
+      }
+      std::vector<uint8_t> payload = decode(encoded);
+      encoded.clear();
+      EXPECT_GE(payload.size(), 4u);
+      size_t size = payload.size() - 2;
+      EXPECT_EQ(Telemetry::crc16(payload.data(), size),
+                payload[size] << 8 | payload[size + 1]);
+      payload.resize(size);
+      payloads.push_back(payload);
+    }
+    EXPECT_TRUE(encoded.empty());
+    return payloads;
+  }
+};
+
+// a key first, then deltas from it
+TEST_F(TelemetrySenderTest, TestKeyThenDeltas) {
+  using Telemetry::Kind;
+
+  TelemetrySender::state(1, 1000);
+  TelemetrySender::range(92, 450, 1030);
+  TelemetrySender::range(91, UINT32_MAX, 1060);
+
+  ASSERT_THAT(frames(), ElementsAre(
+      // KEY for a STATE: 1000 is 0xe8 0x07, angle 0, range 0, state 1
+      ElementsAre(0, (uint8_t)Kind::KEY, (uint8_t)Kind::STATE, 0xe8, 0x07, 0,
+                  0, 1),
+      // +30ms, +92 is 184 (0xb8 0x01), +450 is 900 (0x84 0x07)
+      ElementsAre(1, (uint8_t)Kind::RANGE, 30, 0xb8, 0x01, 0x84, 0x07),
+      // +30ms, -1 is 1, and no echo is 0, so -450 is 899 (0x83 0x07)
+      ElementsAre(2, (uint8_t)Kind::RANGE, 30, 1, 0x83, 0x07)));
+}
+
+TEST_F(TelemetrySenderTest, TestStateFrame) {
+  TelemetrySender::range(90, 400, 10);
+  frames();
+
+  TelemetrySender::state(2, 15);
+
+  ASSERT_THAT(frames(), ElementsAre(
+      ElementsAre(1, (uint8_t)Telemetry::Kind::STATE, 5, 2)));
+}
+
+TEST_F(TelemetrySenderTest, TestKeyEvery) {
+  for (uint32_t i = 0; i <= Telemetry::key_every; ++i) {
+    TelemetrySender::range(90, 400, i);
+    frames();
+  }
+
+  TelemetrySender::range(91, 400, 100);
+
+  auto sent = frames();
+  ASSERT_EQ(sent.size(), 1u);
+  ASSERT_EQ(sent[0][1], (uint8_t)Telemetry::Kind::KEY);
+}
+
+// the buffer fills if nothing reads it, then says how many didn't fit
+TEST_F(TelemetrySenderTest, TestLost) {
+  using Telemetry::Kind;
+
+  for (uint32_t i = 0; i < 20; ++i) {
+    TelemetrySender::range(90, 400 + i, i * 30);
+  }
+  uint16_t dropped = TelemetrySender::dropped();
+  ASSERT_GT(dropped, 0);
+  size_t kept = frames().size();
+  ASSERT_EQ(kept + dropped, 20u);
+
+  TelemetrySender::range(91, 500, 1000);
+
+  auto sent = frames();
+  ASSERT_EQ(sent.size(), 2u);
+  uint8_t lost_at = (uint8_t)kept;
+  ASSERT_THAT(sent[0], ElementsAre(lost_at, (uint8_t)Kind::LOST, dropped));
+  ASSERT_EQ(sent[1][0], lost_at + 1);
+  ASSERT_EQ(sent[1][1], (uint8_t)Kind::KEY);
+}
+
+TEST_F(TelemetrySenderTest, TestStopped) {
+  TelemetrySender::stop();
+
+  TelemetrySender::range(90, 400, 10);
+  TelemetrySender::state(1, 20);
+
+  ASSERT_TRUE(frames().empty());
+  ASSERT_FALSE(TelemetrySender::sending());
+}
+
+// no frame has a 0 in it, whatever's in it, and none is longer than max_frame
+TEST_F(TelemetrySenderTest, TestFrameSize) {
+  TelemetrySender::state(0, UINT32_MAX - 5);
+  TelemetrySender::range(180, UINT32_MAX - 1, 0);
+  TelemetrySender::range(0, 0, UINT32_MAX);
+
+  std::vector<uint8_t> frame;
+  uint8_t byte;
+  size_t ends = 0;
+  while (TelemetrySender::read(byte)) {
+    frame.push_back(byte);
+    if (byte == 0) {
+      ASSERT_LE(frame.size(), Telemetry::max_frame);
+      frame.clear();
+      ++ends;
+    }
+  }
+  ASSERT_EQ(ends, 3u);
+}
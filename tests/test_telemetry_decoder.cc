@@ -0,0 +1,223 @@
+#include <gmock/gmock.h>
+#include <TelemetrySender.h>
+#include <TelemetryDecoder.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Telemetry::Kind;
+using Row = TelemetryDecoder::Row;
+
+class TelemetryDecoderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TelemetrySender::start();
+  }
+
+  void TearDown() override {
+    TelemetrySender::stop();
+  }
+
+  // what the sender has to send
+  static std::vector<uint8_t> sent() {
+    std::vector<uint8_t> bytes;
+    uint8_t byte;
+    while (TelemetrySender::read(byte)) {
+      bytes.push_back(byte);
+    }
+    return bytes;
+  }
+
+  static size_t feed(TelemetryDecoder& decoder,
+                     const std::vector<uint8_t>& bytes) {
+    return decoder.feed(bytes.data(), bytes.size());
+  }
+};
+
+TEST_F(TelemetryDecoderTest, TestRoundTrip) {
+  TelemetryDecoder decoder;
+  std::vector<Row> expected;
+  size_t rows = 0;
+
+  TelemetrySender::state(1, 500);
+  expected.push_back({500, Kind::STATE, 0, 0, 1});
+  for (uint32_t i = 1; i <= 100; ++i) {
+    auto angle = (uint8_t)(i % 180);
+    uint32_t range = (i % 7 == 0) ? UINT32_MAX : 300 + i * 3;
+    TelemetrySender::range(angle, range, 500 + i * 30);
+    expected.push_back({500 + i * 30, Kind::RANGE, angle,
+                        (range == UINT32_MAX) ? 0 : range, 1});
+    rows += feed(decoder, sent());
+  }
+  TelemetrySender::state(0, 4000);
+  Row last = expected.back();
+  expected.push_back({4000, Kind::STATE, last.angle, last.range, 0});
+  rows += feed(decoder, sent());
+
+  ASSERT_EQ(rows, expected.size());
+  ASSERT_EQ(decoder.rows(), expected);
+  auto stats = decoder.stats();
+  ASSERT_EQ(stats.frames, expected.size());
+  ASSERT_EQ(stats.bad + stats.gaps + stats.skipped + stats.lost, 0u);
+}
+
+// a byte at a time decodes the same as all at once
+TEST_F(TelemetryDecoderTest, TestSplitFeed) {
+  for (uint32_t i = 0; i < 40; ++i) {
+    TelemetrySender::range((uint8_t)i, 400 - i, i * 30);
+  }
+  auto bytes = sent();
+
+  TelemetryDecoder whole;
+  feed(whole, bytes);
+  TelemetryDecoder split;
+  for (uint8_t byte : bytes) {
+    split.feed(&byte, 1);
+  }
+
+  ASSERT_FALSE(whole.rows().empty());
+  ASSERT_EQ(split.rows(), whole.rows());
+}
+
+// a bad frame loses the deltas until the next key
+TEST_F(TelemetryDecoderTest, TestCorruption) {
+  TelemetryDecoder decoder;
+  TelemetrySender::range(90, 400, 0);
+  feed(decoder, sent());
+
+  TelemetrySender::range(91, 410, 30);
+  auto bytes = sent();
+  bytes[2] ^= 0x40;
+  feed(decoder, bytes);
+  for (uint32_t i = 2; i <= Telemetry::key_every; ++i) {
+    TelemetrySender::range(90, 400, i * 30);
+    feed(decoder, sent());
+  }
+  ASSERT_EQ(decoder.rows().size(), 1u);
+  ASSERT_EQ(decoder.stats().bad, 1u);
+  ASSERT_EQ(decoder.stats().skipped, Telemetry::key_every - 1u);
+
+  TelemetrySender::range(92, 420, 5000);
+  ASSERT_EQ(feed(decoder, sent()), 1u);
+  ASSERT_EQ(decoder.rows().back(), (Row {5000, Kind::RANGE, 92, 420, 0}));
+}
+
+TEST_F(TelemetryDecoderTest, TestSequenceGap) {
+  TelemetryDecoder decoder;
+  TelemetrySender::range(90, 400, 0);
+  TelemetrySender::range(91, 400, 30);
+  feed(decoder, sent());
+
+  TelemetrySender::range(92, 400, 60);
+  sent();   // never arrives
+  TelemetrySender::range(93, 400, 90);
+  feed(decoder, sent());
+
+  ASSERT_EQ(decoder.rows().size(), 2u);
+  ASSERT_EQ(decoder.stats().gaps, 1u);
+  ASSERT_EQ(decoder.stats().skipped, 1u);
+}
+
+// the sender dropping frames says so, then sends a key
+TEST_F(TelemetryDecoderTest, TestLost) {
+  TelemetryDecoder decoder;
+  for (uint32_t i = 0; i < 20; ++i) {
+    TelemetrySender::range(90, 400, i * 30);
+  }
+  feed(decoder, sent());
+  size_t kept = decoder.rows().size();
+
+  TelemetrySender::range(100, 500, 1000);
+  feed(decoder, sent());
+
+  ASSERT_EQ(decoder.stats().lost, TelemetrySender::dropped());
+  ASSERT_EQ(decoder.stats().gaps, 0u);
+  ASSERT_EQ(decoder.rows().size(), kept + 1);
+  ASSERT_EQ(decoder.rows().back(), (Row {1000, Kind::RANGE, 100, 500, 0}));
+}
+
+// joined part way in, it waits for a key
+TEST_F(TelemetryDecoderTest, TestJoinPartWay) {
+  TelemetrySender::range(90, 400, 0);
+  sent();
+  TelemetrySender::range(91, 400, 30);
+  auto bytes = sent();
+
+  TelemetryDecoder decoder;
+  std::vector<uint8_t> half {bytes.begin() + 3, bytes.end()};
+  feed(decoder, half);   // the end of a frame
+  feed(decoder, bytes);
+
+  ASSERT_TRUE(decoder.rows().empty());
+  ASSERT_EQ(decoder.stats().bad, 1u);
+  ASSERT_EQ(decoder.stats().skipped, 1u);
+}
+
+// times carry on past millis() wrapping, in deltas and keys
+TEST_F(TelemetryDecoderTest, TestWrap) {
+  TelemetryDecoder decoder;
+  TelemetrySender::range(90, 400, UINT32_MAX - 9);
+  TelemetrySender::range(91, 400, 20);
+  feed(decoder, sent());
+  for (uint32_t i = 1; i < Telemetry::key_every; ++i) {
+    TelemetrySender::range(90, 400, 20 + i);
+    feed(decoder, sent());
+  }
+  TelemetrySender::range(90, 400, 1000);
+  feed(decoder, sent());
+
+  uint64_t wrap = (uint64_t)UINT32_MAX + 1;
+  ASSERT_EQ(decoder.rows()[0].time, wrap - 10);
+  ASSERT_EQ(decoder.rows()[1].time, wrap + 20);
+  ASSERT_EQ(decoder.rows().back().kind, Kind::RANGE);
+  ASSERT_EQ(decoder.rows().back().time, wrap + 1000);
+}
+
+// no 0 for far too long
+TEST_F(TelemetryDecoderTest, TestOverlong) {
+  TelemetryDecoder decoder;
+  std::vector<uint8_t> noise(1000, 0x55);
+  noise.push_back(0);
+
+  feed(decoder, noise);
+
+  ASSERT_EQ(decoder.stats().bad, 1u);
+}
+
+TEST(TelemetryWriterTest, TestCSV) {
+  std::vector<Row> rows {{12004, Kind::RANGE, 91, 452, 1},
+                         {12030, Kind::STATE, 91, 452, 0}};
+  std::ostringstream out;
+
+  TelemetryDecoder::write_csv_header(out);
+  TelemetryDecoder::write_csv(out, rows);
+
+  ASSERT_EQ(out.str(), "time_ms,kind,angle,range_mm,state\n"
+                       "12004,range,91,452,1\n"
+                       "12030,state,91,452,0\n");
+}
+
+TEST(TelemetryWriterTest, TestColumns) {
+  std::vector<Row> rows {{0x0102030405, Kind::RANGE, 91, 0x1c4, 1},
+                         {7, Kind::STATE, 92, 0, 0}};
+  std::ostringstream out;
+
+  TelemetryDecoder::write_columns(out, rows);
+
+  std::string s = out.str();
+  std::string header {'R', 'T', 'C', 1, 2, 0, 0, 0, 5};
+  ASSERT_EQ(s.substr(0, header.size()), header);
+
+  std::string time {7, 't', 'i', 'm', 'e', '_', 'm', 's', 8,
+                    5, 4, 3, 2, 1, 0, 0, 0,
+                    7, 0, 0, 0, 0, 0, 0, 0};
+  ASSERT_EQ(s.substr(header.size(), time.size()), time);
+
+  std::string range {8, 'r', 'a', 'n', 'g', 'e', '_', 'm', 'm', 4,
+                     (char)0xc4, 1, 0, 0, 0, 0, 0, 0};
+  ASSERT_NE(s.find(range), std::string::npos);
+  // time, kind, angle, range, state
+  ASSERT_EQ(s.size(), header.size() + (9 + 16) + (6 + 2) + (7 + 2)
+                          + (10 + 8) + (7 + 2));
+}
@@ -0,0 +1,106 @@
+#include <gmock/gmock.h>
+#include <TraceRecorder.h>
+
+#include <vector>
+
+using ::testing::Return;
+
+class TraceRecorderTest : public ::testing::Test {
+ protected:
+  MockArduinoClass mock_arduino_;
+
+  void SetUp() override {
+    MockArduino::mock = &mock_arduino_;
+    TraceRecorder::start();
+  }
+
+  void TearDown() override {
+    TraceRecorder::stop();
+  }
+
+  // everything in the buffer
+  static std::vector<uint8_t> drain() {
+    std::vector<uint8_t> bytes;
+    uint8_t byte;
+    while (TraceRecorder::read(byte)) {
+      bytes.push_back(byte);
+    }
+    return bytes;
+  }
+
+  // everything after the header
+  static std::vector<uint8_t> records() {
+    auto bytes = drain();
+    EXPECT_GE(bytes.size(), Trace::header_size);
+    return {bytes.begin() + Trace::header_size, bytes.end()};
+  }
+};
+
+TEST_F(TraceRecorderTest, TestHeader) {
+  ASSERT_TRUE(TraceRecorder::recording());
+  ASSERT_THAT(drain(), ::testing::ElementsAre('R', 'T', 'R', Trace::version));
+}
+
+TEST_F(TraceRecorderTest, TestRecord) {
+  EXPECT_CALL(mock_arduino_, micros())
+      .WillOnce(Return(100))
+      .WillOnce(Return(25100));
+
+  TraceRecorder::record(Trace::Kind::PIR, HIGH);
+  TraceRecorder::record(Trace::Kind::SERVO, 91);
+
+  // PIR high at +100, zigzag 200 is 0xc8 0x01. SERVO 91 at +25000, zigzag
+  // 50000 is 0xd0 0x86 0x03.
+  ASSERT_THAT(records(), ::testing::ElementsAre(
+      0x81, 0xc8, 0x01,
+      0x02, 0xd0, 0x86, 0x03, 91));
+}
+
+// an ISR stamped a little before the record in front of it
+TEST_F(TraceRecorderTest, TestBackwardsDelta) {
+  EXPECT_CALL(mock_arduino_, micros()).WillOnce(Return(1000));
+
+  TraceRecorder::record(Trace::Kind::STATE, 1);
+  TraceRecorder::record_isr(Trace::Kind::ECHO, LOW, 997);
+
+  // zigzag 2000 is 0xd0 0x0f, -3 is 5
+  ASSERT_THAT(records(), ::testing::ElementsAre(
+      0x03, 0xd0, 0x0f, 1,
+      0x00, 0x05));
+}
+
+// the deltas carry on across micros() wrapping
+TEST_F(TraceRecorderTest, TestWrap) {
+  TraceRecorder::record_isr(Trace::Kind::ECHO, HIGH, UINT32_MAX - 9);
+  drain();
+  TraceRecorder::record_isr(Trace::Kind::ECHO, LOW, 10);
+
+  ASSERT_THAT(drain(), ::testing::ElementsAre(0x00, 40));
+}
+
+TEST_F(TraceRecorderTest, TestStopped) {
+  TraceRecorder::stop();
+  drain();
+
+  TraceRecorder::record(Trace::Kind::PIR, HIGH);
+  TraceRecorder::record_isr(Trace::Kind::ECHO, HIGH, 5);
+
+  ASSERT_TRUE(drain().empty());
+}
+
+TEST_F(TraceRecorderTest, TestLost) {
+  drain();
+  // 2 bytes each. Each needs room for the longest record, so 29 fit.
+  for (uint32_t i = 0; i < 40; ++i) {
+    TraceRecorder::record_isr(Trace::Kind::ECHO, i & 1, i * 10);
+  }
+  ASSERT_EQ(TraceRecorder::dropped(), 11);
+  ASSERT_EQ(drain().size(), 29u * 2);
+
+  TraceRecorder::record_isr(Trace::Kind::ECHO, HIGH, 1000);
+
+  // LOST 11 at +720 from the last one kept, then the record at +0
+  ASSERT_THAT(drain(), ::testing::ElementsAre(
+      0x04, 0xa0, 0x0b, 11,
+      0x80, 0x00));
+}
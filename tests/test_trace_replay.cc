@@ -0,0 +1,220 @@
+#include <gmock/gmock.h>
+#include <SimArduino.h>
+#include <SimFirmware.h>
+#include <HCSR04Model.h>
+#include <TraceReplay.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using SA = SimArduino;
+
+/*
+ * TraceReader tests
+ */
+
+namespace {
+
+std::vector<TraceReader::Event> read_all(const std::vector<uint8_t>& bytes) {
+  TraceReader reader {bytes.data(), bytes.size()};
+  std::vector<TraceReader::Event> events;
+  TraceReader::Event event {};
+  while (reader.next(event)) {
+    events.push_back(event);
+  }
+  return events;
+}
+
+const uint8_t* data_of(const std::string& s) {
+  return (const uint8_t*)s.data();
+}
+
+} // namespace
+
+TEST(TraceReaderTest, TestDecode) {
+  std::vector<uint8_t> bytes {'R', 'T', 'R', Trace::version,
+                              0x81, 0xc8, 0x01,         // PIR high at 100
+                              0x02, 0xd0, 0x86, 0x03, 91,  // SERVO at 25100
+                              0x00, 0x05};              // ECHO low at 25097
+
+  auto events = read_all(bytes);
+
+  ASSERT_EQ(events.size(), 3u);
+  ASSERT_EQ(events[0], (TraceReader::Event {100, Trace::Kind::PIR, 1}));
+  ASSERT_EQ(events[1], (TraceReader::Event {25100, Trace::Kind::SERVO, 91}));
+  ASSERT_EQ(events[2], (TraceReader::Event {25097, Trace::Kind::ECHO, 0}));
+}
+
+TEST(TraceReaderTest, TestBadHeader) {
+  std::vector<uint8_t> bytes {'R', 'T', 'X', Trace::version, 0x81, 0x00};
+  TraceReader reader {bytes.data(), bytes.size()};
+  TraceReader::Event event {};
+
+  ASSERT_FALSE(reader.valid());
+  ASSERT_FALSE(reader.next(event));
+}
+
+TEST(TraceReaderTest, TestTruncated) {
+  std::vector<uint8_t> bytes {'R', 'T', 'R', Trace::version,
+                              0x81, 0x00,
+                              0x02, 0xd0};   // cut off in the delta
+  TraceReader reader {bytes.data(), bytes.size()};
+  TraceReader::Event event {};
+
+  ASSERT_TRUE(reader.next(event));
+  ASSERT_FALSE(reader.next(event));
+  ASSERT_TRUE(reader.truncated());
+  ASSERT_EQ(reader.offset(), 6u);
+}
+
+/*
+ * Recording on the simulator, and replaying it
+ */
+
+class TraceReplayTest : public ::testing::Test {
+ protected:
+  static constexpr uint64_t run_us {40000000};
+
+  // the firmware with the models, something in front of it and the PIR
+  // tripped, as radar_sim runs it
+  static std::string record() {
+    SA::reset();
+    Scene scene;
+    scene.add(70, 400, 50, 0, 15);  // walking off, so it goes to standby
+    ServoModel servo {{CFG::servo_pin}};
+    HCSR04Model::Params params;
+    params.trigger_pin = CFG::trigger_pin;
+    params.echo_pin = CFG::echo_pin;
+    HCSR04Model sensor {scene, servo, params};
+    SA::at(2000000, []() { SA::drive(CFG::ir_pin, HIGH); });
+    SA::at(3000000, []() { SA::drive(CFG::ir_pin, LOW); });
+
+    setup();
+    while (SA::now() < run_us) {
+      loop();
+    }
+    return TraceReplay::recorded();
+  }
+
+  // the firmware with only the trace driving it
+  static std::string replay(const uint8_t* data, size_t size) {
+    SA::reset();
+    TraceReplay replay {data, size, {CFG::echo_pin, CFG::ir_pin}};
+    EXPECT_TRUE(replay.valid());
+    setup();
+    while (SA::now() <= replay.end()) {
+      loop();
+    }
+    return TraceReplay::recorded();
+  }
+};
+
+TEST_F(TraceReplayTest, TestRecordsEverything) {
+  std::string trace = record();
+  TraceReader reader {data_of(trace), trace.size()};
+  ASSERT_TRUE(reader.valid());
+
+  uint64_t counts[5] {};
+  std::vector<uint8_t> states;
+  TraceReader::Event event {};
+  uint64_t last = 0;
+  while (reader.next(event)) {
+    ++counts[(uint8_t)event.kind];
+    if (event.kind == Trace::Kind::STATE) {
+      states.push_back(event.value);
+    }
+    last = event.time;
+  }
+
+  ASSERT_FALSE(reader.truncated());
+  ASSERT_GT(counts[(uint8_t)Trace::Kind::ECHO], 20u);
+  ASSERT_GT(counts[(uint8_t)Trace::Kind::PIR], 4u);
+  ASSERT_GT(counts[(uint8_t)Trace::Kind::SERVO], 100u);
+  ASSERT_EQ(counts[(uint8_t)Trace::Kind::LOST], 0u);
+  ASSERT_THAT(states, ::testing::ElementsAre(
+      (uint8_t)RadarStateId::STANDBY, (uint8_t)RadarStateId::SENSING,
+      (uint8_t)RadarStateId::STANDBY));
+  ASSERT_LE(last, run_us);
+  ASSERT_EQ(TraceRecorder::dropped(), 0);
+}
+
+// with nothing but the trace, the firmware does the same again
+TEST_F(TraceReplayTest, TestReplayMatches) {
+  std::string recorded = record();
+  std::string replayed = replay(data_of(recorded), recorded.size());
+
+  auto d = TraceReplay::compare({data_of(recorded), recorded.size()},
+                                {data_of(replayed), replayed.size()});
+
+  ASSERT_FALSE(d.found) << "recorded " << d.expected << ", replayed "
+                        << d.got;
+  ASSERT_GT(d.compared, 100u);
+}
+
+TEST_F(TraceReplayTest, TestReplayDeterministic) {
+  std::string recorded = record();
+
+  std::string first = replay(data_of(recorded), recorded.size());
+  SA::Stats stats = SA::stats();
+  std::string second = replay(data_of(recorded), recorded.size());
+
+  ASSERT_EQ(first, second);
+  ASSERT_EQ(stats.calls, SA::stats().calls);
+  ASSERT_EQ(stats.interrupts, SA::stats().interrupts);
+}
+
+TEST_F(TraceReplayTest, TestFindsDivergence) {
+  std::string recorded = record();
+  std::string replayed = replay(data_of(recorded), recorded.size());
+
+  // move the 50th servo record somewhere else
+  TraceReader reader {data_of(recorded), recorded.size()};
+  TraceReader::Event event {};
+  int servos = 0;
+  while (reader.next(event)) {
+    if (event.kind == Trace::Kind::SERVO && ++servos == 50) {
+      break;
+    }
+  }
+  // the angle is the record's last byte
+  std::string changed = recorded;
+  changed[reader.offset() - 1] = (char)(event.value + 1);
+
+  auto d = TraceReplay::compare({data_of(changed), changed.size()},
+                                {data_of(replayed), replayed.size()});
+
+  ASSERT_TRUE(d.found);
+  ASSERT_TRUE(d.has_got);
+  ASSERT_EQ(d.expected.kind, Trace::Kind::SERVO);
+  ASSERT_EQ(d.expected.value, event.value + 1);
+  ASSERT_EQ(d.got.value, event.value);
+  ASSERT_EQ(d.compared, 49u + 2);   // and STANDBY and SENSING before it
+}
+
+// streamed from a mapped file, as radar_replay does
+TEST_F(TraceReplayTest, TestReplayFromFile) {
+  std::string recorded = record();
+  std::string path = ::testing::TempDir() + "trace_replay_test.bin";
+  {
+    std::ofstream out {path, std::ios::binary};
+    out.write(recorded.data(), (std::streamsize)recorded.size());
+  }
+
+  MappedFile file;
+  ASSERT_TRUE(file.open(path.c_str()));
+  ASSERT_EQ(file.size(), recorded.size());
+  std::string from_file = replay(file.data(), file.size());
+  std::string from_memory = replay(data_of(recorded), recorded.size());
+  std::remove(path.c_str());
+
+  ASSERT_EQ(from_file, from_memory);
+}
+
+TEST_F(TraceReplayTest, TestMissingFile) {
+  MappedFile file;
+
+  ASSERT_FALSE(file.open("/nonexistent/trace.bin"));
+  ASSERT_EQ(file.data(), nullptr);
+}
@@ -0,0 +1,96 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_ARDUINO_H_
+#define A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_ARDUINO_H_
+
+/*
+ * Declarations standing in for the core's Arduino.h, for avr_check. Only
+ * what the firmware uses, with the same names and types, and nothing is
+ * defined: the check compiles with -fsyntax-only, so nothing is linked.
+ *
+ * The registers are plain volatile globals rather than the AVR's fixed
+ * addresses, which is enough for the compiler to check what's done to them.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <Print.h>
+
+#define F_CPU 16000000UL
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p)  ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#define PIN_A0   (14)
+#define PIN_A1   (15)
+#define PIN_A2   (16)
+#define PIN_A3   (17)
+#define PIN_A4   (18)
+#define PIN_A5   (19)
+#define PIN_A6   (20)
+#define PIN_A7   (21)
+
+static const uint8_t A0 = PIN_A0;
+static const uint8_t A1 = PIN_A1;
+static const uint8_t A2 = PIN_A2;
+static const uint8_t A3 = PIN_A3;
+static const uint8_t A4 = PIN_A4;
+static const uint8_t A5 = PIN_A5;
+static const uint8_t A6 = PIN_A6;
+static const uint8_t A7 = PIN_A7;
+
+#define _BV(bit) (1 << (bit))
+
+extern volatile uint8_t SREG;
+extern volatile uint8_t TIFR0, TIMSK0, TIFR1, TIMSK1;
+extern volatile uint16_t TCNT1, OCR1B;
+#define OCF0B 2
+#define OCIE0B 2
+#define OCF1B 2
+#define OCIE1B 2
+
+#define noInterrupts() cli()
+#define interrupts() sei()
+
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t* portOutputRegister(uint8_t port);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long pulseIn(uint8_t pin, uint8_t state,
+                      unsigned long timeout = 1000000L);
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+class HardwareSerial : public Print {
+ public:
+  void begin(unsigned long baud);
+  int available();
+  int availableForWrite();
+  int read();
+  size_t write(uint8_t c) override;
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_ARDUINO_H_
@@ -0,0 +1,21 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_SERVO_H_
+#define A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_SERVO_H_
+
+// The Servo library's class, for avr_check
+
+#include <stdint.h>
+
+class Servo {
+ public:
+  Servo();
+  uint8_t attach(int pin);
+  uint8_t attach(int pin, int min, int max);
+  void detach();
+  void write(int value);
+  void writeMicroseconds(int value);
+  int read();
+  int readMicroseconds();
+  bool attached();
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_SERVO_H_
@@ -0,0 +1,11 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_AVR_EEPROM_H_
+#define A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_AVR_EEPROM_H_
+
+// avr-libc's, for avr_check
+
+#include <stdint.h>
+
+uint8_t eeprom_read_byte(const uint8_t* address);
+void eeprom_update_byte(uint8_t* address, uint8_t value);
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_AVR_EEPROM_H_
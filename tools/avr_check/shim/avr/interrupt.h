@@ -0,0 +1,11 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_AVR_INTERRUPT_H_
+#define A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_AVR_INTERRUPT_H_
+
+// avr-libc's, for avr_check: an ISR is a plain function
+
+void cli();
+void sei();
+
+#define ISR(vector) extern "C" void vector()
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_AVR_CHECK_SHIM_AVR_INTERRUPT_H_
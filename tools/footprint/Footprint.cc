@@ -0,0 +1,339 @@
+#include <Footprint.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+namespace {
+
+const char* const file_format {":     file format "};
+
+// what objdump puts in front of the class for the extras it comes with
+const char* const class_extras[] {"vtable for ", "typeinfo for ",
+                                  "typeinfo name for ", "VTT for "};
+
+// goes wherever the variable it guards goes
+const char* const guard {"guard variable for "};
+
+// the characters an operator's name can be made of
+const char* const operator_chars {"<>=!+-*/%&|^~[],"};
+
+// where the < at from ends, or npos
+size_t matching_angle(const std::string& s, size_t from) {
+  int depth = 0;
+  for (size_t i = from; i < s.size(); ++i) {
+    if (s[i] == '<') {
+      ++depth;
+    } else if (s[i] == '>' && --depth == 0) {
+      return i;
+    }
+  }
+  return std::string::npos;
+}
+
+// the first c outside any template arguments, or npos
+size_t find_outside(const std::string& s, char c, bool last = false) {
+  size_t found = std::string::npos;
+  int depth = 0;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '<') {
+      ++depth;
+    } else if (s[i] == '>') {
+      --depth;
+    } else if (s[i] == c && depth == 0) {
+      found = i;
+      if (!last) {
+        break;
+      }
+    }
+  }
+  return found;
+}
+
+std::string limit(uint64_t n) {
+  return (n == Footprint::Budget::no_limit) ? "-" : std::to_string(n);
+}
+
+bool parse_limit(const std::string& field, uint64_t& n) {
+  if (field == "-") {
+    n = Footprint::Budget::no_limit;
+    return true;
+  }
+  if (field.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  n = std::stoull(field);
+  return true;
+}
+
+} // namespace
+
+char Footprint::section_kind_(const std::string& section) {
+  auto starts = [&section](const char* prefix) {
+    return section.rfind(prefix, 0) == 0;
+  };
+
+  if (starts(".text") || starts(".progmem")) {
+    return 't';
+  }
+  // the AVR has nowhere else to put .rodata, so it goes in with .data
+  if (starts(".data") || starts(".rodata") || starts(".tdata")) {
+    return 'd';
+  }
+  if (starts(".bss") || starts(".tbss") || section == "*COM*") {
+    return 'b';
+  }
+  return 0;
+}
+
+std::string Footprint::object_name_(const std::string& path) {
+  std::string name = path.substr(path.find_last_of('/') + 1);
+  // RadarState.cc.o from CMake, MyLED.cpp.o from the Arduino toolchain
+  for (const char* ext : {".o", ".obj", ".cc", ".cpp", ".c"}) {
+    size_t len = std::char_traits<char>::length(ext);
+    if (name.size() > len && name.compare(name.size() - len, len, ext) == 0) {
+      name.erase(name.size() - len);
+    }
+  }
+  return name;
+}
+
+std::string Footprint::module_of_(const Symbol& symbol) {
+  std::string s = symbol.name;
+  const std::string anonymous {"(anonymous namespace)::"};
+  for (size_t at; (at = s.find(anonymous)) != std::string::npos;) {
+    s.erase(at, anonymous.size());
+  }
+
+  if (s.rfind(guard, 0) == 0) {
+    s.erase(0, std::char_traits<char>::length(guard));
+  }
+
+  // operator< and the like aren't templates, so take the < out of the way
+  size_t op = s.find("operator");
+  if (op != std::string::npos) {
+    size_t from = op + std::char_traits<char>::length("operator");
+    size_t to = (s.compare(from, 2, "()") == 0)
+                    ? from + 2
+                    : s.find_first_not_of(operator_chars, from);
+    s.erase(from, to - from);
+  }
+
+  bool whole_class = false;
+  for (const char* prefix : class_extras) {
+    if (s.rfind(prefix, 0) == 0) {
+      s.erase(0, std::char_traits<char>::length(prefix));
+      whole_class = true;
+      break;
+    }
+  }
+
+  // the parameters, then the return type a function template has in front
+  size_t paren = find_outside(s, '(');
+  if (paren != std::string::npos) {
+    s.erase(paren);
+  }
+  size_t space = find_outside(s, ' ', true);
+  if (space != std::string::npos && !whole_class) {
+    s.erase(0, space + 1);
+  }
+
+  size_t angle = s.find('<');
+  if (angle != std::string::npos) {
+    size_t end = matching_angle(s, angle);
+    return (end == std::string::npos) ? s : s.substr(0, end + 1);
+  }
+  if (!symbol.shared) {
+    return symbol.object;
+  }
+  if (whole_class) {
+    return s;
+  }
+  size_t scope = s.rfind("::");
+  return (scope == std::string::npos) ? "(inline)" : s.substr(0, scope);
+}
+
+size_t Footprint::read(std::istream& in) {
+  std::string object;
+  std::string line;
+  size_t count = 0;
+
+  while (std::getline(in, line)) {
+    size_t format = line.find(file_format);
+    if (format != std::string::npos) {
+      object = object_name_(line.substr(0, format));
+      continue;
+    }
+
+    // address, 7 flags, section, tab, size, name
+    size_t space = line.find(' ');
+    if (space == std::string::npos || space == 0
+        || line.find_first_not_of("0123456789abcdef") != space
+        || line.size() < space + 9) {
+      continue;
+    }
+    std::string flags = line.substr(space + 1, 7);
+    size_t tab = line.find('\t', space + 9);
+    if (tab == std::string::npos) {
+      continue;
+    }
+    std::string section = line.substr(space + 9, tab - space - 9);
+    size_t size_end = line.find(' ', tab + 1);
+    if (size_end == std::string::npos) {
+      continue;
+    }
+
+    Symbol symbol;
+    symbol.object = object;
+    symbol.section = section_kind_(section);
+    symbol.size = std::stoull(line.substr(tab + 1, size_end - tab - 1),
+                              nullptr, 16);
+    symbol.name = line.substr(size_end + 1);
+    for (const char* visibility : {".hidden ", ".protected ", ".internal "}) {
+      if (symbol.name.rfind(visibility, 0) == 0) {
+        symbol.name.erase(0, std::char_traits<char>::length(visibility));
+      }
+    }
+    // unique and weak symbols are emitted everywhere they're used
+    symbol.shared = flags[0] == 'u' || flags[1] == 'w';
+
+    // sections and files are 'd' and 'f', and aren't space of their own.
+    // DW.ref is the host's exception handling, which the AVR hasn't got.
+    if (symbol.section == 0 || symbol.size == 0 || flags[5] == 'd'
+        || flags[6] == 'f' || symbol.name.rfind("DW.ref.", 0) == 0) {
+      continue;
+    }
+    symbols_.push_back(symbol);
+    ++count;
+  }
+  return count;
+}
+
+bool Footprint::read_budgets(std::istream& in) {
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields {line};
+    std::vector<std::string> words;
+    for (std::string word; fields >> word;) {
+      words.push_back(word);
+    }
+    if (words.empty() || words[0][0] == '#') {
+      continue;
+    }
+
+    // the last two are the budget, the rest is the name
+    Budget budget;
+    if (words.size() < 3
+        || !parse_limit(words[words.size() - 2], budget.flash)
+        || !parse_limit(words.back(), budget.sram)) {
+      return false;
+    }
+    std::string name = words[0];
+    for (size_t i = 1; i < words.size() - 2; ++i) {
+      name += " " + words[i];
+    }
+    budgets_[name] = budget;
+  }
+  return true;
+}
+
+std::vector<Footprint::Module> Footprint::modules() const {
+  std::map<std::string, Module> by_name;
+  std::set<std::string> seen;
+
+  for (const Symbol& symbol : symbols_) {
+    if (symbol.shared && !seen.insert(symbol.name).second) {
+      continue;
+    }
+    std::string name = module_of_(symbol);
+    Module& module = by_name[name];
+    module.name = name;
+    switch (symbol.section) {
+      case 't':
+        module.text += symbol.size;
+        break;
+      case 'd':
+        module.data += symbol.size;
+        break;
+      default:
+        module.bss += symbol.size;
+        break;
+    }
+  }
+
+  std::vector<Module> modules;
+  for (auto& entry : by_name) {
+    modules.push_back(entry.second);
+  }
+  std::sort(modules.begin(), modules.end(),
+            [](const Module& a, const Module& b) {
+              if (a.sram() != b.sram()) {
+                return a.sram() > b.sram();
+              }
+              if (a.flash() != b.flash()) {
+                return a.flash() > b.flash();
+              }
+              return a.name < b.name;
+            });
+  return modules;
+}
+
+Footprint::Module Footprint::total() const {
+  Module total;
+  total.name = total_name;
+  for (const Module& module : modules()) {
+    total.text += module.text;
+    total.data += module.data;
+    total.bss += module.bss;
+  }
+  return total;
+}
+
+std::vector<Footprint::Overrun> Footprint::check() const {
+  std::vector<Module> all = modules();
+  all.push_back(total());
+
+  std::vector<Overrun> overruns;
+  for (auto& entry : budgets_) {
+    Module module;
+    module.name = entry.first;
+    for (const Module& m : all) {
+      if (m.name == entry.first) {
+        module = m;
+      }
+    }
+    if (module.flash() > entry.second.flash
+        || module.sram() > entry.second.sram) {
+      overruns.push_back({module, entry.second});
+    }
+  }
+  return overruns;
+}
+
+void Footprint::write(std::ostream& out) const {
+  std::vector<Module> all = modules();
+  all.push_back(total());
+
+  size_t width = 6;
+  for (const Module& module : all) {
+    width = std::max(width, module.name.size());
+  }
+
+  out << std::left << std::setw((int)width) << "module" << std::right
+      << std::setw(8) << "flash" << std::setw(8) << "sram"
+      << std::setw(8) << "text" << std::setw(8) << "data"
+      << std::setw(8) << "bss" << "  budget\n";
+  for (const Module& module : all) {
+    out << std::left << std::setw((int)width) << module.name << std::right
+        << std::setw(8) << module.flash() << std::setw(8) << module.sram()
+        << std::setw(8) << module.text << std::setw(8) << module.data
+        << std::setw(8) << module.bss;
+    auto budget = budgets_.find(module.name);
+    if (budget != budgets_.end()) {
+      out << "  " << limit(budget->second.flash) << " "
+          << limit(budget->second.sram);
+    }
+    out << "\n";
+  }
+}
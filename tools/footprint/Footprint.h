@@ -0,0 +1,122 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_FOOTPRINT_FOOTPRINT_H_
+#define A_TOOLCHAIN_TEST_TOOLS_FOOTPRINT_FOOTPRINT_H_
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ * Footprint - what each module of the firmware costs in flash and SRAM.
+ * Host only.
+ *
+ * Reads the symbol tables objdump -t -C prints for the firmware's objects (or
+ * archives of them), and adds up the symbols by module:
+ *
+ * - a template instantiation is a module of its own, Radar<Servo> say,
+ *   wherever it was compiled
+ * - anything else the compiler emits wherever it's used (inline functions and
+ *   variables) goes to its class or namespace
+ * - everything else goes to the source file it was compiled from
+ *
+ * Symbols emitted in several objects are only counted once, as the linker
+ * only keeps one. Nothing is dropped as unused though, so it's a little over
+ * what the linker would give.
+ *
+ * Sections count as on the AVR: .text and .progmem (PROGMEM) are flash only,
+ * .data and .rodata are in flash and copied into SRAM at start up, and .bss
+ * is SRAM only.
+ */
+class Footprint {
+ public:
+  struct Module {
+    std::string name;
+    uint64_t text {0};
+    uint64_t data {0};
+    uint64_t bss {0};
+
+    uint64_t flash() const { return text + data; }
+    uint64_t sram() const { return data + bss; }
+  };
+
+  /*
+   * Budget
+   *
+   * Most a module may take, or no_limit.
+   */
+  struct Budget {
+    static constexpr uint64_t no_limit {UINT64_MAX};
+    uint64_t flash {no_limit};
+    uint64_t sram {no_limit};
+  };
+
+  // a module over its budget
+  struct Overrun {
+    Module module;
+    Budget budget;
+  };
+
+  // the name budgets use for the whole firmware
+  static constexpr const char* total_name {"total"};
+
+ private:
+  struct Symbol {
+    std::string object;
+    std::string name;
+    char section;    // 't', 'd' or 'b'
+    uint64_t size;
+    bool shared;     // emitted wherever it's used
+  };
+
+  std::vector<Symbol> symbols_;
+  std::map<std::string, Budget> budgets_;
+
+  static char section_kind_(const std::string& section);
+  static std::string object_name_(const std::string& path);
+  static std::string module_of_(const Symbol& symbol);
+
+ public:
+  /*
+   * Read
+   *
+   * Add the symbols in objdump -t -C output.
+   *
+   * Returns:
+   * size_t - symbols read that take up space
+   */
+  size_t read(std::istream& in);
+
+  /*
+   * Read Budgets
+   *
+   * One module a line, its name then the most flash and SRAM it may take in
+   * bytes, - for no limit. Blank lines and lines starting # are skipped.
+   * Names can have spaces in, it's the last two fields that are the budget.
+   *
+   *    Radar<Servo>   400   -
+   *    total          32256 1536
+   *
+   * Returns:
+   * bool - false if a line couldn't be read
+   */
+  bool read_budgets(std::istream& in);
+
+  // each module, biggest SRAM first, then biggest flash
+  std::vector<Module> modules() const;
+
+  Module total() const;
+
+  // modules, and the total, over their budgets
+  std::vector<Overrun> check() const;
+
+  /*
+   * Write
+   *
+   * A table of the modules and their budgets, and the total.
+   */
+  void write(std::ostream& out) const;
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_FOOTPRINT_FOOTPRINT_H_
@@ -0,0 +1,111 @@
+/*
+ * footprint - what each module of the firmware takes of flash and SRAM
+ *
+ * Usage:
+ *
+ *    footprint [-d objdump] [-b budgets.txt] file ...
+ *
+ * Runs objdump -t -C (or the objdump given, avr-objdump for the real thing)
+ * over each object or archive file, and prints the flash and SRAM each module
+ * takes, see Footprint.h. With -b, checks each module against its budget in
+ * budgets.txt (see Footprint::read_budgets()), and exits 1 if any are over.
+ */
+
+#include <Footprint.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static void usage(const char* name) {
+  std::cerr << "usage: " << name
+            << " [-d objdump] [-b budgets.txt] file ...\n";
+}
+
+// quoted for the shell
+static std::string quote(const char* s) {
+  std::string quoted {"'"};
+  for (; *s != '\0'; ++s) {
+    quoted += (*s == '\'') ? std::string {"'\\''"} : std::string {*s};
+  }
+  return quoted + "'";
+}
+
+int main(int argc, char* argv[]) {
+  const char* objdump = "objdump";
+  const char* budgets_path = nullptr;
+  int first_file = argc;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+
+    if (std::strcmp(argv[i], "-d") == 0 && has_value) {
+      objdump = argv[++i];
+    } else if (std::strcmp(argv[i], "-b") == 0 && has_value) {
+      budgets_path = argv[++i];
+    } else if (argv[i][0] == '-') {
+      usage(argv[0]);
+      return 2;
+    } else {
+      first_file = i;
+      break;
+    }
+  }
+  if (first_file == argc) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  Footprint footprint;
+  if (budgets_path != nullptr) {
+    std::ifstream in {budgets_path};
+    if (!in || !footprint.read_budgets(in)) {
+      std::cerr << argv[0] << ": can't read budgets " << budgets_path << "\n";
+      return 1;
+    }
+  }
+
+  std::string command = quote(objdump) + " -t -C";
+  for (int i = first_file; i < argc; ++i) {
+    command += " " + quote(argv[i]);
+  }
+  FILE* pipe = popen(command.c_str(), "r");
+  if (pipe == nullptr) {
+    std::cerr << argv[0] << ": can't run " << objdump << "\n";
+    return 1;
+  }
+  std::stringstream symbols;
+  char buffer[4096];
+  for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), pipe)) != 0;) {
+    symbols.write(buffer, (std::streamsize)n);
+  }
+  if (pclose(pipe) != 0) {
+    std::cerr << argv[0] << ": " << objdump << " failed\n";
+    return 1;
+  }
+  footprint.read(symbols);
+
+  footprint.write(std::cout);
+
+  auto overruns = footprint.check();
+  for (auto& over : overruns) {
+    std::cerr << argv[0] << ": " << over.module.name << " is over budget, "
+              << over.module.flash() << " bytes of flash and "
+              << over.module.sram() << " of SRAM, for ";
+    if (over.budget.flash != Footprint::Budget::no_limit) {
+      std::cerr << over.budget.flash;
+    } else {
+      std::cerr << "any";
+    }
+    std::cerr << " and ";
+    if (over.budget.sram != Footprint::Budget::no_limit) {
+      std::cerr << over.budget.sram;
+    } else {
+      std::cerr << "any";
+    }
+    std::cerr << "\n";
+  }
+  return overruns.empty() ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_FOOTPRINT_SHIM_AVR_PGMSPACE_H_
+#define A_TOOLCHAIN_TEST_TOOLS_FOOTPRINT_SHIM_AVR_PGMSPACE_H_
+
+// As the simulator's, but PROGMEM goes in a section of its own, named as the
+// AVR's is, so footprint counts it as flash rather than SRAM
+
+#include <cstdint>
+#include <cstring>
+
+#define PROGMEM __attribute__((section(".progmem.data")))
+#define memcpy_P memcpy
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_FOOTPRINT_SHIM_AVR_PGMSPACE_H_
@@ -0,0 +1,201 @@
+#include <OccupancyGrid.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+// GCC/Clang vector extensions. The compiler maps these onto whatever SIMD the
+// host has (SSE2, AVX2, NEON), or plain scalar code if there is none, so we
+// don't need a separate code path per instruction set.
+typedef float   v8f __attribute__((vector_size(32)));
+typedef int32_t v8i __attribute__((vector_size(32)));
+
+const float pi {3.14159265358979f};
+
+} // namespace
+
+OccupancyGrid::OccupancyGrid() : OccupancyGrid(Params()) {}
+
+OccupancyGrid::OccupancyGrid(const Params& params) : params_{params} {
+  // rounded up, without max_range_mm + cell_mm - 1 wrapping
+  uint32_t cells_range = params_.max_range_mm / params_.cell_mm
+      + (params_.max_range_mm % params_.cell_mm != 0);
+
+  width_ = 2 * cells_range + 1;
+  height_ = cells_range + 1;
+
+  // round up to whole tiles
+  tiles_x_ = (width_ + tile_mask) >> tile_shift;
+  uint32_t tiles_y = (height_ + tile_mask) >> tile_shift;
+
+  cells_.assign((size_t)tiles_x_ * tiles_y * tile_size * tile_size, 0);
+}
+
+void OccupancyGrid::clear() {
+  cells_.assign(cells_.size(), 0);
+  rays_ = 0;
+}
+
+/*
+ * Add Ray
+ *
+ * Positions are worked out in cells, with the radar at the centre of the
+ * middle cell on the bottom row. The ray is walked one cell at a time along
+ * whichever axis it moves furthest in, so every step lands in a new cell and
+ * no cell is marked free twice by the same ray. The step along that axis is
+ * always 1, so the walk never reaches the cell the ray ends in.
+ */
+bool OccupancyGrid::add_ray(float angle, uint32_t range_mm) {
+  if (range_mm > params_.max_range_mm || !(angle >= 0 && angle <= 180)) {
+    return false;
+  }
+
+  float radians = angle * pi / 180;
+  float range = (float)range_mm / params_.cell_mm;
+
+  float origin_x = (float)(width_ >> 1) + 0.5f;
+  float origin_y = 0.5f;
+
+  float dx = range * std::cos(radians);
+  float dy = range * std::sin(radians);
+
+  auto end_x = (uint32_t)(origin_x + dx);
+  auto end_y = (uint32_t)(origin_y + dy);
+
+  float length = std::fmax(std::fabs(dx), std::fabs(dy));
+  auto steps = (uint32_t)length;
+
+  if (steps != 0) {
+    march_free_(origin_x, origin_y, dx / length, dy / length, steps);
+  }
+
+  int16_t& cell = cells_[index_(end_x, end_y)];
+  int32_t value = cell + params_.hit;
+  cell = (value > params_.max) ? params_.max : (int16_t)value;
+
+  ++rays_;
+  return true;
+}
+
+/*
+ * March Free
+ *
+ * Mark n cells free, starting at (x, y) and moving (step_x, step_y) each
+ * time. Eight steps are done at once: positions and tile indexes are worked
+ * out as vectors, then the cells are updated one by one as there's no scatter
+ * store to do that part in one go.
+ */
+void OccupancyGrid::march_free_(float x, float y, float step_x, float step_y,
+                                uint32_t n) {
+
+  const v8f lanes {0, 1, 2, 3, 4, 5, 6, 7};
+  const auto tiles_x = (int32_t)tiles_x_;
+  const int16_t miss = params_.miss;
+  const int16_t min = params_.min;
+  int16_t* cells = cells_.data();
+
+  for (uint32_t i = 0; i < n; i += 8) {
+    v8f k = lanes + (float)i;
+
+    // positions are never negative, so truncating is the same as floor()
+    v8i cx = __builtin_convertvector(x + k * step_x, v8i);
+    v8i cy = __builtin_convertvector(y + k * step_y, v8i);
+
+    v8i tile = (cy >> tile_shift) * tiles_x + (cx >> tile_shift);
+    v8i index = (tile << (2 * tile_shift)) + ((cy & tile_mask) << tile_shift)
+        + (cx & tile_mask);
+
+    uint32_t count = (n - i < 8) ? n - i : 8;
+    for (uint32_t lane = 0; lane < count; ++lane) {
+      int16_t& cell = cells[index[lane]];
+      int32_t value = cell + miss;
+      cell = (value < min) ? min : (int16_t)value;
+    }
+  }
+}
+
+int16_t OccupancyGrid::at(uint32_t x, uint32_t y) const {
+  return cells_[index_(x, y)];
+}
+
+bool OccupancyGrid::cell_of(float x_mm, float y_mm,
+                            uint32_t& x, uint32_t& y) const {
+  float cx = (float)(width_ >> 1) + 0.5f + x_mm / params_.cell_mm;
+  float cy = 0.5f + y_mm / params_.cell_mm;
+
+  if (cx < 0 || cy < 0 || cx >= width_ || cy >= height_) {
+    return false;
+  }
+
+  x = (uint32_t)cx;
+  y = (uint32_t)cy;
+  return true;
+}
+
+/*
+ * Write PGM
+ *
+ * Log-odds are turned into a probability with the logistic function. There
+ * are only max - min possible values, so these are worked out once up front
+ * rather than once per cell.
+ */
+void OccupancyGrid::write_pgm(std::ostream& out) const {
+  std::vector<uint8_t> shade(params_.max - params_.min + 1);
+  for (int32_t l = params_.min; l <= params_.max; ++l) {
+    double p = 1.0 / (1.0 + std::exp(-l / 32.0));
+    shade[l - params_.min] = (uint8_t)std::lround(255 * (1.0 - p));
+  }
+
+  out << "P5\n" << width_ << " " << height_ << "\n255\n";
+
+  std::vector<uint8_t> row(width_);
+  for (uint32_t y = height_; y-- > 0;) { // top of the image is furthest away
+    for (uint32_t x = 0; x < width_; ++x) {
+      row[x] = shade[at(x, y) - params_.min];
+    }
+    out.write(reinterpret_cast<const char*>(row.data()), width_);
+  }
+}
+
+/*
+ * Ingest
+ *
+ * strtod() rather than stream extraction, as it is several times
+ * faster and makes it easy to skip lines that aren't samples.
+ */
+uint64_t ingest(std::istream& in, OccupancyGrid& grid) {
+  uint64_t samples = 0;
+  std::string line;
+
+  while (std::getline(in, line)) {
+    const char* p = line.c_str();
+    char* end = nullptr;
+    double fields[3];
+    uint8_t i = 0;
+
+    for (; i < 3; ++i) {
+      while (*p == ',' || *p == ' ' || *p == '\t') {
+        ++p;
+      }
+      fields[i] = std::strtod(p, &end);
+      if (end == p || !std::isfinite(fields[i])) {
+        break; // not a number, or nan or inf
+      }
+      p = end;
+    }
+
+    // casting a range uint32_t can't hold would be undefined
+    if (i < 3 || fields[2] < 0 || fields[2] > UINT32_MAX) {
+      continue;
+    }
+
+    // no echo is sent as UINT32_MAX, which is > max range, so gets ignored
+    auto range = (uint32_t)fields[2];
+    grid.add_ray((float)fields[1], range);
+    ++samples;
+  }
+
+  return samples;
+}
@@ -0,0 +1,121 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_OCCUPANCY_OCCUPANCYGRID_H_
+#define A_TOOLCHAIN_TEST_TOOLS_OCCUPANCY_OCCUPANCYGRID_H_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/*
+ * OccupancyGrid - 2D map built from radar sweeps. Host only.
+ *
+ * The radar sits at the middle of the bottom edge of the grid, looking up.
+ * Servo angle 0° points right, 90° straight ahead and 180° left. Each sample
+ * is a ray from the radar: every cell the ray passes through is more likely
+ * free and the cell it ends in is more likely occupied.
+ *
+ * Cells hold log-odds in fixed point, so an update is a saturating add rather
+ * than a multiply. They are stored in 8x8 tiles (128 bytes, two cache lines)
+ * rather than row by row, so a ray at any angle touches far fewer cache lines
+ * than it would crossing a row-major grid.
+ */
+class OccupancyGrid {
+ public:
+  /*
+   * Params
+   *
+   * cell_mm - size of one cell in mm
+   * max_range_mm - longest ray used. Sets the size of the grid.
+   * hit - log-odds added to the cell a ray ends in
+   * miss - log-odds added to each cell a ray passes through
+   * min, max - log-odds saturate at these values
+   *
+   * Log-odds are in units of 1/32, so hit = 28 is +0.875.
+   */
+  struct Params {
+    uint16_t  cell_mm {20};
+    uint32_t  max_range_mm {4000};
+    int16_t   hit {28};
+    int16_t   miss {-12};
+    int16_t   min {-256};
+    int16_t   max {256};
+  };
+
+  static constexpr uint8_t tile_shift {3};  // tiles are 8x8 cells
+  static constexpr uint8_t tile_size {1 << tile_shift};
+  static constexpr uint8_t tile_mask {tile_size - 1};
+
+ private:
+  Params    params_;
+  uint32_t  width_;         // cells
+  uint32_t  height_;        // cells
+  uint32_t  tiles_x_;       // tiles across one row of tiles
+  uint64_t  rays_ {0};      // rays added so far
+
+  std::vector<int16_t> cells_;
+
+  inline uint32_t index_(uint32_t x, uint32_t y) const {
+    uint32_t tile = (y >> tile_shift) * tiles_x_ + (x >> tile_shift);
+    return (tile << (2 * tile_shift)) + ((y & tile_mask) << tile_shift)
+        + (x & tile_mask);
+  };
+
+  void march_free_(float x, float y, float step_x, float step_y, uint32_t n);
+
+ public:
+  OccupancyGrid();
+  explicit OccupancyGrid(const Params& params);
+
+  /*
+   * Add Ray
+   *
+   * float angle - servo angle in degrees, 0 to 180
+   * uint32_t range_mm - distance measured. Rays with no echo (UINT32_MAX) or
+   *                     further than max_range_mm are ignored.
+   *
+   * Returns:
+   * bool - true if the ray was used
+   */
+  bool add_ray(float angle, uint32_t range_mm);
+
+  // log-odds of a cell, x across and y up from the radar
+  int16_t at(uint32_t x, uint32_t y) const;
+
+  // cell containing a point in mm, relative to the radar
+  bool cell_of(float x_mm, float y_mm, uint32_t& x, uint32_t& y) const;
+
+  inline uint32_t width() const { return width_; };
+  inline uint32_t height() const { return height_; };
+  inline uint64_t rays() const { return rays_; };
+  inline const Params& params() const { return params_; };
+
+  void clear();
+
+  /*
+   * Write PGM
+   *
+   * Write the grid as a binary (P5) greyscale image. Free cells are white,
+   * occupied cells black and unknown cells mid grey. The radar is at the
+   * bottom of the image.
+   */
+  void write_pgm(std::ostream& out) const;
+};
+
+/*
+ * Ingest
+ *
+ * Read a sweep stream and add every sample in it to the grid. The stream is
+ * text, one sample per line:
+ *
+ *    time_ms,angle,range_mm[,anything else]
+ *
+ * Fields may be separated by commas or whitespace. Lines that don't start
+ * with three numbers (headers, comments) are skipped, as are lines with a
+ * nan or inf in them, or a range that isn't a uint32_t.
+ *
+ * Returns:
+ * uint64_t - number of samples read
+ */
+uint64_t ingest(std::istream& in, OccupancyGrid& grid);
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_OCCUPANCY_OCCUPANCYGRID_H_
@@ -0,0 +1,124 @@
+/*
+ * occupancy_grid - build an occupancy grid from recorded radar sweeps
+ *
+ * Usage:
+ *
+ *    occupancy_grid [-c cell_mm] [-r max_range_mm] [-o out.pgm] [file ...]
+ *
+ * Reads each file in turn (or stdin if none are given) as a sweep stream, see
+ * ingest() in OccupancyGrid.h for the format, and writes the grid as a PGM
+ * image to out.pgm, or stdout. cell_mm is 1 to 65535 and max_range_mm at
+ * least 1, with no more than max_cells cells from the radar to max_range_mm.
+ */
+
+#include <OccupancyGrid.h>
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static void usage(const char* name) {
+  std::cerr << "usage: " << name
+            << " [-c cell_mm] [-r max_range_mm] [-o out.pgm] [file ...]\n";
+}
+
+// a 16385x8193 grid at most, 256MB
+static const uint32_t max_cells {8192};
+
+// a whole number from min to max, with nothing after it
+static bool parse(const char* text, uint32_t min, uint32_t max,
+                  uint32_t& value) {
+  if (!std::isdigit((unsigned char)text[0])) {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  unsigned long n = std::strtoul(text, &end, 10);
+  if (*end != '\0' || errno == ERANGE || n < min || n > max) {
+    return false;
+  }
+  value = (uint32_t)n;
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  OccupancyGrid::Params params;
+  const char* out_path = nullptr;
+  int first_file = argc;
+
+  uint32_t cell_mm = params.cell_mm;
+  uint32_t max_range_mm = params.max_range_mm;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+
+    if (std::strcmp(argv[i], "-c") == 0 && has_value) {
+      if (!parse(argv[++i], 1, UINT16_MAX, cell_mm)) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (std::strcmp(argv[i], "-r") == 0 && has_value) {
+      if (!parse(argv[++i], 1, UINT32_MAX, max_range_mm)) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (std::strcmp(argv[i], "-o") == 0 && has_value) {
+      out_path = argv[++i];
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      usage(argv[0]);
+      return 2;
+    } else {
+      first_file = i;
+      break;
+    }
+  }
+
+  // either on its own is fine, but not a long range in small cells
+  if (max_range_mm / cell_mm + (max_range_mm % cell_mm != 0) > max_cells) {
+    std::cerr << argv[0] << ": over " << max_cells << " cells to "
+              << max_range_mm << " mm, make them bigger\n";
+    usage(argv[0]);
+    return 2;
+  }
+  params.cell_mm = (uint16_t)cell_mm;
+  params.max_range_mm = max_range_mm;
+
+  OccupancyGrid grid {params};
+  uint64_t samples = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  if (first_file == argc) {
+    samples += ingest(std::cin, grid);
+  }
+  for (int i = first_file; i < argc; ++i) {
+    std::ifstream in {argv[i]};
+    if (!in) {
+      std::cerr << argv[0] << ": can't open " << argv[i] << "\n";
+      return 1;
+    }
+    samples += ingest(in, grid);
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (out_path != nullptr) {
+    std::ofstream out {out_path, std::ios::binary};
+    if (!out) {
+      std::cerr << argv[0] << ": can't write " << out_path << "\n";
+      return 1;
+    }
+    grid.write_pgm(out);
+  } else {
+    grid.write_pgm(std::cout);
+  }
+
+  std::cerr << samples << " samples, " << grid.rays() << " rays used, "
+            << grid.width() << "x" << grid.height() << " cells, "
+            << elapsed.count() << " s\n";
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include <HCSR04Model.h>
+#include <SimArduino.h>
+#include <Arduino.h>
+
+#include <cmath>
+
+HCSR04Model::HCSR04Model(const Scene& scene, const ServoModel& servo,
+                         const Params& params)
+    : scene_(scene),
+      servo_(servo),
+      params_(params),
+      random_(params.seed),
+      noise_(0, params.noise_mm) {
+  SimArduino::watch([this](SimArduino::Output what, uint8_t pin,
+                           uint16_t value) {
+    if (what == SimArduino::Output::DIGITAL && pin == params_.trigger_pin) {
+      trigger_((uint8_t)value);
+    }
+  });
+}
+
+void HCSR04Model::trigger_(uint8_t level) {
+  uint64_t now = SimArduino::now();
+  if (level) {
+    trigger_time_ = now;
+    return;
+  }
+  if (busy_ || now - trigger_time_ < params_.min_trigger_us) {
+    return;
+  }
+
+  ++pings_;
+  float range = measure_(now);
+  last_range_ = range;
+  uint64_t width = params_.no_echo_us;
+  if (range >= 0) {
+    ++echoes_;
+    width = (uint64_t)std::lround(2 * range / params_.speed_mm_us);
+  }
+
+  busy_ = true;
+  uint8_t echo_pin = params_.echo_pin;
+  uint64_t start = now + params_.burst_us;
+  SimArduino::at(start, [echo_pin]() {
+    SimArduino::drive(echo_pin, HIGH);
+  });
+  SimArduino::at(start + width, [this, echo_pin]() {
+    SimArduino::drive(echo_pin, LOW);
+    busy_ = false;
+  });
+}
+
+// the range the sensor comes up with for a ping at time, or negative
+float HCSR04Model::measure_(uint64_t time) {
+  float range = scene_.range(servo_.angle_at(time), params_.half_beam_deg,
+                             params_.max_range_mm, time / 1e6);
+  if (range < 0 || chance_(random_) < params_.dropout) {
+    return -1;
+  }
+  if (chance_(random_) < params_.multipath) {
+    range *= 2;
+  }
+  range += noise_(random_);
+  if (range > params_.max_range_mm) {
+    return -1;
+  }
+  return (range < 0) ? 0 : range;
+}
@@ -0,0 +1,77 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_HCSR04MODEL_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_HCSR04MODEL_H_
+
+#include <Scene.h>
+#include <ServoModel.h>
+
+#include <cstdint>
+#include <random>
+
+/*
+ * HCSR04Model - the simulated ultrasonic sensor
+ *
+ * Watches the trigger pin, and when a long enough trigger pulse ends, looks
+ * into scene along wherever servo has the sensor pointing and drives the echo
+ * pin high for the round trip, as the real sensor does. The echo then reaches
+ * the firmware through whatever it attached to the echo pin, EchoISR::
+ * echo_isr() in our case.
+ *
+ * The real thing doesn't always get it right, so neither does this:
+ *
+ *  - noise_mm - standard deviation of the range measured
+ *  - dropout - chance an echo is missed altogether
+ *  - multipath - chance the echo comes back off a second surface, at about
+ *                twice the range
+ *
+ * With no echo the pin stays high for no_echo_us, and triggers while the echo
+ * pin is high are ignored. Random numbers come from seed, so a run can be
+ * repeated.
+ *
+ * As with ServoModel, make it after SimArduino::reset().
+ */
+class HCSR04Model {
+ public:
+  struct Params {
+    uint8_t   trigger_pin {4};
+    uint8_t   echo_pin {2};
+    uint16_t  min_trigger_us {10};
+    uint16_t  burst_us {460};       // trigger ending to echo starting
+    uint16_t  no_echo_us {38000};
+    float     speed_mm_us {0.343f}; // of sound, at 20°C
+    float     max_range_mm {4000};
+    float     half_beam_deg {15};
+    float     noise_mm {3};
+    float     dropout {0.02f};
+    float     multipath {0.01f};
+    uint32_t  seed {1};
+  };
+
+  HCSR04Model(const Scene& scene, const ServoModel& servo,
+              const Params& params);
+
+  uint64_t pings() const { return pings_; }
+  uint64_t echoes() const { return echoes_; }  // pings that found something
+
+  // what the last ping measured, before rounding to µs, or negative if no
+  // echo came back
+  float last_range() const { return last_range_; }
+
+ private:
+  const Scene&        scene_;
+  const ServoModel&   servo_;
+  Params              params_;
+  std::mt19937        random_;
+  std::uniform_real_distribution<float> chance_ {0, 1};
+  std::normal_distribution<float>       noise_;
+
+  uint64_t  trigger_time_ {0};  // when the trigger went high
+  bool      busy_ {false};      // echo pin high
+  uint64_t  pings_ {0};
+  uint64_t  echoes_ {0};
+  float     last_range_ {-1};
+
+  void trigger_(uint8_t level);
+  float measure_(uint64_t time);
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_HCSR04MODEL_H_
@@ -0,0 +1,230 @@
+#include <MonteCarlo.h>
+#include <ServoModel.h>
+#include <SimArduino.h>
+#include <SimFirmware.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace MonteCarlo {
+
+namespace {
+
+constexpr float pi {3.14159265f};
+constexpr float intruder_radius_mm {150};
+constexpr float approach_mm {3500};     // where the intruder starts from
+
+// nearest anything in front of the radar, where the sweep can see
+float nearest(const Scene& scene, double time_s) {
+  return scene.range(90, 90, 1e9f, time_s);
+}
+
+// was anything really closer than yellow, give or take, at some point in the
+// second up to time_ms
+bool really_in_range(const Scene& scene, uint32_t time_ms, uint32_t yellow) {
+  float limit = yellow + tolerance_mm;
+  for (int32_t back = 0; back <= 1000; back += 100) {
+    double t = ((int32_t)time_ms - back) / 1000.0;
+    float range = nearest(scene, t < 0 ? 0 : t);
+    if (range >= 0 && range < limit) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// the defaults, with settings set over them in order, on this thread
+void apply_settings(const std::vector<Setting>& settings) {
+  Settings::defaults();
+  for (auto& setting : settings) {
+    Settings::set(setting.id, setting.value);
+  }
+}
+
+} // namespace
+
+bool Outcome::operator==(const Outcome& other) const {
+  return seed == other.seed && intruder == other.intruder
+      && entered == other.entered && detected == other.detected
+      && latency_ms == other.latency_ms && decisions == other.decisions
+      && false_alarms == other.false_alarms && device_s == other.device_s;
+}
+
+Scenario make_scenario(uint64_t seed, const Ranges& ranges) {
+  std::mt19937_64 random {seed};
+  auto uniform = [&](float low, float high) {
+    return std::uniform_real_distribution<float> {low, high}(random);
+  };
+
+  Scenario s;
+  s.seed = seed;
+  s.duration_s = ranges.duration_s;
+  s.intruder = uniform(0, 1) < ranges.intruder_chance;
+  uint32_t duration_ms = s.duration_s * 1000;
+
+  s.sensor.trigger_pin = CFG::trigger_pin;
+  s.sensor.echo_pin = CFG::echo_pin;
+  s.sensor.noise_mm = uniform(ranges.noise_min_mm, ranges.noise_max_mm);
+  s.sensor.dropout = uniform(0, ranges.dropout_max);
+  s.sensor.multipath = uniform(0, ranges.multipath_max);
+  s.sensor.seed = (uint32_t)random();
+
+  int clutter = (int)uniform(0, ranges.clutter_max + 1.0f);
+  for (int i = 0; i < clutter; ++i) {
+    s.scene.add(uniform(0, 180),
+                uniform(ranges.clutter_min_mm, ranges.clutter_max_mm),
+                uniform(50, 300));
+  }
+
+  if (s.intruder) {
+    // a straight walk past, closest at bearing, from approach_mm back along
+    // the line, starting a random time in
+    float bearing = uniform(30, 150) * pi / 180;
+    float closest = uniform(ranges.closest_min_mm, ranges.closest_max_mm);
+    float speed = uniform(ranges.speed_min_mm_s, ranges.speed_max_mm_s);
+    float side = (uniform(0, 1) < 0.5f) ? 1 : -1;
+    float start_s = uniform(0, s.duration_s / 2.0f);
+
+    float ux = -std::sin(bearing) * side, uy = std::cos(bearing) * side;
+    float cx = closest * std::cos(bearing), cy = closest * std::sin(bearing);
+    // where it is at time 0, so it's approach_mm back at start_s
+    float back = approach_mm + speed * start_s;
+    float x0 = cx - ux * back, y0 = cy - uy * back;
+    s.scene.add(std::atan2(y0, x0) * 180 / pi, std::hypot(x0, y0),
+                intruder_radius_mm, ux * speed, uy * speed);
+
+    // the PIR sees it while it's within pir_range_mm
+    float half = 0;
+    if (ranges.pir_range_mm > closest) {
+      half = std::sqrt(ranges.pir_range_mm * ranges.pir_range_mm
+                           - closest * closest) / speed;
+    }
+    float at_closest = start_s + approach_mm / speed;
+    s.pir_from_ms = (uint32_t)std::max(0.0f, (at_closest - half) * 1000);
+    s.pir_to_ms = (uint32_t)std::min((float)duration_ms,
+                                     (at_closest + half) * 1000);
+  } else {
+    // the cat
+    s.pir_from_ms = (uint32_t)uniform(0, duration_ms * 0.8f);
+    s.pir_to_ms = s.pir_from_ms + (uint32_t)uniform(500, 3000);
+  }
+  return s;
+}
+
+Outcome run(const Scenario& scenario) {
+  using SA = SimArduino;
+
+  SA::reset();
+  // saved, then carried over a reset so the writes don't take device time,
+  // for setup() to load
+  if (!scenario.settings.empty()) {
+    apply_settings(scenario.settings);
+    Settings::save();
+    uint8_t eeprom[ArduinoInterface::eeprom_size];
+    std::memcpy(eeprom, SA::eeprom(), sizeof(eeprom));
+    SA::reset();
+    std::memcpy(SA::eeprom(), eeprom, sizeof(eeprom));
+  }
+  ServoModel servo {{CFG::servo_pin}};
+  HCSR04Model sensor {scenario.scene, servo, scenario.sensor};
+  if (scenario.pir_to_ms > scenario.pir_from_ms) {
+    SA::at(scenario.pir_from_ms * 1000ULL,
+           []() { SA::drive(CFG::ir_pin, HIGH); });
+    SA::at(scenario.pir_to_ms * 1000ULL,
+           []() { SA::drive(CFG::ir_pin, LOW); });
+  }
+
+  Outcome outcome {scenario.seed, scenario.intruder, false, false, 0, 0, 0,
+                   0};
+  uint64_t entered_ms = 0;
+
+  setup();
+  uint32_t yellow = Settings::get(Settings::Id::DISTANCE_YELLOW);
+  RadarStateId last_state = context->get_state();
+  uint32_t last_timer = context->get_timer();
+  uint64_t end = scenario.duration_s * 1000000ULL;
+
+  while (SA::now() < end) {
+    loop();
+
+    uint64_t now_ms = SA::now() / 1000;
+    if (scenario.intruder && !outcome.entered) {
+      float range = nearest(scenario.scene, now_ms / 1000.0);
+      if (range >= 0 && range < yellow) {
+        outcome.entered = true;
+        entered_ms = now_ms;
+      }
+    }
+
+    RadarStateId state = context->get_state();
+    uint32_t timer = context->get_timer();
+    // entering SENSING sets the timer too, but that's the PIR's doing
+    if (timer != last_timer && state != RadarStateId::STANDBY
+        && last_state != RadarStateId::STANDBY) {
+      ++outcome.decisions;
+      if (!really_in_range(scenario.scene, timer, yellow)) {
+        ++outcome.false_alarms;
+      } else if (outcome.entered && !outcome.detected) {
+        outcome.detected = true;
+        outcome.latency_ms = (timer > entered_ms)
+                             ? (uint32_t)(timer - entered_ms) : 0;
+      }
+    }
+    last_state = state;
+    last_timer = timer;
+  }
+  outcome.device_s = SA::now() / 1e6;
+
+  heap_delete(context);
+  context = nullptr;
+  return outcome;
+}
+
+void Summary::add(const Outcome& outcome) {
+  ++runs_;
+  intruders_ += outcome.intruder;
+  entered_ += outcome.entered;
+  decisions_ += outcome.decisions;
+  false_alarms_ += outcome.false_alarms;
+  alarmed_runs_ += outcome.false_alarms != 0;
+  device_s_ += outcome.device_s;
+  if (outcome.detected) {
+    ++detected_;
+    latencies_.push_back(outcome.latency_ms);
+  }
+}
+
+uint32_t Summary::latency_percentile(double fraction) const {
+  if (latencies_.empty()) {
+    return 0;
+  }
+  std::sort(latencies_.begin(), latencies_.end());
+  size_t i = (size_t)(fraction * (latencies_.size() - 1) + 0.5);
+  return latencies_[std::min(i, latencies_.size() - 1)];
+}
+
+void Summary::print(std::ostream& out) const {
+  double mean = 0;
+  for (auto latency : latencies_) {
+    mean += latency;
+  }
+  if (!latencies_.empty()) {
+    mean /= latencies_.size();
+  }
+  double hours = device_s_ / 3600;
+
+  out << runs_ << " runs, " << hours << " h of device time\n"
+      << intruders_ << " intruders, " << entered_ << " came in range, "
+      << detected_ << " detected, " << missed() << " missed\n"
+      << "latency ms: mean " << mean << ", p50 " << latency_percentile(0.5)
+      << ", p90 " << latency_percentile(0.9) << ", p99 "
+      << latency_percentile(0.99) << ", max " << latency_percentile(1)
+      << "\n"
+      << decisions_ << " in range decisions, " << false_alarms_
+      << " false alarms in " << alarmed_runs_ << " runs ("
+      << (hours > 0 ? false_alarms_ / hours : 0) << " an hour)\n";
+}
+
+} // namespace MonteCarlo
@@ -0,0 +1,124 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_MONTECARLO_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_MONTECARLO_H_
+
+#include <HCSR04Model.h>
+#include <Scene.h>
+#include <Settings.h>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+ * MonteCarlo - the whole firmware against randomised scenarios
+ *
+ * A scenario is a room drawn from a seed: maybe an intruder walking past on
+ * a straight line, some furniture further off, a sensor with its own noise,
+ * dropout and multipath, and the PIR tripped while the intruder is near (or
+ * by the cat, in an empty room). run() plays one through setup() and loop()
+ * on the simulator and scores what the firmware decided.
+ *
+ * A scenario can run with settings other than the defaults, for tuning the
+ * distances, standby_timeout and the command periods. run() saves them to
+ * the simulator's EEPROM, so setup() loads them as the device would.
+ *
+ * A decision is the firmware setting its timer from a ping while sensing,
+ * i.e. deciding something is closer than the distance_yellow setting it ran
+ * with. It's a false alarm if nothing really was, give or take tolerance_mm,
+ * during the second before. Detection latency is from the intruder first
+ * coming that close to the first decision after.
+ *
+ * Everything run() touches is per thread, so scenarios can be run in
+ * parallel (see WorkStealingPool).
+ */
+namespace MonteCarlo {
+
+// what scenarios are drawn from
+struct Ranges {
+  uint32_t  duration_s {120};
+  float     intruder_chance {0.7f};
+  float     closest_min_mm {100};   // intruder's closest approach
+  float     closest_max_mm {800};
+  float     speed_min_mm_s {150};
+  float     speed_max_mm_s {1200};
+  float     noise_min_mm {1};
+  float     noise_max_mm {30};
+  float     dropout_max {0.1f};
+  float     multipath_max {0.05f};
+  uint8_t   clutter_max {3};        // furniture, not moving
+  float     clutter_min_mm {650};
+  float     clutter_max_mm {3000};
+  float     pir_range_mm {3000};
+};
+
+// a setting to run with in place of its default
+struct Setting {
+  Settings::Id  id;
+  uint32_t      value;
+};
+
+struct Scenario {
+  uint64_t            seed {0};
+  bool                intruder {false};
+  Scene               scene;
+  HCSR04Model::Params sensor;
+  uint32_t            duration_s {120};
+  uint32_t            pir_from_ms {0};  // PIR output high from
+  uint32_t            pir_to_ms {0};    // and low again
+  std::vector<Setting> settings;        // set in this order
+};
+
+struct Outcome {
+  uint64_t  seed;
+  bool      intruder;
+  bool      entered;        // the intruder came in range
+  bool      detected;       // and the firmware decided so
+  uint32_t  latency_ms;
+  uint32_t  decisions;
+  uint32_t  false_alarms;
+  double    device_s;
+
+  bool operator==(const Outcome& other) const;
+};
+
+constexpr float tolerance_mm {100};
+
+Scenario make_scenario(uint64_t seed, const Ranges& ranges = {});
+
+// a setting that's out of range, with those before it set, is left as it
+// was. Check them with Settings::set() first.
+Outcome run(const Scenario& scenario);
+
+/*
+ * Summary
+ *
+ * Detection and false alarm statistics over a batch of outcomes.
+ */
+class Summary {
+ public:
+  void add(const Outcome& outcome);
+  void print(std::ostream& out) const;
+
+  uint64_t runs() const { return runs_; }
+  uint64_t detected() const { return detected_; }
+  uint64_t missed() const { return entered_ - detected_; }
+  uint64_t false_alarms() const { return false_alarms_; }
+
+  // latency in ms at fraction (0 to 1) of the way through those detected
+  uint32_t latency_percentile(double fraction) const;
+
+ private:
+  uint64_t runs_ {0};
+  uint64_t intruders_ {0};
+  uint64_t entered_ {0};
+  uint64_t detected_ {0};
+  uint64_t decisions_ {0};
+  uint64_t false_alarms_ {0};
+  uint64_t alarmed_runs_ {0};   // runs with at least one false alarm
+  double device_s_ {0};
+  mutable std::vector<uint32_t> latencies_;
+};
+
+} // namespace MonteCarlo
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_MONTECARLO_H_
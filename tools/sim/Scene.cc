@@ -0,0 +1,77 @@
+#include <Scene.h>
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+namespace {
+
+constexpr float deg_to_rad {3.14159265f / 180};
+
+} // namespace
+
+void Scene::add(float angle_deg, float range_mm, float radius_mm, float vx,
+                float vy) {
+  float a = angle_deg * deg_to_rad;
+  targets_.push_back({range_mm * std::cos(a), range_mm * std::sin(a),
+                      radius_mm, vx, vy});
+}
+
+bool Scene::parse(std::istream& in) {
+  std::string line;
+  while (std::getline(in, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields {line};
+
+    float angle, range;
+    if (!(fields >> angle)) {
+      if (line.find_first_not_of(" \t\r") != std::string::npos) {
+        return false;
+      }
+      continue;
+    }
+    if (!(fields >> range)) {
+      return false;
+    }
+    float radius = 50, vx = 0, vy = 0;
+    if (fields >> radius) {
+      if ((fields >> vx) && !(fields >> vy)) {
+        return false;
+      }
+    }
+    add(angle, range, radius, vx, vy);
+  }
+  return true;
+}
+
+/*
+ * Range
+ *
+ * A target is in the beam if any of it is: its centre within half_beam_deg
+ * plus the angle its radius takes up. The range is to the near side of the
+ * disc, which is where the first echo comes from.
+ */
+float Scene::range(float bearing_deg, float half_beam_deg, float max_range_mm,
+                   double time_s) const {
+  float nearest = -1;
+  float bearing = bearing_deg * deg_to_rad;
+  float half_beam = half_beam_deg * deg_to_rad;
+
+  for (auto& t : targets_) {
+    float x = t.x + t.vx * (float)time_s;
+    float y = t.y + t.vy * (float)time_s;
+    float centre = std::sqrt(x * x + y * y);
+    float surface = centre - t.radius;
+    if (surface <= 0 || surface > max_range_mm
+        || (nearest >= 0 && surface >= nearest)) {
+      continue;
+    }
+
+    float off = std::fabs(std::remainder(std::atan2(y, x) - bearing,
+                                         2 * 3.14159265f));
+    if (off <= half_beam + std::asin(t.radius / centre)) {
+      nearest = surface;
+    }
+  }
+  return nearest;
+}
@@ -0,0 +1,62 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SCENE_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SCENE_H_
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+/*
+ * Scene - what's in front of the simulated radar
+ *
+ * Same frame as OccupancyGrid: the radar is at the origin, servo angle 0°
+ * points right (+x), 90° straight ahead (+y) and 180° left. Targets are discs,
+ * which is near enough for something the width of an ultrasonic beam, and can
+ * move in a straight line.
+ */
+class Scene {
+ public:
+  struct Target {
+    float x;        // mm, at time 0
+    float y;        // mm
+    float radius;   // mm
+    float vx;       // mm/s
+    float vy;       // mm/s
+  };
+
+  /*
+   * Add
+   *
+   * Put a target range_mm away at angle_deg, at time 0.
+   */
+  void add(float angle_deg, float range_mm, float radius_mm = 50,
+           float vx = 0, float vy = 0);
+
+  /*
+   * Parse
+   *
+   * Add targets from in, one a line:
+   *
+   *    angle_deg range_mm [radius_mm [vx_mm_s vy_mm_s]]
+   *
+   * Blank lines and anything after a # are skipped. Returns false, having
+   * added the lines before it, at the first line that doesn't parse.
+   */
+  bool parse(std::istream& in);
+
+  /*
+   * Range
+   *
+   * The distance to the nearest surface of a target at time_s inside the cone
+   * half_beam_deg either side of bearing_deg, or a negative number if there's
+   * none nearer than max_range_mm.
+   */
+  float range(float bearing_deg, float half_beam_deg, float max_range_mm,
+              double time_s) const;
+
+  const std::vector<Target>& targets() const { return targets_; }
+
+ private:
+  std::vector<Target> targets_;
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SCENE_H_
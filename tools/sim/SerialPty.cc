@@ -0,0 +1,68 @@
+#include <SerialPty.h>
+#include <SimArduino.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+SerialPty::~SerialPty() {
+  if (slave_ >= 0) {
+    ::close(slave_);
+  }
+  if (master_ >= 0) {
+    ::close(master_);
+  }
+}
+
+bool SerialPty::open() {
+  master_ = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (master_ < 0 || grantpt(master_) != 0 || unlockpt(master_) != 0) {
+    return false;
+  }
+  const char* name = ptsname(master_);
+  if (name == nullptr) {
+    return false;
+  }
+  path_ = name;
+  slave_ = ::open(name, O_RDWR | O_NOCTTY);
+  if (slave_ < 0) {
+    return false;
+  }
+
+  // no echo, no line editing and no turning \n into \r\n
+  termios raw {};
+  if (tcgetattr(slave_, &raw) != 0) {
+    return false;
+  }
+  cfmakeraw(&raw);
+  return tcsetattr(slave_, TCSANOW, &raw) == 0;
+}
+
+const std::string& SerialPty::path() const {
+  return path_;
+}
+
+void SerialPty::pump() {
+  uint8_t in[256];
+  ssize_t got;
+  while ((got = ::read(master_, in, sizeof(in))) > 0) {
+    typed_.insert(typed_.end(), in, in + got);
+  }
+  while (!typed_.empty() && SimArduino::serial_receive(typed_.front())) {
+    typed_.pop_front();
+  }
+
+  const std::string& out = SimArduino::serial_output();
+  if (sent_ > out.size()) {
+    sent_ = 0;    // SimArduino's been reset since
+  }
+  while (sent_ < out.size()) {
+    ssize_t put = ::write(master_, out.data() + sent_, out.size() - sent_);
+    if (put <= 0) {
+      break;      // nobody's reading and the pty is full, try next time
+    }
+    sent_ += (size_t)put;
+  }
+}
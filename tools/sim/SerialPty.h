@@ -0,0 +1,52 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SERIALPTY_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SERIALPTY_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+/*
+ * SerialPty - the simulated Uno's Serial on a pseudo terminal
+ *
+ * open() makes a pty and path() is its slave end, /dev/pts/N, which a
+ * terminal program or telemetry_decode can open as if it were the Uno's USB
+ * port. The slave is raw, so bytes go through as they are, both ways.
+ *
+ * Nothing happens on its own: pump() moves what's been typed into
+ * SimArduino::serial_receive(), and what the firmware has written since the
+ * last pump() out to the pty. Call it between loop()s. Neither blocks. What
+ * won't fit in the Uno's receive buffer waits here, rather than being lost,
+ * as a terminal program typing at 9600 baud wouldn't outrun a firmware that
+ * keeps up.
+ *
+ * The slave is kept open too, so the pty stays up while nothing else has it
+ * open.
+ */
+class SerialPty {
+  int master_ {-1};
+  int slave_ {-1};
+  std::string path_;
+  size_t sent_ {0};             // of SimArduino::serial_output()
+  std::deque<uint8_t> typed_;   // read from the pty, not yet received
+
+ public:
+  SerialPty() = default;
+  SerialPty(const SerialPty&) = delete;
+  SerialPty& operator=(const SerialPty&) = delete;
+  ~SerialPty();
+
+  /*
+   * Open
+   *
+   * Returns:
+   * bool - false if there are no ptys to be had, with errno set
+   */
+  bool open();
+
+  const std::string& path() const;
+
+  // pass bytes between the pty and SimArduino, as many as are waiting
+  void pump();
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SERIALPTY_H_
@@ -0,0 +1,38 @@
+#include <ServoModel.h>
+#include <SimArduino.h>
+
+ServoModel::ServoModel(const Params& params)
+    : params_(params),
+      from_deg_(params.start_deg),
+      target_((uint8_t)params.start_deg) {
+  from_time_ = SimArduino::now();
+  SimArduino::watch([this](SimArduino::Output what, uint8_t pin,
+                           uint16_t value) {
+    if (what == SimArduino::Output::SERVO && pin == params_.pin) {
+      write_((uint8_t)value);
+    }
+  });
+}
+
+float ServoModel::angle() const {
+  return angle_at(SimArduino::now());
+}
+
+float ServoModel::angle_at(uint64_t time) const {
+  float travel = params_.slew_deg_s * (float)(time - from_time_) / 1e6f;
+  float left = (float)target_ - from_deg_;
+  if (left > travel) {
+    return from_deg_ + travel;
+  } else if (left < -travel) {
+    return from_deg_ - travel;
+  }
+  return target_;
+}
+
+void ServoModel::write_(uint8_t angle) {
+  uint64_t now = SimArduino::now();
+  from_deg_ = angle_at(now);
+  from_time_ = now;
+  target_ = angle;
+  ++writes_;
+}
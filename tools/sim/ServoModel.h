@@ -0,0 +1,43 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SERVOMODEL_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SERVOMODEL_H_
+
+#include <cstdint>
+
+/*
+ * ServoModel - where the simulated servo horn actually is
+ *
+ * Follows what the firmware writes with Servo::write() on pin, turning
+ * towards it no faster than slew_deg_s. The default is an SG90's 0.1s per
+ * 60°. Position is worked out when asked for rather than stepped, so an idle
+ * servo costs nothing.
+ *
+ * The model watches SimArduino from construction, so make it after
+ * SimArduino::reset(), and keep it until the next one.
+ */
+class ServoModel {
+ public:
+  struct Params {
+    uint8_t pin {9};
+    float   slew_deg_s {600};
+    float   start_deg {90};   // where the horn was left at power on
+  };
+
+  explicit ServoModel(const Params& params);
+
+  float angle() const;                  // now
+  float angle_at(uint64_t time) const;  // µs from reset, not before the
+                                        // last write
+  uint8_t target() const { return target_; }
+  uint64_t writes() const { return writes_; }
+
+ private:
+  Params    params_;
+  uint64_t  from_time_ {0};   // when the last write came in
+  float     from_deg_;        // and where the horn was then
+  uint8_t   target_;
+  uint64_t  writes_ {0};
+
+  void write_(uint8_t angle);
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SERVOMODEL_H_
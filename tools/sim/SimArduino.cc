@@ -0,0 +1,549 @@
+#include <SimArduino.h>
+#include <ArduinoInterface.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <queue>
+
+namespace {
+
+// interrupt vectors in use, in the AVR's priority order
+enum Vector : uint8_t {INT0_VECT, INT1_VECT, TIMER1_COMPB_VECT,
+                       TIMER0_COMPB_VECT, VECTORS};
+
+struct Event {
+  uint64_t time;
+  uint64_t order;
+  std::function<void()> run;
+
+  bool operator>(const Event& other) const {
+    return (time != other.time) ? time > other.time : order > other.order;
+  }
+};
+
+struct State {
+  uint64_t now {0};
+  uint64_t order {0};  // events scheduled so far, to break ties
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+
+  void (*pending[VECTORS])() {};  // interrupt flags, with the ISR to run
+  void (*attached[2])() {};       // external interrupts 0 and 1
+  uint8_t attach_mode[2] {};
+  bool enabled {true};            // the core's init() turns them on
+  bool in_isr {false};
+  bool idle {false};              // nothing but millis() since the last poll
+
+  uint8_t mode[SimArduino::pins] {};
+  uint8_t level[SimArduino::pins] {};
+  uint8_t duty[SimArduino::pins] {};
+  uint8_t servo[SimArduino::pins] {};
+  uint16_t frequency[SimArduino::pins] {};
+  uint32_t tone_gen[SimArduino::pins] {};
+  volatile uint8_t ports[3] {};   // PORTB, PORTC, PORTD
+
+  // re-arming a timer makes what it had scheduled stale
+  uint32_t one_shot_gen {0};
+  void (*one_shot_isr)() {nullptr};
+  uint32_t tick_gen {0};
+  void (*tick_isr)() {nullptr};
+
+  std::vector<SimArduino::Watcher> watchers;
+  bool capture {false};
+  std::vector<SimArduino::PWMSample> pwm_log;
+  std::string serial;
+  bool echo {false};
+  std::deque<uint8_t> received;
+  uint8_t eeprom[ArduinoInterface::eeprom_size];
+  SimArduino::Stats stats {};
+};
+
+// One simulation per thread, see INSTANCE_LOCAL in ArduinoInterface.h. The
+// plain pointer is for speed: a thread_local with a destructor goes through a
+// wrapper function every time it's used. owner only frees it.
+thread_local std::unique_ptr<State> owner;
+thread_local State* s {nullptr};
+
+void advance(uint64_t us);
+
+// run pending interrupts, if they can be
+void service() {
+  while (s->enabled && !s->in_isr) {
+    uint8_t v = 0;
+    while (v < VECTORS && s->pending[v] == nullptr) {
+      ++v;
+    }
+    if (v == VECTORS) {
+      return;
+    }
+    void (*isr)() = s->pending[v];
+    s->pending[v] = nullptr;
+    ++s->stats.interrupts;
+    s->in_isr = true;
+    isr();
+    s->in_isr = false;
+  }
+}
+
+void advance(uint64_t us) {
+  uint64_t target = s->now + us;
+  service();
+  while (!s->events.empty() && s->events.top().time <= target) {
+    Event event = s->events.top();
+    s->events.pop();
+    if (event.time > s->now) {
+      s->now = event.time;
+    }
+    ++s->stats.events;
+    event.run();
+    service();
+  }
+  if (target > s->now) {
+    s->now = target;
+  }
+}
+
+// the cost of a call into the backend from the firmware
+void call() {
+  ++s->stats.calls;
+  if (!s->in_isr) {
+    s->idle = false;
+  }
+  advance(SimArduino::call_us);
+}
+
+void raise(Vector v, void (*isr)()) {
+  if (isr != nullptr) {
+    s->pending[v] = isr;
+  }
+}
+
+void notify(SimArduino::Output what, uint8_t pin, uint16_t value) {
+  for (auto& watcher : s->watchers) {
+    watcher(what, pin, value);
+  }
+}
+
+// the port register and bit for a pin, as on the Uno
+volatile uint8_t* port_of(uint8_t pin) {
+  if (pin < 8) {
+    return &s->ports[2];
+  } else if (pin < 14) {
+    return &s->ports[0];
+  } else if (pin < 20) {
+    return &s->ports[1];
+  }
+  return nullptr;
+}
+
+uint8_t bit_of(uint8_t pin) {
+  if (pin < 8) {
+    return 1 << pin;
+  } else if (pin < 14) {
+    return 1 << (pin - 8);
+  } else if (pin < 20) {
+    return 1 << (pin - 14);
+  }
+  return 0;
+}
+
+void set_level(uint8_t pin, uint8_t level) {
+  level = level ? HIGH : LOW;
+  if (pin >= SimArduino::pins || s->level[pin] == level) {
+    return;
+  }
+  s->level[pin] = level;
+
+  int8_t interrupt = digitalPinToInterrupt(pin);
+  if (interrupt == NOT_AN_INTERRUPT) {
+    return;
+  }
+  uint8_t mode = s->attach_mode[interrupt];
+  if (mode == CHANGE || (mode == RISING && level == HIGH)
+      || (mode == FALLING && level == LOW)) {
+    raise((Vector)(INT0_VECT + interrupt), s->attached[interrupt]);
+  }
+}
+
+// an output the firmware set
+void output(uint8_t pin, uint8_t level) {
+  if (pin >= SimArduino::pins) {
+    return;
+  }
+  volatile uint8_t* port = port_of(pin);
+  if (port != nullptr) {
+    *port = level ? (*port | bit_of(pin)) : (*port & ~bit_of(pin));
+  }
+  if (s->mode[pin] == OUTPUT && s->level[pin] != (level ? HIGH : LOW)) {
+    set_level(pin, level);
+    notify(SimArduino::Output::DIGITAL, pin, s->level[pin]);
+  }
+}
+
+// step towards deadline until pin reads level, for pulseIn()
+bool wait_for(uint8_t pin, uint8_t level, uint64_t deadline) {
+  while (s->level[pin] != level) {
+    if (s->now >= deadline) {
+      return false;
+    }
+    uint64_t next = deadline;
+    if (!s->events.empty() && s->events.top().time < next) {
+      next = std::max(s->events.top().time, s->now + 1);
+    }
+    advance(next - s->now);
+  }
+  return true;
+}
+
+constexpr uint64_t tick_us {ArduinoInterface::tick_us};
+
+// each tick schedules the next, until timer_tick() is called again
+void schedule_tick(uint32_t gen, uint64_t time) {
+  SimArduino::at(time, [gen, time]() {
+    if (s->tick_gen == gen) {
+      raise(TIMER0_COMPB_VECT, s->tick_isr);
+      schedule_tick(gen, time + tick_us);
+    }
+  });
+}
+
+} // namespace
+
+void SimArduino::pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < pins) {
+    s->mode[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+      set_level(pin, HIGH);
+    }
+  }
+  call();
+}
+
+void SimArduino::digitalWrite(uint8_t pin, uint8_t val) {
+  output(pin, val);
+  call();
+}
+
+uint8_t SimArduino::digitalRead(uint8_t pin) {
+  uint8_t level = (pin < pins) ? s->level[pin] : LOW;
+  call();
+  return level;
+}
+
+void SimArduino::delayMicroseconds(unsigned int us) {
+  ++s->stats.calls;
+  s->idle = false;
+  advance(us > call_us ? us : call_us);
+}
+
+void SimArduino::delay(uint32_t ms) {
+  ++s->stats.calls;
+  s->idle = false;
+  advance((uint64_t)ms * 1000);
+}
+
+/*
+ * Pulse In
+ *
+ * The firmware times its echoes with an interrupt instead, but this is here
+ * for completeness. Rather than spin, it steps from event to event, since
+ * nothing else can change the pin.
+ */
+unsigned long SimArduino::pulseIn(uint8_t pin, uint8_t val, uint32_t timeout) {
+  call();
+  if (pin >= pins) {
+    return 0;
+  }
+  uint8_t level = val ? HIGH : LOW;
+  uint8_t other = val ? LOW : HIGH;
+  uint64_t deadline = s->now + timeout;
+
+  // let a pulse already under way finish, then wait for the next
+  if (!wait_for(pin, other, deadline) || !wait_for(pin, level, deadline)) {
+    return 0;
+  }
+  uint64_t start = s->now;
+  if (!wait_for(pin, other, deadline)) {
+    return 0;
+  }
+  return (unsigned long)(s->now - start);
+}
+
+void SimArduino::analogueWrite(uint8_t pin, uint8_t val) {
+  if (pin < pins) {
+    // as the core, which sets the pin to an output and writes 0 and 255 as
+    // plain digital levels
+    s->mode[pin] = OUTPUT;
+    if (val == 0 || val == 255) {
+      output(pin, val ? HIGH : LOW);
+    }
+    s->duty[pin] = val;
+    if (s->capture) {
+      s->pwm_log.push_back({s->now, pin, val});
+    }
+    notify(Output::PWM, pin, val);
+  }
+  call();
+}
+
+/*
+ * Millis
+ *
+ * Two polls in a row with nothing in between means something is waiting on
+ * the clock. Nothing it can see changes before the next event or the next
+ * millisecond, so the clock goes straight there.
+ */
+uint32_t SimArduino::millis() {
+  if (s->idle) {
+    uint64_t next = (s->now / 1000 + 1) * 1000;
+    if (!s->events.empty() && s->events.top().time < next) {
+      next = std::max(s->events.top().time, s->now);
+    }
+    if (next > s->now) {
+      ++s->stats.skips;
+      advance(next - s->now);
+    }
+  }
+  uint32_t ms = (uint32_t)(s->now / 1000);
+  call();
+  s->idle = !s->in_isr;
+  return ms;
+}
+
+uint32_t SimArduino::micros() {
+  uint32_t us = (uint32_t)s->now;
+  call();
+  return us;
+}
+
+void SimArduino::attachInterrupt(uint8_t interrupt, void (*isr)(),
+                                 uint8_t mode) {
+  if (interrupt < 2) {
+    s->attached[interrupt] = isr;
+    s->attach_mode[interrupt] = mode;
+  }
+  call();
+}
+
+void SimArduino::tone(uint8_t pin, uint16_t frequency, uint32_t duration) {
+  if (pin < pins) {
+    s->mode[pin] = OUTPUT;
+    s->frequency[pin] = frequency;
+    uint32_t gen = ++s->tone_gen[pin];
+    notify(Output::TONE, pin, frequency);
+    if (duration != 0) {
+      at(s->now + (uint64_t)duration * 1000, [pin, gen]() {
+        if (s->tone_gen[pin] == gen) {
+          s->frequency[pin] = 0;
+          notify(Output::TONE, pin, 0);
+        }
+      });
+    }
+  }
+  call();
+}
+
+void SimArduino::noTone(uint8_t pin) {
+  if (pin < pins) {
+    ++s->tone_gen[pin];
+    s->frequency[pin] = 0;
+    notify(Output::TONE, pin, 0);
+    output(pin, LOW);
+  }
+  call();
+}
+
+void SimArduino::one_shot(uint16_t us, void (*isr)()) {
+  uint32_t gen = ++s->one_shot_gen;
+  s->one_shot_isr = isr;
+  at(s->now + us, [gen]() {
+    if (s->one_shot_gen == gen) {
+      raise(TIMER1_COMPB_VECT, s->one_shot_isr);
+    }
+  });
+  call();
+}
+
+/*
+ * Timer Tick
+ *
+ * Timer0 runs from power on, so ticks land on multiples of tick_us whenever
+ * the ISR was set.
+ */
+void SimArduino::timer_tick(void (*isr)()) {
+  uint32_t gen = ++s->tick_gen;
+  s->tick_isr = isr;
+  if (isr != nullptr) {
+    schedule_tick(gen, (s->now / tick_us + 1) * tick_us);
+  }
+  call();
+}
+
+/*
+ * Timer Ticks
+ *
+ * Timer1 as Servo runs it, 2 ticks a µs from a frame starting every 20ms. On
+ * the device it's a register read, a couple of cycles, so it costs nothing
+ * here and a profiled build runs exactly as one without.
+ */
+uint16_t SimArduino::timer_ticks() {
+  using AI = ArduinoInterface;
+  uint64_t frame_us = AI::frame_ticks / AI::ticks_per_us;
+  return (uint16_t)(s->now % frame_us * AI::ticks_per_us);
+}
+
+volatile uint8_t* SimArduino::port_output_register(uint8_t pin) {
+  return port_of(pin);
+}
+
+uint8_t SimArduino::pin_bit_mask(uint8_t pin) {
+  return bit_of(pin);
+}
+
+void SimArduino::write_port(volatile uint8_t* port, uint8_t mask,
+                            uint8_t bits) {
+  for (uint8_t pin = 0; pin < pins; ++pin) {
+    if (port_of(pin) == port && (mask & bit_of(pin))) {
+      output(pin, bits & bit_of(pin));
+    }
+  }
+  call();
+}
+
+uint8_t SimArduino::eeprom_read(uint16_t address) {
+  call();
+  return (address < ArduinoInterface::eeprom_size) ? s->eeprom[address]
+                                                    : 0xff;
+}
+
+void SimArduino::eeprom_update(uint16_t address, uint8_t value) {
+  if (address < ArduinoInterface::eeprom_size
+      && s->eeprom[address] != value) {
+    s->eeprom[address] = value;
+    advance(eeprom_write_us);
+  }
+  call();
+}
+
+void SimArduino::disable_interrupts() {
+  s->enabled = false;
+}
+
+void SimArduino::enable_interrupts() {
+  s->enabled = true;
+  service();
+}
+
+void SimArduino::servo_write(uint8_t pin, uint8_t angle) {
+  if (pin < pins) {
+    s->servo[pin] = angle;
+    notify(Output::SERVO, pin, angle);
+  }
+  call();
+}
+
+void SimArduino::serial_write(uint8_t c) {
+  s->serial.push_back((char)c);
+  if (s->echo) {
+    std::putchar(c);
+  }
+  call();
+}
+
+int SimArduino::serial_available() {
+  call();
+  return (int)s->received.size();
+}
+
+int SimArduino::serial_read() {
+  call();
+  if (s->received.empty()) {
+    return -1;
+  }
+  uint8_t c = s->received.front();
+  s->received.pop_front();
+  return c;
+}
+
+void SimArduino::reset() {
+  owner.reset(new State);
+  s = owner.get();
+  std::fill(std::begin(s->eeprom), std::end(s->eeprom), 0xff);
+}
+
+uint64_t SimArduino::now() {
+  return s->now;
+}
+
+void SimArduino::at(uint64_t time, std::function<void()> event) {
+  if (time < s->now) {
+    time = s->now;
+  }
+  s->events.push({time, s->order++, std::move(event)});
+}
+
+void SimArduino::run_for(uint64_t us) {
+  advance(us);
+}
+
+void SimArduino::drive(uint8_t pin, uint8_t level) {
+  set_level(pin, level);
+  service();
+}
+
+uint8_t SimArduino::level(uint8_t pin) {
+  return (pin < pins) ? s->level[pin] : LOW;
+}
+
+uint8_t SimArduino::duty(uint8_t pin) {
+  return (pin < pins) ? s->duty[pin] : 0;
+}
+
+uint8_t SimArduino::servo(uint8_t pin) {
+  return (pin < pins) ? s->servo[pin] : 0;
+}
+
+uint16_t SimArduino::frequency(uint8_t pin) {
+  return (pin < pins) ? s->frequency[pin] : 0;
+}
+
+bool SimArduino::interrupts_enabled() {
+  return s->enabled;
+}
+
+void SimArduino::watch(Watcher watcher) {
+  s->watchers.push_back(std::move(watcher));
+}
+
+void SimArduino::capture_pwm(bool on) {
+  s->capture = on;
+}
+
+const std::vector<SimArduino::PWMSample>& SimArduino::pwm_log() {
+  return s->pwm_log;
+}
+
+const std::string& SimArduino::serial_output() {
+  return s->serial;
+}
+
+void SimArduino::echo_serial(bool on) {
+  s->echo = on;
+}
+
+bool SimArduino::serial_receive(uint8_t c) {
+  if (s->received.size() >= serial_buffer) {
+    return false;
+  }
+  s->received.push_back(c);
+  return true;
+}
+
+uint8_t* SimArduino::eeprom() {
+  return s->eeprom;
+}
+
+SimArduino::Stats SimArduino::stats() {
+  return s->stats;
+}
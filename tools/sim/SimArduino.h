@@ -0,0 +1,175 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SIMARDUINO_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SIMARDUINO_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * SimArduino
+ *
+ * A discrete event simulation of the bits of an Uno the firmware uses, as a
+ * third backend for ArduinoInterface (see HOST_SIM in ArduinoInterface.h).
+ * Like MockArduino it's all static, so code written against the static
+ * interface doesn't change.
+ *
+ * Time is virtual, in µs from reset(). Every call into the backend costs
+ * call_us, delay() and delayMicroseconds() just move the clock on, and
+ * millis() polled in a loop with nothing else happening skips to the next
+ * thing that could change the answer, so the busy wait in loop() costs
+ * almost nothing. Hours of device time run in seconds.
+ *
+ * Anything that happens at a time of its own - a timer match, a pin driven by
+ * a model of the hardware outside - is an event, run in (time, order
+ * scheduled) order, so a run is the same every time. Interrupts raise a flag
+ * per vector as on the AVR, and pending ones are run lowest vector first
+ * whenever interrupts are on and no ISR is already running.
+ *
+ * Each thread has a simulation of its own, so independent runs can go in
+ * parallel.
+ */
+class SimArduino {
+ public:
+  static constexpr uint8_t pins {22};     // D0-D13 and A0-A7
+  static constexpr uint32_t call_us {1};  // cost of each call, in µs
+  // what writing a byte of EEPROM holds the AVR up for, in µs
+  static constexpr uint32_t eeprom_write_us {3300};
+  // the core's receive buffer, which drops what comes in when it's full
+  static constexpr uint8_t serial_buffer {64};
+
+  // what changed, for watch()
+  enum class Output : uint8_t {DIGITAL, PWM, SERVO, TONE};
+  using Watcher = std::function<void(Output what, uint8_t pin,
+                                     uint16_t value)>;
+
+  struct PWMSample {
+    uint64_t time;
+    uint8_t pin;
+    uint8_t duty;
+  };
+
+  struct Stats {
+    uint64_t calls;       // calls into the backend
+    uint64_t events;      // scheduled events run
+    uint64_t interrupts;  // ISRs run
+    uint64_t skips;       // idle millis() polls skipped ahead
+  };
+
+  // ArduinoInterface backend
+
+  static void pinMode(uint8_t pin, uint8_t mode);
+  static void digitalWrite(uint8_t pin, uint8_t val);
+  static uint8_t digitalRead(uint8_t pin);
+  static void delayMicroseconds(unsigned int us);
+  static void delay(uint32_t ms);
+  static unsigned long pulseIn(uint8_t pin, uint8_t val,
+                               uint32_t timeout = 1000000);
+  static void analogueWrite(uint8_t pin, uint8_t val);
+  static uint32_t millis();
+  static uint32_t micros();
+  static void attachInterrupt(uint8_t interrupt, void (*isr)(), uint8_t mode);
+  static void tone(uint8_t pin, uint16_t frequency, uint32_t duration = 0);
+  static void noTone(uint8_t pin);
+  static void one_shot(uint16_t us, void (*isr)());
+  static void timer_tick(void (*isr)());
+  static uint16_t timer_ticks();
+  static volatile uint8_t* port_output_register(uint8_t pin);
+  static uint8_t pin_bit_mask(uint8_t pin);
+  static void write_port(volatile uint8_t* port, uint8_t mask, uint8_t bits);
+  static uint8_t eeprom_read(uint16_t address);
+  static void eeprom_update(uint16_t address, uint8_t value);
+
+  // noInterrupts() and interrupts() in the shim Arduino.h
+  static void disable_interrupts();
+  static void enable_interrupts();
+
+  // core bits that aren't part of ArduinoInterface
+  static void servo_write(uint8_t pin, uint8_t angle);
+  static void serial_write(uint8_t c);
+  static int serial_available();
+  static int serial_read();       // -1 if there's nothing
+
+  // the simulation
+
+  /*
+   * Reset
+   *
+   * Back to power on: time 0, pins inputs and low, nothing scheduled or
+   * attached, no watchers. Call it before each run, and before anything else
+   * on a new thread.
+   */
+  static void reset();
+
+  static uint64_t now();
+
+  /*
+   * At
+   *
+   * Run event at time (µs from reset), or now if that has passed. Events at
+   * the same time run in the order they were scheduled.
+   */
+  static void at(uint64_t time, std::function<void()> event);
+
+  /*
+   * Run For
+   *
+   * Move the clock on by us from outside the firmware, running whatever falls
+   * due. This is delay() without the call cost.
+   */
+  static void run_for(uint64_t us);
+
+  /*
+   * Drive
+   *
+   * Set the level on an input pin from outside, as the hardware around the
+   * Arduino would. An interrupt attached to the pin is raised if the change
+   * matches its mode.
+   */
+  static void drive(uint8_t pin, uint8_t level);
+
+  static uint8_t level(uint8_t pin);      // what the pin is at now
+  static uint8_t duty(uint8_t pin);       // last analogueWrite()
+  static uint8_t servo(uint8_t pin);      // last angle written
+  static uint16_t frequency(uint8_t pin); // tone playing, or 0
+  static bool interrupts_enabled();
+
+  /*
+   * Watch
+   *
+   * Call watcher whenever the firmware changes an output. This is how models
+   * of the hardware see what the firmware is doing.
+   */
+  static void watch(Watcher watcher);
+
+  // keep every analogueWrite() in pwm_log()
+  static void capture_pwm(bool on);
+  static const std::vector<PWMSample>& pwm_log();
+
+  static const std::string& serial_output();
+  static void echo_serial(bool on);   // copy Serial to stdout too
+
+  /*
+   * Serial Receive
+   *
+   * A byte arriving on Serial from outside, for the firmware to read. It's
+   * lost if serial_buffer bytes are already waiting, as on the Uno.
+   *
+   * Returns:
+   * bool - false if it was lost
+   */
+  static bool serial_receive(uint8_t c);
+
+  /*
+   * EEPROM
+   *
+   * ArduinoInterface::eeprom_size bytes, erased (0xff) by reset() as on a
+   * new board. Copy them out and back in around reset() to keep them over a
+   * power cycle.
+   */
+  static uint8_t* eeprom();
+
+  static Stats stats();
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SIMARDUINO_H_
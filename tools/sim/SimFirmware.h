@@ -0,0 +1,15 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SIMFIRMWARE_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SIMFIRMWARE_H_
+
+#include <RadarState.h>
+
+// What main.cpp gives the core, for host tools driving the firmware
+// themselves. Call setup() after SimArduino::reset(), then loop() for as long
+// as the run lasts.
+
+extern INSTANCE_LOCAL RadarContext* context;
+
+void setup();
+void loop();
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SIMFIRMWARE_H_
@@ -0,0 +1,64 @@
+#include <TraceReader.h>
+
+bool TraceReader::Event::operator==(const Event& other) const {
+  return time == other.time && kind == other.kind && value == other.value;
+}
+
+TraceReader::TraceReader(const uint8_t* data, size_t size)
+    : data_{data}, size_{size} {
+  valid_ = size_ >= Trace::header_size && data_[0] == Trace::magic[0]
+           && data_[1] == Trace::magic[1] && data_[2] == Trace::magic[2]
+           && data_[3] == Trace::version;
+  offset_ = valid_ ? Trace::header_size : size_;
+}
+
+bool TraceReader::next(Event& event) {
+  using Trace::Kind;
+
+  if (offset_ >= size_) {
+    return false;
+  }
+  size_t at = offset_;
+  uint8_t tag = data_[at++];
+  auto kind = (Kind)(tag & ~Trace::level_bit);
+  if (kind > Kind::LOST) {
+    truncated_ = true;
+    return false;
+  }
+
+  uint32_t zigzag = 0;
+  for (uint8_t shift = 0;; shift += 7) {
+    if (at >= size_ || shift > 28) {
+      truncated_ = true;
+      return false;
+    }
+    uint8_t byte = data_[at++];
+    zigzag |= (uint32_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+  auto delta = (int32_t)((zigzag >> 1) ^ (0 - (zigzag & 1)));
+
+  uint8_t value;
+  if (kind == Kind::ECHO || kind == Kind::PIR) {
+    value = (tag & Trace::level_bit) ? 1 : 0;
+  } else {
+    if (at >= size_) {
+      truncated_ = true;
+      return false;
+    }
+    value = data_[at++];
+  }
+
+  offset_ = at;
+  time_ += delta;
+  event = {(uint64_t)(time_ < 0 ? 0 : time_), kind, value};
+  return true;
+}
+
+std::ostream& operator<<(std::ostream& out, const TraceReader::Event& event) {
+  static const char* const names[] {"ECHO", "PIR", "SERVO", "STATE", "LOST"};
+  return out << event.time << ' ' << names[(uint8_t)event.kind] << ' '
+             << (unsigned)event.value;
+}
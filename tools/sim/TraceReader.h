@@ -0,0 +1,61 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_TRACEREADER_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_TRACEREADER_H_
+
+#include <TraceRecorder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/*
+ * TraceReader - decode a trace written by TraceRecorder
+ *
+ * Walks a trace already in memory (or mapped into it) one record at a time,
+ * adding up the deltas into µs since 0. Nothing is copied, so a reader is
+ * cheap to copy too, and each copy carries on from where it was.
+ */
+class TraceReader {
+ public:
+  struct Event {
+    uint64_t time;      // µs
+    Trace::Kind kind;
+    uint8_t value;      // level, angle, state or count, as Trace::Kind says
+
+    bool is_input() const {
+      return kind == Trace::Kind::ECHO || kind == Trace::Kind::PIR;
+    }
+    bool operator==(const Event& other) const;
+  };
+
+  TraceReader(const uint8_t* data, size_t size);
+
+  // the header is there and a version we can read
+  bool valid() const { return valid_; }
+
+  /*
+   * Next
+   *
+   * Event& event - set to the next record, if there is one
+   *
+   * Returns:
+   * bool - false at the end of the trace, or at a record that's cut short or
+   *        doesn't make sense (see truncated())
+   */
+  bool next(Event& event);
+
+  // next() stopped at something other than the end
+  bool truncated() const { return truncated_; }
+  size_t offset() const { return offset_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ {0};
+  int64_t time_ {0};
+  bool valid_ {false};
+  bool truncated_ {false};
+};
+
+std::ostream& operator<<(std::ostream& out, const TraceReader::Event& event);
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_TRACEREADER_H_
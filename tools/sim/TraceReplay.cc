@@ -0,0 +1,142 @@
+#include <TraceReplay.h>
+#include <SimArduino.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// the next record of kind, if there is one
+bool next_of(TraceReader& reader, Trace::Kind kind,
+             TraceReader::Event& event) {
+  while (reader.next(event)) {
+    if (event.kind == kind) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool next_output(TraceReader& reader, TraceReader::Event& event) {
+  while (reader.next(event)) {
+    if (event.kind == Trace::Kind::SERVO
+        || event.kind == Trace::Kind::STATE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap((void*)data_, size_);
+  }
+}
+
+bool MappedFile::open(const char* path) {
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  size_ = (size_t)st.st_size;
+  if (size_ != 0) {
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      close(fd);
+      size_ = 0;
+      return false;
+    }
+    // read front to back, once
+    madvise(map, size_, MADV_SEQUENTIAL);
+    data_ = (const uint8_t*)map;
+  }
+  close(fd);
+  return true;
+}
+
+TraceReplay::TraceReplay(const uint8_t* data, size_t size,
+                         const Params& params)
+    : params_{params}, echo_{data, size}, pir_{data, size} {
+  valid_ = echo_.valid();
+  if (!valid_) {
+    return;
+  }
+
+  // one pass up front for the end and anything lost. It only reads, so it
+  // costs little next to the replay itself.
+  TraceReader reader {data, size};
+  TraceReader::Event event {};
+  while (reader.next(event)) {
+    end_ = event.time;
+    if (event.kind == Trace::Kind::LOST) {
+      lost_ += event.value;
+    }
+  }
+
+  schedule_echo_();
+  schedule_pir_(0);
+}
+
+void TraceReplay::schedule_echo_() {
+  TraceReader::Event event {};
+  if (!next_of(echo_, Trace::Kind::ECHO, event)) {
+    return;
+  }
+  SimArduino::at(event.time, [this, event]() {
+    SimArduino::drive(params_.echo_pin, event.value);
+    ++inputs_;
+    schedule_echo_();
+  });
+}
+
+void TraceReplay::schedule_pir_(uint64_t after) {
+  TraceReader::Event event {};
+  if (!next_of(pir_, Trace::Kind::PIR, event)) {
+    return;
+  }
+  SimArduino::at(after, [this, event]() {
+    if (SimArduino::level(params_.ir_pin) != event.value) {
+      SimArduino::drive(params_.ir_pin, event.value);
+      ++inputs_;
+    }
+    // the read itself was at event.time, so the next level is set after it
+    schedule_pir_(event.time + 1);
+  });
+}
+
+TraceReplay::Divergence TraceReplay::compare(TraceReader expected,
+                                             TraceReader got) {
+  Divergence d {};
+  while (true) {
+    // the replay is run a little past the end of the recording, so what it
+    // did after doesn't count
+    if (!next_output(expected, d.expected)) {
+      return d;
+    }
+    d.has_got = next_output(got, d.got);
+    if (!d.has_got || d.expected.kind != d.got.kind
+        || d.expected.value != d.got.value) {
+      d.found = true;
+      return d;
+    }
+    ++d.compared;
+  }
+}
+
+std::string TraceReplay::recorded() {
+  std::string trace = SimArduino::serial_output();
+  uint8_t byte;
+  while (TraceRecorder::read(byte)) {
+    trace.push_back((char)byte);
+  }
+  return trace;
+}
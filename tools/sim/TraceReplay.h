@@ -0,0 +1,113 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_TRACEREPLAY_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_TRACEREPLAY_H_
+
+#include <TraceReader.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * MappedFile - a file mapped read only into memory
+ *
+ * Traces can run to tens of megabytes for a long recording, so rather than
+ * read one in, it's mapped and the pages come in as a reader gets to them.
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  // false, with errno set, if it can't be opened or mapped
+  bool open(const char* path);
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ {nullptr};
+  size_t size_ {0};
+};
+
+/*
+ * TraceReplay - play a recorded trace back into the firmware
+ *
+ * Stands in for the hardware outside the Arduino, as HCSR04Model and the
+ * PIR drives do in a simulation, but from what a recording says happened
+ * rather than from a model. The echo pin is driven at the times of the
+ * recorded edges, so EchoISR sees the same pulse widths. The PIR pin is
+ * set to each recorded read's level just after the read before it, so
+ * pir_check() reads the same levels even if it runs a little earlier or
+ * later than it did.
+ *
+ * Records are read as they fall due, one ahead for the echo pin and one for
+ * the PIR, so a trace is never loaded or scheduled all at once.
+ *
+ * Servo and state records are what the firmware did. The firmware on the
+ * simulator records a trace of its own as it goes (see recorded()), and
+ * compare() checks the two did the same things in the same order. Timing
+ * on the host isn't the device's, so only the order and values are
+ * compared. A replay of the same trace is the same every time, to the bit.
+ *
+ * As with the models, make it after SimArduino::reset().
+ */
+class TraceReplay {
+ public:
+  struct Params {
+    uint8_t echo_pin {2};
+    uint8_t ir_pin {11};
+  };
+
+  struct Divergence {
+    bool found;
+    uint64_t compared;          // outputs that matched before it
+    TraceReader::Event expected;
+    bool has_got;               // the replay did something here
+    TraceReader::Event got;
+  };
+
+  // the trace has to stay where it is until the replay is finished with
+  TraceReplay(const uint8_t* data, size_t size, const Params& params);
+
+  bool valid() const { return valid_; }
+
+  // time of the last record, when the replay has nothing more to drive
+  uint64_t end() const { return end_; }
+
+  uint64_t inputs() const { return inputs_; }   // pin changes driven
+  uint64_t lost() const { return lost_; }       // records the device lost
+
+  /*
+   * Compare
+   *
+   * Find the first servo or state record that differs between a recording
+   * and a replay of it, or where the replay stops short. Anything the replay
+   * did after the recording ends isn't compared.
+   */
+  static Divergence compare(TraceReader expected, TraceReader got);
+
+  /*
+   * Recorded
+   *
+   * The trace the firmware on the simulator has recorded this run: what it
+   * has sent out over Serial and what's still waiting in TraceRecorder.
+   * That's taken out of TraceRecorder, so call it once, at the end.
+   */
+  static std::string recorded();
+
+ private:
+  Params params_;
+  bool valid_;
+  uint64_t end_ {0};
+  uint64_t inputs_ {0};
+  uint64_t lost_ {0};
+  TraceReader echo_;    // where each pin has got to in the trace
+  TraceReader pir_;
+
+  void schedule_echo_();
+  void schedule_pir_(uint64_t after);
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_TRACEREPLAY_H_
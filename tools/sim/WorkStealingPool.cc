@@ -0,0 +1,75 @@
+#include <WorkStealingPool.h>
+
+#include <atomic>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) : threads_(threads) {
+  if (threads_ == 0) {
+    threads_ = std::thread::hardware_concurrency();
+  }
+  if (threads_ == 0) {
+    threads_ = 1;
+  }
+  for (unsigned i = 0; i < threads_; ++i) {
+    queues_.emplace_back(new Queue);
+  }
+}
+
+void WorkStealingPool::run(size_t n, const Job& job) {
+  // deal out in blocks, so each worker starts on its own part of the batch
+  for (unsigned w = 0; w < threads_; ++w) {
+    size_t first = n * w / threads_;
+    size_t last = n * (w + 1) / threads_;
+    std::lock_guard<std::mutex> guard {queues_[w]->lock};
+    for (size_t i = first; i < last; ++i) {
+      queues_[w]->jobs.push_back(i);
+    }
+  }
+
+  std::atomic<uint64_t> steals {0};
+  auto work = [&](unsigned worker) {
+    size_t index;
+    bool stolen;
+    while (take_(worker, index, stolen)) {
+      if (stolen) {
+        steals.fetch_add(1, std::memory_order_relaxed);
+      }
+      job(index, worker);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned w = 1; w < threads_; ++w) {
+    pool.emplace_back(work, w);
+  }
+  work(0);  // the calling thread is worker 0
+  for (auto& thread : pool) {
+    thread.join();
+  }
+  steals_ = steals;
+}
+
+// own work from the back, or someone else's from the front
+bool WorkStealingPool::take_(unsigned worker, size_t& index, bool& stolen) {
+  {
+    Queue& own = *queues_[worker];
+    std::lock_guard<std::mutex> guard {own.lock};
+    if (!own.jobs.empty()) {
+      index = own.jobs.back();
+      own.jobs.pop_back();
+      stolen = false;
+      return true;
+    }
+  }
+  for (unsigned i = 1; i < threads_; ++i) {
+    Queue& victim = *queues_[(worker + i) % threads_];
+    std::lock_guard<std::mutex> guard {victim.lock};
+    if (!victim.jobs.empty()) {
+      index = victim.jobs.front();
+      victim.jobs.pop_front();
+      stolen = true;
+      return true;
+    }
+  }
+  return false;
+}
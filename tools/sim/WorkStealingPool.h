@@ -0,0 +1,57 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_WORKSTEALINGPOOL_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_WORKSTEALINGPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+ * WorkStealingPool - run a batch of independent jobs across threads
+ *
+ * Jobs are numbered 0 to n - 1 and dealt out to the workers in contiguous
+ * blocks up front. Each worker takes from the back of its own deque, and when
+ * that's empty steals from the front of someone else's, so a worker that
+ * drew the long simulations gets help rather than holding everyone up.
+ *
+ * Jobs don't make more jobs, so a worker that finds every deque empty is
+ * done.
+ */
+class WorkStealingPool {
+ public:
+  // job index, and which worker (0 to threads() - 1) is running it
+  using Job = std::function<void(size_t index, unsigned worker)>;
+
+  // 0 threads is one per core
+  explicit WorkStealingPool(unsigned threads = 0);
+
+  unsigned threads() const { return threads_; }
+
+  /*
+   * Run
+   *
+   * Run job for each index in [0, n), and return when they've all finished.
+   * job has to be safe to call from several threads at once.
+   */
+  void run(size_t n, const Job& job);
+
+  // jobs taken from another worker's deque in the last run()
+  uint64_t steals() const { return steals_; }
+
+ private:
+  struct Queue {
+    std::mutex lock;
+    std::deque<size_t> jobs;
+  };
+
+  unsigned threads_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+  uint64_t steals_ {0};
+
+  bool take_(unsigned worker, size_t& index, bool& stolen);
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_WORKSTEALINGPOOL_H_
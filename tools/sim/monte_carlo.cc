@@ -0,0 +1,140 @@
+/*
+ * monte_carlo - score the firmware over many randomised scenarios
+ *
+ * Usage:
+ *
+ *    monte_carlo [-n runs] [-j threads] [-s first_seed] [-t seconds]
+ *                [-o runs.csv] [-S setting=value ...]
+ *
+ * Runs scenarios first_seed to first_seed + runs - 1 (1000 from 1 by
+ * default), each for seconds of device time, across threads (one per core by
+ * default) and prints detection latency and false alarm statistics. -o also
+ * writes one line per run. Each -S runs every scenario with a setting (see
+ * Settings.h, the same names the console takes) in place of its default,
+ * e.g. -S distance_yellow=500 -S ping_ms=800; they're set in the order given.
+ */
+
+#include <MonteCarlo.h>
+#include <WorkStealingPool.h>
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static void usage(const char* name) {
+  std::cerr << "usage: " << name << " [-n runs] [-j threads] [-s first_seed]"
+            << " [-t seconds] [-o runs.csv] [-S setting=value ...]\n";
+}
+
+// name=value, with a setting of that name and a whole number value
+static bool parse_setting(const char* text, MonteCarlo::Setting& setting) {
+  const char* equals = std::strchr(text, '=');
+  if (equals == nullptr) {
+    return false;
+  }
+  setting.id = Settings::find(std::string(text, equals).c_str());
+  if (setting.id == Settings::Id::COUNT || !std::isdigit(equals[1])) {
+    return false;
+  }
+
+  char* end = nullptr;
+  errno = 0;
+  unsigned long value = std::strtoul(equals + 1, &end, 10);
+  if (*end != '\0' || errno == ERANGE || value > UINT32_MAX) {
+    return false;
+  }
+  setting.value = (uint32_t)value;
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  size_t runs = 1000;
+  unsigned threads = 0;
+  uint64_t first_seed = 1;
+  MonteCarlo::Ranges ranges;
+  const char* csv_path = nullptr;
+  std::vector<MonteCarlo::Setting> settings;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+
+    if (std::strcmp(argv[i], "-n") == 0 && has_value) {
+      runs = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-j") == 0 && has_value) {
+      threads = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-s") == 0 && has_value) {
+      first_seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-t") == 0 && has_value) {
+      ranges.duration_s = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-o") == 0 && has_value) {
+      csv_path = argv[++i];
+    } else if (std::strcmp(argv[i], "-S") == 0 && has_value) {
+      MonteCarlo::Setting setting;
+      if (!parse_setting(argv[++i], setting)) {
+        std::cerr << argv[0] << ": not a setting=value: " << argv[i] << "\n";
+        return 2;
+      }
+      settings.push_back(setting);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (runs == 0 || ranges.duration_s == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  // checked here, as run() can't say which it couldn't set
+  Settings::defaults();
+  for (auto& setting : settings) {
+    if (!Settings::set(setting.id, setting.value)) {
+      Settings::Range range = Settings::range(setting.id);
+      std::cerr << argv[0] << ": " << Settings::entry(setting.id).name
+                << " can be " << range.min << " to " << range.max
+                << " with the settings before it\n";
+      return 2;
+    }
+  }
+
+  std::vector<MonteCarlo::Outcome> outcomes(runs);
+  WorkStealingPool pool {threads};
+  auto start = std::chrono::steady_clock::now();
+
+  pool.run(runs, [&](size_t i, unsigned) {
+    auto scenario = MonteCarlo::make_scenario(first_seed + i, ranges);
+    scenario.settings = settings;
+    outcomes[i] = MonteCarlo::run(scenario);
+  });
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  MonteCarlo::Summary summary;
+  for (auto& outcome : outcomes) {
+    summary.add(outcome);
+  }
+  summary.print(std::cout);
+  std::cout << elapsed.count() << " s on " << pool.threads()
+            << " threads, " << pool.steals() << " steals\n";
+
+  if (csv_path != nullptr) {
+    std::ofstream csv {csv_path};
+    if (!csv) {
+      std::cerr << argv[0] << ": can't write " << csv_path << "\n";
+      return 1;
+    }
+    csv << "seed,intruder,entered,detected,latency_ms,decisions,"
+           "false_alarms\n";
+    for (auto& o : outcomes) {
+      csv << o.seed << ',' << o.intruder << ',' << o.entered << ','
+          << o.detected << ',' << o.latency_ms << ',' << o.decisions << ','
+          << o.false_alarms << '\n';
+    }
+  }
+  return 0;
+}
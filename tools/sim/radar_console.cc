@@ -0,0 +1,132 @@
+/*
+ * radar_console - run the firmware in real time with Serial on a pty
+ *
+ * Usage:
+ *
+ *    radar_console [-t seconds] [-c scene] [-r seed] [-m at_seconds]
+ *                  [-e eeprom.bin]
+ *
+ * Runs the firmware as it's built for the device by default, with
+ * telemetry and the Console on Serial, at the speed it would run on the Uno,
+ * for seconds (until interrupted by default). Serial is a pty (see
+ * SerialPty), whose path goes to stderr at the start: telemetry_decode it
+ * to watch the pings, or open it in a terminal program and type a line to
+ * get the console. The scene, seed and motion are as for radar_sim.
+ *
+ * -e keeps the EEPROM in a file, read at the start if it's there and written
+ * at the end, so settings saved from the console are there next time, as
+ * they would be on the Uno.
+ */
+
+#include <SimArduino.h>
+#include <SimFirmware.h>
+#include <HCSR04Model.h>
+#include <SerialPty.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+static const uint32_t motion_s {10};
+
+static volatile std::sig_atomic_t interrupted {0};
+
+static void on_signal(int) {
+  interrupted = 1;
+}
+
+static void usage(const char* name) {
+  std::cerr << "usage: " << name
+            << " [-t seconds] [-c scene] [-r seed] [-m at_seconds]"
+            << " [-e eeprom.bin]\n";
+}
+
+int main(int argc, char* argv[]) {
+  uint64_t run_s = 0;
+  int64_t motion_at = -1;
+  const char* eeprom_path = nullptr;
+  Scene scene;
+  HCSR04Model::Params sensor_params;
+  sensor_params.trigger_pin = CFG::trigger_pin;
+  sensor_params.echo_pin = CFG::echo_pin;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+
+    if (std::strcmp(argv[i], "-t") == 0 && has_value) {
+      run_s = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-c") == 0 && has_value) {
+      std::ifstream in {argv[++i]};
+      if (!in || !scene.parse(in)) {
+        std::cerr << argv[0] << ": can't read scene " << argv[i] << "\n";
+        return 1;
+      }
+    } else if (std::strcmp(argv[i], "-r") == 0 && has_value) {
+      sensor_params.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-m") == 0 && has_value) {
+      motion_at = std::strtoll(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-e") == 0 && has_value) {
+      eeprom_path = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  using SA = SimArduino;
+  SA::reset();
+  if (eeprom_path != nullptr) {
+    // not there yet is fine, it stays erased
+    std::ifstream in {eeprom_path, std::ios::binary};
+    in.read((char*)SA::eeprom(), ArduinoInterface::eeprom_size);
+  }
+  ServoModel servo {{CFG::servo_pin}};
+  HCSR04Model sensor {scene, servo, sensor_params};
+
+  if (motion_at >= 0) {
+    SA::at(motion_at * 1000000ULL, []() { SA::drive(CFG::ir_pin, HIGH); });
+    SA::at((motion_at + motion_s) * 1000000ULL,
+           []() { SA::drive(CFG::ir_pin, LOW); });
+  }
+
+  SerialPty pty;
+  if (!pty.open()) {
+    std::cerr << argv[0] << ": can't open a pty: " << std::strerror(errno)
+              << "\n";
+    return 1;
+  }
+  std::cerr << "Serial is on " << pty.path() << "\n";
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t end = run_s * 1000000ULL;
+  setup();
+  while (!interrupted && (run_s == 0 || SA::now() < end)) {
+    loop();
+    pty.pump();
+
+    // wait for the wall clock to catch up with the device's
+    auto due = start + std::chrono::microseconds(SA::now());
+    std::this_thread::sleep_until(due);
+  }
+  pty.pump();
+
+  if (eeprom_path != nullptr) {
+    std::ofstream out {eeprom_path, std::ios::binary};
+    if (!out.write((const char*)SA::eeprom(),
+                   ArduinoInterface::eeprom_size)) {
+      std::cerr << argv[0] << ": can't write " << eeprom_path << "\n";
+      return 1;
+    }
+  }
+  std::cerr << SA::now() / 1e6 << " s of device time, ends in state "
+            << (int)context->get_state() << "\n";
+  return 0;
+}
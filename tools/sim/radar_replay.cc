@@ -0,0 +1,132 @@
+/*
+ * radar_replay - play a recorded trace back through the firmware
+ *
+ * Usage:
+ *
+ *    radar_replay [-w replay.bin] trace.bin
+ *    radar_replay -d trace.bin
+ *
+ * Runs setup() and loop() from main.cpp on the simulator with the echo and
+ * PIR pins driven from trace.bin, a recording from the device (built with
+ * TRACE_RECORD) or from radar_sim -w, until the last record. Then checks the
+ * firmware moved the servo and changed state as the recording says it did,
+ * and prints where it first didn't. Exits 1 if it didn't match.
+ *
+ * -w writes the trace the replay recorded, which is the same every time for
+ * the same trace.bin. -d prints trace.bin as text, one record a line, and
+ * doesn't replay it.
+ */
+
+#include <SimArduino.h>
+#include <SimFirmware.h>
+#include <TraceReplay.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static void usage(const char* name) {
+  std::cerr << "usage: " << name << " [-w replay.bin] trace.bin\n"
+            << "       " << name << " -d trace.bin\n";
+}
+
+static int dump(const MappedFile& file) {
+  TraceReader reader {file.data(), file.size()};
+  TraceReader::Event event {};
+  while (reader.next(event)) {
+    std::cout << event << "\n";
+  }
+  if (reader.truncated()) {
+    std::cerr << "bad record at byte " << reader.offset() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  const char* trace_path = nullptr;
+  const char* out_path = nullptr;
+  bool dump_only = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (std::strcmp(argv[i], "-d") == 0) {
+      dump_only = true;
+    } else if (argv[i][0] != '-' && trace_path == nullptr) {
+      trace_path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (trace_path == nullptr) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  MappedFile file;
+  if (!file.open(trace_path)) {
+    std::cerr << argv[0] << ": can't open " << trace_path << ": "
+              << std::strerror(errno) << "\n";
+    return 1;
+  }
+  if (!TraceReader {file.data(), file.size()}.valid()) {
+    std::cerr << argv[0] << ": " << trace_path << " isn't a trace\n";
+    return 1;
+  }
+  if (dump_only) {
+    return dump(file);
+  }
+
+  using SA = SimArduino;
+  SA::reset();
+  TraceReplay replay {file.data(), file.size(),
+                      {CFG::echo_pin, CFG::ir_pin}};
+
+  auto start = std::chrono::steady_clock::now();
+  setup();
+  while (SA::now() <= replay.end()) {
+    loop();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::string recorded = TraceReplay::recorded();
+
+  if (out_path != nullptr) {
+    std::ofstream out {out_path, std::ios::binary};
+    if (!out.write(recorded.data(), (std::streamsize)recorded.size())) {
+      std::cerr << argv[0] << ": can't write " << out_path << "\n";
+      return 1;
+    }
+  }
+
+  auto d = TraceReplay::compare(
+      {file.data(), file.size()},
+      {(const uint8_t*)recorded.data(), recorded.size()});
+
+  double device_s = SA::now() / 1e6;
+  std::cerr << device_s << " s of device time in " << elapsed.count()
+            << " s (" << device_s / elapsed.count() << "x), "
+            << replay.inputs() << " inputs driven\n";
+  if (replay.lost() != 0) {
+    std::cerr << replay.lost() << " records were lost in recording, so "
+              << "expect it to go its own way after\n";
+  }
+  if (!d.found) {
+    std::cerr << d.compared << " servo moves and state changes match\n";
+    return 0;
+  }
+
+  std::cerr << "differs after " << d.compared << " matching outputs:\n";
+  std::cerr << "  recorded: " << d.expected << "\n";
+  std::cerr << "  replayed: ";
+  if (d.has_got) {
+    std::cerr << d.got << "\n";
+  } else {
+    std::cerr << "nothing more\n";
+  }
+  return 1;
+}
@@ -0,0 +1,166 @@
+/*
+ * radar_sim - run the firmware on the host simulator
+ *
+ * Usage:
+ *
+ *    radar_sim [-t seconds] [-c scene] [-r seed] [-m at_seconds] [-s]
+ *              [-w trace.bin]
+ *
+ * Runs setup() and then loop() from main.cpp for seconds of device time (an
+ * hour by default) on SimArduino's virtual clock, with the servo and HC-SR04
+ * modelled looking at the targets in scene (see Scene::parse()). -r seeds the
+ * sensor's noise, -m holds the PIR output high for ten seconds from
+ * at_seconds in, and -s copies Serial to stdout. -w writes the trace the
+ * firmware recorded (see TraceRecorder), for radar_replay. A summary of what
+ * the firmware did goes to stderr at the end, then the Profiler's dump of
+ * how long its commands took, in simulated time, and the most heap and stack
+ * it used (see Memory).
+ */
+
+#include <SimArduino.h>
+#include <SimFirmware.h>
+#include <HCSR04Model.h>
+#include <TraceReplay.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const uint32_t motion_s {10};
+
+// Print onto a stream, for the profiler's dump
+class StreamPrint : public Print {
+  std::ostream& out_;
+
+ public:
+  explicit StreamPrint(std::ostream& out) : out_{out} {}
+  size_t write(uint8_t c) override {
+    if (c != '\r') {
+      out_.put((char)c);
+    }
+    return 1;
+  }
+  using Print::write;
+};
+
+static void usage(const char* name) {
+  std::cerr << "usage: " << name
+            << " [-t seconds] [-c scene] [-r seed] [-m at_seconds] [-s]"
+            << " [-w trace.bin]\n";
+}
+
+static const char* state_name(RadarStateId s) {
+  switch (s) {
+    case RadarStateId::STANDBY:
+      return "STANDBY";
+    case RadarStateId::SENSING:
+      return "SENSING";
+    case RadarStateId::WARNING:
+      return "WARNING";
+    default:
+      return "NONE";
+  }
+}
+
+int main(int argc, char* argv[]) {
+  uint64_t run_s = 3600;
+  int64_t motion_at = -1;
+  bool serial = false;
+  const char* trace_path = nullptr;
+  Scene scene;
+  HCSR04Model::Params sensor_params;
+  sensor_params.trigger_pin = CFG::trigger_pin;
+  sensor_params.echo_pin = CFG::echo_pin;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+
+    if (std::strcmp(argv[i], "-t") == 0 && has_value) {
+      run_s = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-c") == 0 && has_value) {
+      std::ifstream in {argv[++i]};
+      if (!in || !scene.parse(in)) {
+        std::cerr << argv[0] << ": can't read scene " << argv[i] << "\n";
+        return 1;
+      }
+    } else if (std::strcmp(argv[i], "-r") == 0 && has_value) {
+      sensor_params.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-m") == 0 && has_value) {
+      motion_at = std::strtoll(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-s") == 0) {
+      serial = true;
+    } else if (std::strcmp(argv[i], "-w") == 0 && has_value) {
+      trace_path = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  using SA = SimArduino;
+  SA::reset();
+  SA::echo_serial(serial);
+  ServoModel servo {{CFG::servo_pin}};
+  HCSR04Model sensor {scene, servo, sensor_params};
+
+  uint64_t servo_moves = 0, triggers = 0, pwm_writes = 0;
+  SA::watch([&](SA::Output what, uint8_t pin, uint16_t value) {
+    if (what == SA::Output::SERVO) {
+      ++servo_moves;
+    } else if (what == SA::Output::PWM) {
+      ++pwm_writes;
+    } else if (what == SA::Output::DIGITAL && pin == CFG::trigger_pin
+               && value == HIGH) {
+      ++triggers;
+    }
+  });
+
+  if (motion_at >= 0) {
+    SA::at(motion_at * 1000000ULL, []() { SA::drive(CFG::ir_pin, HIGH); });
+    SA::at((motion_at + motion_s) * 1000000ULL,
+           []() { SA::drive(CFG::ir_pin, LOW); });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  uint64_t loops = 0;
+  uint64_t end = run_s * 1000000ULL;
+  setup();
+  while (SA::now() < end) {
+    loop();
+    ++loops;
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  SA::Stats stats = SA::stats();
+  double device_s = SA::now() / 1e6;
+
+  std::cerr << device_s << " s of device time in " << elapsed.count()
+            << " s (" << device_s / elapsed.count() << "x), "
+            << loops << " loops\n"
+            << stats.calls << " calls, " << stats.events << " events, "
+            << stats.interrupts << " interrupts, " << stats.skips
+            << " idle skips\n"
+            << servo_moves << " servo moves, " << triggers << " pings, "
+            << sensor.echoes() << " echoes, "
+            << pwm_writes << " LED writes, ends in "
+            << state_name(context->get_state()) << "\n";
+  StreamPrint profile {std::cerr};
+  Profiler::dump(profile);
+  Memory::report(profile);
+
+  if (trace_path != nullptr) {
+    std::string trace = TraceReplay::recorded();
+    std::ofstream out {trace_path, std::ios::binary};
+    if (!out.write(trace.data(), (std::streamsize)trace.size())) {
+      std::cerr << argv[0] << ": can't write " << trace_path << "\n";
+      return 1;
+    }
+    std::cerr << trace.size() << " bytes of trace, "
+              << TraceRecorder::dropped() << " records dropped\n";
+  }
+  return 0;
+}
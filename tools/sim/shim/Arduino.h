@@ -0,0 +1,98 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_ARDUINO_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_ARDUINO_H_
+
+/*
+ * Stand in for the core's Arduino.h in the HOST_SIM build. Everything that
+ * touches the hardware goes to SimArduino, so code calling the core directly
+ * (LiquidCrystal, main.cpp) runs on the same virtual clock as code going
+ * through ArduinoInterface.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <avr/pgmspace.h>
+#include <Print.h>
+#include <SimArduino.h>
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p)  ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#define PIN_A0   (14)
+#define PIN_A1   (15)
+#define PIN_A2   (16)
+#define PIN_A3   (17)
+#define PIN_A4   (18)
+#define PIN_A5   (19)
+#define PIN_A6   (20)
+#define PIN_A7   (21)
+
+static const uint8_t A0 = PIN_A0;
+static const uint8_t A1 = PIN_A1;
+static const uint8_t A2 = PIN_A2;
+static const uint8_t A3 = PIN_A3;
+static const uint8_t A4 = PIN_A4;
+static const uint8_t A5 = PIN_A5;
+static const uint8_t A6 = PIN_A6;
+static const uint8_t A7 = PIN_A7;
+
+#define noInterrupts() SimArduino::disable_interrupts()
+#define interrupts() SimArduino::enable_interrupts()
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  SimArduino::pinMode(pin, mode);
+}
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+  SimArduino::digitalWrite(pin, val);
+}
+inline int digitalRead(uint8_t pin) {
+  return SimArduino::digitalRead(pin);
+}
+inline void analogWrite(uint8_t pin, int val) {
+  SimArduino::analogueWrite(pin, (uint8_t)val);
+}
+inline unsigned long millis() {
+  return SimArduino::millis();
+}
+inline unsigned long micros() {
+  return SimArduino::micros();
+}
+inline void delay(unsigned long ms) {
+  SimArduino::delay(ms);
+}
+inline void delayMicroseconds(unsigned int us) {
+  SimArduino::delayMicroseconds(us);
+}
+
+/*
+ * HardwareSerial
+ *
+ * What's written collects in SimArduino::serial_output(), and what's read
+ * comes from SimArduino::serial_receive().
+ */
+class HardwareSerial : public Print {
+ public:
+  void begin(unsigned long) {}
+  // the simulated line never backs up
+  int availableForWrite() { return 63; }
+  int available() { return SimArduino::serial_available(); }
+  int read() { return SimArduino::serial_read(); }
+  size_t write(uint8_t c) override {
+    SimArduino::serial_write(c);
+    return 1;
+  }
+  using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_ARDUINO_H_
@@ -0,0 +1,75 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_PRINT_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_PRINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define DEC 10
+#define HEX 16
+
+/*
+ * Print
+ *
+ * The part of the core's Print the firmware uses. Subclasses only have to
+ * write a byte, the rest is built on that.
+ */
+class Print {
+ public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+  size_t write(const char* str) {
+    return (str == nullptr) ? 0 : write((const uint8_t*)str, strlen(str));
+  }
+  size_t write(const char* buffer, size_t size) {
+    return write((const uint8_t*)buffer, size);
+  }
+
+  size_t print(const char* str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned long n, int base = DEC) {
+    return print_number_(n, base);
+  }
+  size_t print(long n, int base = DEC) {
+    if (n < 0 && base == DEC) {
+      return print('-') + print_number_(0UL - (unsigned long)n, base);
+    }
+    return print_number_((unsigned long)n, base);
+  }
+  size_t print(unsigned int n, int base = DEC) {
+    return print((unsigned long)n, base);
+  }
+  size_t print(int n, int base = DEC) { return print((long)n, base); }
+
+  size_t println() { return write("\r\n"); }
+  template <class T>
+  size_t println(T value) {
+    return print(value) + println();
+  }
+
+ private:
+  size_t print_number_(unsigned long n, int base) {
+    char buf[8 * sizeof(long) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if (base < 2) {
+      base = 10;
+    }
+    do {
+      char digit = (char)(n % base);
+      n /= base;
+      *--str = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    } while (n);
+    return write(str);
+  }
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_PRINT_H_
@@ -0,0 +1,54 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_SERVO_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_SERVO_H_
+
+#include <SimArduino.h>
+
+#define MIN_PULSE_WIDTH 544
+#define MAX_PULSE_WIDTH 2400
+
+/*
+ * Servo
+ *
+ * Stands in for the Servo library. There's no pulse train, the angle written
+ * goes straight to SimArduino::servo_write() for whatever is modelling the
+ * servo to pick up.
+ */
+class Servo {
+ public:
+  uint8_t attach(int pin) {
+    return attach(pin, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+  }
+  uint8_t attach(int pin, int min, int max) {
+    pin_ = pin;
+    min_ = min;
+    max_ = max;
+    return 0;
+  }
+  void detach() { pin_ = -1; }
+  bool attached() const { return pin_ >= 0; }
+
+  // as the library, values below the minimum pulse width are angles
+  void write(int value) {
+    if (value >= MIN_PULSE_WIDTH) {
+      writeMicroseconds(value);
+      return;
+    }
+    angle_ = (value < 0) ? 0 : (value > 180) ? 180 : value;
+    if (attached()) {
+      SimArduino::servo_write((uint8_t)pin_, (uint8_t)angle_);
+    }
+  }
+  void writeMicroseconds(int us) {
+    us = (us < min_) ? min_ : (us > max_) ? max_ : us;
+    write((us - min_) * 180 / (max_ - min_));
+  }
+  int read() const { return angle_; }
+
+ private:
+  int pin_ {-1};
+  int min_ {MIN_PULSE_WIDTH};
+  int max_ {MAX_PULSE_WIDTH};
+  int angle_ {90};
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_SERVO_H_
@@ -0,0 +1,14 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_AVR_PGMSPACE_H_
+#define A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_AVR_PGMSPACE_H_
+
+// The host has one address space, so flash is just more memory
+
+#include <cstdint>
+#include <cstring>
+
+#define PROGMEM
+#define memcpy_P memcpy
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_SIM_SHIM_AVR_PGMSPACE_H_
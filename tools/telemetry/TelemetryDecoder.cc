@@ -0,0 +1,183 @@
+#include <TelemetryDecoder.h>
+
+using Telemetry::Kind;
+
+namespace {
+
+const uint8_t columns_magic[3] {'R', 'T', 'C'};
+const uint8_t columns_version {1};
+
+void put_le(std::ostream& out, uint64_t value, uint8_t width) {
+  for (uint8_t i = 0; i < width; ++i) {
+    out.put((char)(value >> (8 * i)));
+  }
+}
+
+// name, width, then each row's value of it
+template<typename Get>
+void column(std::ostream& out, const char* name, uint8_t width,
+            const std::vector<TelemetryDecoder::Row>& rows, Get get) {
+  size_t length = std::char_traits<char>::length(name);
+  out.put((char)length);
+  out.write(name, (std::streamsize)length);
+  out.put((char)width);
+  for (auto& row : rows) {
+    put_le(out, get(row), width);
+  }
+}
+
+} // namespace
+
+size_t TelemetryDecoder::feed(const uint8_t* data, size_t size) {
+  size_t before = rows_.size();
+  stats_.bytes += size;
+
+  for (size_t i = 0; i < size; ++i) {
+    if (data[i] == 0) {
+      frame_end_();
+    } else if (frame_.size() < max_encoded) {
+      frame_.push_back(data[i]);
+    } else {
+      overlong_ = true;
+    }
+  }
+  return rows_.size() - before;
+}
+
+void TelemetryDecoder::frame_end_() {
+  bool overlong = overlong_;
+  overlong_ = false;
+  if (frame_.empty() && !overlong) {
+    return;
+  }
+
+  uint8_t payload[max_encoded];
+  size_t size = overlong ? 0 : Telemetry::cobs_decode(frame_.data(),
+                                                      frame_.size(), payload);
+  frame_.clear();
+
+  if (size < 2 + Telemetry::crc_size
+      || Telemetry::crc16(payload, size - Telemetry::crc_size)
+         != (uint16_t)(payload[size - 2] << 8 | payload[size - 1])) {
+    ++stats_.bad;
+    have_key_ = false;
+    return;
+  }
+  size -= Telemetry::crc_size;
+
+  if (have_sequence_ && payload[0] != sequence_) {
+    ++stats_.gaps;
+    have_key_ = false;
+  }
+  have_sequence_ = true;
+  sequence_ = (uint8_t)(payload[0] + 1);
+
+  if (payload_(payload + 1, payload + size)) {
+    ++stats_.frames;
+  } else {
+    ++stats_.bad;
+    have_key_ = false;
+  }
+}
+
+bool TelemetryDecoder::payload_(const uint8_t* data, const uint8_t* end) {
+  using Telemetry::get_varint;
+  using Telemetry::unzigzag;
+
+  Kind kind = (Kind)*data++;
+  uint32_t a, b, c;
+
+  switch (kind) {
+    case Kind::KEY: {
+      if (end - data < 1) {
+        return false;
+      }
+      Kind stands_for = (Kind)*data++;
+      if (!get_varint(data, end, a) || end - data < 1) {
+        return false;
+      }
+      uint8_t angle = *data++;
+      if (!get_varint(data, end, b) || end - data != 1
+          || (stands_for != Kind::RANGE && stands_for != Kind::STATE)) {
+        return false;
+      }
+      // the time is millis() as it was, which may have wrapped since
+      time_ = have_time_ ? time_ + (uint32_t)(a - (uint32_t)time_) : a;
+      have_time_ = true;
+      angle_ = angle;
+      range_ = b;
+      state_ = *data;
+      have_key_ = true;
+      row_(stands_for);
+      return true;
+    }
+
+    case Kind::RANGE:
+      if (!get_varint(data, end, a) || !get_varint(data, end, b)
+          || !get_varint(data, end, c) || data != end) {
+        return false;
+      }
+      if (!have_key_) {
+        ++stats_.skipped;
+        return true;
+      }
+      time_ += a;
+      angle_ = (uint8_t)(angle_ + unzigzag(b));
+      range_ += (uint32_t)unzigzag(c);
+      row_(Kind::RANGE);
+      return true;
+
+    case Kind::STATE:
+      if (!get_varint(data, end, a) || end - data != 1) {
+        return false;
+      }
+      if (!have_key_) {
+        ++stats_.skipped;
+        return true;
+      }
+      time_ += a;
+      state_ = *data;
+      row_(Kind::STATE);
+      return true;
+
+    case Kind::LOST:
+      if (!get_varint(data, end, a) || data != end) {
+        return false;
+      }
+      stats_.lost += a;
+      have_key_ = false;
+      return true;
+  }
+  return false;
+}
+
+void TelemetryDecoder::row_(Kind kind) {
+  rows_.push_back({time_, kind, angle_, range_, state_});
+}
+
+void TelemetryDecoder::write_csv_header(std::ostream& out) {
+  out << "time_ms,kind,angle,range_mm,state\n";
+}
+
+void TelemetryDecoder::write_csv(std::ostream& out,
+                                 const std::vector<Row>& rows) {
+  for (auto& row : rows) {
+    out << row.time << ',' << (row.kind == Kind::RANGE ? "range" : "state")
+        << ',' << (unsigned)row.angle << ',' << row.range << ','
+        << (unsigned)row.state << '\n';
+  }
+}
+
+void TelemetryDecoder::write_columns(std::ostream& out,
+                                     const std::vector<Row>& rows) {
+  out.write((const char*)columns_magic, sizeof(columns_magic));
+  out.put((char)columns_version);
+  put_le(out, rows.size(), 4);
+  out.put(5);
+
+  column(out, "time_ms", 8, rows, [](const Row& r) { return r.time; });
+  column(out, "kind", 1, rows, [](const Row& r) { return (uint64_t)r.kind; });
+  column(out, "angle", 1, rows, [](const Row& r) { return r.angle; });
+  column(out, "range_mm", 4, rows, [](const Row& r) { return r.range; });
+  column(out, "state", 1, rows, [](const Row& r) { return r.state; });
+}
@@ -0,0 +1,116 @@
+#ifndef A_TOOLCHAIN_TEST_TOOLS_TELEMETRY_TELEMETRYDECODER_H_
+#define A_TOOLCHAIN_TEST_TOOLS_TELEMETRY_TELEMETRYDECODER_H_
+
+#include <Telemetry.h>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+ * TelemetryDecoder - turn the radar's telemetry back into rows. Host only.
+ *
+ * Takes the byte stream TelemetrySender sends (see Telemetry.h) in whatever
+ * pieces it comes in, and gives a row for each ping and state change, with
+ * the deltas added back up. Times are unwrapped, so they carry on past
+ * millis() wrapping.
+ *
+ * A frame that won't decode, or fails its CRC, is counted as bad and
+ * skipped. After a bad frame or a gap in the sequence, deltas can't be added
+ * up any more, so they're counted as skipped until the next KEY. The same
+ * goes for the start of the stream if it was joined part way in.
+ */
+class TelemetryDecoder {
+ public:
+  struct Row {
+    uint64_t time;          // ms
+    Telemetry::Kind kind;   // RANGE or STATE
+    uint8_t angle;
+    uint32_t range;         // mm, 0 for no echo
+    uint8_t state;
+
+    bool operator==(const Row& rhs) const {
+      return time == rhs.time && kind == rhs.kind && angle == rhs.angle
+             && range == rhs.range && state == rhs.state;
+    }
+  };
+
+  struct Stats {
+    uint64_t bytes;
+    uint64_t frames;     // that decoded
+    uint64_t bad;        // COBS, CRC or fields wrong
+    uint64_t gaps;       // times the sequence jumped
+    uint64_t skipped;    // frames waiting for a KEY
+    uint64_t lost;       // frames the sender said it dropped
+  };
+
+  // longer than any frame, so a stream without 0s can't fill memory
+  static constexpr size_t max_encoded {255};
+
+ private:
+  std::vector<uint8_t> frame_;
+  bool overlong_ {false};
+  std::vector<Row> rows_;
+  Stats stats_ {};
+
+  bool have_key_ {false};
+  bool have_sequence_ {false};
+  uint8_t sequence_ {0};
+  bool have_time_ {false};
+  uint64_t time_ {0};
+  uint8_t angle_ {0};
+  uint32_t range_ {0};
+  uint8_t state_ {0};
+
+  void frame_end_();
+  // false if the fields were wrong
+  bool payload_(const uint8_t* data, const uint8_t* end);
+  void row_(Telemetry::Kind kind);
+
+ public:
+  /*
+   * Feed
+   *
+   * Decode the next bytes of the stream. Anything after the last 0 is kept
+   * for next time.
+   *
+   * Returns:
+   * size_t - rows added
+   */
+  size_t feed(const uint8_t* data, size_t size);
+
+  // every row so far, or since clear_rows()
+  const std::vector<Row>& rows() const { return rows_; }
+  void clear_rows() { rows_.clear(); }
+
+  Stats stats() const { return stats_; }
+
+  /*
+   * Write CSV
+   *
+   * A header line, then a line a row:
+   *
+   *    time_ms,kind,angle,range_mm,state
+   *    12004,range,91,452,1
+   */
+  static void write_csv_header(std::ostream& out);
+  static void write_csv(std::ostream& out, const std::vector<Row>& rows);
+
+  /*
+   * Write Columns
+   *
+   * The rows a column at a time, each column's values one after another, so
+   * a reader can load the one it wants without going through the rest, as
+   * Parquet does. Little endian throughout:
+   *
+   *    'R' 'T' 'C' version     rows (uint32)     columns (uint8)
+   *    then each column:
+   *      name length (uint8)   name   width in bytes (uint8)   values
+   *
+   * The columns are time_ms (8 bytes), kind (1, Telemetry::Kind), angle
+   * (1), range_mm (4) and state (1).
+   */
+  static void write_columns(std::ostream& out, const std::vector<Row>& rows);
+};
+
+#endif //A_TOOLCHAIN_TEST_TOOLS_TELEMETRY_TELEMETRYDECODER_H_
@@ -0,0 +1,155 @@
+/*
+ * telemetry_decode - turn the radar's telemetry into CSV or columns
+ *
+ * Usage:
+ *
+ *    telemetry_decode [-b baud] [-f csv|columns] [-o out] [input]
+ *
+ * Reads the telemetry the firmware sends over Serial (see Telemetry.h) from
+ * input, a file, a pipe or the serial port itself, or stdin if none is
+ * given. A serial port or pty is put in raw mode first, at -b baud if given.
+ * Reads until the end, or until Ctrl-C for a port, which never ends.
+ *
+ * -f csv (the default) writes a line a ping or state change to out, or
+ * stdout, as they come. -f columns writes them a column at a time at the
+ * end, see TelemetryDecoder::write_columns(). How many frames there were,
+ * and how many were bad or lost, goes to stderr.
+ */
+
+#include <TelemetryDecoder.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+volatile std::sig_atomic_t interrupted {0};
+
+void usage(const char* name) {
+  std::cerr << "usage: " << name
+            << " [-b baud] [-f csv|columns] [-o out] [input]\n";
+}
+
+bool speed_of(unsigned long baud, speed_t& speed) {
+  switch (baud) {
+    case 9600: speed = B9600; return true;
+    case 19200: speed = B19200; return true;
+    case 38400: speed = B38400; return true;
+    case 57600: speed = B57600; return true;
+    case 115200: speed = B115200; return true;
+    default: return false;
+  }
+}
+
+// raw, so nothing is changed on the way in, and at baud if it's not 0
+bool make_raw(int fd, unsigned long baud) {
+  termios tio {};
+  if (tcgetattr(fd, &tio) != 0) {
+    return false;
+  }
+  cfmakeraw(&tio);
+  speed_t speed;
+  if (baud != 0 && (!speed_of(baud, speed) || cfsetispeed(&tio, speed) != 0
+                    || cfsetospeed(&tio, speed) != 0)) {
+    return false;
+  }
+  return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  unsigned long baud = 0;
+  bool columns = false;
+  const char* out_path = nullptr;
+  const char* in_path = nullptr;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+
+    if (std::strcmp(argv[i], "-b") == 0 && has_value) {
+      baud = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "-f") == 0 && has_value) {
+      ++i;
+      if (std::strcmp(argv[i], "columns") == 0) {
+        columns = true;
+      } else if (std::strcmp(argv[i], "csv") != 0) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (std::strcmp(argv[i], "-o") == 0 && has_value) {
+      out_path = argv[++i];
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      usage(argv[0]);
+      return 2;
+    } else if (in_path == nullptr) {
+      in_path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  int fd = (in_path == nullptr) ? STDIN_FILENO : open(in_path, O_RDONLY);
+  if (fd < 0) {
+    std::cerr << argv[0] << ": can't open " << in_path << "\n";
+    return 1;
+  }
+  if (isatty(fd) && !make_raw(fd, baud)) {
+    std::cerr << argv[0] << ": can't set up " << in_path << " at " << baud
+              << " baud\n";
+    return 1;
+  }
+
+  std::ofstream file;
+  if (out_path != nullptr) {
+    file.open(out_path, std::ios::binary);
+    if (!file) {
+      std::cerr << argv[0] << ": can't write " << out_path << "\n";
+      return 1;
+    }
+  }
+  std::ostream& out = (out_path != nullptr) ? file : std::cout;
+
+  // not restarted, so Ctrl-C gets read() out of waiting on a port
+  struct sigaction action {};
+  action.sa_handler = [](int) { interrupted = 1; };
+  sigaction(SIGINT, &action, nullptr);
+
+  TelemetryDecoder decoder;
+  if (!columns) {
+    TelemetryDecoder::write_csv_header(out);
+  }
+  uint8_t buffer[4096];
+  while (!interrupted) {
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // a pty reads EIO once the other end closes
+    if (n <= 0) {
+      break;
+    }
+    if (decoder.feed(buffer, (size_t)n) != 0 && !columns) {
+      TelemetryDecoder::write_csv(out, decoder.rows());
+      out.flush();
+      decoder.clear_rows();
+    }
+  }
+  if (columns) {
+    TelemetryDecoder::write_columns(out, decoder.rows());
+  }
+
+  auto stats = decoder.stats();
+  std::cerr << stats.bytes << " bytes, " << stats.frames << " frames, "
+            << stats.bad << " bad, " << stats.gaps << " gaps, "
+            << stats.skipped << " skipped, " << stats.lost << " lost\n";
+  return out ? 0 : 1;
+}